@@ -0,0 +1,99 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define MATRIX_BENCH_COUNT_ALLOCATIONS 1
+#else
+#define MATRIX_BENCH_COUNT_ALLOCATIONS 0
+#endif
+
+
+namespace {
+
+std::atomic<size_t> g_live{0};
+
+void* countedAlloc(size_t size, size_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+    void* pointer = alignment <= alignof(std::max_align_t)
+        ? std::malloc(size)
+        : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (pointer == nullptr) {
+        throw std::bad_alloc{};
+    }
+#if MATRIX_BENCH_COUNT_ALLOCATIONS
+    g_live.fetch_add(malloc_usable_size(pointer), std::memory_order_relaxed);
+#endif
+    return pointer;
+}
+
+void countedFree(void* pointer) {
+    if (pointer == nullptr) {
+        return;
+    }
+#if MATRIX_BENCH_COUNT_ALLOCATIONS
+    g_live.fetch_sub(malloc_usable_size(pointer), std::memory_order_relaxed);
+#endif
+    std::free(pointer);
+}
+
+}
+
+
+size_t liveBytes() {
+    return g_live.load(std::memory_order_relaxed);
+}
+
+
+void* operator new(size_t size) {
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size) {
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept {
+    countedFree(pointer);
+}
@@ -0,0 +1,16 @@
+/*!
+@file
+@brief Счетчик памяти, выделенной через глобальный operator new, для измерения байт на элемент
+*/
+
+#pragma once
+
+#include <cstddef>
+
+/*!
+ Возвращает количество байт, выделенных через operator new и еще не освобожденных.
+ Учитывается реальный размер блоков аллокатора (malloc_usable_size), поэтому в результат входят
+ служебные накладные расходы. Если платформа не позволяет узнать размер блока, возвращается 0.
+ @return Количество занятых байт
+ */
+size_t liveBytes();
@@ -0,0 +1,102 @@
+#include "sparse_matrix.h"
+#include "alloc_counter.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+
+/*
+ Кластеризованные данные: случайные окрестности 8x8, заполненные на 3/4.
+ Сравниваются вставка (с байтами на элемент), перебор элементов и сумма значений по тайлам BlockData.
+ */
+
+namespace {
+
+std::vector<Indexes<2>> clusteredIndexes(size_t count) {
+    std::mt19937_64 gen{3};
+    std::uniform_int_distribution<size_t> corner{0, (1u << 17) - 1};
+    std::bernoulli_distribution occupied{0.75};
+    
+    std::vector<Indexes<2>> result;
+    result.reserve(count);
+    while (result.size() < count) {
+        const size_t x = corner(gen) * 8;
+        const size_t y = corner(gen) * 8;
+        for (size_t cell = 0; cell < 64 && result.size() < count; ++cell) {
+            if (occupied(gen)) {
+                result.push_back({x + cell / 8, y + cell % 8});
+            }
+        }
+    }
+    return result;
+}
+
+
+template <typename Storage>
+Matrix<int, 0, 2, Storage> clusteredMatrix(const std::vector<Indexes<2>>& indexes) {
+    Matrix<int, 0, 2, Storage> matrix;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        matrix.set(indexes[i], static_cast<int>(i % 1000) + 1);
+    }
+    return matrix;
+}
+
+}
+
+
+template <typename Storage>
+void BM_ClusteredInsert(benchmark::State& state) {
+    const auto indexes = clusteredIndexes(static_cast<size_t>(state.range(0)));
+    
+    size_t bytes = 0;
+    for (auto _ : state) {
+        const size_t before = liveBytes();
+        auto matrix = clusteredMatrix<Storage>(indexes);
+        bytes = liveBytes() - before;
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes_per_nnz"] = static_cast<double>(bytes) / static_cast<double>(indexes.size());
+}
+
+
+template <typename Storage>
+void BM_ClusteredIterate(benchmark::State& state) {
+    const auto matrix = clusteredMatrix<Storage>(clusteredIndexes(static_cast<size_t>(state.range(0))));
+    
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& elem : matrix) {
+            sum += std::get<2>(elem);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+void BM_ClusteredTileSum(benchmark::State& state) {
+    const auto matrix = clusteredMatrix<BlockData<int, 2>>(clusteredIndexes(static_cast<size_t>(state.range(0))));
+    
+    for (auto _ : state) {
+        long long sum = 0;
+        matrix.storage().forEachTile([&sum](const Indexes<2>&, const auto& values, std::uint64_t) {
+            for (int v : values) {
+                sum += v;
+            }
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+BENCHMARK_TEMPLATE(BM_ClusteredInsert, Data<int, 2>)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ClusteredInsert, HashData<int, 2>)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ClusteredInsert, BlockData<int, 2>)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ClusteredIterate, Data<int, 2>)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ClusteredIterate, HashData<int, 2>)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ClusteredIterate, BlockData<int, 2>)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ClusteredTileSum)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,60 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+
+namespace {
+
+std::vector<std::tuple<size_t, size_t, int>> randomTriples(size_t count) {
+    std::mt19937_64 gen{1};
+    std::uniform_int_distribution<size_t> index{0, 1u << 16};
+    
+    std::vector<std::tuple<size_t, size_t, int>> result(count);
+    int value = 1;
+    for (auto& [x, y, v] : result) {
+        x = index(gen);
+        y = index(gen);
+        v = value++;
+    }
+    return result;
+}
+
+}
+
+
+template <typename Storage>
+void BM_ProxyLoad(benchmark::State& state) {
+    const auto triples = randomTriples(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        Matrix<int, 0, 2, Storage> matrix;
+        for (const auto& [x, y, v] : triples) {
+            matrix[x][y] = v;
+        }
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_BulkLoad(benchmark::State& state) {
+    const auto triples = randomTriples(static_cast<size_t>(state.range(0)));
+    ThreadPool pool;
+    
+    for (auto _ : state) {
+        Matrix<int, 0, 2, Storage> matrix;
+        matrix.bulkLoad(triples, DuplicatePolicy::KEEP_LAST, pool);
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+BENCHMARK_TEMPLATE(BM_ProxyLoad, Data<int, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ProxyLoad, HashData<int, 2>)->RangeMultiplier(10)->Range(1000, 1000000)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BulkLoad,  Data<int, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BulkLoad,  HashData<int, 2>)->RangeMultiplier(10)->Range(1000, 1000000)->UseRealTime();
@@ -0,0 +1,52 @@
+#include "concurrent_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+
+
+namespace {
+
+constexpr size_t SIDE = 1u << 12;
+
+ConcurrentMatrix<long long, 0, 2>& sharedMatrix() {
+    static ConcurrentMatrix<long long, 0, 2> matrix;
+    return matrix;
+}
+
+}
+
+
+void BM_ConcurrentAccumulate(benchmark::State& state) {
+    auto& matrix = sharedMatrix();
+    std::mt19937_64 gen{static_cast<std::uint64_t>(state.thread_index()) + 1};
+    std::uniform_int_distribution<size_t> index{0, SIDE - 1};
+    
+    for (auto _ : state) {
+        matrix.accumulate({index(gen), index(gen)}, 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+
+void BM_ConcurrentMixed(benchmark::State& state) {
+    auto& matrix = sharedMatrix();
+    std::mt19937_64 gen{static_cast<std::uint64_t>(state.thread_index()) + 1};
+    std::uniform_int_distribution<size_t> index{0, SIDE - 1};
+    
+    // каждый восьмой запрос -- запись, остальные -- чтение
+    size_t counter = 0;
+    for (auto _ : state) {
+        const Indexes<2> indexes = {index(gen), index(gen)};
+        if (++counter % 8 == 0) {
+            matrix.update(indexes, static_cast<long long>(counter));
+        } else {
+            benchmark::DoNotOptimize(matrix.get(indexes));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+
+BENCHMARK(BM_ConcurrentAccumulate)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_ConcurrentMixed)     ->ThreadRange(1, 64)->UseRealTime();
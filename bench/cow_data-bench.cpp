@@ -0,0 +1,60 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+
+
+namespace {
+
+template <typename M>
+M randomMatrix(size_t count) {
+    std::mt19937_64 gen{1};
+    std::uniform_int_distribution<size_t> index{0, 1u << 16};
+    
+    M matrix;
+    for (size_t i = 0; i < count; ++i) {
+        matrix.set({index(gen), index(gen)}, static_cast<int>(i) + 1);
+    }
+    return matrix;
+}
+
+}
+
+
+void BM_DeepCopy(benchmark::State& state) {
+    const auto matrix = randomMatrix<Matrix<int, 0, 2, HashData<int, 2>>>(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        auto copy = matrix;
+        benchmark::DoNotOptimize(copy.size());
+    }
+}
+
+
+void BM_Snapshot(benchmark::State& state) {
+    const auto matrix = randomMatrix<CowMatrix<int, 0, 2>>(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        auto snapshot = matrix.snapshot();
+        benchmark::DoNotOptimize(snapshot.size());
+    }
+}
+
+
+void BM_SnapshotThenWrite(benchmark::State& state) {
+    auto matrix = randomMatrix<CowMatrix<int, 0, 2>>(static_cast<size_t>(state.range(0)));
+    
+    size_t next = 0;
+    for (auto _ : state) {
+        auto snapshot = matrix.snapshot();
+        matrix.set({next, next}, 1);
+        next = (next + 1) & 0xffff;
+        benchmark::DoNotOptimize(snapshot.size());
+    }
+}
+
+
+BENCHMARK(BM_DeepCopy)         ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_Snapshot)         ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_SnapshotThenWrite)->RangeMultiplier(10)->Range(1000, 1000000);
@@ -0,0 +1,117 @@
+#include "data.h"
+#include "hash_data.h"
+#include "random_indexes.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+
+namespace {
+
+constexpr size_t SIDE = size_t{1} << 20;
+
+template <typename Storage, size_t N>
+void fill(Storage& data, const std::vector<Indexes<N>>& indexes) {
+    int value = 1;
+    for (const auto& i : indexes) {
+        data.insert(data.makeKey(i), value++);
+    }
+}
+
+}
+
+
+template <typename Storage>
+void BM_Insert(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    
+    for (auto _ : state) {
+        Storage data;
+        fill(data, indexes);
+        benchmark::DoNotOptimize(data.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_LookupHit(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    Storage data;
+    fill(data, indexes);
+    
+    for (auto _ : state) {
+        for (const auto& i : indexes) {
+            benchmark::DoNotOptimize(data.getElement(data.makeKey(i)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_LookupMiss(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    const auto missing = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 2);
+    Storage data;
+    fill(data, indexes);
+    
+    for (auto _ : state) {
+        for (const auto& i : missing) {
+            benchmark::DoNotOptimize(data.getElement(data.makeKey(i)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_Iterate(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    Storage data;
+    fill(data, indexes);
+    
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& [x, y, v] : data) {
+            sum += v;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_Erase(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    
+    for (auto _ : state) {
+        state.PauseTiming();
+        Storage data;
+        fill(data, indexes);
+        state.ResumeTiming();
+        
+        for (const auto& i : indexes) {
+            const auto [exists, it] = data.contains(data.makeKey(i));
+            if (exists) {
+                data.erase(it);
+            }
+        }
+        benchmark::DoNotOptimize(data.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+BENCHMARK_TEMPLATE(BM_Insert,     Data<int, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_Insert,     HashData<int, 2>)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_LookupHit,  Data<int, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_LookupHit,  HashData<int, 2>)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_LookupMiss, Data<int, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_LookupMiss, HashData<int, 2>)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_Iterate,    Data<int, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_Iterate,    HashData<int, 2>)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_Erase,      Data<int, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_Erase,      HashData<int, 2>)->RangeMultiplier(10)->Range(1000, 1000000);
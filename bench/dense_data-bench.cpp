@@ -0,0 +1,87 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+
+/*
+ Таблица поиска 256x256, заполненная наполовину: случайное чтение, заполнение и перебор
+ для DenseData (Extents<256, 256>) в сравнении с Data и HashData.
+ */
+
+namespace {
+
+constexpr size_t SIDE = 256;
+
+template <typename Storage>
+Matrix<int, 0, 2, Storage> lookupTable() {
+    std::mt19937 gen{11};
+    std::bernoulli_distribution occupied{0.5};
+
+    Matrix<int, 0, 2, Storage> matrix;
+    for (size_t i = 0; i < SIDE; ++i) {
+        for (size_t j = 0; j < SIDE; ++j) {
+            if (occupied(gen)) {
+                matrix.set({i, j}, static_cast<int>(i * SIDE + j) + 1);
+            }
+        }
+    }
+    return matrix;
+}
+
+}
+
+
+template <typename Storage>
+void BM_LookupTableGet(benchmark::State& state) {
+    const auto matrix = lookupTable<Storage>();
+    std::mt19937_64 gen{13};
+    std::uniform_int_distribution<size_t> index{0, SIDE - 1};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matrix.get({index(gen), index(gen)}));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+
+template <typename Storage>
+void BM_LookupTableFill(benchmark::State& state) {
+    for (auto _ : state) {
+        auto matrix = lookupTable<Storage>();
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(SIDE * SIDE));
+}
+
+
+template <typename Storage>
+void BM_LookupTableIterate(benchmark::State& state) {
+    const auto matrix = lookupTable<Storage>();
+
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& elem : matrix) {
+            sum += std::get<2>(elem);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(matrix.size()));
+}
+
+
+using DenseTable = Extents<SIDE, SIDE>;
+using TreeTable  = Data<int, 2>;
+using HashTable  = HashData<int, 2>;
+
+BENCHMARK_TEMPLATE(BM_LookupTableGet, DenseTable);
+BENCHMARK_TEMPLATE(BM_LookupTableGet, TreeTable);
+BENCHMARK_TEMPLATE(BM_LookupTableGet, HashTable);
+BENCHMARK_TEMPLATE(BM_LookupTableFill, DenseTable)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LookupTableFill, TreeTable) ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LookupTableFill, HashTable) ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LookupTableIterate, DenseTable)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LookupTableIterate, TreeTable) ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LookupTableIterate, HashTable) ->Unit(benchmark::kMicrosecond);
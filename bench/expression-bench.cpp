@@ -0,0 +1,65 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+
+
+namespace {
+
+Matrix2D<int> randomMatrix(size_t nnz, std::uint64_t seed) {
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<size_t> index{0, 9999};
+    std::vector<std::tuple<size_t, size_t, int>> triples(nnz);
+    int value = 1;
+    for (auto& [x, y, v] : triples) {
+        x = index(gen);
+        y = index(gen);
+        v = value++;
+    }
+    Matrix2D<int> result;
+    result.bulkLoad(triples);
+    return result;
+}
+
+}
+
+
+// Сложение вручную: обход одной матрицы с поиском в другой и запись в третью
+void BM_AddByHand(benchmark::State& state) {
+    const auto a = randomMatrix(static_cast<size_t>(state.range(0)), 1);
+    const auto b = randomMatrix(static_cast<size_t>(state.range(0)), 2);
+    for (auto _ : state) {
+        Matrix2D<int> sum = a.apply([](int v) { return v; });
+        for (const auto& [x, y, v] : b) {
+            sum.modify({x, y}, [v = v](int& value) { value += v; });
+        }
+        benchmark::DoNotOptimize(sum.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_AddByHand)->Range(1 << 10, 1 << 20);
+
+
+void BM_AddExpression(benchmark::State& state) {
+    const auto a = randomMatrix(static_cast<size_t>(state.range(0)), 1);
+    const auto b = randomMatrix(static_cast<size_t>(state.range(0)), 2);
+    for (auto _ : state) {
+        Matrix2D<int> sum = a + b;
+        benchmark::DoNotOptimize(sum.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_AddExpression)->Range(1 << 10, 1 << 20);
+
+
+void BM_AxpyExpression(benchmark::State& state) {
+    const auto a = randomMatrix(static_cast<size_t>(state.range(0)), 1);
+    const auto b = randomMatrix(static_cast<size_t>(state.range(0)), 2);
+    for (auto _ : state) {
+        Matrix2D<int> result = 3 * a - hadamard(a, b) + b;
+        benchmark::DoNotOptimize(result.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_AxpyExpression)->Range(1 << 10, 1 << 20);
@@ -0,0 +1,59 @@
+#include "sparse_matrix.h"
+#include "random_indexes.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+
+namespace {
+
+constexpr size_t SIDE = size_t{1} << 12;
+
+template <typename Probe>
+using BenchMatrix = BasicMatrix<int, 2, HashData<int, 2>, StaticDefault<int, 0>, NoStats, Probe>;
+
+}
+
+
+template <typename Probe>
+void BM_ProbeSet(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    
+    for (auto _ : state) {
+        BenchMatrix<Probe> matrix;
+        int value = 1;
+        for (const auto& i : indexes) {
+            matrix.set(i, value++);
+        }
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Probe>
+void BM_ProbeGet(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    BenchMatrix<Probe> matrix;
+    for (size_t i = 0; i < indexes.size(); i += 2) {
+        matrix.set(indexes[i], 1);
+    }
+    
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& i : indexes) {
+            sum += matrix.get(i);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+BENCHMARK_TEMPLATE(BM_ProbeSet, NoProbe)            ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_ProbeSet, MatrixProbe<>)      ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_ProbeSet, MatrixProbe<true>)  ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_ProbeGet, NoProbe)            ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_ProbeGet, MatrixProbe<>)      ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_ProbeGet, MatrixProbe<true>)  ->RangeMultiplier(10)->Range(1000, 1000000);
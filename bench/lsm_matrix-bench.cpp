@@ -0,0 +1,72 @@
+#include "lsm_matrix.h"
+#include "random_indexes.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+
+/*
+ Поток записи со случайными индексами, каждая восьмая запись -- удаление (запись Default).
+ Сравниваются скорость записи в LsmMatrix и в Matrix с упорядоченным и хэш-хранилищем,
+ а также случайное чтение после записи: сразу и после compact().
+ */
+
+namespace {
+
+constexpr size_t SIDE = 1u << 14;
+
+template <typename M>
+void writeAll(M& matrix, const std::vector<Indexes<2>>& indexes) {
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        matrix.update(indexes[i], i % 8 == 0 ? 0 : static_cast<int>(i % 1000) + 1);
+    }
+}
+
+}
+
+
+template <typename M>
+void BM_WriteStream(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 5);
+
+    for (auto _ : state) {
+        M matrix;
+        writeAll(matrix, indexes);
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename M, bool Compact>
+void BM_ReadAfterWrite(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 5);
+    M matrix;
+    writeAll(matrix, indexes);
+    if constexpr (Compact) {
+        matrix.compact();
+    }
+
+    std::mt19937_64 gen{7};
+    std::uniform_int_distribution<size_t> pick{0, indexes.size() - 1};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matrix.get(indexes[pick(gen)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+
+using LsmIntMatrix  = LsmMatrix<int, 0, 2>;
+using TreeIntMatrix = Matrix<int, 0, 2, Data<int, 2>>;
+using HashIntMatrix = Matrix<int, 0, 2, HashData<int, 2>>;
+
+BENCHMARK_TEMPLATE(BM_WriteStream, LsmIntMatrix) ->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_WriteStream, TreeIntMatrix)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_WriteStream, HashIntMatrix)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ReadAfterWrite, LsmIntMatrix, false) ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_ReadAfterWrite, LsmIntMatrix, true)  ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_ReadAfterWrite, TreeIntMatrix, false)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_ReadAfterWrite, HashIntMatrix, false)->Arg(1 << 20);
@@ -0,0 +1,10 @@
+#include "benchmark/benchmark.h"
+
+int main(int argc, char **argv) {
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    ::benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "sparse_matrix.h"
+#include "alloc_counter.h"
+#include "random_indexes.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+#ifndef MATRIX_BENCH_MAX_NNZ
+#define MATRIX_BENCH_MAX_NNZ 1000000
+#endif
+
+
+/*
+ Набор бенчмарков всех операций Matrix для разных хранилищ и размерностей 2, 3 и 8.
+ Количество элементов -- от 1K до MATRIX_BENCH_MAX_NNZ (опция CMake), шаг x10.
+ Все бенчмарки сообщают пропускную способность (items_per_second), вставка -- еще и байты на элемент.
+ */
+
+namespace {
+
+constexpr size_t SIDE = size_t{1} << 20;
+
+template <typename Storage>
+constexpr size_t DIMENSION = std::tuple_size_v<typename Storage::Element> - 1;
+
+template <typename Storage>
+using BenchMatrix = Matrix<int, 0, DIMENSION<Storage>, Storage>;
+
+
+// Последовательные ключи: номер раскладывается по основанию 1024, младшие разряды -- в последних измерениях
+template <size_t N>
+std::vector<Indexes<N>> sequentialIndexes(size_t count) {
+    std::vector<Indexes<N>> result(count);
+    for (size_t n = 0; n < count; ++n) {
+        size_t rest = n;
+        for (size_t d = N; d-- > 0;) {
+            result[n][d] = rest % 1024;
+            rest /= 1024;
+        }
+    }
+    return result;
+}
+
+
+template <typename M, size_t N>
+void fill(M& matrix, const std::vector<Indexes<N>>& indexes) {
+    int value = 1;
+    for (const auto& i : indexes) {
+        matrix.set(i, value++);
+    }
+}
+
+
+void sizes(benchmark::internal::Benchmark* bench) {
+    for (long long nnz = 1000; nnz <= MATRIX_BENCH_MAX_NNZ; nnz *= 10) {
+        bench->Arg(nnz);
+    }
+}
+
+}
+
+
+template <typename Storage>
+void BM_MatrixInsertRandom(benchmark::State& state) {
+    constexpr size_t N = DIMENSION<Storage>;
+    const auto indexes = randomIndexes<N>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    
+    size_t bytes = 0;
+    size_t nnz = 0;
+    for (auto _ : state) {
+        const size_t before = liveBytes();
+        BenchMatrix<Storage> matrix;
+        fill(matrix, indexes);
+        bytes = liveBytes() - before;
+        nnz = matrix.size();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes_per_nnz"] = nnz == 0 ? 0.0 : static_cast<double>(bytes) / static_cast<double>(nnz);
+}
+
+
+template <typename Storage>
+void BM_MatrixInsertSequential(benchmark::State& state) {
+    constexpr size_t N = DIMENSION<Storage>;
+    const auto indexes = sequentialIndexes<N>(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        BenchMatrix<Storage> matrix;
+        fill(matrix, indexes);
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_MatrixOverwrite(benchmark::State& state) {
+    constexpr size_t N = DIMENSION<Storage>;
+    const auto indexes = randomIndexes<N>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    BenchMatrix<Storage> matrix;
+    fill(matrix, indexes);
+    
+    int value = 1;
+    for (auto _ : state) {
+        for (const auto& i : indexes) {
+            matrix.set(i, value);
+        }
+        value = value % 1000 + 1;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_MatrixEraseByDefault(benchmark::State& state) {
+    constexpr size_t N = DIMENSION<Storage>;
+    const auto indexes = randomIndexes<N>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    
+    for (auto _ : state) {
+        state.PauseTiming();
+        BenchMatrix<Storage> matrix;
+        fill(matrix, indexes);
+        state.ResumeTiming();
+        
+        for (const auto& i : indexes) {
+            matrix.set(i, 0);
+        }
+        benchmark::DoNotOptimize(matrix.size());
+        
+        state.PauseTiming();
+        { BenchMatrix<Storage> release = std::move(matrix); }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_MatrixLookupHit(benchmark::State& state) {
+    constexpr size_t N = DIMENSION<Storage>;
+    const auto indexes = randomIndexes<N>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    BenchMatrix<Storage> matrix;
+    fill(matrix, indexes);
+    
+    for (auto _ : state) {
+        for (const auto& i : indexes) {
+            benchmark::DoNotOptimize(matrix.get(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_MatrixLookupMiss(benchmark::State& state) {
+    constexpr size_t N = DIMENSION<Storage>;
+    const auto indexes = randomIndexes<N>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    const auto missing = randomIndexes<N>(static_cast<size_t>(state.range(0)), SIDE, 2);
+    BenchMatrix<Storage> matrix;
+    fill(matrix, indexes);
+    
+    for (auto _ : state) {
+        for (const auto& i : missing) {
+            benchmark::DoNotOptimize(matrix.get(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_MatrixIterate(benchmark::State& state) {
+    constexpr size_t N = DIMENSION<Storage>;
+    const auto indexes = randomIndexes<N>(static_cast<size_t>(state.range(0)), SIDE, 1);
+    BenchMatrix<Storage> matrix;
+    fill(matrix, indexes);
+    
+    for (auto _ : state) {
+        long long sum = 0;
+        for (const auto& elem : matrix) {
+            sum += std::get<N>(elem);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<long long>(matrix.size()));
+}
+
+
+#define MATRIX_BENCHMARK(name)                                                                \
+    BENCHMARK_TEMPLATE(name, Data<int, 2>)->Apply(sizes);                                     \
+    BENCHMARK_TEMPLATE(name, Data<int, 3>)->Apply(sizes);                                     \
+    BENCHMARK_TEMPLATE(name, Data<int, 8>)->Apply(sizes);                                     \
+    BENCHMARK_TEMPLATE(name, HashData<int, 2>)->Apply(sizes);                                 \
+    BENCHMARK_TEMPLATE(name, HashData<int, 3>)->Apply(sizes);                                 \
+    BENCHMARK_TEMPLATE(name, HashData<int, 8>)->Apply(sizes);                                 \
+    BENCHMARK_TEMPLATE(name, Data<int, 2, PoolAllocator<ElementType<int, 2>>>)->Apply(sizes); \
+    BENCHMARK_TEMPLATE(name, PackedData<int, 2>)->Apply(sizes);                               \
+    BENCHMARK_TEMPLATE(name, PackedData<int, 3>)->Apply(sizes);                               \
+    BENCHMARK_TEMPLATE(name, PackedHashData<int, 2>)->Apply(sizes);                           \
+    BENCHMARK_TEMPLATE(name, PackedHashData<int, 3>)->Apply(sizes);                           \
+    BENCHMARK_TEMPLATE(name, CowData<int, 2>)->Apply(sizes);                                  \
+    BENCHMARK_TEMPLATE(name, BlockData<int, 2>)->Apply(sizes)
+
+MATRIX_BENCHMARK(BM_MatrixInsertRandom);
+MATRIX_BENCHMARK(BM_MatrixInsertSequential);
+MATRIX_BENCHMARK(BM_MatrixOverwrite);
+MATRIX_BENCHMARK(BM_MatrixEraseByDefault);
+MATRIX_BENCHMARK(BM_MatrixLookupHit);
+MATRIX_BENCHMARK(BM_MatrixLookupMiss);
+MATRIX_BENCHMARK(BM_MatrixIterate);
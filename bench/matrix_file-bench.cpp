@@ -0,0 +1,54 @@
+#include "matrix_file.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cstdio>
+#include <random>
+
+
+namespace {
+
+std::string writeRandomMatrix(size_t count) {
+    std::mt19937_64 gen{1};
+    std::uniform_int_distribution<size_t> index{0, 1u << 16};
+    
+    Matrix2D<int> matrix;
+    for (size_t i = 0; i < count; ++i) {
+        matrix[index(gen)][index(gen)] = static_cast<int>(i) + 1;
+    }
+    
+    const std::string path = "matrix_file_bench_" + std::to_string(count) + ".bin";
+    writeMatrix(matrix, path);
+    return path;
+}
+
+}
+
+
+void BM_OpenMapped(benchmark::State& state) {
+    const auto path = writeRandomMatrix(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        MappedMatrix<int, 0, 2> matrix{path};
+        benchmark::DoNotOptimize(matrix.get({1, 1}));
+    }
+    std::remove(path.c_str());
+}
+
+
+void BM_RebuildFromMapped(benchmark::State& state) {
+    const auto path = writeRandomMatrix(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        MappedMatrix<int, 0, 2> mapped{path};
+        Matrix2D<int> matrix;
+        matrix.bulkLoad(mapped);
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+
+BENCHMARK(BM_OpenMapped)       ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_RebuildFromMapped)->RangeMultiplier(10)->Range(1000, 1000000);
@@ -0,0 +1,45 @@
+#include "sparse_matrix.h"
+#include "random_indexes.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+
+namespace {
+
+constexpr size_t SIDE = 4096;
+
+}
+
+
+// Стоимость поддержки статистики при записи: NoStats, счетчики и суммы, счетчики с экстремумами
+template <typename M>
+void BM_StatsUpdate(benchmark::State& state) {
+    const auto indexes = randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 3);
+    for (auto _ : state) {
+        M matrix;
+        int value = 1;
+        for (const auto& i : indexes) {
+            matrix.set(i, value++ % 7);
+        }
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_StatsUpdate, Matrix<int, 0, 2, HashData<int, 2>>)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_StatsUpdate, Matrix<int, 0, 2, HashData<int, 2>, MatrixStats<int, 2>>)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_StatsUpdate, Matrix<int, 0, 2, HashData<int, 2>, MatrixStats<int, 2, true>>)->Range(1 << 10, 1 << 18);
+
+
+void BM_StatsRowCount(benchmark::State& state) {
+    StatsMatrix<int, 0, 2> matrix;
+    for (const auto& i : randomIndexes<2>(static_cast<size_t>(state.range(0)), SIDE, 3)) {
+        matrix.set(i, 1);
+    }
+    size_t row = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matrix.stats().nnz(0, row++ & 4095));
+    }
+}
+BENCHMARK(BM_StatsRowCount)->Range(1 << 10, 1 << 18);
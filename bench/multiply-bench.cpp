@@ -0,0 +1,77 @@
+#include "multiply.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+
+
+namespace {
+
+CSRMatrix<int> randomCSR(size_t size, size_t per_row, std::uint32_t seed) {
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<size_t> column{0, size - 1};
+    std::uniform_int_distribution<int> value{1, 9};
+    
+    Matrix<int, 0, 2, HashData<int, 2>> matrix;
+    for (size_t row = 0; row < size; ++row) {
+        for (size_t i = 0; i < per_row; ++i) {
+            matrix[row][column(gen)] = value(gen);
+        }
+    }
+    return toCSR(matrix);
+}
+
+}
+
+
+void BM_MatrixVector(benchmark::State& state) {
+    const auto csr = randomCSR(100000, 32, 1);
+    const std::vector<int> x(csr.columns(), 1);
+    const auto level = static_cast<SimdLevel>(state.range(0));
+    ThreadPool pool{static_cast<size_t>(state.range(1))};
+    
+    if (level > detectSimdLevel()) {
+        state.SkipWithError("instruction set is not supported");
+        return;
+    }
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(multiply(csr, x, pool, level));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(csr.size()));
+}
+
+
+void BM_MatrixDense(benchmark::State& state) {
+    const auto csr = randomCSR(20000, 16, 2);
+    DenseMatrix<int> dense{csr.columns(), 64};
+    std::fill(dense.data.begin(), dense.data.end(), 1);
+    const auto level = static_cast<SimdLevel>(state.range(0));
+    ThreadPool pool{static_cast<size_t>(state.range(1))};
+    
+    if (level > detectSimdLevel()) {
+        state.SkipWithError("instruction set is not supported");
+        return;
+    }
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(multiply(csr, dense, pool, level));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(csr.size() * dense.columns));
+}
+
+
+void BM_MatrixMatrix(benchmark::State& state) {
+    const auto lhs = randomCSR(20000, 8, 3);
+    const auto rhs = randomCSR(20000, 8, 4);
+    ThreadPool pool{static_cast<size_t>(state.range(0))};
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(multiply(lhs, rhs, pool));
+    }
+}
+
+
+BENCHMARK(BM_MatrixVector)->ArgsProduct({{0, 1, 2}, {1, 2, 4, 8}})->UseRealTime();
+BENCHMARK(BM_MatrixDense) ->ArgsProduct({{0, 1, 2}, {1, 4}})->UseRealTime();
+BENCHMARK(BM_MatrixMatrix)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
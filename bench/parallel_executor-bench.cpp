@@ -0,0 +1,91 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cmath>
+#include <random>
+#include <thread>
+
+
+/*
+ Масштабирование parallelReduce и parallelForEach по количеству потоков пула (аргумент бенчмарка).
+ Сравниваются хранилища: HashData и BlockData делятся без прохода, Data -- одним проходом по списку.
+ */
+
+namespace {
+
+template <typename M>
+const M& benchMatrix() {
+    static const M matrix = [] {
+        std::mt19937_64 gen{5};
+        std::uniform_int_distribution<size_t> index{0, 1u << 12};
+        M result;
+        for (size_t i = 0; i < (1u << 21); ++i) {
+            result.set({index(gen), index(gen)}, static_cast<double>(i % 1000) + 1.0);
+        }
+        return result;
+    }();
+    return matrix;
+}
+
+
+void threads(benchmark::internal::Benchmark* bench) {
+    for (size_t n = 1; n <= std::thread::hardware_concurrency(); n *= 2) {
+        bench->Arg(static_cast<long long>(n));
+    }
+    bench->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+}
+
+
+template <typename M>
+void BM_ParallelReduce(benchmark::State& state) {
+    const M& matrix = benchMatrix<M>();
+    ThreadPool pool{static_cast<size_t>(state.range(0))};
+    
+    for (auto _ : state) {
+        const double sum = matrix.parallelReduce(0.0, [](const auto& elem) { return std::sqrt(std::get<2>(elem)); },
+                                                 [](double a, double b) { return a + b; }, pool);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<long long>(matrix.size()));
+}
+
+
+template <typename M>
+void BM_ParallelForEach(benchmark::State& state) {
+    const M& matrix = benchMatrix<M>();
+    ThreadPool pool{static_cast<size_t>(state.range(0))};
+    
+    for (auto _ : state) {
+        std::atomic<size_t> big{0};
+        matrix.parallelForEach([&big](const auto& elem) {
+            if (std::get<2>(elem) > 500.0) {
+                big.fetch_add(1, std::memory_order_relaxed);
+            }
+        }, pool);
+        benchmark::DoNotOptimize(big.load());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<long long>(matrix.size()));
+}
+
+
+template <typename M>
+void BM_ParallelTransform(benchmark::State& state) {
+    const M& matrix = benchMatrix<M>();
+    ThreadPool pool{static_cast<size_t>(state.range(0))};
+    
+    for (auto _ : state) {
+        const auto result = matrix.parallelTransform([](double v) { return std::sqrt(v); }, pool);
+        benchmark::DoNotOptimize(result.size());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<long long>(matrix.size()));
+}
+
+
+BENCHMARK_TEMPLATE(BM_ParallelReduce, RuntimeMatrix<double, 2, HashData<double, 2>>)->Apply(threads);
+BENCHMARK_TEMPLATE(BM_ParallelReduce, RuntimeMatrix<double, 2, BlockData<double, 2>>)->Apply(threads);
+BENCHMARK_TEMPLATE(BM_ParallelReduce, RuntimeMatrix<double, 2>)->Apply(threads);
+BENCHMARK_TEMPLATE(BM_ParallelForEach, RuntimeMatrix<double, 2, HashData<double, 2>>)->Apply(threads);
+BENCHMARK_TEMPLATE(BM_ParallelTransform, RuntimeMatrix<double, 2, HashData<double, 2>>)->Apply(threads);
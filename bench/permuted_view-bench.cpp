@@ -0,0 +1,80 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+
+
+namespace {
+
+Matrix2D<int> randomMatrix(size_t count) {
+    std::mt19937_64 gen{1};
+    std::uniform_int_distribution<size_t> index{0, 1u << 16};
+    
+    Matrix2D<int> matrix;
+    for (size_t i = 0; i < count; ++i) {
+        matrix.set({index(gen), index(gen)}, static_cast<int>(i) + 1);
+    }
+    return matrix;
+}
+
+}
+
+
+void BM_TransposeCopy(benchmark::State& state) {
+    const auto matrix = randomMatrix(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        Matrix2D<int> transposed;
+        for (const auto& [i, j, v] : matrix) {
+            transposed[j][i] = v;
+        }
+        benchmark::DoNotOptimize(transposed.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+void BM_TransposeMaterialize(benchmark::State& state) {
+    const auto matrix = randomMatrix(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        auto elements = matrix.transpose().materialize();
+        benchmark::DoNotOptimize(elements.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+void BM_TransposeMaterializeParallel(benchmark::State& state) {
+    const auto matrix = randomMatrix(static_cast<size_t>(state.range(0)));
+    ThreadPool pool{4};
+    
+    for (auto _ : state) {
+        auto elements = matrix.transpose().materialize(pool);
+        benchmark::DoNotOptimize(elements.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+void BM_TransposeLookup(benchmark::State& state) {
+    const auto matrix = randomMatrix(static_cast<size_t>(state.range(0)));
+    const auto transposed = matrix.transpose();
+    std::vector<Indexes<2>> keys;
+    for (const auto& [i, j, v] : matrix) {
+        keys.push_back({j, i});
+    }
+    
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transposed.get(keys[next]));
+        next = next + 1 < keys.size() ? next + 1 : 0;
+    }
+}
+
+
+BENCHMARK(BM_TransposeCopy)               ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_TransposeMaterialize)        ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_TransposeMaterializeParallel)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_TransposeLookup)             ->RangeMultiplier(10)->Range(1000, 1000000);
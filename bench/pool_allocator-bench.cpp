@@ -0,0 +1,40 @@
+#include "sparse_matrix.h"
+#include "random_indexes.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+
+namespace {
+
+constexpr size_t SIDE = size_t{1} << 16;
+
+}
+
+
+// В матрице постоянно живет range(0) элементов: на каждом шаге самый старый удаляется, новый добавляется
+template <typename M>
+void BM_Churn(benchmark::State& state) {
+    const size_t live = static_cast<size_t>(state.range(0));
+    const auto indexes = randomIndexes<2>(live * 4, SIDE, 3);
+    
+    M matrix;
+    for (size_t i = 0; i < live; ++i) {
+        matrix.set(indexes[i], 1);
+    }
+    
+    size_t oldest = 0;
+    size_t next = live;
+    for (auto _ : state) {
+        matrix.set(indexes[oldest], 0);
+        matrix.set(indexes[next], 1);
+        oldest = (oldest + 1) % indexes.size();
+        next = (next + 1) % indexes.size();
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+
+BENCHMARK_TEMPLATE(BM_Churn, Matrix<int, 0, 2>)    ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_Churn, PoolMatrix<int, 0, 2>)->RangeMultiplier(10)->Range(1000, 1000000);
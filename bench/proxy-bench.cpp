@@ -0,0 +1,205 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <stdexcept>
+
+
+namespace {
+
+/*
+ Прежняя цепочка доступа: виртуальный вызов объекта-создателя и проверка количества
+ индексов во время выполнения. Оставлена только для сравнения
+ */
+template <typename V, size_t N>
+class LegacyIProxy {
+public:
+    virtual ~LegacyIProxy() = default;
+    virtual void update(const Indexes<N>& indexes, const V& elem) = 0;
+    virtual V get(const Indexes<N>& indexes) const = 0;
+};
+
+
+template <typename V, size_t N>
+class LegacyProxy : public LegacyIProxy<V, N> {
+public:
+    explicit LegacyProxy(LegacyIProxy<V, N>* subjectPtr) : m_subjectPtr{subjectPtr} {}
+    
+    LegacyProxy& operator[](size_t index) {
+        if (m_counter >= N) {
+            throw std::runtime_error("Too many indexes");
+        }
+        m_indexes[m_counter++] = index;
+        return *this;
+    }
+    
+    LegacyProxy& operator=(const V& elem) {
+        update(m_indexes, elem);
+        return *this;
+    }
+    
+    operator V() { return get(m_indexes); }
+    
+    void update(const Indexes<N>& indexes, const V& elem) override {
+        if (m_counter < N) {
+            throw std::runtime_error("Too few indexes");
+        }
+        m_subjectPtr->update(indexes, elem);
+    }
+    
+    V get(const Indexes<N>& indexes) const override { return m_subjectPtr->get(indexes); }
+    
+private:
+    LegacyIProxy<V, N>* m_subjectPtr;
+    Indexes<N> m_indexes{};
+    size_t m_counter = 0;
+};
+
+
+template <typename T, T Default, size_t N>
+class LegacyMatrix : public LegacyIProxy<T, N> {
+public:
+    LegacyProxy<T, N> operator[](size_t index) {
+        LegacyProxy<T, N> proxy{this};
+        proxy[index];
+        return proxy;
+    }
+    
+    void update(const Indexes<N>& indexes, const T& value) override { m_matrix.update(indexes, value); }
+    T get(const Indexes<N>& indexes) const override { return m_matrix.get(indexes); }
+    
+private:
+    Matrix<T, Default, N, HashData<T, N>> m_matrix;
+};
+
+
+template <typename M>
+void access2D(benchmark::State& state, M& matrix) {
+    const size_t side = static_cast<size_t>(state.range(0));
+    for (size_t i = 0; i < side; ++i) {
+        matrix[i][i] = static_cast<int>(i) + 1;
+    }
+    
+    for (auto _ : state) {
+        int sum = 0;
+        for (size_t i = 0; i < side; ++i) {
+            for (size_t j = 0; j < side; ++j) {
+                sum += matrix[i][j];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+
+template <typename M>
+void access3D(benchmark::State& state, M& matrix) {
+    const size_t side = static_cast<size_t>(state.range(0));
+    for (size_t i = 0; i < side; ++i) {
+        matrix[i][i][i] = static_cast<int>(i) + 1;
+    }
+    
+    for (auto _ : state) {
+        int sum = 0;
+        for (size_t i = 0; i < side; ++i) {
+            for (size_t j = 0; j < side; ++j) {
+                for (size_t k = 0; k < side; ++k) {
+                    sum += matrix[i][j][k];
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0) * state.range(0));
+}
+
+}
+
+
+void BM_LegacyProxy2D(benchmark::State& state) {
+    LegacyMatrix<int, 0, 2> matrix;
+    access2D(state, matrix);
+}
+
+
+void BM_Proxy2D(benchmark::State& state) {
+    Matrix<int, 0, 2, HashData<int, 2>> matrix;
+    access2D(state, matrix);
+}
+
+
+void BM_LegacyProxy3D(benchmark::State& state) {
+    LegacyMatrix<int, 0, 3> matrix;
+    access3D(state, matrix);
+}
+
+
+void BM_Proxy3D(benchmark::State& state) {
+    Matrix<int, 0, 3, HashData<int, 3>> matrix;
+    access3D(state, matrix);
+}
+
+
+void BM_Direct2D(benchmark::State& state) {
+    Matrix<int, 0, 2, HashData<int, 2>> matrix;
+    const size_t side = static_cast<size_t>(state.range(0));
+    for (size_t i = 0; i < side; ++i) {
+        matrix.set({i, i}, static_cast<int>(i) + 1);
+    }
+    
+    for (auto _ : state) {
+        int sum = 0;
+        for (size_t i = 0; i < side; ++i) {
+            for (size_t j = 0; j < side; ++j) {
+                sum += matrix(i, j);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_ReadModifyWrite(benchmark::State& state) {
+    Matrix<int, 0, 2, Storage> matrix;
+    const size_t side = static_cast<size_t>(state.range(0));
+    
+    for (auto _ : state) {
+        for (size_t i = 0; i < side; ++i) {
+            for (size_t j = 0; j < side; ++j) {
+                matrix[i][j] = matrix[i][j] + 1;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+
+template <typename Storage>
+void BM_Modify(benchmark::State& state) {
+    Matrix<int, 0, 2, Storage> matrix;
+    const size_t side = static_cast<size_t>(state.range(0));
+    
+    for (auto _ : state) {
+        for (size_t i = 0; i < side; ++i) {
+            for (size_t j = 0; j < side; ++j) {
+                matrix.modify({i, j}, [](int& value) { ++value; });
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+
+BENCHMARK(BM_LegacyProxy2D)->Arg(64)->Arg(256);
+BENCHMARK(BM_Proxy2D)      ->Arg(64)->Arg(256);
+BENCHMARK(BM_Direct2D)     ->Arg(64)->Arg(256);
+BENCHMARK(BM_LegacyProxy3D)->Arg(16)->Arg(40);
+BENCHMARK(BM_Proxy3D)      ->Arg(16)->Arg(40);
+
+BENCHMARK_TEMPLATE(BM_ReadModifyWrite, Data<int, 2>)    ->Arg(256);
+BENCHMARK_TEMPLATE(BM_ReadModifyWrite, HashData<int, 2>)->Arg(256);
+BENCHMARK_TEMPLATE(BM_Modify,          Data<int, 2>)    ->Arg(256);
+BENCHMARK_TEMPLATE(BM_Modify,          HashData<int, 2>)->Arg(256);
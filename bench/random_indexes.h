@@ -0,0 +1,35 @@
+/*!
+@file
+@brief Вспомогательные функции бенчмарков: случайные наборы индексов
+*/
+
+#pragma once
+
+#include "indexes.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+/*!
+ Создает count наборов случайных индексов из [0, side) по каждому измерению.
+ Генератор инициализируется seed, поэтому наборы воспроизводимы; наборы могут повторяться
+ @param count Количество наборов
+ @param side  Граница индексов
+ @param seed  Начальное значение генератора
+ @return Наборы индексов
+ */
+template <size_t N>
+std::vector<Indexes<N>> randomIndexes(size_t count, size_t side, std::uint64_t seed) {
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<size_t> index{0, side - 1};
+
+    std::vector<Indexes<N>> result(count);
+    for (auto& indexes : result) {
+        for (auto& i : indexes) {
+            i = index(gen);
+        }
+    }
+    return result;
+}
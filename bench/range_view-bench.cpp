@@ -0,0 +1,94 @@
+#include "sparse_matrix.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+
+
+namespace {
+
+constexpr size_t SIDE = 200;
+
+template <typename M = Matrix3D<int>>
+const M& randomMatrix() {
+    static const M matrix = [] {
+        std::mt19937_64 gen{5};
+        std::uniform_int_distribution<size_t> index{0, SIDE - 1};
+        std::vector<std::tuple<size_t, size_t, size_t, int>> triples(1000000);
+        int value = 1;
+        for (auto& [x, y, z, v] : triples) {
+            x = index(gen);
+            y = index(gen);
+            z = index(gen);
+            v = value++;
+        }
+        M result;
+        result.bulkLoad(triples);
+        return result;
+    }();
+    return matrix;
+}
+
+
+template <typename Range>
+long long sum(const Range& range) {
+    long long result = 0;
+    for (const auto& [x, y, z, v] : range) {
+        result += v;
+        (void)x;
+        (void)y;
+        (void)z;
+    }
+    return result;
+}
+
+}
+
+
+void BM_SliceScan(benchmark::State& state) {
+    const auto& matrix = randomMatrix();
+    for (auto _ : state) {
+        const auto row = matrix.range({17, 0, 0}, {17, SIDE, SIDE});
+        long long result = 0;
+        for (const auto& elem : matrix) {
+            Indexes<3> indexes = {std::get<0>(elem), std::get<1>(elem), std::get<2>(elem)};
+            if (row.contains(indexes)) {
+                result += std::get<3>(elem);
+            }
+        }
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+
+void BM_Slice(benchmark::State& state) {
+    const auto& matrix = randomMatrix();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sum(matrix.slice(17)));
+    }
+}
+
+
+void BM_Box(benchmark::State& state) {
+    const auto& matrix = randomMatrix();
+    const size_t side = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sum(matrix.range({50, 50, 50}, {50 + side, 50 + side, 50 + side})));
+    }
+}
+
+
+template <typename M>
+void BM_LastIndexSlice(benchmark::State& state) {
+    const auto& matrix = randomMatrix<M>();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sum(matrix.range({0, 0, 17}, {SIDE, SIDE, 17})));
+    }
+}
+
+
+BENCHMARK(BM_SliceScan)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Slice)    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Box)      ->Unit(benchmark::kMicrosecond)->Arg(4)->Arg(16)->Arg(64);
+BENCHMARK_TEMPLATE(BM_LastIndexSlice, Matrix3D<int>)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_LastIndexSlice, IndexedMatrix<int, 0, 3>)->Unit(benchmark::kMicrosecond);
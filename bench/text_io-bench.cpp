@@ -0,0 +1,91 @@
+#include "text_io.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+
+namespace {
+
+std::string writeRandomText(size_t count) {
+    std::mt19937_64 gen{1};
+    std::uniform_int_distribution<size_t> index{0, 1u << 16};
+    
+    Matrix2D<int> matrix;
+    for (size_t i = 0; i < count; ++i) {
+        matrix[index(gen)][index(gen)] = static_cast<int>(i) + 1;
+    }
+    
+    const std::string path = "text_io_bench_" + std::to_string(count) + ".txt";
+    saveText(matrix, path, TextFormat::COORDINATE);
+    return path;
+}
+
+}
+
+
+void BM_LoadTextIostream(benchmark::State& state) {
+    const auto path = writeRandomText(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        Matrix2D<int> matrix;
+        std::ifstream in{path};
+        size_t i = 0;
+        size_t j = 0;
+        int v = 0;
+        while (in >> i >> j >> v) {
+            matrix[i][j] = v;
+        }
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+
+void BM_LoadText(benchmark::State& state) {
+    const auto path = writeRandomText(static_cast<size_t>(state.range(0)));
+    
+    for (auto _ : state) {
+        Matrix2D<int> matrix;
+        loadText(matrix, path, TextFormat::COORDINATE);
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+
+void BM_LoadTextParallel(benchmark::State& state) {
+    const auto path = writeRandomText(static_cast<size_t>(state.range(0)));
+    ThreadPool pool{4};
+    
+    for (auto _ : state) {
+        Matrix2D<int> matrix;
+        loadText(matrix, path, TextFormat::COORDINATE, DuplicatePolicy::KEEP_LAST, pool);
+        benchmark::DoNotOptimize(matrix.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+
+void BM_SaveText(benchmark::State& state) {
+    const auto path = writeRandomText(static_cast<size_t>(state.range(0)));
+    Matrix2D<int> matrix;
+    loadText(matrix, path, TextFormat::COORDINATE);
+    
+    for (auto _ : state) {
+        saveText(matrix, path, TextFormat::MATRIX_MARKET);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+
+
+BENCHMARK(BM_LoadTextIostream)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_LoadText)        ->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_LoadTextParallel)->RangeMultiplier(10)->Range(1000, 1000000);
+BENCHMARK(BM_SaveText)        ->RangeMultiplier(10)->Range(1000, 1000000);
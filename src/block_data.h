@@ -0,0 +1,527 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией блочно-разреженного хранилища:
+ элементы хранятся в плотных тайлах фиксированной формы
+*/
+
+#pragma once
+
+#include "hash_data.h"
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+/*!
+@brief Форма тайла BlockData: размер тайла по каждому измерению
+@tparam Extents размеры тайла, произведение не больше 64
+*/
+template <size_t... Extents>
+struct TileShape {
+    static constexpr size_t RANK = sizeof...(Extents);                  ///< Количество измерений
+    static constexpr std::array<size_t, RANK> EXTENTS{Extents...};      ///< Размеры тайла
+    static constexpr size_t CELLS = (Extents * ... * size_t{1});        ///< Количество ячеек тайла
+};
+
+
+namespace detail {
+
+/// Возвращает наибольшую сторону кубического тайла размерности n, в котором не больше 64 ячеек
+constexpr size_t tileEdge(size_t n) {
+    size_t edge = 1;
+    for (;;) {
+        size_t cells = 1;
+        for (size_t d = 0; d < n; ++d) {
+            cells *= edge + 1;
+        }
+        if (cells > 64) {
+            return edge;
+        }
+        ++edge;
+    }
+}
+
+/// Кубический тайл размерности N: 8x8 для матрицы, 4x4x4 для трехмерной матрицы
+template <size_t N, typename = std::make_index_sequence<N>>
+struct CubeTile;
+
+template <size_t N, size_t... I>
+struct CubeTile<N, std::index_sequence<I...>> {
+    using type = TileShape<((void)I, tileEdge(N))...>;
+};
+
+}
+
+
+/*!
+@brief Класс, который отвечает за хранение данных плотными тайлами фиксированной формы
+@details Индексы делятся на координату тайла (indexes[d] / EXTENTS[d]) и номер ячейки внутри тайла.
+ Тайл -- массив из Shape::CELLS значений и 64-битная маска занятых ячеек, тайлы лежат подряд
+ в одном std::vector, а HashData<size_t, N> отображает координату тайла в его номер.
+ Поэтому кластер из 64 соседних ячеек стоит одного тайла и одной записи в таблице вместо 64 узлов,
+ а size() и перебор по-прежнему видят только занятые ячейки. Свободные ячейки тайла содержат T{},
+ так что forEachTile() позволяет обходить значения тайла плотным циклом фиксированной длины,
+ который компилятор векторизует. Пустой тайл удаляется, на его место переносится последний.
+ Интерфейс совпадает с HashData<T, N>, поэтому класс можно передать в Matrix<T, Default, N, Storage>.
+@tparam T тип хранимых данных
+@tparam N n-мерность матрицы
+@tparam Shape форма тайла TileShape, по умолчанию кубический тайл не больше 64 ячеек
+*/
+template <typename T, size_t N, typename Shape = typename detail::CubeTile<N>::type>
+class BlockData {
+public:
+    /// @brief тип ключа
+    using Key      = KeyType<N>;
+
+    /// @brief тип хранимого элемента, представляет из себя std::tuple из N индексов типа size_t и последющим значением типа T
+    using Element  = ElementType<T, N>;
+
+    /// @brief количество ячеек тайла
+    static constexpr size_t CELLS = Shape::CELLS;
+
+    /// @brief значения тайла
+    using Values   = std::array<T, CELLS>;
+
+    /// @brief тайл и ячейка в нем
+    struct MapIt {
+        size_t tile;    ///< Номер тайла, NONE если тайла еще нет
+        size_t cell;    ///< Номер ячейки в тайле
+    };
+
+    class It;
+
+    /// @brief признак того, что хранилище упорядочено по ключу
+    static constexpr bool IS_ORDERED = false;
+
+    /// @brief номер отсутствующего тайла
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    static_assert(Shape::RANK == N, "BlockData tile shape must have N extents");
+    static_assert(CELLS > 0 && CELLS <= 64, "BlockData tile must have from 1 to 64 cells");
+
+    std::pair<bool, MapIt> locate(const Key& key) const;       ///< Ищет элемент или место для его вставки
+    template <typename V>
+    T& emplace(MapIt hint, const Key& key, V&& elem);          ///< Добавляет отсутствующий элемент в место, найденное locate
+    template <typename V>
+    void insert(MapIt it, const Key& key, V&& elem);           ///< Добавляет или перезаписывает элемент по итератору, V -- const T& или T
+    void erase(MapIt it);                                      ///< Удаление по переданному итератору
+    T& value(MapIt it);                                        ///< Возвращает значение существующего элемента
+    const T& value(MapIt it) const;                            ///< Возвращает значение существующего элемента
+    It find(const Key& key) const;                             ///< Находит элемент по ключу, end() если его нет
+
+    size_t size() const;                                       ///< Возвращает количесвто хранимых элементов
+    size_t tiles() const;                                      ///< Возвращает количество непустых тайлов
+    void reserve(size_t count);                                ///< Резервирует место под count элементов
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);                  ///< Заменяет содержимое уникальными элементами
+
+    template <typename Fn>
+    void forEachTile(Fn fn) const;                             ///< Вызывает fn(origin, values, mask) для каждого тайла
+
+    It begin() const;                                          ///< Возвращает итератор на начало
+    It end() const;                                            ///< Возвращает итератор на конец
+    std::vector<std::pair<It, It>> split(size_t parts) const;  ///< Делит элементы на не более parts последовательных частей
+
+    Key makeKey(const Indexes<N>& indexes) const;              ///< Создает ключ
+    Element makeElement(const Key& key, const T& elem) const;  ///< Создает элемент
+
+private:
+    /// @brief плотный тайл
+    struct Tile {
+        Indexes<N> origin;          ///< Индексы первой ячейки тайла
+        Values values{};            ///< Значения, свободные ячейки содержат T{}
+        std::uint64_t mask = 0;     ///< Маска занятых ячеек
+    };
+
+    /// @brief ключ тайла в m_index
+    using TileKey = KeyType<N>;
+
+    static TileKey tileKey(const Indexes<N>& origin);               ///< Ключ тайла по индексам его первой ячейки
+    static Indexes<N> originOf(const Key& key, size_t& cell);       ///< Индексы первой ячейки тайла и номер ячейки ключа
+    static Element cellElement(const Tile& tile, size_t cell);      ///< Элемент ячейки тайла
+    void removeTile(size_t tile);                                   ///< Удаляет пустой тайл
+
+    std::vector<Tile> m_tiles;          ///< Непустые тайлы
+    HashData<size_t, N> m_index;        ///< Координата тайла -> номер тайла в m_tiles
+    size_t m_size = 0;                  ///< Количество хранимых элементов
+};
+
+
+/*!
+ @brief Прямой итератор по элементам BlockData: тайлы по порядку, внутри тайла -- занятые ячейки по возрастанию номера
+ @details Разыменование возвращает ссылку на элемент, собранный внутри итератора: она действительна,
+  пока жив итератор и хранилище не изменялось
+ */
+template <typename T, size_t N, typename Shape>
+class BlockData<T, N, Shape>::It {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const Element*;
+    using reference         = const Element&;
+
+    It() = default;
+    It(const std::vector<Tile>* tiles, size_t tile, std::uint64_t rest) : m_tiles{tiles}, m_tile{tile}, m_rest{rest} { load(); }
+
+    reference operator*() const { return m_elem; }
+    pointer operator->() const { return &m_elem; }
+    It& operator++() { next(); return *this; }
+    It operator++(int) { It tmp = *this; next(); return tmp; }
+    bool operator==(const It& other) const { return m_tile == other.m_tile && m_rest == other.m_rest; }
+    bool operator!=(const It& other) const { return !(*this == other); }
+
+private:
+    /// Переходит к следующей занятой ячейке или к первой ячейке следующего тайла
+    void next() {
+        m_rest &= m_rest - 1;
+        if (m_rest == 0 && ++m_tile < m_tiles->size()) {
+            m_rest = (*m_tiles)[m_tile].mask;
+        }
+        load();
+    }
+
+    /// Собирает элемент текущей ячейки
+    void load() {
+        if (m_rest != 0) {
+            m_elem = cellElement((*m_tiles)[m_tile], static_cast<size_t>(__builtin_ctzll(m_rest)));
+        }
+    }
+
+    const std::vector<Tile>* m_tiles = nullptr; ///< Тайлы хранилища
+    size_t m_tile = 0;                          ///< Текущий тайл, m_tiles->size() для конца
+    std::uint64_t m_rest = 0;                   ///< Еще не пройденные занятые ячейки текущего тайла
+    Element m_elem{};                           ///< Текущий элемент
+};
+
+
+/*!
+Ищет элемент по ключу
+@param key Ключ искомого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и позиции элемента или места для его вставки
+*/
+template <typename T, size_t N, typename Shape>
+std::pair<bool, typename BlockData<T, N, Shape>::MapIt> BlockData<T, N, Shape>::locate(const Key& key) const {
+    size_t cell = 0;
+    const auto [exists, slot] = m_index.locate(tileKey(originOf(key, cell)));
+    if (!exists) {
+        return {false, MapIt{NONE, cell}};
+    }
+    const size_t tile = m_index.value(slot);
+    return {(m_tiles[tile].mask >> cell & 1) != 0, MapIt{tile, cell}};
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище, при необходимости создавая тайл
+@param hint Позиция, полученная из locate для того же ключа
+@param key  Ключ для элемента
+@param val  Хранимое значение, rvalue перемещается
+@return Ссылка на сохраненное значение
+*/
+template <typename T, size_t N, typename Shape>
+template <typename V>
+T& BlockData<T, N, Shape>::emplace(MapIt hint, const Key& key, V&& val) {
+    if (hint.tile == NONE) {
+        size_t cell = 0;
+        const Indexes<N> origin = originOf(key, cell);
+        const TileKey tile_key = tileKey(origin);
+        hint.tile = m_tiles.size();
+        m_tiles.push_back(Tile{origin});
+        m_index.emplace(m_index.locate(tile_key).second, tile_key, hint.tile);
+    }
+    Tile& tile = m_tiles[hint.tile];
+    tile.values[hint.cell] = std::forward<V>(val);
+    tile.mask |= std::uint64_t{1} << hint.cell;
+    ++m_size;
+    return tile.values[hint.cell];
+}
+
+
+/*!
+Добавляет элемент по итератору. В случае, когда элемент существует, значение перезаписывается на месте.
+@param it  Позиция, полученная из locate
+@param key Ключ для элемента
+@param val Хранимое значение, rvalue перемещается
+*/
+template <typename T, size_t N, typename Shape>
+template <typename V>
+void BlockData<T, N, Shape>::insert(MapIt it, const Key& key, V&& val) {
+    if (it.tile != NONE && (m_tiles[it.tile].mask >> it.cell & 1) != 0) {
+        m_tiles[it.tile].values[it.cell] = std::forward<V>(val);
+    } else {
+        emplace(it, key, std::forward<V>(val));
+    }
+}
+
+
+/*!
+Удаляет элемент по переданному итератору. Тайл, в котором не осталось элементов, удаляется.
+@param it Позиция существующего элемента
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N, typename Shape>
+void BlockData<T, N, Shape>::erase(MapIt it) {
+    if (it.tile == NONE || (m_tiles[it.tile].mask >> it.cell & 1) == 0) {
+        throw std::runtime_error("Try to erase element by key which was not created");
+    }
+    Tile& tile = m_tiles[it.tile];
+    tile.values[it.cell] = T{};
+    tile.mask &= ~(std::uint64_t{1} << it.cell);
+    --m_size;
+    if (tile.mask == 0) {
+        removeTile(it.tile);
+    }
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Позиция найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename Shape>
+T& BlockData<T, N, Shape>::value(MapIt it) {
+    return m_tiles[it.tile].values[it.cell];
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Позиция найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename Shape>
+const T& BlockData<T, N, Shape>::value(MapIt it) const {
+    return m_tiles[it.tile].values[it.cell];
+}
+
+
+/*!
+Находит элемент по ключу
+@param key Ключ искомого элемента
+@return Итератор на элемент или end(), если элемента нет
+*/
+template <typename T, size_t N, typename Shape>
+typename BlockData<T, N, Shape>::It BlockData<T, N, Shape>::find(const Key& key) const {
+    const auto [exists, it] = locate(key);
+    if (!exists) {
+        return end();
+    }
+    return It{&m_tiles, it.tile, m_tiles[it.tile].mask & ~((std::uint64_t{1} << it.cell) - 1)};
+}
+
+
+/*!
+Возвращает количество хранимых элементов
+@return количество хранимых элементов
+*/
+template <typename T, size_t N, typename Shape>
+size_t BlockData<T, N, Shape>::size() const {
+    return m_size;
+}
+
+
+/*!
+Возвращает количество непустых тайлов, каждый занимает sizeof(T) * CELLS байт значений
+@return количество тайлов
+*/
+template <typename T, size_t N, typename Shape>
+size_t BlockData<T, N, Shape>::tiles() const {
+    return m_tiles.size();
+}
+
+
+/*!
+Резервирует место под count элементов в предположении, что тайлы заполнены плотно
+@param count Ожидаемое количество элементов
+*/
+template <typename T, size_t N, typename Shape>
+void BlockData<T, N, Shape>::reserve(size_t count) {
+    const size_t tiles = (count + CELLS - 1) / CELLS;
+    m_tiles.reserve(tiles);
+    m_index.reserve(tiles);
+}
+
+
+/*!
+Заменяет содержимое переданными элементами. Ключи элементов не должны повторяться.
+@param first Начало диапазона элементов типа Element
+@param last  Конец диапазона элементов типа Element
+*/
+template <typename T, size_t N, typename Shape>
+template <typename InputIt>
+void BlockData<T, N, Shape>::assign(InputIt first, InputIt last) {
+    *this = BlockData{};
+    for (; first != last; ++first) {
+        const Key key = elemKeyImpl(*first, std::make_index_sequence<N>{});
+        const auto [exists, it] = locate(key);
+        insert(it, key, std::get<N>(*first));
+    }
+}
+
+
+/*!
+Обходит тайлы в порядке хранения. Свободные ячейки values содержат T{}, поэтому, например,
+ сумму значений можно считать по всему массиву без проверки маски.
+@param fn Функция fn(const Indexes<N>& origin, const Values& values, std::uint64_t mask),
+ origin -- индексы первой ячейки тайла, ячейка cell лежит в values[cell] и занята, если бит cell маски установлен
+*/
+template <typename T, size_t N, typename Shape>
+template <typename Fn>
+void BlockData<T, N, Shape>::forEachTile(Fn fn) const {
+    for (const Tile& tile : m_tiles) {
+        fn(tile.origin, tile.values, tile.mask);
+    }
+}
+
+
+/*!
+Возвращает итератор на начало диапазона
+@return итератор на начало диапазона
+*/
+template <typename T, size_t N, typename Shape>
+typename BlockData<T, N, Shape>::It BlockData<T, N, Shape>::begin() const {
+    return m_tiles.empty() ? end() : It{&m_tiles, 0, m_tiles.front().mask};
+}
+
+
+/*!
+Возвращает итератор на конец диапазона
+@return итератор на конец диапазона
+*/
+template <typename T, size_t N, typename Shape>
+typename BlockData<T, N, Shape>::It BlockData<T, N, Shape>::end() const {
+    return It{&m_tiles, m_tiles.size(), 0};
+}
+
+
+/*!
+Делит элементы на части для параллельной обработки, границы частей -- границы тайлов
+@param parts Желаемое количество частей
+@return Непустые диапазоны [first, last) в порядке итерирования, вместе покрывающие все элементы
+*/
+template <typename T, size_t N, typename Shape>
+std::vector<std::pair<typename BlockData<T, N, Shape>::It, typename BlockData<T, N, Shape>::It>>
+BlockData<T, N, Shape>::split(size_t parts) const {
+    std::vector<std::pair<It, It>> result;
+    if (m_size == 0) {
+        return result;
+    }
+    parts = std::clamp<size_t>(parts, 1, m_size);
+    const size_t step = (m_size + parts - 1) / parts;
+
+    It first = begin();
+    size_t passed = 0;
+    size_t cut = step;
+    for (size_t tile = 0; tile < m_tiles.size(); ++tile) {
+        if (passed >= cut) {
+            const It next{&m_tiles, tile, m_tiles[tile].mask};
+            result.emplace_back(first, next);
+            first = next;
+            cut = (passed / step + 1) * step;
+        }
+        passed += static_cast<size_t>(__builtin_popcountll(m_tiles[tile].mask));
+    }
+    result.emplace_back(first, end());
+    return result;
+}
+
+
+/*!
+Создает ключ по набору индексов
+@param indexes Набор индексов
+@return Ключ
+*/
+template <typename T, size_t N, typename Shape>
+typename BlockData<T, N, Shape>::Key BlockData<T, N, Shape>::makeKey(const Indexes<N>& indexes) const {
+    return makeKeyImpl(indexes, std::make_index_sequence<N>{});
+}
+
+
+/*!
+Создает элемент
+@param key Ключ
+@return Хранимое значение типа Eleement
+*/
+template <typename T, size_t N, typename Shape>
+typename BlockData<T, N, Shape>::Element BlockData<T, N, Shape>::makeElement(const Key& key, const T& elem) const {
+    return makeElemImpl(key, std::make_index_sequence<N>{}, elem);
+}
+
+
+/*!
+Возвращает ключ тайла: индексы первой ячейки, деленные на размеры тайла
+@param origin Индексы первой ячейки тайла
+@return Ключ для m_index
+*/
+template <typename T, size_t N, typename Shape>
+typename BlockData<T, N, Shape>::TileKey BlockData<T, N, Shape>::tileKey(const Indexes<N>& origin) {
+    Indexes<N> coord;
+    for (size_t d = 0; d < N; ++d) {
+        coord[d] = origin[d] / Shape::EXTENTS[d];
+    }
+    return makeKeyImpl(coord, std::make_index_sequence<N>{});
+}
+
+
+/*!
+Делит индексы ключа на первую ячейку тайла и номер ячейки внутри тайла (последнее измерение меняется быстрее всех)
+@param key  Ключ элемента
+@param cell Номер ячейки внутри тайла
+@return Индексы первой ячейки тайла
+*/
+template <typename T, size_t N, typename Shape>
+Indexes<N> BlockData<T, N, Shape>::originOf(const Key& key, size_t& cell) {
+    Indexes<N> origin;
+    std::apply([&origin](const auto&... items) {
+        size_t d = 0;
+        ((origin[d++] = items), ...);
+    }, key);
+    cell = 0;
+    for (size_t d = 0; d < N; ++d) {
+        const size_t extent = Shape::EXTENTS[d];
+        cell = cell * extent + origin[d] % extent;
+        origin[d] -= origin[d] % extent;
+    }
+    return origin;
+}
+
+
+/*!
+Собирает элемент ячейки тайла
+@param tile Тайл
+@param cell Номер занятой ячейки
+@return Элемент (индекс_1, ..., индекс_N, значение)
+*/
+template <typename T, size_t N, typename Shape>
+typename BlockData<T, N, Shape>::Element BlockData<T, N, Shape>::cellElement(const Tile& tile, size_t cell) {
+    Indexes<N> indexes = tile.origin;
+    size_t rest = cell;
+    for (size_t d = N; d-- > 0;) {
+        indexes[d] += rest % Shape::EXTENTS[d];
+        rest /= Shape::EXTENTS[d];
+    }
+    return makeElemImpl(makeKeyImpl(indexes, std::make_index_sequence<N>{}), std::make_index_sequence<N>{}, tile.values[cell]);
+}
+
+
+/*!
+Удаляет пустой тайл: на его место переносится последний тайл, номер которого обновляется в m_index
+@param tile Номер пустого тайла
+*/
+template <typename T, size_t N, typename Shape>
+void BlockData<T, N, Shape>::removeTile(size_t tile) {
+    m_index.erase(m_index.locate(tileKey(m_tiles[tile].origin)).second);
+    const size_t last = m_tiles.size() - 1;
+    if (tile != last) {
+        m_tiles[tile] = std::move(m_tiles[last]);
+        m_index.value(m_index.locate(tileKey(m_tiles[tile].origin)).second) = tile;
+    }
+    m_tiles.pop_back();
+}
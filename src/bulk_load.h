@@ -0,0 +1,80 @@
+/*!
+@file
+@brief Заголовочный файл с подготовкой данных для пакетной загрузки элементов в матрицу
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+#include "parallel_sort.h"
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+/// Способ разрешения повторяющихся индексов при пакетной загрузке
+enum class DuplicatePolicy {
+    KEEP_FIRST, ///< Оставляется первое значение (при слиянии -- уже хранящееся в матрице)
+    KEEP_LAST,  ///< Оставляется последнее значение (при слиянии -- загружаемое)
+    SUM,        ///< Значения складываются
+    THROW       ///< Повторение индексов является ошибкой
+};
+
+
+/*!
+ Разрешает конфликт двух значений с одинаковыми индексами
+ @param earlier Значение, встретившееся раньше
+ @param later   Значение, встретившееся позже
+ @param policy  Способ разрешения
+ @return Итоговое значение
+ @throw std::runtime_error Для DuplicatePolicy::THROW
+ */
+template <typename T>
+T resolveDuplicate(const T& earlier, const T& later, DuplicatePolicy policy) {
+    switch (policy) {
+        case DuplicatePolicy::KEEP_FIRST:
+            return earlier;
+        case DuplicatePolicy::KEEP_LAST:
+            return later;
+        case DuplicatePolicy::SUM:
+            return earlier + later;
+        case DuplicatePolicy::THROW:
+            break;
+    }
+    throw std::runtime_error("Duplicate indexes in bulk load");
+}
+
+
+/*!
+ Упорядочивает элементы по индексам и схлопывает повторения. Уже упорядоченный вход не сортируется,
+ сортировка устойчива, поэтому "первый" и "последний" соответствуют порядку во входных данных.
+ @tparam N Размерность матрицы
+ @param elements Элементы типа ElementType<T, N>
+ @param policy   Способ разрешения повторяющихся индексов
+ @param pool     Пул потоков для сортировки, nullptr -- сортировать в вызывающем потоке
+ */
+template <size_t N, typename Element>
+void sortUnique(std::vector<Element>& elements, DuplicatePolicy policy, ThreadPool* pool) {
+    const ElementKeyLess<N> less;
+
+    if (!std::is_sorted(elements.begin(), elements.end(), less)) {
+        if (pool != nullptr) {
+            parallelSort(elements.begin(), elements.end(), less, *pool);
+        } else {
+            std::stable_sort(elements.begin(), elements.end(), less);
+        }
+    }
+
+    auto out = elements.begin();
+    for (auto it = elements.begin(); it != elements.end(); ++it) {
+        if (out != elements.begin() && !less(*std::prev(out), *it)) {
+            std::get<N>(*std::prev(out)) = resolveDuplicate(std::get<N>(*std::prev(out)), std::get<N>(*it), policy);
+        } else {
+            if (out != it) {
+                *out = std::move(*it);
+            }
+            ++out;
+        }
+    }
+    elements.erase(out, elements.end());
+}
@@ -0,0 +1,213 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией потокобезопасной разреженной матрицы
+ с разбиением пространства ключей на независимо блокируемые сегменты
+*/
+
+#pragma once
+
+#include "sparse_matrix.h"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+/*!
+ @brief Потокобезопасная бесконечная n-мерная разреженная матрица
+ @details Пространство ключей делится по хэшу на сегменты, каждый из которых -- отдельная
+  Matrix<T, Default, N, Storage> под своим std::shared_mutex. Читатели одного сегмента не блокируют
+  друг друга, запись блокирует только свой сегмент. Все операции над одной ячейкой атомарны.
+ @tparam T тип хранимого элемента
+ @tparam Default значение хранимого элемента по умолчанию
+ @tparam N размерность матрицы
+ @tparam Storage хранилище элементов сегмента
+ */
+template <typename T, T Default, size_t N, typename Storage = HashData<T, N>>
+class ConcurrentMatrix {
+public:
+    /// @brief матрица, в которую копируется снимок
+    using Snapshot = Matrix<T, Default, N, Storage>;
+
+    /// @brief тип хранимого элемента: N индексов и значение
+    using Element = typename Snapshot::Element;
+
+    explicit ConcurrentMatrix(size_t shards = DEFAULT_SHARDS);
+
+    Proxy<T, N, 1, ConcurrentMatrix> operator[](std::size_t);
+
+    void update(const Indexes<N>& indexes, const T& value); ///< Записывает элемент в ячейку с переданными индексами
+    T get(const Indexes<N>& indexes) const;                 ///< Считывает элемент из ячейки с переданными индексами
+    T accumulate(const Indexes<N>& indexes, const T& delta); ///< Атомарно прибавляет delta к элементу
+
+    template <typename Fn>
+    void modify(const Indexes<N>& indexes, Fn fn);          ///< Атомарно изменяет элемент
+
+    size_t size() const;        ///< Возвращает количество хранимых элементов
+    size_t shards() const;      ///< Возвращает количество сегментов
+    Snapshot snapshot() const;  ///< Возвращает согласованную копию всех элементов
+
+    static constexpr size_t DEFAULT_SHARDS = 64; ///< Количество сегментов по умолчанию
+
+private:
+    /// @brief сегмент матрицы, выровненный по кэш-линии, чтобы соседние мьютексы не делили линию
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex; ///< Защищает matrix
+        Snapshot matrix;                 ///< Элементы сегмента
+    };
+
+    Shard& shard(const Indexes<N>& indexes) const; ///< Выбирает сегмент по хэшу индексов
+
+    std::unique_ptr<Shard[]> m_shards; ///< Сегменты
+    size_t m_mask;                     ///< Количество сегментов минус один
+};
+
+
+/*!
+ Создает пустую матрицу
+ @param shards Количество сегментов, округляется вверх до степени двойки. Значение 0 трактуется как 1
+ */
+template <typename T, T Default, size_t N, typename Storage>
+ConcurrentMatrix<T, Default, N, Storage>::ConcurrentMatrix(size_t shards) {
+    size_t count = 1;
+    while (count < shards) {
+        count *= 2;
+    }
+    m_shards = std::make_unique<Shard[]>(count);
+    m_mask = count - 1;
+}
+
+
+/*!
+@return Проксирующий класс
+*/
+template <typename T, T Default, size_t N, typename Storage>
+Proxy<T, N, 1, ConcurrentMatrix<T, Default, N, Storage>> ConcurrentMatrix<T, Default, N, Storage>::operator[](std::size_t index) {
+    Indexes<N> indexes{};
+    indexes[0] = index;
+    return {this, indexes};
+}
+
+
+/*!
+ Записывает элемент в ячейку с переданными индексами
+ @param indexes Набор индексов
+ @param value   Записываемое значение
+ */
+template <typename T, T Default, size_t N, typename Storage>
+void ConcurrentMatrix<T, Default, N, Storage>::update(const Indexes<N>& indexes, const T& value) {
+    Shard& target = shard(indexes);
+    std::unique_lock<std::shared_mutex> lock{target.mutex};
+    target.matrix.set(indexes, value);
+}
+
+
+/*!
+ Считывает элемент, блокируя сегмент только на чтение
+ @param indexes Набор индексов
+ @return Хранимое значение или Default
+ */
+template <typename T, T Default, size_t N, typename Storage>
+T ConcurrentMatrix<T, Default, N, Storage>::get(const Indexes<N>& indexes) const {
+    const Shard& target = shard(indexes);
+    std::shared_lock<std::shared_mutex> lock{target.mutex};
+    return target.matrix.get(indexes);
+}
+
+
+/*!
+ Атомарно прибавляет delta к элементу. Если сумма равна Default, элемент удаляется
+ @param indexes Набор индексов
+ @param delta   Прибавляемое значение
+ @return Значение элемента после сложения
+ */
+template <typename T, T Default, size_t N, typename Storage>
+T ConcurrentMatrix<T, Default, N, Storage>::accumulate(const Indexes<N>& indexes, const T& delta) {
+    T result = Default;
+    modify(indexes, [&delta, &result](T& value) {
+        value += delta;
+        result = value;
+    });
+    return result;
+}
+
+
+/*!
+ Атомарно изменяет элемент, см. Matrix::modify. fn выполняется под блокировкой сегмента
+ и не должна обращаться к этой же матрице
+ @param indexes Набор индексов
+ @param fn      Функция вида void(T&)
+ */
+template <typename T, T Default, size_t N, typename Storage>
+template <typename Fn>
+void ConcurrentMatrix<T, Default, N, Storage>::modify(const Indexes<N>& indexes, Fn fn) {
+    Shard& target = shard(indexes);
+    std::unique_lock<std::shared_mutex> lock{target.mutex};
+    target.matrix.modify(indexes, fn);
+}
+
+
+/*!
+@return Количество хранимых элементов. Сегменты опрашиваются по очереди, поэтому при
+ параллельной записи результат приблизителен
+*/
+template <typename T, T Default, size_t N, typename Storage>
+size_t ConcurrentMatrix<T, Default, N, Storage>::size() const {
+    size_t result = 0;
+    for (size_t i = 0; i <= m_mask; ++i) {
+        std::shared_lock<std::shared_mutex> lock{m_shards[i].mutex};
+        result += m_shards[i].matrix.size();
+    }
+    return result;
+}
+
+
+/*!
+@return Количество сегментов
+*/
+template <typename T, T Default, size_t N, typename Storage>
+size_t ConcurrentMatrix<T, Default, N, Storage>::shards() const {
+    return m_mask + 1;
+}
+
+
+/*!
+ Копирует все элементы в обычную матрицу. На время копирования все сегменты блокируются
+ на чтение (всегда в одном порядке), поэтому снимок соответствует одному моменту времени.
+ @return Матрица, итерирование по которой равносильно Matrix::begin()/end()
+ */
+template <typename T, T Default, size_t N, typename Storage>
+typename ConcurrentMatrix<T, Default, N, Storage>::Snapshot ConcurrentMatrix<T, Default, N, Storage>::snapshot() const {
+    std::vector<std::shared_lock<std::shared_mutex>> locks;
+    locks.reserve(m_mask + 1);
+
+    size_t count = 0;
+    for (size_t i = 0; i <= m_mask; ++i) {
+        locks.emplace_back(m_shards[i].mutex);
+        count += m_shards[i].matrix.size();
+    }
+
+    std::vector<Element> elements;
+    elements.reserve(count);
+    for (size_t i = 0; i <= m_mask; ++i) {
+        elements.insert(elements.end(), m_shards[i].matrix.begin(), m_shards[i].matrix.end());
+    }
+    locks.clear();
+
+    Snapshot result;
+    result.bulkLoad(std::move(elements));
+    return result;
+}
+
+
+/*!
+ Выбирает сегмент по старшим битам хэша, младшие используются хэш-таблицей внутри сегмента
+ @param indexes Набор индексов
+ @return Сегмент, которому принадлежит ячейка
+ */
+template <typename T, T Default, size_t N, typename Storage>
+typename ConcurrentMatrix<T, Default, N, Storage>::Shard& ConcurrentMatrix<T, Default, N, Storage>::shard(const Indexes<N>& indexes) const {
+    const std::uint64_t hash = KeyHash<N>{}(makeKeyImpl(indexes, std::make_index_sequence<N>{}));
+    return m_shards[static_cast<size_t>(hash >> 32) & m_mask];
+}
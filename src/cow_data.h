@@ -0,0 +1,470 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией хранилища разреженной матрицы,
+ страницы которого разделяются между копиями и копируются только при записи
+*/
+
+#pragma once
+
+#include "hash_data.h"
+
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+/*!
+@brief Класс, который отвечает за хранение данных в страницах, разделяемых между копиями (copy-on-write)
+@details Ключ по старшим битам своего хэша попадает в одну из 2^PAGE_BITS страниц, каждая страница --
+ HashData<T, N>, которой владеет std::shared_ptr. Каталог страниц тоже разделяемый, поэтому копирование
+ хранилища стоит O(1): копируется указатель на каталог и счетчик элементов. Первая запись после копирования
+ копирует каталог (2^PAGE_BITS указателей), а каждая страница копируется при первой записи в нее,
+ остальные страницы по-прежнему общие. Страница освобождается, когда ее не использует ни одна копия.
+ Интерфейс совпадает с HashData<T, N>, поэтому класс можно передать в Matrix<T, Default, N, Storage>,
+ см. также BasicMatrix::snapshot().
+ Копии можно читать и уничтожать в других потоках, пока исходное хранилище изменяется, если сами
+ копии создаются в потоке, который изменяет исходное хранилище: перед записью на месте владение
+ страницей проверяется с барьером acquire, см. writablePage.
+@tparam T тип хранимых данных
+@tparam N n-мерность матрицы
+@tparam PAGE_BITS двоичный логарифм количества страниц
+*/
+template <typename T, size_t N, size_t PAGE_BITS = 8>
+class CowData {
+    /// @brief страница элементов
+    using Page = HashData<T, N>;
+
+    /// @brief каталог страниц, nullptr -- пустая страница
+    using Directory = std::array<std::shared_ptr<Page>, size_t{1} << PAGE_BITS>;
+public:
+    /// @brief тип ключа
+    using Key      = typename Page::Key;
+
+    /// @brief тип хранимого элемента, представляет из себя std::tuple из N индексов типа size_t и последющим значением типа T
+    using Element  = typename Page::Element;
+
+    /// @brief страница и ячейка в ее таблице
+    struct MapIt {
+        size_t page;                ///< Номер страницы
+        typename Page::MapIt slot;  ///< Номер ячейки в таблице страницы
+    };
+
+    class It;
+
+    /// @brief признак того, что хранилище упорядочено по ключу
+    static constexpr bool IS_ORDERED = false;
+
+    /// @brief признак того, что копирование хранилища стоит O(1)
+    static constexpr bool COPY_ON_WRITE = true;
+
+    /// @brief количество страниц
+    static constexpr size_t PAGES = size_t{1} << PAGE_BITS;
+
+    static_assert(PAGE_BITS > 0 && PAGE_BITS < 16, "CowData supports from 2 to 2^15 pages");
+
+    std::pair<bool, MapIt> locate(const Key& key) const;       ///< Ищет элемент или место для его вставки
+    template <typename V>
+    T& emplace(MapIt hint, const Key& key, V&& elem);          ///< Добавляет отсутствующий элемент в место, найденное locate
+    template <typename V>
+    void insert(MapIt it, const Key& key, V&& elem);           ///< Добавляет или перезаписывает элемент по итератору, V -- const T& или T
+    void erase(MapIt it);                                      ///< Удаление по переданному итератору
+    T& value(MapIt it);                                        ///< Возвращает значение существующего элемента
+    const T& value(MapIt it) const;                            ///< Возвращает значение существующего элемента
+    It find(const Key& key) const;                             ///< Находит элемент по ключу, end() если его нет
+
+    size_t size() const;                                       ///< Возвращает количесвто хранимых элементов
+    void reserve(size_t count);                                ///< Резервирует место под count элементов
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);                  ///< Заменяет содержимое уникальными элементами
+
+    It begin() const;                                          ///< Возвращает итератор на начало
+    It end() const;                                            ///< Возвращает итератор на конец
+    std::vector<std::pair<It, It>> split(size_t parts) const;  ///< Делит элементы на не более parts последовательных частей
+
+    Key makeKey(const Indexes<N>& indexes) const;              ///< Создает ключ
+    Element makeElement(const Key& key, const T& elem) const;  ///< Создает элемент
+
+    size_t sharedPages() const;                                ///< Возвращает количество страниц, общих с другими копиями
+
+private:
+    static size_t pageOf(const Key& key);   ///< Возвращает номер страницы ключа
+    template <typename P>
+    static bool owned(const std::shared_ptr<P>& pointer); ///< Проверяет, что объектом не владеют другие копии
+    Page& writablePage(size_t page);        ///< Возвращает страницу, которой владеет только это хранилище
+
+    std::shared_ptr<Directory> m_pages; ///< Каталог страниц, nullptr для пустого хранилища
+    size_t m_size = 0;                  ///< Количество хранимых элементов
+};
+
+
+namespace detail {
+
+/// Проверяет, что копирование хранилища стоит O(1) (Storage::COPY_ON_WRITE)
+template <typename Storage, typename = void>
+struct IsCopyOnWrite : std::false_type {};
+
+template <typename Storage>
+struct IsCopyOnWrite<Storage, std::void_t<decltype(Storage::COPY_ON_WRITE)>> : std::bool_constant<Storage::COPY_ON_WRITE> {};
+
+}
+
+
+/*!
+ @brief Прямой итератор по элементам CowData: страницы по порядку, внутри страницы -- порядок HashData
+ @details Действителен до следующего изменения хранилища
+ */
+template <typename T, size_t N, size_t PAGE_BITS>
+class CowData<T, N, PAGE_BITS>::It {
+    /// @brief итератор страницы
+    using Base = typename Page::It;
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const Element*;
+    using reference         = const Element&;
+
+    It() = default;
+    It(const Directory* pages, size_t page, Base it) : m_pages{pages}, m_page{page}, m_it{it} {}
+
+    reference operator*() const { return *m_it; }
+    pointer operator->() const { return &*m_it; }
+    It& operator++() { ++m_it; settle(); return *this; }
+    It operator++(int) { It tmp = *this; ++*this; return tmp; }
+    bool operator==(const It& other) const { return m_page == other.m_page && (m_page == PAGES || m_it == other.m_it); }
+    bool operator!=(const It& other) const { return !(*this == other); }
+
+private:
+    friend class CowData;
+
+    /// Переходит к первой непустой странице, если текущая закончилась
+    void settle() {
+        while (m_page < PAGES && m_it == (*m_pages)[m_page]->end()) {
+            m_page = next(m_page + 1);
+            if (m_page < PAGES) {
+                m_it = (*m_pages)[m_page]->begin();
+            }
+        }
+    }
+
+    /// Возвращает номер первой непустой страницы, начиная с page, или PAGES
+    size_t next(size_t page) const {
+        while (page < PAGES && ((*m_pages)[page] == nullptr || (*m_pages)[page]->size() == 0)) {
+            ++page;
+        }
+        return page;
+    }
+
+    const Directory* m_pages = nullptr; ///< Каталог страниц
+    size_t m_page = PAGES;              ///< Текущая страница, PAGES для конца
+    Base m_it{};                        ///< Текущая позиция в странице
+};
+
+
+/*!
+Ищет элемент по ключу
+@param key Ключ искомого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и позиции элемента или места для его вставки
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+std::pair<bool, typename CowData<T, N, PAGE_BITS>::MapIt> CowData<T, N, PAGE_BITS>::locate(const Key& key) const {
+    const size_t page = pageOf(key);
+    if (m_pages == nullptr || (*m_pages)[page] == nullptr) {
+        return {false, MapIt{page, 0}};
+    }
+    const auto [exists, slot] = (*m_pages)[page]->locate(key);
+    return {exists, MapIt{page, slot}};
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище. Общая с другими копиями страница сначала копируется
+ вместе с таблицей, поэтому номер ячейки из locate остается действительным.
+@param hint Позиция, полученная из locate для того же ключа
+@param key  Ключ для элемента
+@param val  Хранимое значение, rvalue перемещается
+@return Ссылка на сохраненное значение
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+template <typename V>
+T& CowData<T, N, PAGE_BITS>::emplace(MapIt hint, const Key& key, V&& val) {
+    T& stored = writablePage(hint.page).emplace(hint.slot, key, std::forward<V>(val));
+    ++m_size;
+    return stored;
+}
+
+
+/*!
+Добавляет элемент по итератору. В случае, когда элемент существует, значение перезаписывается на месте.
+@param it  Позиция, полученная из locate
+@param key Ключ для элемента
+@param val Хранимое значение, rvalue перемещается
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+template <typename V>
+void CowData<T, N, PAGE_BITS>::insert(MapIt it, const Key& key, V&& val) {
+    Page& page = writablePage(it.page);
+    const bool exists = page.contains(it.slot);
+    page.insert(it.slot, key, std::forward<V>(val));
+    m_size += !exists;
+}
+
+
+/*!
+Удаляет элемент по переданному итератору
+@param it Позиция существующего элемента
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+void CowData<T, N, PAGE_BITS>::erase(MapIt it) {
+    writablePage(it.page).erase(it.slot);
+    --m_size;
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента, копируя общую страницу
+@param it Позиция найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+T& CowData<T, N, PAGE_BITS>::value(MapIt it) {
+    return writablePage(it.page).value(it.slot);
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Позиция найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+const T& CowData<T, N, PAGE_BITS>::value(MapIt it) const {
+    return (*m_pages)[it.page]->value(it.slot);
+}
+
+
+/*!
+Находит элемент по ключу
+@param key Ключ искомого элемента
+@return Итератор на элемент или end(), если элемента нет
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+typename CowData<T, N, PAGE_BITS>::It CowData<T, N, PAGE_BITS>::find(const Key& key) const {
+    const size_t page = pageOf(key);
+    if (m_pages == nullptr || (*m_pages)[page] == nullptr) {
+        return end();
+    }
+    const auto it = (*m_pages)[page]->find(key);
+    return it != (*m_pages)[page]->end() ? It{m_pages.get(), page, it} : end();
+}
+
+
+/*!
+Возвращает количество хранимых элементов
+@return количество хранимых элементов
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+size_t CowData<T, N, PAGE_BITS>::size() const {
+    return m_size;
+}
+
+
+/*!
+Резервирует место под count элементов, поровну на каждую страницу
+@param count Ожидаемое количество элементов
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+void CowData<T, N, PAGE_BITS>::reserve(size_t count) {
+    if (count <= m_size) {
+        return;
+    }
+    const size_t per_page = count / PAGES + count / PAGES / 8 + 1;
+    for (size_t page = 0; page < PAGES; ++page) {
+        writablePage(page).reserve(per_page);
+    }
+}
+
+
+/*!
+Заменяет содержимое переданными элементами. Ключи элементов не должны повторяться.
+ Прежние страницы остаются у копий, которые их используют.
+@param first Начало диапазона элементов типа Element
+@param last  Конец диапазона элементов типа Element
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+template <typename InputIt>
+void CowData<T, N, PAGE_BITS>::assign(InputIt first, InputIt last) {
+    std::array<std::vector<Element>, PAGES> parts;
+    for (; first != last; ++first) {
+        parts[pageOf(elemKeyImpl(*first, std::make_index_sequence<N>{}))].push_back(*first);
+    }
+
+    m_pages = std::make_shared<Directory>();
+    m_size = 0;
+    for (size_t page = 0; page < PAGES; ++page) {
+        if (!parts[page].empty()) {
+            (*m_pages)[page] = std::make_shared<Page>();
+            (*m_pages)[page]->assign(parts[page].begin(), parts[page].end());
+            m_size += parts[page].size();
+        }
+    }
+}
+
+
+/*!
+Возвращает итератор на начало диапазона
+@return итератор на начало диапазона
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+typename CowData<T, N, PAGE_BITS>::It CowData<T, N, PAGE_BITS>::begin() const {
+    if (m_pages == nullptr) {
+        return end();
+    }
+    It it{m_pages.get(), PAGES, {}};
+    const size_t page = it.next(0);
+    return page < PAGES ? It{m_pages.get(), page, (*m_pages)[page]->begin()} : end();
+}
+
+
+/*!
+Возвращает итератор на конец диапазона
+@return итератор на конец диапазона
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+typename CowData<T, N, PAGE_BITS>::It CowData<T, N, PAGE_BITS>::end() const {
+    return It{m_pages.get(), PAGES, {}};
+}
+
+
+/*!
+Делит элементы на части для параллельной обработки. Страница -- массив элементов, поэтому граница
+ части может приходиться на середину страницы и находится без прохода по элементам
+@param parts Желаемое количество частей
+@return Непустые диапазоны [first, last) в порядке итерирования, вместе покрывающие все элементы
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+std::vector<std::pair<typename CowData<T, N, PAGE_BITS>::It, typename CowData<T, N, PAGE_BITS>::It>>
+CowData<T, N, PAGE_BITS>::split(size_t parts) const {
+    std::vector<std::pair<It, It>> result;
+    if (m_size == 0) {
+        return result;
+    }
+    parts = std::clamp<size_t>(parts, 1, m_size);
+    const size_t step = (m_size + parts - 1) / parts;
+
+    It first = begin();
+    size_t passed = 0;
+    size_t cut = step;
+    for (size_t page = 0; page < PAGES; ++page) {
+        const Page* elements = (*m_pages)[page].get();
+        const size_t count = elements == nullptr ? 0 : elements->size();
+        for (; cut < passed + count; cut += step) {
+            const It next{m_pages.get(), page, elements->begin() + static_cast<std::ptrdiff_t>(cut - passed)};
+            result.emplace_back(first, next);
+            first = next;
+        }
+        passed += count;
+    }
+    result.emplace_back(first, end());
+    return result;
+}
+
+
+/*!
+Создает ключ по набору индексов
+@param indexes Набор индексов
+@return Ключ
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+typename CowData<T, N, PAGE_BITS>::Key CowData<T, N, PAGE_BITS>::makeKey(const Indexes<N>& indexes) const {
+    return makeKeyImpl(indexes, std::make_index_sequence<N>{});
+}
+
+
+/*!
+Создает элемент
+@param key Ключ
+@return Хранимое значение типа Eleement
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+typename CowData<T, N, PAGE_BITS>::Element CowData<T, N, PAGE_BITS>::makeElement(const Key& key, const T& elem) const {
+    return makeElemImpl(key, std::make_index_sequence<N>{}, elem);
+}
+
+
+/*!
+Возвращает количество страниц, которые используются также другими копиями хранилища.
+ Если каталог общий, общими считаются все непустые страницы.
+@return Количество общих страниц
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+size_t CowData<T, N, PAGE_BITS>::sharedPages() const {
+    if (m_pages == nullptr) {
+        return 0;
+    }
+    const bool shared_directory = m_pages.use_count() > 1;
+    size_t shared = 0;
+    for (const auto& page : *m_pages) {
+        shared += page != nullptr && (shared_directory || page.use_count() > 1);
+    }
+    return shared;
+}
+
+
+/*!
+Возвращает номер страницы по старшим битам хэша ключа, младшие биты использует таблица страницы
+@param key Ключ
+@return Номер страницы
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+size_t CowData<T, N, PAGE_BITS>::pageOf(const Key& key) {
+    return static_cast<size_t>(KeyHash<N>{}(key) >> (64 - PAGE_BITS));
+}
+
+
+/*!
+Проверяет, что объектом владеет только это хранилище. use_count() читает счетчик ссылок без
+ упорядочивания (relaxed), поэтому чтения последней другой копии, уничтоженной в другом потоке, не
+ упорядочены с последующей записью на месте. Барьер acquire синхронизируется с уменьшением счетчика
+ в деструкторе этой копии (acq_rel), которое прочитал use_count()
+@param pointer Указатель на каталог или страницу
+@return true, если других владельцев нет
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+template <typename P>
+bool CowData<T, N, PAGE_BITS>::owned(const std::shared_ptr<P>& pointer) {
+    if (pointer.use_count() > 1) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+
+/*!
+Готовит страницу к записи: копирует каталог, если он общий с другой копией, затем копирует
+ страницу, если она общая, или создает отсутствующую
+@param page Номер страницы
+@return Страница, которой владеет только это хранилище
+*/
+template <typename T, size_t N, size_t PAGE_BITS>
+typename CowData<T, N, PAGE_BITS>::Page& CowData<T, N, PAGE_BITS>::writablePage(size_t page) {
+    if (m_pages == nullptr) {
+        m_pages = std::make_shared<Directory>();
+    } else if (!owned(m_pages)) {
+        m_pages = std::make_shared<Directory>(*m_pages);
+    }
+
+    auto& slot = (*m_pages)[page];
+    if (slot == nullptr) {
+        slot = std::make_shared<Page>();
+    } else if (!owned(slot)) {
+        slot = std::make_shared<Page>(*slot);
+    }
+    return *slot;
+}
@@ -0,0 +1,554 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией неизменяемой сжатой (CSR/CSC) двумерной матрицы,
+ которая строится из Matrix<T, Default, 2, Storage> после окончания заполнения
+*/
+
+#pragma once
+
+#include "sparse_matrix.h"
+
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+/// Порядок хранения сжатой матрицы
+enum class Major {
+    ROW,   ///< Compressed Sparse Row: элементы сгруппированы по строкам
+    COLUMN ///< Compressed Sparse Column: элементы сгруппированы по столбцам
+};
+
+
+/*!
+ @brief Неизменяемая двумерная разреженная матрица в сжатом формате
+ @details Элементы хранятся в формате DCSR: m_lineIds (номера непустых линий -- строк для CSR
+  или столбцов для CSC -- по возрастанию), m_offsets (начало каждой непустой линии), m_indexes
+  (второй индекс элемента) и m_values. Пустые линии не занимают памяти, поэтому элемент с номером
+  строки 10^12 стоит столько же, сколько элемент в нулевой строке. Если линий не больше, чем
+  элементов (матрица не гиперразреженная), дополнительно хранится обычный массив CSR m_linePtr
+  с началом каждой линии, включая пустые: он занимает не больше памяти, чем m_indexes, и дает
+  получение линии за O(1). Для гиперразреженной матрицы линия находится двоичным поиском по m_lineIds
+  за O(log непустых линий). Внутри линии элементы упорядочены по второму индексу, поэтому чтение
+  ячейки -- двоичный поиск по линии.
+ @tparam T тип хранимого элемента
+ @tparam Default значение хранимого элемента по умолчанию
+ @tparam Order порядок хранения
+ */
+template <typename T, T Default, Major Order = Major::ROW>
+class CompressedMatrix {
+public:
+    /// @brief тип элемента, возвращаемого при итерировании: (строка, столбец, значение)
+    using Element = ElementType<T, 2>;
+
+    class Line;
+    class Iterator;
+
+    CompressedMatrix() = default;
+    CompressedMatrix(size_t rows, size_t columns,
+                     std::vector<size_t> offsets, std::vector<size_t> indexes, std::vector<T> values);
+    CompressedMatrix(size_t rows, size_t columns, std::vector<size_t> lineIds,
+                     std::vector<size_t> offsets, std::vector<size_t> indexes, std::vector<T> values);
+
+    T get(size_t row, size_t column) const;        ///< Считывает элемент по индексам
+    T operator()(size_t row, size_t column) const; ///< Считывает элемент по индексам
+
+    Line line(size_t index) const;                 ///< Возвращает строку (CSR) или столбец (CSC)
+    Line row(size_t index) const;                  ///< Возвращает строку, доступно только для CSR
+    Line column(size_t index) const;               ///< Возвращает столбец, доступно только для CSC
+    bool directLines() const;                      ///< Проверяет, находится ли линия за O(1)
+
+    size_t size() const;                           ///< Возвращает количество хранимых элементов
+    size_t rows() const;                           ///< Возвращает количество строк
+    size_t columns() const;                        ///< Возвращает количество столбцов
+    size_t lines() const;                          ///< Возвращает количество линий, включая пустые
+
+    const std::vector<size_t>& lineIds() const;    ///< Массив номеров непустых линий
+    const std::vector<size_t>& offsets() const;    ///< Массив начал непустых линий, размер lineIds().size() + 1
+    const std::vector<size_t>& indexes() const;    ///< Массив вторых индексов элементов
+    const std::vector<T>& values() const;          ///< Массив значений элементов
+
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    void buildLinePtr();                 ///< Строит m_linePtr, если матрица не гиперразреженная
+
+    size_t m_rows = 0;                   ///< Количество строк
+    size_t m_columns = 0;                ///< Количество столбцов
+    std::vector<size_t> m_lineIds;       ///< Номера непустых линий по возрастанию
+    std::vector<size_t> m_offsets = {0}; ///< Начало каждой непустой линии в m_indexes и m_values
+    std::vector<size_t> m_indexes;       ///< Второй индекс каждого элемента
+    std::vector<T> m_values;             ///< Значение каждого элемента
+    std::vector<size_t> m_linePtr;       ///< Начало каждой линии, включая пустые, или пустой для гиперразреженной матрицы
+};
+
+
+/*!
+ @brief Представление одной линии (строки или столбца) сжатой матрицы
+ @details Итерирование возвращает пары (второй индекс, значение)
+ */
+template <typename T, T Default, Major Order>
+class CompressedMatrix<T, Default, Order>::Line {
+public:
+    /// @brief итератор по элементам линии
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::tuple<size_t, T>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = value_type;
+
+        Iterator(const size_t* index, const T* value) : m_index{index}, m_value{value} {}
+
+        reference operator*() const { return {*m_index, *m_value}; }
+        Iterator& operator++() { ++m_index; ++m_value; return *this; }
+        Iterator operator++(int) { Iterator tmp = *this; ++(*this); return tmp; }
+        difference_type operator-(const Iterator& other) const { return m_index - other.m_index; }
+        bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+    private:
+        const size_t* m_index; ///< Указатель на текущий индекс
+        const T* m_value;      ///< Указатель на текущее значение
+    };
+
+    Line(size_t index, const size_t* indexes, const T* values, size_t size)
+        : m_index{index}, m_indexes{indexes}, m_values{values}, m_size{size} {}
+
+    size_t index() const { return m_index; }            ///< Номер линии
+    size_t size() const { return m_size; }              ///< Количество элементов в линии
+    bool empty() const { return m_size == 0; }          ///< Проверяет, есть ли элементы в линии
+    const size_t* indexes() const { return m_indexes; } ///< Вторые индексы элементов линии
+    const T* values() const { return m_values; }        ///< Значения элементов линии
+
+    T get(size_t index) const;                          ///< Считывает элемент линии по второму индексу
+
+    Iterator begin() const { return {m_indexes, m_values}; }
+    Iterator end() const { return {m_indexes + m_size, m_values + m_size}; }
+
+private:
+    size_t m_index;          ///< Номер линии
+    const size_t* m_indexes; ///< Начало вторых индексов линии
+    const T* m_values;       ///< Начало значений линии
+    size_t m_size;           ///< Количество элементов в линии
+};
+
+
+/*!
+ @brief Итератор по всем элементам сжатой матрицы
+ @details Разыменование возвращает Element (строка, столбец, значение), что позволяет использовать
+  structured bindings так же, как с Matrix::begin()/end()
+ */
+template <typename T, T Default, Major Order>
+class CompressedMatrix<T, Default, Order>::Iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = Element;
+
+    Iterator(const CompressedMatrix* matrix, size_t line, size_t position)
+        : m_matrix{matrix}, m_line{line}, m_position{position} {
+        skipEmptyLines();
+    }
+
+    reference operator*() const {
+        const size_t index = m_matrix->m_indexes[m_position];
+        const T& value     = m_matrix->m_values[m_position];
+        const size_t line  = m_matrix->m_lineIds[m_line];
+        if constexpr (Order == Major::ROW) {
+            return {line, index, value};
+        } else {
+            return {index, line, value};
+        }
+    }
+
+    Iterator& operator++() {
+        ++m_position;
+        skipEmptyLines();
+        return *this;
+    }
+
+    Iterator operator++(int) { Iterator tmp = *this; ++(*this); return tmp; }
+    bool operator==(const Iterator& other) const { return m_position == other.m_position; }
+    bool operator!=(const Iterator& other) const { return m_position != other.m_position; }
+
+private:
+    /// Переходит к непустой линии, которой принадлежит m_position
+    void skipEmptyLines() {
+        const auto& offsets = m_matrix->m_offsets;
+        while (m_line + 1 < offsets.size() && offsets[m_line + 1] <= m_position) {
+            ++m_line;
+        }
+    }
+
+    const CompressedMatrix* m_matrix; ///< Итерируемая матрица
+    size_t m_line;                    ///< Номер текущей линии в m_lineIds
+    size_t m_position;                ///< Номер текущего элемента в m_indexes и m_values
+};
+
+
+/// @brief сокращение для матрицы в формате CSR
+template <typename T, T Default = 0> using CSRMatrix = CompressedMatrix<T, Default, Major::ROW>;
+/// @brief сокращение для матрицы в формате CSC
+template <typename T, T Default = 0> using CSCMatrix = CompressedMatrix<T, Default, Major::COLUMN>;
+
+
+/*!
+ Создает матрицу из массивов в формате CSR/CSC, пустые линии отбрасываются
+ @param rows    Количество строк
+ @param columns Количество столбцов
+ @param offsets Начала всех линий, размер равен количеству линий + 1
+ @param indexes Вторые индексы элементов, упорядоченные внутри каждой линии
+ @param values  Значения элементов
+ @throw std::invalid_argument Если размеры массивов не согласованы
+ */
+template <typename T, T Default, Major Order>
+CompressedMatrix<T, Default, Order>::CompressedMatrix(size_t rows, size_t columns,
+                                                      std::vector<size_t> offsets,
+                                                      std::vector<size_t> indexes,
+                                                      std::vector<T> values)
+    : m_rows{rows}, m_columns{columns}, m_indexes{std::move(indexes)}, m_values{std::move(values)} {
+    const size_t lines = Order == Major::ROW ? m_rows : m_columns;
+    if (offsets.size() != lines + 1 || m_indexes.size() != m_values.size() ||
+        offsets.front() != 0 || offsets.back() != m_values.size()) {
+        throw std::invalid_argument("Inconsistent compressed matrix arrays");
+    }
+    for (size_t line = 0; line < lines; ++line) {
+        if (offsets[line + 1] < offsets[line]) {
+            throw std::invalid_argument("Inconsistent compressed matrix arrays");
+        }
+        if (offsets[line + 1] != offsets[line]) {
+            m_lineIds.push_back(line);
+            m_offsets.push_back(offsets[line + 1]);
+        }
+    }
+    buildLinePtr();
+}
+
+
+/*!
+ Создает матрицу из массивов в формате DCSR/DCSC
+ @param rows    Количество строк
+ @param columns Количество столбцов
+ @param lineIds Номера непустых линий по возрастанию
+ @param offsets Начала непустых линий, размер равен lineIds.size() + 1
+ @param indexes Вторые индексы элементов, упорядоченные внутри каждой линии
+ @param values  Значения элементов
+ @throw std::invalid_argument Если размеры массивов не согласованы
+ */
+template <typename T, T Default, Major Order>
+CompressedMatrix<T, Default, Order>::CompressedMatrix(size_t rows, size_t columns,
+                                                      std::vector<size_t> lineIds,
+                                                      std::vector<size_t> offsets,
+                                                      std::vector<size_t> indexes,
+                                                      std::vector<T> values)
+    : m_rows{rows}, m_columns{columns}, m_lineIds{std::move(lineIds)},
+      m_offsets{std::move(offsets)}, m_indexes{std::move(indexes)}, m_values{std::move(values)} {
+    const size_t lines = Order == Major::ROW ? m_rows : m_columns;
+    if (m_offsets.size() != m_lineIds.size() + 1 || m_indexes.size() != m_values.size() ||
+        m_offsets.front() != 0 || m_offsets.back() != m_values.size() ||
+        (!m_lineIds.empty() && m_lineIds.back() >= lines)) {
+        throw std::invalid_argument("Inconsistent compressed matrix arrays");
+    }
+    for (size_t i = 0; i < m_lineIds.size(); ++i) {
+        if (m_offsets[i + 1] <= m_offsets[i] || (i > 0 && m_lineIds[i] <= m_lineIds[i - 1])) {
+            throw std::invalid_argument("Inconsistent compressed matrix arrays");
+        }
+    }
+    buildLinePtr();
+}
+
+
+/*!
+ Считывает элемент по индексам двоичным поиском внутри линии
+ @param row    Номер строки
+ @param column Номер столбца
+ @return Хранимое значение или Default
+ */
+template <typename T, T Default, Major Order>
+T CompressedMatrix<T, Default, Order>::get(size_t row, size_t column) const {
+    const size_t outer = Order == Major::ROW ? row : column;
+    const size_t inner = Order == Major::ROW ? column : row;
+
+    if (outer >= lines()) {
+        return Default;
+    }
+    return line(outer).get(inner);
+}
+
+
+/*!
+ @copydoc get
+ */
+template <typename T, T Default, Major Order>
+T CompressedMatrix<T, Default, Order>::operator()(size_t row, size_t column) const {
+    return get(row, column);
+}
+
+
+/*!
+ Считывает элемент линии по второму индексу
+ @param index Второй индекс элемента
+ @return Хранимое значение или Default
+ */
+template <typename T, T Default, Major Order>
+T CompressedMatrix<T, Default, Order>::Line::get(size_t index) const {
+    const size_t* last = m_indexes + m_size;
+    const size_t* it   = std::lower_bound(m_indexes, last, index);
+
+    if (it == last || *it != index) {
+        return Default;
+    }
+    return m_values[it - m_indexes];
+}
+
+
+/*!
+ Находит линию: за O(1) по m_linePtr или, для гиперразреженной матрицы, двоичным поиском по номерам непустых линий
+ @param index Номер линии
+ @return Строку (для CSR) или столбец (для CSC). Для пустой линии и линии за пределами матрицы возвращается пустая линия
+ */
+template <typename T, T Default, Major Order>
+typename CompressedMatrix<T, Default, Order>::Line CompressedMatrix<T, Default, Order>::line(size_t index) const {
+    if (!m_linePtr.empty()) {
+        if (index >= lines()) {
+            return {index, m_indexes.data(), m_values.data(), 0};
+        }
+        const size_t first = m_linePtr[index];
+        return {index, m_indexes.data() + first, m_values.data() + first, m_linePtr[index + 1] - first};
+    }
+
+    const auto it = std::lower_bound(m_lineIds.begin(), m_lineIds.end(), index);
+    if (it == m_lineIds.end() || *it != index) {
+        return {index, m_indexes.data(), m_values.data(), 0};
+    }
+
+    const auto position = static_cast<size_t>(it - m_lineIds.begin());
+    const size_t first = m_offsets[position];
+    return {index, m_indexes.data() + first, m_values.data() + first, m_offsets[position + 1] - first};
+}
+
+
+/*!
+ Возвращает строку за O(1), для гиперразреженной матрицы -- за O(log непустых строк), см. directLines()
+ @param index Номер строки
+ @return Строку матрицы
+ */
+template <typename T, T Default, Major Order>
+typename CompressedMatrix<T, Default, Order>::Line CompressedMatrix<T, Default, Order>::row(size_t index) const {
+    static_assert(Order == Major::ROW, "Row slicing is available only for CSR matrix");
+    return line(index);
+}
+
+
+/*!
+ Возвращает столбец за O(1), для гиперразреженной матрицы -- за O(log непустых столбцов), см. directLines()
+ @param index Номер столбца
+ @return Столбец матрицы
+ */
+template <typename T, T Default, Major Order>
+typename CompressedMatrix<T, Default, Order>::Line CompressedMatrix<T, Default, Order>::column(size_t index) const {
+    static_assert(Order == Major::COLUMN, "Column slicing is available only for CSC matrix");
+    return line(index);
+}
+
+
+/*!
+@return true, если хранится массив начал всех линий и line() -- O(1); false для гиперразреженной
+ матрицы, в которой линий больше, чем элементов, и line() -- двоичный поиск
+*/
+template <typename T, T Default, Major Order>
+bool CompressedMatrix<T, Default, Order>::directLines() const {
+    return !m_linePtr.empty();
+}
+
+
+/*!
+ Строит массив начал всех линий, если их не больше, чем элементов: тогда он не длиннее m_indexes
+*/
+template <typename T, T Default, Major Order>
+void CompressedMatrix<T, Default, Order>::buildLinePtr() {
+    if (lines() == 0 || lines() > size()) {
+        return;
+    }
+    m_linePtr.assign(lines() + 1, 0);
+    size_t next = 0;
+    for (size_t line = 0; line <= lines(); ++line) {
+        while (next < m_lineIds.size() && m_lineIds[next] < line) {
+            ++next;
+        }
+        m_linePtr[line] = m_offsets[next];
+    }
+}
+
+
+/*!
+@return Количество хранимых элементов
+*/
+template <typename T, T Default, Major Order>
+size_t CompressedMatrix<T, Default, Order>::size() const {
+    return m_values.size();
+}
+
+
+/*!
+@return Количество строк, т.е. наибольший номер строки с элементом + 1
+*/
+template <typename T, T Default, Major Order>
+size_t CompressedMatrix<T, Default, Order>::rows() const {
+    return m_rows;
+}
+
+
+/*!
+@return Количество столбцов, т.е. наибольший номер столбца с элементом + 1
+*/
+template <typename T, T Default, Major Order>
+size_t CompressedMatrix<T, Default, Order>::columns() const {
+    return m_columns;
+}
+
+
+/*!
+@return Количество строк для CSR или столбцов для CSC, включая пустые
+*/
+template <typename T, T Default, Major Order>
+size_t CompressedMatrix<T, Default, Order>::lines() const {
+    return Order == Major::ROW ? m_rows : m_columns;
+}
+
+
+/*!
+@return Массив номеров непустых линий по возрастанию
+*/
+template <typename T, T Default, Major Order>
+const std::vector<size_t>& CompressedMatrix<T, Default, Order>::lineIds() const {
+    return m_lineIds;
+}
+
+
+/*!
+@return Массив начал непустых линий, линия lineIds()[i] занимает [offsets()[i], offsets()[i + 1])
+*/
+template <typename T, T Default, Major Order>
+const std::vector<size_t>& CompressedMatrix<T, Default, Order>::offsets() const {
+    return m_offsets;
+}
+
+
+/*!
+@return Массив вторых индексов элементов
+*/
+template <typename T, T Default, Major Order>
+const std::vector<size_t>& CompressedMatrix<T, Default, Order>::indexes() const {
+    return m_indexes;
+}
+
+
+/*!
+@return Массив значений элементов
+*/
+template <typename T, T Default, Major Order>
+const std::vector<T>& CompressedMatrix<T, Default, Order>::values() const {
+    return m_values;
+}
+
+
+/*!
+@return Итератор на начало диапазона элементов
+*/
+template <typename T, T Default, Major Order>
+typename CompressedMatrix<T, Default, Order>::Iterator CompressedMatrix<T, Default, Order>::begin() const {
+    return {this, 0, 0};
+}
+
+
+/*!
+@return Итератор на конец диапазона элементов
+*/
+template <typename T, T Default, Major Order>
+typename CompressedMatrix<T, Default, Order>::Iterator CompressedMatrix<T, Default, Order>::end() const {
+    return {this, m_lineIds.size(), size()};
+}
+
+
+/*!
+ Строит сжатую матрицу из произвольной двумерной матрицы. Элементы упорядочиваются по линии
+ и второму индексу, затем делятся на непустые линии, поэтому время и память зависят только
+ от количества элементов, а не от величины индексов.
+ @param matrix Исходная матрица
+ @return Сжатая матрица с тем же набором элементов
+ @throw std::invalid_argument Если индекс элемента равен SIZE_MAX: количество строк или столбцов
+  (наибольший индекс + 1) в size_t не представимо
+ */
+template <Major Order, typename T, T Default, typename Storage, typename Stats, typename Probe>
+CompressedMatrix<T, Default, Order> compress(const BasicMatrix<T, 2, Storage, StaticDefault<T, Default>, Stats, Probe>& matrix) {
+    constexpr size_t OUTER = Order == Major::ROW ? 0 : 1;
+    constexpr size_t INNER = 1 - OUTER;
+
+    size_t rows = 0;
+    size_t columns = 0;
+    std::vector<std::tuple<size_t, size_t, T>> entries;
+    entries.reserve(matrix.size());
+    for (const auto& element : matrix) {
+        const auto& [x, y, v] = element;
+        if (x == std::numeric_limits<size_t>::max() || y == std::numeric_limits<size_t>::max()) {
+            throw std::invalid_argument("Index SIZE_MAX cannot be compressed");
+        }
+        rows    = std::max(rows, x + 1);
+        columns = std::max(columns, y + 1);
+        entries.emplace_back(std::get<OUTER>(element), std::get<INNER>(element), v);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(std::get<0>(lhs), std::get<1>(lhs)) < std::tie(std::get<0>(rhs), std::get<1>(rhs));
+    });
+
+    std::vector<size_t> line_ids;
+    std::vector<size_t> offsets{0};
+    std::vector<size_t> indexes(entries.size());
+    std::vector<T> values(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto& [line, index, value] = entries[i];
+        if (line_ids.empty() || line_ids.back() != line) {
+            if (!line_ids.empty()) {
+                offsets.push_back(i);
+            }
+            line_ids.push_back(line);
+        }
+        indexes[i] = index;
+        values[i]  = std::move(value);
+    }
+    if (!line_ids.empty()) {
+        offsets.push_back(entries.size());
+    }
+
+    return {rows, columns, std::move(line_ids), std::move(offsets), std::move(indexes), std::move(values)};
+}
+
+
+/*!
+ Замораживает матрицу в формате CSR
+ @param matrix Исходная матрица
+ @return Матрица в формате CSR
+ */
+template <typename T, T Default, typename Storage, typename Stats, typename Probe>
+CSRMatrix<T, Default> toCSR(const BasicMatrix<T, 2, Storage, StaticDefault<T, Default>, Stats, Probe>& matrix) {
+    return compress<Major::ROW>(matrix);
+}
+
+
+/*!
+ Замораживает матрицу в формате CSC
+ @param matrix Исходная матрица
+ @return Матрица в формате CSC
+ */
+template <typename T, T Default, typename Storage, typename Stats, typename Probe>
+CSCMatrix<T, Default> toCSC(const BasicMatrix<T, 2, Storage, StaticDefault<T, Default>, Stats, Probe>& matrix) {
+    return compress<Major::COLUMN>(matrix);
+}
@@ -7,18 +7,26 @@
 #pragma once
 
 #include "data_helpers.h"
+#include "key_codec.h"
 
 #include <list>
 #include <map>
+#include <memory>
+#include <functional>
 #include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 /*!
 @brief Класс, который отвечает за хранение данных
 @details
 @tparam T тип хранимых данных
 @tparam N n-мерность матрицы
+@tparam Allocator аллокатор элементов, перепривязывается к узлам std::list и std::map (например, PoolAllocator)
+@tparam KeyCodec способ кодирования индексов в ключ std::map: TupleKeyCodec<N> или PackedKeyCodec<N, Bits>
 */
-template <typename T, size_t N>
+template <typename T, size_t N, typename Allocator = std::allocator<ElementType<T, N>>, typename KeyCodec = TupleKeyCodec<N>>
 class Data {
 public:
     /// Набор возможных результатов  поиска
@@ -28,22 +36,39 @@ public:
     };
     
     /// @brief тип ключа
-    using Key      = KeyType<N>;
+    using Key      = typename KeyCodec::Key;
     
     /// @brief тип хранимого элемента, представляет из себя std::tuple из N индексов типа size_t и последющим значением типа T
     using Element  = ElementType<T, N>;
     
-    /// @brief сокращение для итератора в std::list<Element>
-    using It       = typename std::list<Element>::const_iterator;
+    /// @brief последовательность элементов
+    using List     = std::list<Element, typename std::allocator_traits<Allocator>::template rebind_alloc<Element>>;
     
-    /// @brief сокращение для итератора в std::map<Key, It>
-    using MapIt    = typename std::map<Key, It>::const_iterator;
+    /// @brief индекс от ключа к элементу последовательности
+    using Map      = std::map<Key, typename List::iterator, std::less<Key>,
+                              typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const Key, typename List::iterator>>>;
+    
+    /// @brief сокращение для итератора в List
+    using It       = typename List::const_iterator;
+    
+    /// @brief сокращение для итератора в Map
+    using MapIt    = typename Map::const_iterator;
+    
+    /// @brief признак того, что хранилище упорядочено по ключу
+    static constexpr bool IS_ORDERED = true;
+    
+    Data() = default;
+    Data(const Data& other);
+    Data(Data&& other) = default;
+    Data& operator=(const Data& other);
+    Data& operator=(Data&& other) = default;
     
     void erase(const Key& key);                                ///< Удаляет элемент по ключу
     void erase(MapIt it);                                      ///< Удаление по переданному итератору
     
     void insert(const Key& key, const T& elem);                ///< Добавляет элемент по ключу
-    void insert(MapIt it, const Key& key, const T& elem);      ///< Добавляет элемент по итератору
+    template <typename V>
+    void insert(MapIt it, const Key& key, V&& elem);           ///< Добавляет элемент по итератору, V -- const T& или T
     
     std::pair<bool, MapIt> contains(const Key& key) const;     ///< Проверяет, есть ли элемент по переданному ключу
     bool contains(MapIt it) const;                             ///< Проверяет, есть ли элемент по переданному итератору
@@ -51,27 +76,99 @@ public:
     std::pair<FindStatus, T> getElement(const Key& key) const; ///< Находит элемент по ключу
     std::pair<FindStatus, T> getElement(MapIt it) const;       ///< Находит элемент по итератору
     
+    std::pair<bool, MapIt> locate(const Key& key) const;       ///< Ищет элемент или место для его вставки
+    template <typename V>
+    T& emplace(MapIt hint, const Key& key, V&& elem);          ///< Добавляет отсутствующий элемент в место, найденное locate
+    T& value(MapIt it);                                        ///< Возвращает значение существующего элемента
+    const T& value(MapIt it) const;                            ///< Возвращает значение существующего элемента
+    It find(const Key& key) const;                             ///< Находит элемент по ключу, end() если его нет
+    
+    MapIt lowerBound(const Indexes<N>& indexes) const;         ///< Возвращает первый элемент с индексами не меньше indexes
+    MapIt mapEnd() const;                                      ///< Возвращает конец упорядоченного индекса
+    const Element& element(MapIt it) const;                    ///< Возвращает элемент по итератору индекса
+    
     size_t size() const;                                       ///< Возвращает количесвто хранимых элементов
+    void reserve(size_t count);                                ///< Резервирует место под count элементов
+    typename List::allocator_type allocator() const;           ///< Возвращает аллокатор, общий для m_data и m_map
+    
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);                  ///< Заменяет содержимое упорядоченными уникальными элементами
     
-    It begin();                                                ///< Возвращает итератор на начало
-    It end();                                                  ///< Возвращает итератор на конец
+    It begin() const;                                          ///< Возвращает итератор на начало
+    It end() const;                                            ///< Возвращает итератор на конец
+    std::vector<std::pair<It, It>> split(size_t parts) const;  ///< Делит элементы на не более parts последовательных частей
     
     Key makeKey(const Indexes<N>& indexes) const;              ///< Создает ключ
+    std::pair<bool, Key> tryMakeKey(const Indexes<N>& indexes) const; ///< Создает ключ, если индексы представимы KeyCodec
     Element makeElement(const Key& key, const T& elem) const;  ///< Создает элемент
     
 private:
-    std::list<Element> m_data; ///< Хранит последовательность из данных типа Element
-    std::map<Key, It> m_map;   ///< Ключом явлется Key, а значение это итератор на элемент в m_data
+    List m_data;                                                     ///< Хранит последовательность из данных типа Element
+    Map m_map{typename Map::allocator_type{m_data.get_allocator()}}; ///< Ключом явлется Key, а значение это итератор на элемент в m_data
 };
 
 
+namespace detail {
+
+/// Проверяет, что хранилище умеет создавать ключ без исключения (Storage::tryMakeKey)
+template <typename Storage, typename = void>
+struct HasTryMakeKey : std::false_type {};
+
+template <typename Storage>
+struct HasTryMakeKey<Storage, std::void_t<decltype(&Storage::tryMakeKey)>> : std::true_type {};
+
+/*!
+ Создает ключ для поиска и удаления: хранилища без tryMakeKey представляют любые индексы
+ @param data    Хранилище
+ @param indexes Набор индексов
+ @return false, если такой ячейки не может быть в хранилище, иначе true и ключ
+ */
+template <typename Storage, size_t N>
+std::pair<bool, typename Storage::Key> tryMakeKey(const Storage& data, const Indexes<N>& indexes) {
+    if constexpr (HasTryMakeKey<Storage>::value) {
+        return data.tryMakeKey(indexes);
+    } else {
+        return {true, data.makeKey(indexes)};
+    }
+}
+
+}
+
+
+/*!
+Копирует элементы. m_map хранит итераторы на узлы m_data, поэтому индекс строится заново
+ по узлам копии, а не копируется. Аллокатор m_map перепривязывается от аллокатора копии m_data
+@param other Копируемое хранилище
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+Data<T, N, Allocator, KeyCodec>::Data(const Data& other) : m_data{other.m_data}, m_map{typename Map::allocator_type{m_data.get_allocator()}} {
+    for (auto it = m_data.begin(); it != m_data.end(); ++it) {
+        m_map.emplace(KeyCodec::elementKey(*it), it);
+    }
+}
+
+
+/*!
+Заменяет содержимое копией элементов other
+@param other Копируемое хранилище
+@return Ссылку на себя
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+Data<T, N, Allocator, KeyCodec>& Data<T, N, Allocator, KeyCodec>::operator=(const Data& other) {
+    if (this != &other) {
+        *this = Data{other};
+    }
+    return *this;
+}
+
+
 /*!
 Удаляет элемент по переданному ключу
 @param key Ключ удаляемого элемент
 @throw std::runtime_error В случае удаления по несуществующему ключу
 */
-template <typename T, size_t N>
-void Data<T, N>::erase(const Key& key) {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+void Data<T, N, Allocator, KeyCodec>::erase(const Key& key) {
     MapIt it = m_map.find(key);
     erase(it);
 }
@@ -81,8 +178,8 @@ void Data<T, N>::erase(const Key& key) {
 Удаляет элемент по переданному итератору
 @param it Итератор на m_map
 */
-template <typename T, size_t N>
-void Data<T, N>::erase(MapIt it) {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+void Data<T, N, Allocator, KeyCodec>::erase(MapIt it) {
     if (!contains(it)) {
         throw std::runtime_error("Try to erase element by key which was not created");
     }
@@ -96,25 +193,28 @@ void Data<T, N>::erase(MapIt it) {
 @param key Ключ для элемента
 @param val Хранимое значение
 */
-template <typename T, size_t N>
-void Data<T, N>::insert(const Key& key, const T& val) {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+void Data<T, N, Allocator, KeyCodec>::insert(const Key& key, const T& val) {
     MapIt it = m_map.find(key);
     insert(it, key, val);
 }
 
 
 /*!
-Добавляет элемент по итератору. В случае, когда элемент с таким итератором существует, предыдущее значение удаляется.
+Добавляет элемент по итератору. В случае, когда элемент с таким итератором существует, значение
+ перезаписывается на месте: элемент сохраняет свою позицию в порядке вставки.
 @param it  Итератор на элемент
 @param key Ключ для элемента
-@param val Хранимое значение
+@param val Хранимое значение, rvalue перемещается
 */
-template <typename T, size_t N>
-void Data<T, N>::insert(MapIt it, const Key& key, const T& val) {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+template <typename V>
+void Data<T, N, Allocator, KeyCodec>::insert(MapIt it, const Key& key, V&& val) {
     if (contains(it)) {
-        erase(it);
+        std::get<N>(*it->second) = std::forward<V>(val);
+        return;
     }
-    m_data.push_back(makeElement(key, val));
+    emplaceElemImpl(m_data, KeyCodec::decode(key), std::make_index_sequence<N>{}, std::forward<V>(val));
     m_map.emplace(key, std::prev(m_data.end()));
 }
 
@@ -125,8 +225,8 @@ void Data<T, N>::insert(MapIt it, const Key& key, const T& val) {
 @return std::pair из булевого значения (элемент найден/не найден) и итератора на std::map. В случае, когда элемент
  не найден, итератор будет равен на end.
 */
-template <typename T, size_t N>
-std::pair<bool, typename Data<T, N>::MapIt> Data<T, N>::contains(const Key& key) const {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+std::pair<bool, typename Data<T, N, Allocator, KeyCodec>::MapIt> Data<T, N, Allocator, KeyCodec>::contains(const Key& key) const {
     MapIt it = m_map.find(key);
     return {contains(it), it};
 }
@@ -137,8 +237,8 @@ std::pair<bool, typename Data<T, N>::MapIt> Data<T, N>::contains(const Key& key)
 @param it Итератор на m_map
 @return true если элемент по переданному итератору существует, false -- если нет
 */
-template <typename T, size_t N>
-bool Data<T, N>::contains(MapIt it) const {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+bool Data<T, N, Allocator, KeyCodec>::contains(MapIt it) const {
     return it != m_map.end();
 }
 
@@ -149,8 +249,8 @@ bool Data<T, N>::contains(MapIt it) const {
 @return Если элемента нет, то пару FindStatus::NOT_FOUND и значение типа T по умолчанию. В противном случае
  возвращается пара FindStatus::FOUND и значение типа T
 */
-template <typename T, size_t N>
-std::pair<typename Data<T, N>::FindStatus, T> Data<T, N>::getElement(const Key& key) const {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+std::pair<typename Data<T, N, Allocator, KeyCodec>::FindStatus, T> Data<T, N, Allocator, KeyCodec>::getElement(const Key& key) const {
     MapIt it = m_map.find(key);
     return getElement(it);
 }
@@ -162,8 +262,8 @@ std::pair<typename Data<T, N>::FindStatus, T> Data<T, N>::getElement(const Key&
 @return Если элемента нет, то пару FindStatus::NOT_FOUND и значение типа T по умолчанию. В противном случае
  возвращается пара FindStatus::FOUND и значение типа T
 */
-template <typename T, size_t N>
-std::pair<typename Data<T, N>::FindStatus, T> Data<T, N>::getElement(MapIt it) const {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+std::pair<typename Data<T, N, Allocator, KeyCodec>::FindStatus, T> Data<T, N, Allocator, KeyCodec>::getElement(MapIt it) const {
     if (!contains(it)) {
         return {FindStatus::NOT_FOUND, T{}};
     }
@@ -171,20 +271,122 @@ std::pair<typename Data<T, N>::FindStatus, T> Data<T, N>::getElement(MapIt it) c
 }
 
 
+/*!
+Ищет элемент по ключу за один проход по дереву
+@param key Ключ искомого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и итератора на std::map. Если элемент найден,
+ итератор указывает на него, иначе -- на место, куда его следует вставить (подсказка для emplace).
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+std::pair<bool, typename Data<T, N, Allocator, KeyCodec>::MapIt> Data<T, N, Allocator, KeyCodec>::locate(const Key& key) const {
+    MapIt it = m_map.lower_bound(key);
+    return {it != m_map.end() && !(key < it->first), it};
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище, не выполняя повторного поиска.
+ Элемент создается прямо в узле списка, rvalue перемещается без промежуточных копий.
+@param hint Итератор, полученный из locate для того же ключа
+@param key  Ключ для элемента
+@param val  Хранимое значение
+@return Ссылка на сохраненное значение
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+template <typename V>
+T& Data<T, N, Allocator, KeyCodec>::emplace(MapIt hint, const Key& key, V&& val) {
+    Element& elem = emplaceElemImpl(m_data, KeyCodec::decode(key), std::make_index_sequence<N>{}, std::forward<V>(val));
+    m_map.emplace_hint(hint, key, std::prev(m_data.end()));
+    return std::get<N>(elem);
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Итератор на найденный элемент
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+T& Data<T, N, Allocator, KeyCodec>::value(MapIt it) {
+    return std::get<N>(*it->second);
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Итератор на найденный элемент
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+const T& Data<T, N, Allocator, KeyCodec>::value(MapIt it) const {
+    return std::get<N>(*it->second);
+}
+
+
+/*!
+Находит элемент по ключу
+@param key Ключ искомого элемента
+@return Итератор на элемент или end(), если элемента нет
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::It Data<T, N, Allocator, KeyCodec>::find(const Key& key) const {
+    MapIt it = m_map.find(key);
+    return contains(it) ? It{it->second} : m_data.end();
+}
+
+
+/*!
+Ищет первый элемент, индексы которого лексикографически не меньше переданных
+@param indexes Набор индексов, могут выходить за допустимые для KeyCodec значения
+@return Итератор на m_map
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::MapIt Data<T, N, Allocator, KeyCodec>::lowerBound(const Indexes<N>& indexes) const {
+    const auto [exists, key] = KeyCodec::lowerKey(indexes);
+    return exists ? m_map.lower_bound(key) : m_map.end();
+}
+
+
+/*!
+@return Итератор на конец m_map
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::MapIt Data<T, N, Allocator, KeyCodec>::mapEnd() const {
+    return m_map.end();
+}
+
+
+/*!
+Возвращает элемент, на который ссылается итератор упорядоченного индекса
+@param it Итератор на существующий элемент m_map
+@return Элемент (индекс_1, ..., индекс_N, значение)
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+const typename Data<T, N, Allocator, KeyCodec>::Element& Data<T, N, Allocator, KeyCodec>::element(MapIt it) const {
+    return *it->second;
+}
+
+
 /*!
 Создает ключ по набору индексов
 @param indexes Набор индексов
 @return Ключ
 */
-template <typename T, size_t N>
-typename Data<T, N>::Key Data<T, N>::makeKey(const Indexes<N>& indexes) const {
-    if (indexes.size() != N) {
-        std::string error_message = "Indexes size must be "  + \
-                                    std::to_string(N) + " not " + \
-                                    std::to_string(indexes.size());
-        throw std::runtime_error(error_message);
-    }
-    return makeKeyImpl(indexes, std::make_index_sequence<N>{});
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::Key Data<T, N, Allocator, KeyCodec>::makeKey(const Indexes<N>& indexes) const {
+    return KeyCodec::encode(indexes);
+}
+
+
+/*!
+Создает ключ, не бросая исключений: ячейка, индексы которой не представимы KeyCodec,
+ не может храниться, поэтому поиск и удаление по ней ничего не находят
+@param indexes Набор индексов
+@return false, если индексы не помещаются в ключ, иначе true и ключ
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+std::pair<bool, typename Data<T, N, Allocator, KeyCodec>::Key> Data<T, N, Allocator, KeyCodec>::tryMakeKey(const Indexes<N>& indexes) const {
+    return KeyCodec::tryEncode(indexes);
 }
 
 
@@ -193,9 +395,9 @@ typename Data<T, N>::Key Data<T, N>::makeKey(const Indexes<N>& indexes) const {
 @param key Ключ
 @return Хранимое значение типа Eleement
 */
-template <typename T, size_t N>
-typename Data<T, N>::Element Data<T, N>::makeElement(const Key& key, const T& elem) const {
-    return makeElemImpl(key, std::make_index_sequence<N>{}, elem);
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::Element Data<T, N, Allocator, KeyCodec>::makeElement(const Key& key, const T& elem) const {
+    return makeElemImpl(KeyCodec::decode(key), std::make_index_sequence<N>{}, elem);
 }
 
 
@@ -203,18 +405,57 @@ typename Data<T, N>::Element Data<T, N>::makeElement(const Key& key, const T& el
 Возвращает количество хранимых элементов
 @return количество хранимых элементов
 */
-template <typename T, size_t N>
-size_t Data<T, N>::size() const {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+size_t Data<T, N, Allocator, KeyCodec>::size() const {
     return m_data.size();
 }
 
 
+/*!
+Резервирует место под count элементов. Узловые контейнеры не умеют резервировать память,
+ поэтому метод ничего не делает и нужен для совместимости с HashData<T, N>
+@param count Ожидаемое количество элементов
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+void Data<T, N, Allocator, KeyCodec>::reserve(size_t /*count*/) {}
+
+
+/*!
+Заменяет содержимое переданными элементами. Элементы должны быть упорядочены по ключу и не повторяться,
+ тогда каждая вставка в m_map выполняется за амортизированное O(1) благодаря подсказке.
+@param first Начало диапазона элементов типа Element
+@param last  Конец диапазона элементов типа Element
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+template <typename InputIt>
+void Data<T, N, Allocator, KeyCodec>::assign(InputIt first, InputIt last) {
+    m_map.clear();
+    m_data.clear();
+    for (; first != last; ++first) {
+        const Key key = KeyCodec::elementKey(*first);
+        m_data.push_back(*first);
+        m_map.emplace_hint(m_map.end(), key, std::prev(m_data.end()));
+    }
+}
+
+
+/*!
+Возвращает аллокатор хранилища. m_map использует его перепривязанную копию, поэтому аллокатор
+ с общим состоянием (PoolAllocator, CountingAllocator) обслуживает оба контейнера
+@return Аллокатор m_data
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::List::allocator_type Data<T, N, Allocator, KeyCodec>::allocator() const {
+    return m_data.get_allocator();
+}
+
+
 /*!
 Возвращает итератор на начало диапазона
 @return итератор на начало диапазона
 */
-template <typename T, size_t N>
-typename Data<T, N>::It Data<T, N>::begin() {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::It Data<T, N, Allocator, KeyCodec>::begin() const {
     return m_data.begin();
 }
 
@@ -223,7 +464,20 @@ typename Data<T, N>::It Data<T, N>::begin() {
 Возвращает итератор на конец диапазона
 @return итератор на конец диапазона
 */
-template <typename T, size_t N>
-typename Data<T, N>::It Data<T, N>::end() {
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+typename Data<T, N, Allocator, KeyCodec>::It Data<T, N, Allocator, KeyCodec>::end() const {
     return m_data.end();
 }
+
+
+/*!
+Делит элементы на части для параллельной обработки. Список не поддерживает произвольный доступ,
+ поэтому границы частей находятся одним последовательным проходом
+@param parts Желаемое количество частей
+@return Непустые диапазоны [first, last) в порядке итерирования, вместе покрывающие все элементы
+*/
+template <typename T, size_t N, typename Allocator, typename KeyCodec>
+std::vector<std::pair<typename Data<T, N, Allocator, KeyCodec>::It, typename Data<T, N, Allocator, KeyCodec>::It>>
+Data<T, N, Allocator, KeyCodec>::split(size_t parts) const {
+    return splitEvenly(begin(), end(), size(), parts);
+}
@@ -11,6 +11,9 @@
 #include <tuple>
 #include <utility>
 #include <array>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
 
 
 /*!
@@ -38,12 +41,60 @@ auto makeKeyImpl(const Indexes<N>& v, std::index_sequence<I...>) {
     return std::make_tuple(v[I]...);
 }
 
+/*!
+Вспомогательная функция для получения ключа из элемента
+*/
+template<typename Element, std::size_t... I>
+auto elemKeyImpl(const Element& elem, std::index_sequence<I...>) {
+    return std::make_tuple(std::get<I>(elem)...);
+}
+
+/*!
+Вспомогательная функция для получения ссылок на индексы элемента
+*/
+template<typename Element, std::size_t... I>
+auto elemKeyTieImpl(const Element& elem, std::index_sequence<I...>) {
+    return std::tie(std::get<I>(elem)...);
+}
+
 /*!
 Вспомогательная функция для получения элемента
 */
 template<typename T, typename Key, std::size_t... I>
-auto makeElemImpl(const Key& key, std::index_sequence<I...>, const T& elem) {
-    return std::make_tuple(std::get<I>(key)..., elem);
+auto makeElemImpl(const Key& key, std::index_sequence<I...>, T&& elem) {
+    return std::make_tuple(std::get<I>(key)..., std::forward<T>(elem));
+}
+
+/*!
+Вспомогательная функция для создания элемента в конце контейнера без промежуточного кортежа:
+ значение копируется или перемещается в узел контейнера один раз
+*/
+template<typename Container, typename Key, typename V, std::size_t... I>
+auto& emplaceElemImpl(Container& container, const Key& key, std::index_sequence<I...>, V&& elem) {
+    return container.emplace_back(std::get<I>(key)..., std::forward<V>(elem));
+}
+
+
+/*!
+Вспомогательная функция для разбиения диапазона из count элементов на не более parts непустых
+ последовательных частей почти равной длины. Для итераторов без произвольного доступа границы
+ находятся одним проходом по диапазону
+*/
+template <typename It>
+std::vector<std::pair<It, It>> splitEvenly(It first, It last, size_t count, size_t parts) {
+    std::vector<std::pair<It, It>> result;
+    if (count == 0) {
+        return result;
+    }
+    parts = std::clamp<size_t>(parts, 1, count);
+    result.reserve(parts);
+    for (size_t part = 0; part + 1 < parts; ++part) {
+        const It next = std::next(first, static_cast<std::ptrdiff_t>(count / parts + (part < count % parts)));
+        result.emplace_back(first, next);
+        first = next;
+    }
+    result.emplace_back(first, last);
+    return result;
 }
 
 
@@ -63,3 +114,65 @@ using KeyType = decltype(key_type (std::make_index_sequence<N>{}));
 template <typename T, size_t N>
 using ElementType = decltype(elem_type(std::make_index_sequence<N>{}, T{}));
 
+
+
+/*!
+Вспомогательная функция для перемешивания битов хэша (финализатор splitmix64)
+*/
+inline std::uint64_t mixHash(std::uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+/*!
+Вспомогательная функция для вычисления хэша ключа
+*/
+template<typename Key, std::size_t... I>
+std::uint64_t hashKeyImpl(const Key& key, std::index_sequence<I...>) {
+    std::uint64_t h = 0;
+    ((h = (h ^ static_cast<std::uint64_t>(std::get<I>(key))) * 0x9e3779b97f4a7c15ULL), ...);
+    return mixHash(h);
+}
+
+
+/*!
+ @brief Функтор, вычисляющий хэш ключа типа KeyType<N>
+ @tparam N Размерность матрицы
+ */
+template <size_t N>
+struct KeyHash {
+    std::uint64_t operator()(const KeyType<N>& key) const {
+        return hashKeyImpl(key, std::make_index_sequence<N>{});
+    }
+};
+
+
+/*!
+ @brief Функтор, сравнивающий элементы типа ElementType<T, N> лексикографически по индексам
+ @tparam N Размерность матрицы
+ */
+template <size_t N>
+struct ElementKeyLess {
+    template <typename Element>
+    bool operator()(const Element& lhs, const Element& rhs) const {
+        return elemKeyTieImpl(lhs, std::make_index_sequence<N>{}) < elemKeyTieImpl(rhs, std::make_index_sequence<N>{});
+    }
+};
+
+
+/*!
+Вспомогательная функция для циклического сдвига индексов: результат начинается с измерения order,
+ (x_order, ..., x_{N-1}, x_0, ..., x_{order-1}). Ключ в таком порядке упорядочивает элементы сначала по измерению order
+*/
+template <size_t N>
+Indexes<N> rotateIndexes(const Indexes<N>& indexes, size_t order) {
+    Indexes<N> result;
+    for (size_t d = 0; d < N; ++d) {
+        result[d] = indexes[(d + order) % N];
+    }
+    return result;
+}
@@ -0,0 +1,81 @@
+/*!
+@file
+@brief Заголовочный файл со стратегиями значения по умолчанию для BasicMatrix
+*/
+
+#pragma once
+
+/*!
+ @brief Значение по умолчанию, известное на этапе компиляции
+ @details Пустой класс: сравнение со значением по умолчанию -- сравнение с константой,
+  поэтому Matrix<T, Default, N> не платит за стратегию ни памятью, ни временем
+ @tparam T тип хранимого элемента, допустимый как параметр шаблона (целые, перечисления, указатели)
+ @tparam Default значение по умолчанию
+ */
+template <typename T, T Default>
+struct StaticDefault {
+    static constexpr const T& value() { return VALUE; }                    ///< Возвращает значение по умолчанию
+    static constexpr bool isDefault(const T& elem) { return elem == Default; } ///< Проверяет, что элемент не нужно хранить
+
+    static constexpr T VALUE = Default;                                    ///< Значение по умолчанию, на которое ссылается value()
+};
+
+
+/*!
+ @brief Значение по умолчанию, задаваемое при создании матрицы
+ @details Подходит для double, float и пользовательских числовых типов. Элемент считается
+  значением по умолчанию, если |elem - value| <= epsilon, поэтому при ненулевом epsilon почти нулевые
+  результаты вычислений не хранятся. Требует от T операций <, - и <=.
+ @tparam T тип хранимого элемента
+ */
+template <typename T>
+class RuntimeDefault {
+public:
+    explicit RuntimeDefault(const T& value = T{}, const T& epsilon = T{});
+
+    const T& value() const;               ///< Возвращает значение по умолчанию
+    const T& epsilon() const;             ///< Возвращает допуск сравнения
+    bool isDefault(const T& elem) const;  ///< Проверяет, что элемент не нужно хранить
+
+private:
+    T m_value;   ///< Значение по умолчанию
+    T m_epsilon; ///< Допуск сравнения
+};
+
+
+/*!
+ Создает стратегию
+ @param value   Значение по умолчанию
+ @param epsilon Допуск, T{} -- точное сравнение
+ */
+template <typename T>
+RuntimeDefault<T>::RuntimeDefault(const T& value, const T& epsilon) : m_value{value}, m_epsilon{epsilon} {}
+
+
+/*!
+@return Значение по умолчанию
+*/
+template <typename T>
+const T& RuntimeDefault<T>::value() const {
+    return m_value;
+}
+
+
+/*!
+@return Допуск сравнения
+*/
+template <typename T>
+const T& RuntimeDefault<T>::epsilon() const {
+    return m_epsilon;
+}
+
+
+/*!
+ @param elem Элемент
+ @return true, если элемент отличается от значения по умолчанию не больше чем на epsilon
+ */
+template <typename T>
+bool RuntimeDefault<T>::isDefault(const T& elem) const {
+    const T diff = elem < m_value ? m_value - elem : elem - m_value;
+    return diff <= m_epsilon;
+}
@@ -0,0 +1,534 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией плотного хранилища для матриц
+ с размерами, известными при компиляции: массив значений и битовая маска занятых ячеек
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+#include "indexes.h"
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+
+/*!
+@brief Размеры матрицы, известные при компиляции: Matrix<T, Default, N, Extents<256, 256>>
+ хранит элементы в DenseData вместо Data
+@details Ячейки нумеруются построчно (последний индекс меняется быстрее всех), поэтому порядок
+ номеров совпадает с лексикографическим порядком индексов. Функции Extents constexpr, но сама
+ матрица с Extents в constexpr-вычислениях неприменима: DenseData хранит значения в куче
+@tparam E размеры по каждому измерению
+*/
+template <size_t... E>
+struct Extents {
+    static constexpr size_t RANK = sizeof...(E);                    ///< Количество измерений
+    static constexpr std::array<size_t, RANK> EXTENTS{E...};        ///< Размеры по измерениям
+    static constexpr size_t CELLS = (E * ... * size_t{1});          ///< Количество ячеек
+
+    /// Проверяет, что индексы лежат внутри размеров
+    static constexpr bool contains(const Indexes<RANK>& indexes) {
+        for (size_t d = 0; d < RANK; ++d) {
+            if (indexes[d] >= EXTENTS[d]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Возвращает номер ячейки с индексами, лежащими внутри размеров
+    static constexpr size_t offset(const Indexes<RANK>& indexes) {
+        size_t result = 0;
+        for (size_t d = 0; d < RANK; ++d) {
+            result = result * EXTENTS[d] + indexes[d];
+        }
+        return result;
+    }
+
+    /// Возвращает номер первой ячейки, индексы которой лексикографически не меньше переданных, CELLS если такой нет
+    static constexpr size_t lowerOffset(const Indexes<RANK>& indexes) {
+        size_t result = 0;
+        for (size_t d = 0; d < RANK; ++d) {
+            if (indexes[d] >= EXTENTS[d]) {
+                // следующий за indexes[0..d) префикс, дополненный нулями
+                ++result;
+                for (size_t e = d; e < RANK; ++e) {
+                    result *= EXTENTS[e];
+                }
+                return result;
+            }
+            result = result * EXTENTS[d] + indexes[d];
+        }
+        return result;
+    }
+
+    /// Возвращает индексы ячейки по ее номеру
+    static constexpr Indexes<RANK> indexesOf(size_t offset) {
+        Indexes<RANK> result{};
+        for (size_t d = RANK; d-- > 0;) {
+            result[d] = offset % EXTENTS[d];
+            offset /= EXTENTS[d];
+        }
+        return result;
+    }
+};
+
+
+/*!
+@brief Класс, который отвечает за плотное хранение данных матрицы ограниченного размера
+@details Значения лежат в одном массиве из Shape::CELLS элементов, занятость ячейки -- бит
+ в массиве 64-битных слов. Поиск -- вычисление номера ячейки без ветвлений по содержимому,
+ вставка и удаление -- запись значения и бита, size() и перебор по-прежнему видят только
+ занятые ячейки, перебор идет по возрастанию индексов. Свободные ячейки содержат T{}.
+ Память выделяется при первой вставке, поэтому пустое хранилище ничего не занимает.
+ Индексы за пределами Shape читаются как отсутствующие элементы, а запись туда -- ошибка.
+ Хранилище упорядочено, как Data<T, N>: lowerBound вычисляет номер ячейки по Extents::lowerOffset,
+ поэтому range(), slice() и ordered() не копируют и не сортируют элементы, а упорядоченный индекс --
+ это тот же итератор по маске. Класс можно передать в Matrix<T, Default, N, Storage>.
+@tparam T тип хранимых данных
+@tparam N n-мерность матрицы
+@tparam Shape размеры матрицы Extents
+*/
+template <typename T, size_t N, typename Shape>
+class DenseData {
+public:
+    /// @brief тип ключа
+    using Key      = KeyType<N>;
+
+    /// @brief тип хранимого элемента, представляет из себя std::tuple из N индексов типа size_t и последющим значением типа T
+    using Element  = ElementType<T, N>;
+
+    /// @brief номер ячейки, NONE для индексов за пределами Shape
+    using MapIt    = size_t;
+
+    class It;
+
+    /// @brief признак того, что хранилище упорядочено по ключу
+    static constexpr bool IS_ORDERED = true;
+
+    /// @brief номер ячейки за пределами Shape
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    /// @brief количество ячеек
+    static constexpr size_t CELLS = Shape::CELLS;
+
+    /// @brief количество слов маски занятых ячеек
+    static constexpr size_t WORDS = (CELLS + 63) / 64;
+
+    static_assert(Shape::RANK == N, "DenseData extents must have N dimensions");
+    static_assert(CELLS > 0, "DenseData extents must be positive");
+
+    std::pair<bool, MapIt> locate(const Key& key) const;       ///< Ищет элемент или место для его вставки
+    template <typename V>
+    T& emplace(MapIt hint, const Key& key, V&& elem);          ///< Добавляет отсутствующий элемент в место, найденное locate
+    template <typename V>
+    T& emplace(const It& hint, const Key& key, V&& elem);      ///< Добавляет отсутствующий элемент, hint -- позиция обхода, например mapEnd()
+    template <typename V>
+    void insert(MapIt it, const Key& key, V&& elem);           ///< Добавляет или перезаписывает элемент по итератору, V -- const T& или T
+    void erase(MapIt it);                                      ///< Удаление по переданному итератору
+    T& value(MapIt it);                                        ///< Возвращает значение существующего элемента
+    const T& value(MapIt it) const;                            ///< Возвращает значение существующего элемента
+    It find(const Key& key) const;                             ///< Находит элемент по ключу, end() если его нет
+
+    It lowerBound(const Indexes<N>& indexes) const;            ///< Возвращает первый элемент с индексами не меньше indexes
+    It mapEnd() const;                                         ///< Возвращает конец упорядоченного обхода
+    const Element& element(const It& it) const;                ///< Возвращает элемент по позиции обхода
+
+    size_t size() const;                                       ///< Возвращает количесвто хранимых элементов
+    void reserve(size_t count);                                ///< Выделяет массив значений
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);                  ///< Заменяет содержимое уникальными элементами
+
+    const T* values() const;                                   ///< Возвращает массив из CELLS значений или nullptr
+
+    It begin() const;                                          ///< Возвращает итератор на начало
+    It end() const;                                            ///< Возвращает итератор на конец
+    std::vector<std::pair<It, It>> split(size_t parts) const;  ///< Делит элементы на не более parts последовательных частей
+
+    Key makeKey(const Indexes<N>& indexes) const;              ///< Создает ключ
+    Element makeElement(const Key& key, const T& elem) const;  ///< Создает элемент
+
+private:
+    bool occupied(MapIt it) const;  ///< Проверяет, занята ли ячейка
+    void allocate();                ///< Выделяет массив значений и маску, если их еще нет
+
+    std::vector<T> m_values;              ///< Значения ячеек, пустой до первой вставки
+    std::vector<std::uint64_t> m_mask;    ///< Маска занятых ячеек, пустая до первой вставки
+    size_t m_size = 0;                    ///< Количество хранимых элементов
+};
+
+
+/*!
+ @brief Прямой итератор по элементам DenseData: занятые ячейки по возрастанию номера
+ @details Разыменование возвращает ссылку на элемент, собранный внутри итератора: она действительна,
+  пока жив итератор и хранилище не изменялось
+ */
+template <typename T, size_t N, typename Shape>
+class DenseData<T, N, Shape>::It {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const Element*;
+    using reference         = const Element&;
+
+    It() = default;
+    It(const DenseData* data, size_t word, std::uint64_t rest) : m_data{data}, m_word{word}, m_rest{rest} { skip(); }
+
+    reference operator*() const { return m_elem; }
+    pointer operator->() const { return &m_elem; }
+    It& operator++() { m_rest &= m_rest - 1; skip(); return *this; }
+    It operator++(int) { It tmp = *this; ++*this; return tmp; }
+    bool operator==(const It& other) const { return m_word == other.m_word && m_rest == other.m_rest; }
+    bool operator!=(const It& other) const { return !(*this == other); }
+
+private:
+    /// Пропускает пустые слова маски и собирает элемент первой занятой ячейки
+    void skip() {
+        while (m_rest == 0 && m_word < WORDS) {
+            if (++m_word < WORDS) {
+                m_rest = m_data->m_mask[m_word];
+            }
+        }
+        if (m_rest != 0) {
+            const size_t cell = m_word * 64 + static_cast<size_t>(__builtin_ctzll(m_rest));
+            m_elem = makeElemImpl(makeKeyImpl(Shape::indexesOf(cell), std::make_index_sequence<N>{}),
+                                  std::make_index_sequence<N>{}, m_data->m_values[cell]);
+        }
+    }
+
+    const DenseData* m_data = nullptr;  ///< Хранилище
+    size_t m_word = WORDS;              ///< Текущее слово маски, WORDS для конца
+    std::uint64_t m_rest = 0;           ///< Еще не пройденные занятые ячейки текущего слова
+    Element m_elem{};                   ///< Текущий элемент
+};
+
+
+/*!
+Ищет элемент по ключу: номер ячейки вычисляется по индексам
+@param key Ключ искомого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и номера ячейки, NONE за пределами Shape
+*/
+template <typename T, size_t N, typename Shape>
+std::pair<bool, typename DenseData<T, N, Shape>::MapIt> DenseData<T, N, Shape>::locate(const Key& key) const {
+    const Indexes<N> indexes = std::apply([](const auto&... items) { return Indexes<N>{items...}; }, key);
+    if (!Shape::contains(indexes)) {
+        return {false, NONE};
+    }
+    const size_t cell = Shape::offset(indexes);
+    return {occupied(cell), cell};
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище
+@param hint Позиция, полученная из locate для того же ключа
+@param key  Ключ для элемента
+@param val  Хранимое значение, rvalue перемещается
+@return Ссылка на сохраненное значение
+@throw std::runtime_error В случае индексов за пределами Shape
+*/
+template <typename T, size_t N, typename Shape>
+template <typename V>
+T& DenseData<T, N, Shape>::emplace(MapIt hint, const Key&, V&& val) {
+    if (hint == NONE) {
+        throw std::runtime_error("Try to store element outside of dense matrix extents");
+    }
+    allocate();
+    m_values[hint] = std::forward<V>(val);
+    m_mask[hint / 64] |= std::uint64_t{1} << hint % 64;
+    ++m_size;
+    return m_values[hint];
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище, по позиции упорядоченного обхода. Номер ячейки
+ однозначно определяется ключом, поэтому позиция не нужна: так вставка по возрастанию ключей
+ с подсказкой mapEnd() работает и для DenseData, и для Data
+@param key Ключ для элемента
+@param val Хранимое значение, rvalue перемещается
+@return Ссылка на сохраненное значение
+@throw std::runtime_error В случае индексов за пределами Shape
+*/
+template <typename T, size_t N, typename Shape>
+template <typename V>
+T& DenseData<T, N, Shape>::emplace(const It&, const Key& key, V&& val) {
+    return emplace(locate(key).second, key, std::forward<V>(val));
+}
+
+
+/*!
+Добавляет элемент по итератору. В случае, когда элемент существует, значение перезаписывается на месте.
+@param it  Позиция, полученная из locate
+@param key Ключ для элемента
+@param val Хранимое значение, rvalue перемещается
+*/
+template <typename T, size_t N, typename Shape>
+template <typename V>
+void DenseData<T, N, Shape>::insert(MapIt it, const Key& key, V&& val) {
+    if (occupied(it)) {
+        m_values[it] = std::forward<V>(val);
+    } else {
+        emplace(it, key, std::forward<V>(val));
+    }
+}
+
+
+/*!
+Удаляет элемент по переданному итератору
+@param it Позиция существующего элемента
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N, typename Shape>
+void DenseData<T, N, Shape>::erase(MapIt it) {
+    if (!occupied(it)) {
+        throw std::runtime_error("Try to erase element by key which was not created");
+    }
+    m_values[it] = T{};
+    m_mask[it / 64] &= ~(std::uint64_t{1} << it % 64);
+    --m_size;
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Позиция найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename Shape>
+T& DenseData<T, N, Shape>::value(MapIt it) {
+    return m_values[it];
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Позиция найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename Shape>
+const T& DenseData<T, N, Shape>::value(MapIt it) const {
+    return m_values[it];
+}
+
+
+/*!
+Находит элемент по ключу
+@param key Ключ искомого элемента
+@return Итератор на элемент или end(), если элемента нет
+*/
+template <typename T, size_t N, typename Shape>
+typename DenseData<T, N, Shape>::It DenseData<T, N, Shape>::find(const Key& key) const {
+    const auto [exists, it] = locate(key);
+    if (!exists) {
+        return end();
+    }
+    return It{this, it / 64, m_mask[it / 64] & ~((std::uint64_t{1} << it % 64) - 1)};
+}
+
+
+/*!
+Ищет первый элемент, индексы которого лексикографически не меньше переданных
+@param indexes Набор индексов, могут выходить за пределы Shape
+@return Итератор на элемент или mapEnd()
+*/
+template <typename T, size_t N, typename Shape>
+typename DenseData<T, N, Shape>::It DenseData<T, N, Shape>::lowerBound(const Indexes<N>& indexes) const {
+    const size_t cell = Shape::lowerOffset(indexes);
+    if (m_size == 0 || cell == CELLS) {
+        return end();
+    }
+    return It{this, cell / 64, m_mask[cell / 64] & ~((std::uint64_t{1} << cell % 64) - 1)};
+}
+
+
+/*!
+@return Итератор на конец упорядоченного обхода, совпадает с end()
+*/
+template <typename T, size_t N, typename Shape>
+typename DenseData<T, N, Shape>::It DenseData<T, N, Shape>::mapEnd() const {
+    return end();
+}
+
+
+/*!
+Возвращает элемент, на который указывает позиция упорядоченного обхода
+@param it Итератор на существующий элемент
+@return Элемент (индекс_1, ..., индекс_N, значение), собранный в итераторе: ссылка действительна, пока жив it
+*/
+template <typename T, size_t N, typename Shape>
+const typename DenseData<T, N, Shape>::Element& DenseData<T, N, Shape>::element(const It& it) const {
+    return *it;
+}
+
+
+/*!
+Возвращает количество хранимых элементов
+@return количество хранимых элементов
+*/
+template <typename T, size_t N, typename Shape>
+size_t DenseData<T, N, Shape>::size() const {
+    return m_size;
+}
+
+
+/*!
+Выделяет массив значений заранее: его размер не зависит от count
+@param count Ожидаемое количество элементов
+*/
+template <typename T, size_t N, typename Shape>
+void DenseData<T, N, Shape>::reserve(size_t count) {
+    if (count != 0) {
+        allocate();
+    }
+}
+
+
+/*!
+Заменяет содержимое переданными элементами. Ключи элементов не должны повторяться.
+@param first Начало диапазона элементов типа Element
+@param last  Конец диапазона элементов типа Element
+*/
+template <typename T, size_t N, typename Shape>
+template <typename InputIt>
+void DenseData<T, N, Shape>::assign(InputIt first, InputIt last) {
+    std::fill(m_values.begin(), m_values.end(), T{});
+    std::fill(m_mask.begin(), m_mask.end(), std::uint64_t{0});
+    m_size = 0;
+    for (; first != last; ++first) {
+        const Key key = elemKeyImpl(*first, std::make_index_sequence<N>{});
+        const auto [exists, it] = locate(key);
+        insert(it, key, std::get<N>(*first));
+    }
+}
+
+
+/*!
+Возвращает массив значений всех ячеек в порядке их номеров (см. Extents::offset). Свободные ячейки
+ содержат T{}, поэтому, например, сумму значений можно считать плотным циклом без проверки маски.
+@return Указатель на CELLS значений или nullptr, если в хранилище еще ничего не вставлялось
+*/
+template <typename T, size_t N, typename Shape>
+const T* DenseData<T, N, Shape>::values() const {
+    return m_values.empty() ? nullptr : m_values.data();
+}
+
+
+/*!
+Возвращает итератор на начало диапазона
+@return итератор на начало диапазона
+*/
+template <typename T, size_t N, typename Shape>
+typename DenseData<T, N, Shape>::It DenseData<T, N, Shape>::begin() const {
+    return m_size == 0 ? end() : It{this, 0, m_mask.front()};
+}
+
+
+/*!
+Возвращает итератор на конец диапазона
+@return итератор на конец диапазона
+*/
+template <typename T, size_t N, typename Shape>
+typename DenseData<T, N, Shape>::It DenseData<T, N, Shape>::end() const {
+    return It{this, WORDS, 0};
+}
+
+
+/*!
+Делит элементы на части для параллельной обработки, границы частей -- границы слов маски
+@param parts Желаемое количество частей
+@return Непустые диапазоны [first, last) в порядке итерирования, вместе покрывающие все элементы
+*/
+template <typename T, size_t N, typename Shape>
+std::vector<std::pair<typename DenseData<T, N, Shape>::It, typename DenseData<T, N, Shape>::It>>
+DenseData<T, N, Shape>::split(size_t parts) const {
+    std::vector<std::pair<It, It>> result;
+    if (m_size == 0) {
+        return result;
+    }
+    parts = std::clamp<size_t>(parts, 1, m_size);
+    const size_t step = (m_size + parts - 1) / parts;
+
+    It first = begin();
+    size_t passed = 0;
+    size_t cut = step;
+    for (size_t word = 0; word < WORDS; ++word) {
+        if (passed >= cut && m_mask[word] != 0) {
+            const It next{this, word, m_mask[word]};
+            result.emplace_back(first, next);
+            first = next;
+            cut = (passed / step + 1) * step;
+        }
+        passed += static_cast<size_t>(__builtin_popcountll(m_mask[word]));
+    }
+    result.emplace_back(first, end());
+    return result;
+}
+
+
+/*!
+Создает ключ по набору индексов
+@param indexes Набор индексов
+@return Ключ
+*/
+template <typename T, size_t N, typename Shape>
+typename DenseData<T, N, Shape>::Key DenseData<T, N, Shape>::makeKey(const Indexes<N>& indexes) const {
+    return makeKeyImpl(indexes, std::make_index_sequence<N>{});
+}
+
+
+/*!
+Создает элемент
+@param key Ключ
+@return Хранимое значение типа Eleement
+*/
+template <typename T, size_t N, typename Shape>
+typename DenseData<T, N, Shape>::Element DenseData<T, N, Shape>::makeElement(const Key& key, const T& elem) const {
+    return makeElemImpl(key, std::make_index_sequence<N>{}, elem);
+}
+
+
+/*!
+Проверяет, занята ли ячейка
+@param it Номер ячейки или NONE
+@return true, если в ячейке хранится элемент
+*/
+template <typename T, size_t N, typename Shape>
+bool DenseData<T, N, Shape>::occupied(MapIt it) const {
+    return it != NONE && m_size != 0 && (m_mask[it / 64] >> it % 64 & 1) != 0;
+}
+
+
+/*!
+Выделяет массив значений и маску при первой вставке
+*/
+template <typename T, size_t N, typename Shape>
+void DenseData<T, N, Shape>::allocate() {
+    if (m_values.empty()) {
+        m_values.resize(CELLS);
+        m_mask.resize(WORDS);
+    }
+}
+
+
+namespace detail {
+
+/// Хранилище для параметра Storage матрицы: Extents<E...> заменяется на DenseData, остальное -- как есть
+template <typename T, size_t N, typename Storage>
+struct SelectStorage {
+    using type = Storage;
+};
+
+template <typename T, size_t N, size_t... E>
+struct SelectStorage<T, N, Extents<E...>> {
+    using type = DenseData<T, N, Extents<E...>>;
+};
+
+}
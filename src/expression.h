@@ -0,0 +1,371 @@
+/*!
+@file
+@brief Заголовочный файл с ленивыми поэлементными выражениями над разреженными матрицами:
+ сложение, вычитание, умножение на скаляр, произведение Адамара и apply
+*/
+
+#pragma once
+
+#include "range_view.h"
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+class BasicMatrix;
+
+
+/*!
+ @brief Базовый класс выражений (CRTP)
+ @details Выражение не хранит элементов: оно ссылается на операнды и вычисляется только при
+  создании или присваивании BasicMatrix. Каждое выражение предоставляет:
+  - Value -- тип значения, DIMENSION -- размерность;
+  - defaultValue() -- значение в ячейках, которых нет ни в одном операнде;
+  - Cursor -- курсор по объединению хранимых в операндах индексов в лексикографическом порядке
+    с методами done(), key(), value() и next().
+  Выражение ссылается на операнды, поэтому действительно, пока они существуют.
+ @tparam E тип выражения-наследника
+ */
+template <typename E>
+struct MatrixExpression {
+    const E& self() const { return static_cast<const E&>(*this); } ///< Возвращает выражение-наследника
+
+    template <typename Fn>
+    auto apply(Fn fn) const;                                         ///< Возвращает выражение fn(*this)
+};
+
+
+/*!
+ @brief Лист выражения -- ссылка на матрицу
+ @details Курсор перебирает Matrix::ordered(): для упорядоченного хранилища это обход его индекса,
+  для неупорядоченного -- отсортированная копия элементов
+ @tparam M тип матрицы
+ */
+template <typename M>
+class MatrixOperand : public MatrixExpression<MatrixOperand<M>> {
+public:
+    /// @brief размерность матрицы
+    static constexpr size_t DIMENSION = std::tuple_size_v<typename M::Element> - 1;
+
+    /// @brief тип значения
+    using Value = std::tuple_element_t<DIMENSION, typename M::Element>;
+
+    class Cursor;
+
+    explicit MatrixOperand(const M& matrix) : m_matrix{matrix} {}
+
+    Value defaultValue() const { return m_matrix.defaultValue(); } ///< Возвращает значение по умолчанию матрицы
+
+private:
+    const M& m_matrix; ///< Матрица
+};
+
+
+/*!
+ @brief Поэлементная бинарная операция: результат в ячейке -- op(значение левого, значение правого)
+ @tparam L левое выражение
+ @tparam R правое выражение
+ @tparam Op функтор вида Value(LValue, RValue)
+ */
+template <typename L, typename R, typename Op>
+class BinaryExpression : public MatrixExpression<BinaryExpression<L, R, Op>> {
+    static_assert(L::DIMENSION == R::DIMENSION, "Operands must have the same dimension");
+public:
+    /// @brief размерность выражения
+    static constexpr size_t DIMENSION = L::DIMENSION;
+
+    /// @brief тип значения
+    using Value = std::decay_t<std::invoke_result_t<const Op&, typename L::Value, typename R::Value>>;
+
+    class Cursor;
+
+    BinaryExpression(L left, R right, Op op) : m_left{std::move(left)}, m_right{std::move(right)}, m_op{std::move(op)} {}
+
+    Value defaultValue() const { return m_op(m_left.defaultValue(), m_right.defaultValue()); } ///< Возвращает значение в пустых ячейках
+
+private:
+    L m_left;  ///< Левый операнд
+    R m_right; ///< Правый операнд
+    Op m_op;   ///< Операция
+};
+
+
+/*!
+ @brief Поэлементное преобразование: результат в ячейке -- fn(значение выражения)
+ @tparam E преобразуемое выражение
+ @tparam Fn функтор вида Value(EValue)
+ */
+template <typename E, typename Fn>
+class UnaryExpression : public MatrixExpression<UnaryExpression<E, Fn>> {
+public:
+    /// @brief размерность выражения
+    static constexpr size_t DIMENSION = E::DIMENSION;
+
+    /// @brief тип значения
+    using Value = std::decay_t<std::invoke_result_t<const Fn&, typename E::Value>>;
+
+    class Cursor;
+
+    UnaryExpression(E expr, Fn fn) : m_expr{std::move(expr)}, m_fn{std::move(fn)} {}
+
+    Value defaultValue() const { return m_fn(m_expr.defaultValue()); } ///< Возвращает значение в пустых ячейках
+
+private:
+    E m_expr; ///< Преобразуемое выражение
+    Fn m_fn;  ///< Преобразование
+};
+
+
+/*!
+ @brief Курсор по элементам матрицы в порядке индексов
+ @details Курсоры хранят итераторы на собственные члены, поэтому не копируются и не перемещаются
+ */
+template <typename M>
+class MatrixOperand<M>::Cursor {
+public:
+    explicit Cursor(const MatrixOperand& operand);
+    Cursor(const Cursor&) = delete;
+    Cursor& operator=(const Cursor&) = delete;
+
+    bool done() const { return m_it == m_end; }          ///< Проверяет, что элементы закончились
+    const Indexes<DIMENSION>& key() const { return m_key; } ///< Возвращает индексы текущего элемента
+    Value value() const { return std::get<DIMENSION>(*m_it); } ///< Возвращает значение текущего элемента
+    void next();                                          ///< Переходит к следующему элементу
+
+private:
+    void load(); ///< Заполняет m_key по текущему элементу
+
+    /// @brief упорядоченные элементы матрицы
+    using View = typename M::OrderedView;
+
+    View m_view;                                     ///< Упорядоченные элементы
+    decltype(std::declval<const View&>().begin()) m_it;  ///< Текущий элемент
+    decltype(std::declval<const View&>().end()) m_end;   ///< Конец элементов
+    Indexes<DIMENSION> m_key{};                      ///< Индексы текущего элемента
+};
+
+
+/*!
+ @brief Курсор слияния двух упорядоченных потоков: текущие индексы -- меньшие из индексов операндов
+ */
+template <typename L, typename R, typename Op>
+class BinaryExpression<L, R, Op>::Cursor {
+public:
+    explicit Cursor(const BinaryExpression& expr);
+    Cursor(const Cursor&) = delete;
+    Cursor& operator=(const Cursor&) = delete;
+
+    bool done() const { return m_left.done() && m_right.done(); } ///< Проверяет, что элементы закончились
+    const Indexes<DIMENSION>& key() const;                        ///< Возвращает индексы текущего элемента
+    Value value() const;                                          ///< Возвращает значение в текущей ячейке
+    void next();                                                  ///< Переходит к следующей ячейке
+
+private:
+    bool leftHere() const;  ///< Проверяет, хранит ли левый операнд текущую ячейку
+    bool rightHere() const; ///< Проверяет, хранит ли правый операнд текущую ячейку
+
+    const BinaryExpression& m_expr;  ///< Выражение
+    typename L::Cursor m_left;       ///< Курсор левого операнда
+    typename R::Cursor m_right;      ///< Курсор правого операнда
+};
+
+
+/*!
+ @brief Курсор преобразования: те же ячейки, что у преобразуемого выражения
+ */
+template <typename E, typename Fn>
+class UnaryExpression<E, Fn>::Cursor {
+public:
+    explicit Cursor(const UnaryExpression& expr) : m_expr{expr}, m_cursor{expr.m_expr} {}
+    Cursor(const Cursor&) = delete;
+    Cursor& operator=(const Cursor&) = delete;
+
+    bool done() const { return m_cursor.done(); }                          ///< Проверяет, что элементы закончились
+    const Indexes<DIMENSION>& key() const { return m_cursor.key(); }       ///< Возвращает индексы текущего элемента
+    Value value() const { return m_expr.m_fn(m_cursor.value()); }          ///< Возвращает значение в текущей ячейке
+    void next() { m_cursor.next(); }                                        ///< Переходит к следующей ячейке
+
+private:
+    const UnaryExpression& m_expr;  ///< Выражение
+    typename E::Cursor m_cursor;    ///< Курсор преобразуемого выражения
+};
+
+
+template <typename M>
+MatrixOperand<M>::Cursor::Cursor(const MatrixOperand& operand) : m_view{operand.m_matrix.ordered()}, m_it{m_view.begin()}, m_end{m_view.end()} {
+    load();
+}
+
+
+template <typename M>
+void MatrixOperand<M>::Cursor::next() {
+    ++m_it;
+    load();
+}
+
+
+template <typename M>
+void MatrixOperand<M>::Cursor::load() {
+    if (m_it != m_end) {
+        m_key = detail::elementIndexes<DIMENSION>(*m_it);
+    }
+}
+
+
+template <typename L, typename R, typename Op>
+BinaryExpression<L, R, Op>::Cursor::Cursor(const BinaryExpression& expr) : m_expr{expr}, m_left{expr.m_left}, m_right{expr.m_right} {}
+
+
+/*!
+@return Меньшие из текущих индексов операндов
+*/
+template <typename L, typename R, typename Op>
+const Indexes<BinaryExpression<L, R, Op>::DIMENSION>& BinaryExpression<L, R, Op>::Cursor::key() const {
+    if (m_right.done() || (!m_left.done() && m_left.key() < m_right.key())) {
+        return m_left.key();
+    }
+    return m_right.key();
+}
+
+
+/*!
+@return op от значений операндов, операнд без текущей ячейки дает свое значение по умолчанию
+*/
+template <typename L, typename R, typename Op>
+typename BinaryExpression<L, R, Op>::Value BinaryExpression<L, R, Op>::Cursor::value() const {
+    return m_expr.m_op(leftHere() ? m_left.value() : m_expr.m_left.defaultValue(),
+                       rightHere() ? m_right.value() : m_expr.m_right.defaultValue());
+}
+
+
+template <typename L, typename R, typename Op>
+void BinaryExpression<L, R, Op>::Cursor::next() {
+    const bool left = leftHere();
+    const bool right = rightHere();
+    if (left) {
+        m_left.next();
+    }
+    if (right) {
+        m_right.next();
+    }
+}
+
+
+template <typename L, typename R, typename Op>
+bool BinaryExpression<L, R, Op>::Cursor::leftHere() const {
+    return !m_left.done() && (m_right.done() || !(m_right.key() < m_left.key()));
+}
+
+
+template <typename L, typename R, typename Op>
+bool BinaryExpression<L, R, Op>::Cursor::rightHere() const {
+    return !m_right.done() && (m_left.done() || !(m_left.key() < m_right.key()));
+}
+
+
+namespace detail {
+
+/// Признак операнда выражения: матрица или выражение
+template <typename X>
+struct IsOperand : std::is_base_of<MatrixExpression<X>, X> {};
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+struct IsOperand<BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>> : std::true_type {};
+
+/// Приводит операнд к выражению: матрица оборачивается в MatrixOperand, выражение копируется
+template <typename X>
+auto toExpression(const X& operand) {
+    if constexpr (std::is_base_of_v<MatrixExpression<X>, X>) {
+        return operand;
+    } else {
+        return MatrixOperand<X>{operand};
+    }
+}
+
+/// Умножение на скаляр
+template <typename S>
+struct Scale {
+    S scalar; ///< Множитель
+
+    template <typename V>
+    auto operator()(const V& value) const { return value * scalar; }
+};
+
+template <typename L, typename R>
+using EnableOperands = std::enable_if_t<IsOperand<L>::value && IsOperand<R>::value, int>;
+
+template <typename X, typename S>
+using EnableScalar = std::enable_if_t<IsOperand<X>::value && !IsOperand<S>::value, int>;
+
+}
+
+
+/*!
+ Поэлементная сумма
+ @param left  Матрица или выражение
+ @param right Матрица или выражение той же размерности
+ @return Ленивое выражение left + right
+ */
+template <typename L, typename R, detail::EnableOperands<L, R> = 0>
+auto operator+(const L& left, const R& right) {
+    return BinaryExpression{detail::toExpression(left), detail::toExpression(right), std::plus<>{}};
+}
+
+
+/*!
+ Поэлементная разность
+ @param left  Матрица или выражение
+ @param right Матрица или выражение той же размерности
+ @return Ленивое выражение left - right
+ */
+template <typename L, typename R, detail::EnableOperands<L, R> = 0>
+auto operator-(const L& left, const R& right) {
+    return BinaryExpression{detail::toExpression(left), detail::toExpression(right), std::minus<>{}};
+}
+
+
+/*!
+ Поэлементное произведение (произведение Адамара)
+ @param left  Матрица или выражение
+ @param right Матрица или выражение той же размерности
+ @return Ленивое выражение left ∘ right
+ */
+template <typename L, typename R, detail::EnableOperands<L, R> = 0>
+auto hadamard(const L& left, const R& right) {
+    return BinaryExpression{detail::toExpression(left), detail::toExpression(right), std::multiplies<>{}};
+}
+
+
+/*!
+ Умножение на скаляр
+ @param operand Матрица или выражение
+ @param scalar  Множитель
+ @return Ленивое выражение operand * scalar
+ */
+template <typename X, typename S, detail::EnableScalar<X, S> = 0>
+auto operator*(const X& operand, const S& scalar) {
+    return UnaryExpression{detail::toExpression(operand), detail::Scale<S>{scalar}};
+}
+
+
+/*!
+ @copydoc operator*(const X&, const S&)
+ */
+template <typename S, typename X, detail::EnableScalar<X, S> = 0>
+auto operator*(const S& scalar, const X& operand) {
+    return operand * scalar;
+}
+
+
+/*!
+ Поэлементное преобразование
+ @param fn Функция вида Value(Value), вызывается для хранимых элементов и для значения по умолчанию
+ @return Ленивое выражение fn(*this)
+ */
+template <typename E>
+template <typename Fn>
+auto MatrixExpression<E>::apply(Fn fn) const {
+    return UnaryExpression{self(), std::move(fn)};
+}
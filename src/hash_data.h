@@ -0,0 +1,495 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией класса,
+ осуществляющего хранение данных разреженной матрицы в хэш-таблице с открытой адресацией
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+#include "key_codec.h"
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/*!
+@brief Класс, который отвечает за хранение данных в плоской хэш-таблице
+@details Элементы лежат подряд в std::vector<Element>, а таблица m_slots с линейным
+ пробированием хранит для каждого ключа номер элемента и его хэш. Интерфейс совпадает с Data<T, N>,
+ поэтому класс можно передать в Matrix<T, Default, N, Storage> в качестве хранилища.
+ Перезапись значения не меняет положения элемента, а удаление переносит последний элемент на место удаленного.
+ С PackedKeyCodec (PackedHashData) массив хранит пары (упакованный ключ, значение), а индексы
+ восстанавливаются при разыменовании итератора, см. DecodingIterator.
+@tparam T тип хранимых данных
+@tparam N n-мерность матрицы
+@tparam KeyCodec способ кодирования индексов в ключ: TupleKeyCodec<N> или PackedKeyCodec<N, Bits>
+*/
+template <typename T, size_t N, typename KeyCodec = TupleKeyCodec<N>>
+class HashData {
+public:
+    /// Набор возможных результатов  поиска
+    enum class FindStatus {
+        FOUND,    ///< Указывает, что объект был найден
+        NOT_FOUND ///< Указывает, что объект не был найден
+    };
+
+    /// @brief тип ключа
+    using Key      = typename KeyCodec::Key;
+
+    /// @brief тип хранимого элемента, представляет из себя std::tuple из N индексов типа size_t и последющим значением типа T
+    using Element  = ElementType<T, N>;
+
+    /// @brief запись массива: Element или (упакованный ключ, значение)
+    using Entry    = typename KeyCodec::template Entry<T>;
+
+    /// @brief итератор по элементам массива записей
+    using It       = typename KeyCodec::template Iterator<typename std::vector<Entry>::const_iterator>;
+
+    /// @brief номер ячейки в таблице m_slots: отдельный тип, чтобы перегрузки по ключу и по ячейке
+    ///  не совпадали, когда ключ -- целое (PackedKeyCodec)
+    struct MapIt {
+        size_t slot; ///< Номер ячейки
+    };
+
+    /// @brief признак того, что хранилище упорядочено по ключу
+    static constexpr bool IS_ORDERED = false;
+
+    void erase(const Key& key);                                ///< Удаляет элемент по ключу
+    void erase(MapIt it);                                      ///< Удаление по переданному итератору
+
+    void insert(const Key& key, const T& elem);                ///< Добавляет элемент по ключу
+    template <typename V>
+    void insert(MapIt it, const Key& key, V&& elem);           ///< Добавляет элемент по итератору, V -- const T& или T
+
+    std::pair<bool, MapIt> contains(const Key& key) const;     ///< Проверяет, есть ли элемент по переданному ключу
+    bool contains(MapIt it) const;                             ///< Проверяет, есть ли элемент по переданному итератору
+
+    std::pair<FindStatus, T> getElement(const Key& key) const; ///< Находит элемент по ключу
+    std::pair<FindStatus, T> getElement(MapIt it) const;       ///< Находит элемент по итератору
+
+    std::pair<bool, MapIt> locate(const Key& key) const;       ///< Ищет элемент или место для его вставки
+    template <typename V>
+    T& emplace(MapIt hint, const Key& key, V&& elem);          ///< Добавляет отсутствующий элемент в место, найденное locate
+    T& value(MapIt it);                                        ///< Возвращает значение существующего элемента
+    const T& value(MapIt it) const;                            ///< Возвращает значение существующего элемента
+    It find(const Key& key) const;                             ///< Находит элемент по ключу, end() если его нет
+
+    size_t size() const;                                       ///< Возвращает количесвто хранимых элементов
+    void reserve(size_t count);                                ///< Резервирует место под count элементов
+    
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);                  ///< Заменяет содержимое уникальными элементами
+
+    It begin() const;                                          ///< Возвращает итератор на начало
+    It end() const;                                            ///< Возвращает итератор на конец
+    std::vector<std::pair<It, It>> split(size_t parts) const;  ///< Делит элементы на не более parts последовательных частей
+
+    Key makeKey(const Indexes<N>& indexes) const;              ///< Создает ключ
+    std::pair<bool, Key> tryMakeKey(const Indexes<N>& indexes) const; ///< Создает ключ, если индексы представимы KeyCodec
+    Element makeElement(const Key& key, const T& elem) const;  ///< Создает элемент
+
+private:
+    /// @brief ячейка хэш-таблицы
+    struct Slot {
+        size_t index = EMPTY;     ///< Номер элемента в m_data или EMPTY
+        std::uint64_t hash = 0;   ///< Хэш ключа элемента
+    };
+
+    static constexpr size_t EMPTY = std::numeric_limits<size_t>::max(); ///< Признак пустой ячейки
+    static constexpr size_t MIN_CAPACITY = 16;                         ///< Минимальный размер таблицы
+
+    size_t probe(const Key& key, std::uint64_t hash) const; ///< Ищет ячейку ключа или первую пустую ячейку
+    void rehash(size_t capacity);                           ///< Перестраивает таблицу под новый размер
+    bool needGrow(size_t count) const;                      ///< Проверяет, превысит ли count допустимую загрузку
+
+    std::vector<Entry> m_data;   ///< Хранит последовательность записей типа Entry
+    std::vector<Slot> m_slots;   ///< Хэш-таблица, размер всегда степень двойки
+};
+
+
+/*!
+Удаляет элемент по переданному ключу
+@param key Ключ удаляемого элемент
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N, typename KeyCodec>
+void HashData<T, N, KeyCodec>::erase(const Key& key) {
+    erase(contains(key).second);
+}
+
+
+/*!
+Удаляет элемент по переданному итератору. Освободившаяся ячейка заполняется сдвигом
+ следующих за ней элементов цепочки, поэтому таблица не содержит "надгробий".
+@param it Номер ячейки в m_slots
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N, typename KeyCodec>
+void HashData<T, N, KeyCodec>::erase(MapIt it) {
+    if (!contains(it)) {
+        throw std::runtime_error("Try to erase element by key which was not created");
+    }
+
+    const size_t mask  = m_slots.size() - 1;
+    const size_t index = m_slots[it.slot].index;
+
+    size_t hole = it.slot;
+    for (size_t next = (hole + 1) & mask; m_slots[next].index != EMPTY; next = (next + 1) & mask) {
+        const size_t home = m_slots[next].hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            m_slots[hole] = m_slots[next];
+            hole = next;
+        }
+    }
+    m_slots[hole] = Slot{};
+
+    const size_t last = m_data.size() - 1;
+    if (index != last) {
+        const Key key = KeyCodec::entryKey(m_data[last]);
+        m_slots[probe(key, KeyCodec::hash(key))].index = index;
+        m_data[index] = std::move(m_data[last]);
+    }
+    m_data.pop_back();
+}
+
+
+/*!
+Добавляет элемент по ключу. В случае, когда элемент с таким ключом существует, значение перезаписывается.
+@param key Ключ для элемента
+@param val Хранимое значение
+*/
+template <typename T, size_t N, typename KeyCodec>
+void HashData<T, N, KeyCodec>::insert(const Key& key, const T& val) {
+    insert(contains(key).second, key, val);
+}
+
+
+/*!
+Добавляет элемент по итератору. В случае, когда элемент с таким итератором существует,
+ значение перезаписывается на месте.
+@param it  Номер ячейки, полученный из contains
+@param key Ключ для элемента
+@param val Хранимое значение, rvalue перемещается
+*/
+template <typename T, size_t N, typename KeyCodec>
+template <typename V>
+void HashData<T, N, KeyCodec>::insert(MapIt it, const Key& key, V&& val) {
+    if (contains(it)) {
+        value(it) = std::forward<V>(val);
+        return;
+    }
+    emplace(it, key, std::forward<V>(val));
+}
+
+
+/*!
+Проверяет, существует ли элемент по переданному ключу
+@param key Ключ проверяемого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и номера ячейки. В случае, когда элемент
+ не найден, номер указывает на пустую ячейку, куда его можно вставить.
+*/
+template <typename T, size_t N, typename KeyCodec>
+std::pair<bool, typename HashData<T, N, KeyCodec>::MapIt> HashData<T, N, KeyCodec>::contains(const Key& key) const {
+    const MapIt it{probe(key, KeyCodec::hash(key))};
+    return {contains(it), it};
+}
+
+
+/*!
+Проверяет, существует ли элемент по переданному итератору
+@param it Номер ячейки в m_slots
+@return true если элемент по переданному итератору существует, false -- если нет
+*/
+template <typename T, size_t N, typename KeyCodec>
+bool HashData<T, N, KeyCodec>::contains(MapIt it) const {
+    return it.slot < m_slots.size() && m_slots[it.slot].index != EMPTY;
+}
+
+
+/*!
+Осуществляет поиск элемента по ключу
+@param key Ключ искомого элемента
+@return Если элемента нет, то пару FindStatus::NOT_FOUND и значение типа T по умолчанию. В противном случае
+ возвращается пара FindStatus::FOUND и значение типа T
+*/
+template <typename T, size_t N, typename KeyCodec>
+std::pair<typename HashData<T, N, KeyCodec>::FindStatus, T> HashData<T, N, KeyCodec>::getElement(const Key& key) const {
+    return getElement(contains(key).second);
+}
+
+
+/*!
+Осуществляет поиск элемента по итератору
+@param it Номер ячейки искомого элемента
+@return Если элемента нет, то пару FindStatus::NOT_FOUND и значение типа T по умолчанию. В противном случае
+ возвращается пара FindStatus::FOUND и значение типа T
+*/
+template <typename T, size_t N, typename KeyCodec>
+std::pair<typename HashData<T, N, KeyCodec>::FindStatus, T> HashData<T, N, KeyCodec>::getElement(MapIt it) const {
+    if (!contains(it)) {
+        return {FindStatus::NOT_FOUND, T{}};
+    }
+    return {FindStatus::FOUND, KeyCodec::entryValue(m_data[m_slots[it.slot].index])};
+}
+
+
+/*!
+Ищет элемент по ключу. Для хэш-таблицы совпадает с contains: номер пустой ячейки и есть место вставки
+@param key Ключ искомого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и номера ячейки
+*/
+template <typename T, size_t N, typename KeyCodec>
+std::pair<bool, typename HashData<T, N, KeyCodec>::MapIt> HashData<T, N, KeyCodec>::locate(const Key& key) const {
+    return contains(key);
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище. Если таблицу приходится увеличить, ячейка ищется заново.
+@param hint Номер пустой ячейки, полученный из locate для того же ключа
+@param key  Ключ для элемента
+@param val  Хранимое значение, создается прямо в m_data, rvalue перемещается
+@return Ссылка на сохраненное значение
+*/
+template <typename T, size_t N, typename KeyCodec>
+template <typename V>
+T& HashData<T, N, KeyCodec>::emplace(MapIt hint, const Key& key, V&& val) {
+    const std::uint64_t hash = KeyCodec::hash(key);
+    if (needGrow(m_data.size() + 1)) {
+        rehash(std::max(MIN_CAPACITY, m_slots.size() * 2));
+        hint = MapIt{probe(key, hash)};
+    }
+
+    T& stored = KeyCodec::emplaceEntry(m_data, key, std::forward<V>(val));
+    m_slots[hint.slot] = Slot{m_data.size() - 1, hash};
+    return stored;
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Номер ячейки найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename KeyCodec>
+T& HashData<T, N, KeyCodec>::value(MapIt it) {
+    return KeyCodec::entryValue(m_data[m_slots[it.slot].index]);
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента
+@param it Номер ячейки найденного элемента
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, typename KeyCodec>
+const T& HashData<T, N, KeyCodec>::value(MapIt it) const {
+    return KeyCodec::entryValue(m_data[m_slots[it.slot].index]);
+}
+
+
+/*!
+Находит элемент по ключу
+@param key Ключ искомого элемента
+@return Итератор на элемент или end(), если элемента нет
+*/
+template <typename T, size_t N, typename KeyCodec>
+typename HashData<T, N, KeyCodec>::It HashData<T, N, KeyCodec>::find(const Key& key) const {
+    const MapIt it = contains(key).second;
+    return contains(it) ? It{m_data.cbegin() + static_cast<std::ptrdiff_t>(m_slots[it.slot].index)} : end();
+}
+
+
+/*!
+Создает ключ по набору индексов
+@param indexes Набор индексов
+@return Ключ
+*/
+template <typename T, size_t N, typename KeyCodec>
+typename HashData<T, N, KeyCodec>::Key HashData<T, N, KeyCodec>::makeKey(const Indexes<N>& indexes) const {
+    return KeyCodec::encode(indexes);
+}
+
+
+/*!
+Создает ключ, не бросая исключений: ячейка, индексы которой не представимы KeyCodec,
+ не может храниться, поэтому поиск и удаление по ней ничего не находят
+@param indexes Набор индексов
+@return false, если индексы не помещаются в ключ, иначе true и ключ
+*/
+template <typename T, size_t N, typename KeyCodec>
+std::pair<bool, typename HashData<T, N, KeyCodec>::Key> HashData<T, N, KeyCodec>::tryMakeKey(const Indexes<N>& indexes) const {
+    return KeyCodec::tryEncode(indexes);
+}
+
+
+/*!
+Создает элемент
+@param key Ключ
+@return Хранимое значение типа Eleement
+*/
+template <typename T, size_t N, typename KeyCodec>
+typename HashData<T, N, KeyCodec>::Element HashData<T, N, KeyCodec>::makeElement(const Key& key, const T& elem) const {
+    return makeElemImpl(KeyCodec::decode(key), std::make_index_sequence<N>{}, elem);
+}
+
+
+/*!
+Возвращает количество хранимых элементов
+@return количество хранимых элементов
+*/
+template <typename T, size_t N, typename KeyCodec>
+size_t HashData<T, N, KeyCodec>::size() const {
+    return m_data.size();
+}
+
+
+/*!
+Резервирует место под count элементов, чтобы последующие вставки не перестраивали таблицу
+@param count Ожидаемое количество элементов
+*/
+template <typename T, size_t N, typename KeyCodec>
+void HashData<T, N, KeyCodec>::reserve(size_t count) {
+    m_data.reserve(count);
+
+    size_t capacity = std::max(MIN_CAPACITY, m_slots.size());
+    while (count * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+    if (capacity != m_slots.size()) {
+        rehash(capacity);
+    }
+}
+
+
+/*!
+Заменяет содержимое переданными элементами одной резервацией памяти.
+ Ключи элементов не должны повторяться, поэтому при построении таблицы они не сравниваются.
+@param first Начало диапазона элементов типа Element
+@param last  Конец диапазона элементов типа Element
+*/
+template <typename T, size_t N, typename KeyCodec>
+template <typename InputIt>
+void HashData<T, N, KeyCodec>::assign(InputIt first, InputIt last) {
+    if constexpr (std::is_same_v<Entry, Element>) {
+        m_data.assign(first, last);
+    } else {
+        m_data.clear();
+        for (; first != last; ++first) {
+            m_data.push_back(KeyCodec::toEntry(*first));
+        }
+    }
+    m_slots.clear();
+    reserve(m_data.size());
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t index = 0; index < m_data.size(); ++index) {
+        const std::uint64_t hash = KeyCodec::hash(KeyCodec::entryKey(m_data[index]));
+        size_t it = hash & mask;
+        while (m_slots[it].index != EMPTY) {
+            it = (it + 1) & mask;
+        }
+        m_slots[it] = Slot{index, hash};
+    }
+}
+
+
+/*!
+Возвращает итератор на начало диапазона
+@return итератор на начало диапазона
+*/
+template <typename T, size_t N, typename KeyCodec>
+typename HashData<T, N, KeyCodec>::It HashData<T, N, KeyCodec>::begin() const {
+    return It{m_data.cbegin()};
+}
+
+
+/*!
+Возвращает итератор на конец диапазона
+@return итератор на конец диапазона
+*/
+template <typename T, size_t N, typename KeyCodec>
+typename HashData<T, N, KeyCodec>::It HashData<T, N, KeyCodec>::end() const {
+    return It{m_data.cend()};
+}
+
+
+/*!
+Делит элементы на части для параллельной обработки: части -- соседние участки массива элементов
+@param parts Желаемое количество частей
+@return Непустые диапазоны [first, last) в порядке итерирования, вместе покрывающие все элементы
+*/
+template <typename T, size_t N, typename KeyCodec>
+std::vector<std::pair<typename HashData<T, N, KeyCodec>::It, typename HashData<T, N, KeyCodec>::It>> HashData<T, N, KeyCodec>::split(size_t parts) const {
+    return splitEvenly(begin(), end(), size(), parts);
+}
+
+
+/*!
+Ищет ячейку с переданным ключом, а если ключа нет -- первую пустую ячейку его цепочки
+@param key  Искомый ключ
+@param hash Хэш искомого ключа
+@return Номер ячейки. Для пустой таблицы возвращается 0, который не является валидной ячейкой
+*/
+template <typename T, size_t N, typename KeyCodec>
+size_t HashData<T, N, KeyCodec>::probe(const Key& key, std::uint64_t hash) const {
+    if (m_slots.empty()) {
+        return 0;
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t it = hash & mask; ; it = (it + 1) & mask) {
+        const Slot& slot = m_slots[it];
+        if (slot.index == EMPTY) {
+            return it;
+        }
+        if (slot.hash == hash && KeyCodec::entryKey(m_data[slot.index]) == key) {
+            return it;
+        }
+    }
+}
+
+
+/*!
+Перестраивает таблицу под новый размер
+@param capacity Новый размер таблицы, степень двойки
+*/
+template <typename T, size_t N, typename KeyCodec>
+void HashData<T, N, KeyCodec>::rehash(size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    const size_t mask = capacity - 1;
+
+    for (const Slot& slot : m_slots) {
+        if (slot.index == EMPTY) {
+            continue;
+        }
+        size_t it = slot.hash & mask;
+        while (slots[it].index != EMPTY) {
+            it = (it + 1) & mask;
+        }
+        slots[it] = slot;
+    }
+
+    m_slots.swap(slots);
+}
+
+
+/*!
+Проверяет, превысит ли заданное количество элементов допустимую загрузку таблицы (3/4)
+@param count Количество элементов
+@return true если таблицу нужно увеличить
+*/
+template <typename T, size_t N, typename KeyCodec>
+bool HashData<T, N, KeyCodec>::needGrow(size_t count) const {
+    return count * 4 > m_slots.size() * 3;
+}
+
+
+/// @brief хэш-таблица, записи которой хранят ключ, упакованный в одно целое по Bits бит на индекс, см. PackedKeyCodec
+template <typename T, size_t N, size_t Bits = 64 / N>
+using PackedHashData = HashData<T, N, PackedKeyCodec<N, Bits>>;
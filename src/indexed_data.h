@@ -0,0 +1,478 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией хранилища разреженной матрицы
+ с упорядоченными индексами по каждому измерению
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+
+#include <array>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*!
+@brief Класс, который отвечает за хранение данных с упорядоченным индексом по каждому измерению
+@details Элементы лежат в std::list, как в Data<T, N>, но индексов ORDERS = N: m_maps[d] упорядочивает
+ элементы по ключу (x_d, ..., x_{N-1}, x_0, ..., x_{d-1}), см. rotateIndexes. m_maps[0] -- обычный
+ лексикографический индекс, через него работают locate, emplace и ordered(). RangeView выбирает индекс,
+ в котором ограниченное измерение ведущее, поэтому столбец двумерной матрицы, range({0, j}, {SIZE_MAX, j}),
+ стоит O(log nnz + размер столбца), а не O(строк * log nnz). Цена -- N деревьев вместо одного:
+ вставка и удаление стоят O(N log nnz), память под индекс растет в N раз.
+ Интерфейс совпадает с Data<T, N>, поэтому класс можно передать в Matrix<T, Default, N, Storage>.
+@tparam T тип хранимых данных
+@tparam N n-мерность матрицы
+*/
+template <typename T, size_t N>
+class IndexedData {
+public:
+    /// Набор возможных результатов  поиска
+    enum class FindStatus {
+        FOUND,    ///< Указывает, что объект был найден
+        NOT_FOUND ///< Указывает, что объект не был найден
+    };
+
+    /// @brief тип ключа
+    using Key      = KeyType<N>;
+
+    /// @brief тип хранимого элемента, представляет из себя std::tuple из N индексов типа size_t и последющим значением типа T
+    using Element  = ElementType<T, N>;
+
+    /// @brief последовательность элементов
+    using List     = std::list<Element>;
+
+    /// @brief индекс от ключа, циклически сдвинутого на номер индекса, к элементу последовательности
+    using Map      = std::map<Key, typename List::iterator>;
+
+    /// @brief сокращение для итератора в List
+    using It       = typename List::const_iterator;
+
+    /// @brief сокращение для итератора в Map, общий для всех индексов
+    using MapIt    = typename Map::const_iterator;
+
+    /// @brief признак того, что хранилище упорядочено по ключу
+    static constexpr bool IS_ORDERED = true;
+
+    /// @brief количество упорядоченных индексов: индекс d начинается с измерения d
+    static constexpr size_t ORDERS = N;
+
+    IndexedData() = default;
+    IndexedData(const IndexedData& other);
+    IndexedData(IndexedData&& other) = default;
+    IndexedData& operator=(const IndexedData& other);
+    IndexedData& operator=(IndexedData&& other) = default;
+
+    void erase(const Key& key);                                ///< Удаляет элемент по ключу
+    void erase(MapIt it);                                      ///< Удаление по переданному итератору
+
+    void insert(const Key& key, const T& elem);                ///< Добавляет элемент по ключу
+    template <typename V>
+    void insert(MapIt it, const Key& key, V&& elem);           ///< Добавляет элемент по итератору, V -- const T& или T
+
+    std::pair<bool, MapIt> contains(const Key& key) const;     ///< Проверяет, есть ли элемент по переданному ключу
+    bool contains(MapIt it) const;                             ///< Проверяет, есть ли элемент по переданному итератору
+
+    std::pair<FindStatus, T> getElement(const Key& key) const; ///< Находит элемент по ключу
+    std::pair<FindStatus, T> getElement(MapIt it) const;       ///< Находит элемент по итератору
+
+    std::pair<bool, MapIt> locate(const Key& key) const;       ///< Ищет элемент или место для его вставки
+    template <typename V>
+    T& emplace(MapIt hint, const Key& key, V&& elem);          ///< Добавляет отсутствующий элемент в место, найденное locate
+    T& value(MapIt it);                                        ///< Возвращает значение существующего элемента
+    const T& value(MapIt it) const;                            ///< Возвращает значение существующего элемента
+    It find(const Key& key) const;                             ///< Находит элемент по ключу, end() если его нет
+
+    MapIt lowerBound(const Indexes<N>& indexes) const;         ///< Возвращает первый элемент с индексами не меньше indexes
+    MapIt lowerBound(const Indexes<N>& indexes, size_t order) const; ///< То же в индексе order, indexes сдвинуты rotateIndexes
+    MapIt mapEnd() const;                                      ///< Возвращает конец упорядоченного индекса
+    MapIt mapEnd(size_t order) const;                          ///< Возвращает конец индекса order
+    const Element& element(MapIt it) const;                    ///< Возвращает элемент по итератору любого индекса
+
+    size_t size() const;                                       ///< Возвращает количесвто хранимых элементов
+    void reserve(size_t count);                                ///< Резервирует место под count элементов
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);                  ///< Заменяет содержимое упорядоченными уникальными элементами
+
+    It begin() const;                                          ///< Возвращает итератор на начало
+    It end() const;                                            ///< Возвращает итератор на конец
+    std::vector<std::pair<It, It>> split(size_t parts) const;  ///< Делит элементы на не более parts последовательных частей
+
+    Key makeKey(const Indexes<N>& indexes) const;              ///< Создает ключ
+    Element makeElement(const Key& key, const T& elem) const;  ///< Создает элемент
+
+private:
+    static Key rotatedKey(const Key& key, size_t order);       ///< Создает ключ индекса order
+    void link(typename List::iterator it, const Key& key);     ///< Добавляет элемент в индексы 1..N-1
+
+    List m_data;                ///< Хранит последовательность из данных типа Element
+    std::array<Map, N> m_maps;  ///< m_maps[d] упорядочивает элементы по ключу, начинающемуся с измерения d
+};
+
+
+/*!
+Копирует элементы. Индексы хранят итераторы на узлы m_data, поэтому строятся заново по узлам копии
+@param other Копируемое хранилище
+*/
+template <typename T, size_t N>
+IndexedData<T, N>::IndexedData(const IndexedData& other) : m_data{other.m_data} {
+    for (auto it = m_data.begin(); it != m_data.end(); ++it) {
+        const Key key = elemKeyImpl(*it, std::make_index_sequence<N>{});
+        m_maps[0].emplace(key, it);
+        link(it, key);
+    }
+}
+
+
+/*!
+Заменяет содержимое копией элементов other
+@param other Копируемое хранилище
+@return Ссылку на себя
+*/
+template <typename T, size_t N>
+IndexedData<T, N>& IndexedData<T, N>::operator=(const IndexedData& other) {
+    if (this != &other) {
+        *this = IndexedData{other};
+    }
+    return *this;
+}
+
+
+/*!
+Удаляет элемент по переданному ключу
+@param key Ключ удаляемого элемент
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N>
+void IndexedData<T, N>::erase(const Key& key) {
+    erase(m_maps[0].find(key));
+}
+
+
+/*!
+Удаляет элемент из последовательности и из всех индексов
+@param it Итератор на m_maps[0]
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N>
+void IndexedData<T, N>::erase(MapIt it) {
+    if (!contains(it)) {
+        throw std::runtime_error("Try to erase element by key which was not created");
+    }
+    for (size_t d = 1; d < N; ++d) {
+        m_maps[d].erase(rotatedKey(it->first, d));
+    }
+    m_data.erase(it->second);
+    m_maps[0].erase(it);
+}
+
+
+/*!
+Добавляет элемент по ключу. В случае, когда элемент с таким ключом существует, предыдущее значение удаляется.
+@param key Ключ для элемента
+@param val Хранимое значение
+*/
+template <typename T, size_t N>
+void IndexedData<T, N>::insert(const Key& key, const T& val) {
+    insert(m_maps[0].find(key), key, val);
+}
+
+
+/*!
+Добавляет элемент по итератору. В случае, когда элемент с таким итератором существует, значение
+ перезаписывается на месте: индексы не меняются.
+@param it  Итератор на элемент
+@param key Ключ для элемента
+@param val Хранимое значение, rvalue перемещается
+*/
+template <typename T, size_t N>
+template <typename V>
+void IndexedData<T, N>::insert(MapIt it, const Key& key, V&& val) {
+    if (contains(it)) {
+        std::get<N>(*it->second) = std::forward<V>(val);
+        return;
+    }
+    emplace(m_maps[0].lower_bound(key), key, std::forward<V>(val));
+}
+
+
+/*!
+Проверяет, существует ли элемент по переданному ключу
+@param key Ключ проверяемого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и итератора на m_maps[0]
+*/
+template <typename T, size_t N>
+std::pair<bool, typename IndexedData<T, N>::MapIt> IndexedData<T, N>::contains(const Key& key) const {
+    MapIt it = m_maps[0].find(key);
+    return {contains(it), it};
+}
+
+
+/*!
+Проверяет, существует ли элемент по переданному итератору
+@param it Итератор на m_maps[0]
+@return true если элемент по переданному итератору существует, false -- если нет
+*/
+template <typename T, size_t N>
+bool IndexedData<T, N>::contains(MapIt it) const {
+    return it != m_maps[0].end();
+}
+
+
+/*!
+Осуществляет поиск элемента по ключу
+@param key Ключ искомого элемента
+@return Пара FindStatus и значения, значение по умолчанию типа T, если элемента нет
+*/
+template <typename T, size_t N>
+std::pair<typename IndexedData<T, N>::FindStatus, T> IndexedData<T, N>::getElement(const Key& key) const {
+    return getElement(m_maps[0].find(key));
+}
+
+
+/*!
+Осуществляет поиск элемента по итератору
+@param it Итератор на искомый элемент
+@return Пара FindStatus и значения, значение по умолчанию типа T, если элемента нет
+*/
+template <typename T, size_t N>
+std::pair<typename IndexedData<T, N>::FindStatus, T> IndexedData<T, N>::getElement(MapIt it) const {
+    if (!contains(it)) {
+        return {FindStatus::NOT_FOUND, T{}};
+    }
+    return {FindStatus::FOUND, std::get<N>(*it->second)};
+}
+
+
+/*!
+Ищет элемент по ключу за один проход по основному индексу
+@param key Ключ искомого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и итератора на m_maps[0]: на элемент
+ или на место, куда его следует вставить (подсказка для emplace)
+*/
+template <typename T, size_t N>
+std::pair<bool, typename IndexedData<T, N>::MapIt> IndexedData<T, N>::locate(const Key& key) const {
+    MapIt it = m_maps[0].lower_bound(key);
+    return {it != m_maps[0].end() && !(key < it->first), it};
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище. В основной индекс элемент попадает по подсказке,
+ в остальные -- поиском по сдвинутому ключу
+@param hint Итератор, полученный из locate для того же ключа
+@param key  Ключ для элемента
+@param val  Хранимое значение, rvalue перемещается
+@return Ссылка на сохраненное значение
+*/
+template <typename T, size_t N>
+template <typename V>
+T& IndexedData<T, N>::emplace(MapIt hint, const Key& key, V&& val) {
+    Element& elem = emplaceElemImpl(m_data, key, std::make_index_sequence<N>{}, std::forward<V>(val));
+    const auto node = std::prev(m_data.end());
+    m_maps[0].emplace_hint(hint, key, node);
+    link(node, key);
+    return std::get<N>(elem);
+}
+
+
+/*!
+@param it Итератор на найденный элемент
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N>
+T& IndexedData<T, N>::value(MapIt it) {
+    return std::get<N>(*it->second);
+}
+
+
+/*!
+@param it Итератор на найденный элемент
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N>
+const T& IndexedData<T, N>::value(MapIt it) const {
+    return std::get<N>(*it->second);
+}
+
+
+/*!
+Находит элемент по ключу
+@param key Ключ искомого элемента
+@return Итератор на элемент или end(), если элемента нет
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::It IndexedData<T, N>::find(const Key& key) const {
+    MapIt it = m_maps[0].find(key);
+    return contains(it) ? It{it->second} : m_data.end();
+}
+
+
+/*!
+Ищет в основном индексе первый элемент, индексы которого лексикографически не меньше переданных
+@param indexes Набор индексов
+@return Итератор на m_maps[0]
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::MapIt IndexedData<T, N>::lowerBound(const Indexes<N>& indexes) const {
+    return lowerBound(indexes, 0);
+}
+
+
+/*!
+Ищет в индексе order первый элемент, сдвинутые индексы которого лексикографически не меньше переданных
+@param indexes Набор индексов, уже сдвинутый rotateIndexes(indexes, order)
+@param order   Номер индекса, меньше ORDERS
+@return Итератор на m_maps[order]
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::MapIt IndexedData<T, N>::lowerBound(const Indexes<N>& indexes, size_t order) const {
+    return m_maps[order].lower_bound(makeKeyImpl(indexes, std::make_index_sequence<N>{}));
+}
+
+
+/*!
+@return Итератор на конец m_maps[0]
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::MapIt IndexedData<T, N>::mapEnd() const {
+    return m_maps[0].end();
+}
+
+
+/*!
+@param order Номер индекса, меньше ORDERS
+@return Итератор на конец m_maps[order]
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::MapIt IndexedData<T, N>::mapEnd(size_t order) const {
+    return m_maps[order].end();
+}
+
+
+/*!
+Возвращает элемент, на который ссылается итератор любого из индексов
+@param it Итератор на существующий элемент m_maps[d]
+@return Элемент (индекс_1, ..., индекс_N, значение)
+*/
+template <typename T, size_t N>
+const typename IndexedData<T, N>::Element& IndexedData<T, N>::element(MapIt it) const {
+    return *it->second;
+}
+
+
+/*!
+@return Количество хранимых элементов
+*/
+template <typename T, size_t N>
+size_t IndexedData<T, N>::size() const {
+    return m_data.size();
+}
+
+
+/*!
+Узлы списка и деревьев выделяются по одному, поэтому резервировать нечего
+*/
+template <typename T, size_t N>
+void IndexedData<T, N>::reserve(size_t) {
+}
+
+
+/*!
+Заменяет содержимое элементами [first, last), упорядоченными по индексам без повторов.
+ Основной индекс строится вставкой в конец за O(nnz), остальные -- за O(nnz log nnz)
+@param first Начало диапазона элементов
+@param last  Конец диапазона элементов
+*/
+template <typename T, size_t N>
+template <typename InputIt>
+void IndexedData<T, N>::assign(InputIt first, InputIt last) {
+    for (auto& map : m_maps) {
+        map.clear();
+    }
+    m_data.clear();
+    for (; first != last; ++first) {
+        const Key key = elemKeyImpl(*first, std::make_index_sequence<N>{});
+        m_data.push_back(*first);
+        m_maps[0].emplace_hint(m_maps[0].end(), key, std::prev(m_data.end()));
+        link(std::prev(m_data.end()), key);
+    }
+}
+
+
+/*!
+@return итератор на начало диапазона в порядке вставки
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::It IndexedData<T, N>::begin() const {
+    return m_data.begin();
+}
+
+
+/*!
+@return итератор на конец диапазона
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::It IndexedData<T, N>::end() const {
+    return m_data.end();
+}
+
+
+/*!
+Делит элементы на части для параллельной обработки одним последовательным проходом по списку
+@param parts Желаемое количество частей
+@return Непустые диапазоны [first, last) в порядке итерирования, вместе покрывающие все элементы
+*/
+template <typename T, size_t N>
+std::vector<std::pair<typename IndexedData<T, N>::It, typename IndexedData<T, N>::It>> IndexedData<T, N>::split(size_t parts) const {
+    return splitEvenly(begin(), end(), size(), parts);
+}
+
+
+/*!
+@param indexes Набор индексов
+@return Ключ
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::Key IndexedData<T, N>::makeKey(const Indexes<N>& indexes) const {
+    return makeKeyImpl(indexes, std::make_index_sequence<N>{});
+}
+
+
+/*!
+@param key  Ключ
+@param elem Хранимое значение
+@return Элемент (индекс_1, ..., индекс_N, значение)
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::Element IndexedData<T, N>::makeElement(const Key& key, const T& elem) const {
+    return makeElemImpl(key, std::make_index_sequence<N>{}, elem);
+}
+
+
+/*!
+@param key   Ключ основного индекса
+@param order Номер индекса
+@return Ключ (x_order, ..., x_{N-1}, x_0, ..., x_{order-1})
+*/
+template <typename T, size_t N>
+typename IndexedData<T, N>::Key IndexedData<T, N>::rotatedKey(const Key& key, size_t order) {
+    const Indexes<N> indexes = std::apply([](const auto&... items) { return Indexes<N>{items...}; }, key);
+    return makeKeyImpl(rotateIndexes(indexes, order), std::make_index_sequence<N>{});
+}
+
+
+/*!
+@param it  Узел m_data с новым элементом
+@param key Ключ элемента
+*/
+template <typename T, size_t N>
+void IndexedData<T, N>::link(typename List::iterator it, const Key& key) {
+    for (size_t d = 1; d < N; ++d) {
+        m_maps[d].emplace(rotatedKey(key, d), it);
+    }
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 
 /// @brief сокращение для набора индексов
 template <size_t N> using Indexes = std::array<size_t, N>;
@@ -0,0 +1,397 @@
+/*!
+@file
+@brief Заголовочный файл со стратегиями инструментирования горячих путей BasicMatrix
+ и аллокатором, подсчитывающим выделенную хранилищем память
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+/*!
+ Включает MatrixProbe<> для всех матриц, у которых стратегия Probe не указана явно.
+ Задается опцией CMake MATRIX_INSTRUMENTATION, по умолчанию выключено
+ */
+#ifndef MATRIX_INSTRUMENTATION
+#define MATRIX_INSTRUMENTATION 0
+#endif
+
+/// Событие, которое учитывает MatrixProbe
+enum class ProbeEvent {
+    LOOKUP,        ///< Поиск элемента в хранилище при чтении или записи одного элемента
+    HIT,           ///< Элемент найден при чтении
+    MISS,          ///< Элемент не найден при чтении, возвращено значение по умолчанию
+    INSERT,        ///< Добавлен новый элемент
+    OVERWRITE,     ///< Перезаписан существующий элемент
+    DEFAULT_ERASE  ///< Элемент удален записью значения по умолчанию
+};
+
+/// @brief количество видов ProbeEvent
+constexpr size_t PROBE_EVENTS = 6;
+
+/// @brief количество корзин гистограммы задержек, корзина b -- задержки из [2^b, 2^(b+1)) нс
+constexpr size_t PROBE_LATENCY_BUCKETS = 32;
+
+/// @brief отметка времени начала операции
+using ProbeStamp = std::chrono::steady_clock::time_point;
+
+
+/*!
+ @brief Сводка счетчиков MatrixProbe по всем потокам
+ */
+struct ProbeReport {
+    std::array<std::uint64_t, PROBE_EVENTS> events{};           ///< Количество событий каждого вида
+    std::array<std::uint64_t, PROBE_LATENCY_BUCKETS> latency{}; ///< Гистограмма задержек операций
+
+    /// Возвращает количество событий вида event
+    std::uint64_t count(ProbeEvent event) const { return events[static_cast<size_t>(event)]; }
+};
+
+
+/*!
+ @brief Инструментирование выключено
+ @details Пустой класс: BasicMatrix проверяет ENABLED на этапе компиляции и не вызывает
+  обработчики, поэтому матрица с NoProbe не отличается от матрицы без инструментирования
+ */
+struct NoProbe {
+    static constexpr bool ENABLED = false; ///< Признак того, что события учитываются
+};
+
+
+/*!
+ @brief Счетчики событий горячих путей матрицы: поиски, попадания и промахи, вставки,
+  перезаписи и удаления записью значения по умолчанию
+ @details Счетчики разбиты на части, выровненные по 64 байта. Первые SHARDS потоков процесса
+  (поток получает номер при первом обращении к MatrixProbe с теми же параметрами) пишут каждый в свою часть
+  обычными relaxed-загрузкой и записью, без lock-инструкций, которые на x86 мешали бы
+  перекрываться промахам кэша соседних поисков. Остальные потоки делят еще одну часть и
+  увеличивают ее атомарно. report() суммирует части.
+  При LATENCY = true время каждой операции измеряется steady_clock и попадает в логарифмическую
+  гистограмму. Функция hook, если задана, вызывается для каждого события с его задержкой в
+  наносекундах (0 без LATENCY) -- например, чтобы передать событие в свою систему метрик.
+  Копия матрицы получает новые нулевые счетчики и тот же hook, а присваивание матрице оставляет ей свои.
+ @tparam LATENCY измерять ли задержку операций
+ @tparam SHARDS количество частей счетчиков
+ */
+template <bool LATENCY = false, size_t SHARDS = 16>
+class MatrixProbe {
+public:
+    static constexpr bool ENABLED = true; ///< Признак того, что события учитываются
+
+    /// @brief обработчик событий: вид события и задержка в наносекундах
+    using Hook = std::function<void(ProbeEvent, std::uint64_t)>;
+
+    MatrixProbe();
+    MatrixProbe(const MatrixProbe& other);
+    MatrixProbe& operator=(const MatrixProbe& other);
+
+    ProbeReport report() const;     ///< Суммирует счетчики всех потоков
+    void reset();                   ///< Обнуляет счетчики
+    void setHook(Hook hook);        ///< Задает обработчик событий, пустой -- отключает его
+
+    ProbeStamp start() const;                           ///< Отмечает начало операции
+    void record(ProbeEvent event, ProbeStamp stamp) const; ///< Учитывает событие операции, начатой в stamp
+    void recordLookup(bool found, ProbeStamp stamp) const; ///< Учитывает поиск при чтении и его результат
+
+private:
+    /// @brief счетчики одного потока
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, PROBE_EVENTS> events{};           ///< Количество событий
+        std::array<std::atomic<std::uint64_t>, PROBE_LATENCY_BUCKETS> latency{}; ///< Гистограмма задержек
+    };
+
+    static size_t thread();                         ///< Возвращает номер текущего потока
+    static void bump(std::atomic<std::uint64_t>& counter, bool owned, std::uint64_t delta = 1); ///< Увеличивает счетчик
+    void finish(Shard& shard, bool owned, ProbeEvent event, ProbeStamp stamp) const;       ///< Учитывает задержку и вызывает hook
+    static size_t bucket(std::uint64_t nanoseconds); ///< Возвращает корзину гистограммы
+
+    std::unique_ptr<Shard[]> m_shards; ///< Счетчики: SHARDS собственных частей потоков и одна общая
+    Hook m_hook;                       ///< Обработчик событий
+};
+
+
+/// @brief стратегия инструментирования по умолчанию, выбирается макросом MATRIX_INSTRUMENTATION
+using DefaultProbe = std::conditional_t<MATRIX_INSTRUMENTATION != 0, MatrixProbe<>, NoProbe>;
+
+
+template <bool LATENCY, size_t SHARDS>
+MatrixProbe<LATENCY, SHARDS>::MatrixProbe() : m_shards{new Shard[SHARDS + 1]} {}
+
+
+/*!
+ Создает нулевые счетчики с обработчиком other
+ @param other Копируемые счетчики
+ */
+template <bool LATENCY, size_t SHARDS>
+MatrixProbe<LATENCY, SHARDS>::MatrixProbe(const MatrixProbe& other) : m_shards{new Shard[SHARDS + 1]}, m_hook{other.m_hook} {}
+
+
+/*!
+ Сохраняет собственные счетчики и обработчик: присваивание матрице, в том числе результата
+ выражения или parallelTransform, заменяет ее элементы, но не инструментирование
+ @return Ссылку на себя
+ */
+template <bool LATENCY, size_t SHARDS>
+MatrixProbe<LATENCY, SHARDS>& MatrixProbe<LATENCY, SHARDS>::operator=(const MatrixProbe&) {
+    return *this;
+}
+
+
+/*!
+ Суммирует счетчики всех потоков. Одновременные с вызовом события могут быть учтены частично
+ @return Сводка счетчиков
+ */
+template <bool LATENCY, size_t SHARDS>
+ProbeReport MatrixProbe<LATENCY, SHARDS>::report() const {
+    ProbeReport report;
+    for (size_t s = 0; s <= SHARDS; ++s) {
+        for (size_t e = 0; e < PROBE_EVENTS; ++e) {
+            report.events[e] += m_shards[s].events[e].load(std::memory_order_relaxed);
+        }
+        for (size_t b = 0; b < PROBE_LATENCY_BUCKETS; ++b) {
+            report.latency[b] += m_shards[s].latency[b].load(std::memory_order_relaxed);
+        }
+    }
+    return report;
+}
+
+
+/*!
+ Обнуляет счетчики. Не должен выполняться одновременно с операциями над матрицей
+ */
+template <bool LATENCY, size_t SHARDS>
+void MatrixProbe<LATENCY, SHARDS>::reset() {
+    for (size_t s = 0; s <= SHARDS; ++s) {
+        for (auto& counter : m_shards[s].events) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        for (auto& counter : m_shards[s].latency) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+/*!
+ @param hook Функция void(ProbeEvent, std::uint64_t), вызывается в потоке, породившем событие
+ */
+template <bool LATENCY, size_t SHARDS>
+void MatrixProbe<LATENCY, SHARDS>::setHook(Hook hook) {
+    m_hook = std::move(hook);
+}
+
+
+/*!
+@return Текущее время при LATENCY = true, иначе пустая отметка без обращения к часам
+*/
+template <bool LATENCY, size_t SHARDS>
+ProbeStamp MatrixProbe<LATENCY, SHARDS>::start() const {
+    if constexpr (LATENCY) {
+        return std::chrono::steady_clock::now();
+    } else {
+        return {};
+    }
+}
+
+
+/*!
+ @param event Событие
+ @param stamp Отметка, полученная из start() в начале операции, или пустая отметка, если
+  событие не завершает операцию и его задержка не нужна
+ */
+template <bool LATENCY, size_t SHARDS>
+void MatrixProbe<LATENCY, SHARDS>::record(ProbeEvent event, ProbeStamp stamp) const {
+    const size_t index = thread();
+    const bool owned = index < SHARDS;
+    Shard& shard = m_shards[owned ? index : SHARDS];
+    bump(shard.events[static_cast<size_t>(event)], owned);
+    finish(shard, owned, event, stamp);
+}
+
+
+/*!
+ Учитывает поиск при чтении: LOOKUP и HIT или MISS. Результат поиска прибавляется к обоим
+ счетчикам как число, а не выбирает адрес счетчика, поэтому запись не зависит от промаха кэша
+ при поиске и не задерживает следующие поиски
+ @param found Найден ли элемент
+ @param stamp Отметка, полученная из start() в начале операции
+ */
+template <bool LATENCY, size_t SHARDS>
+void MatrixProbe<LATENCY, SHARDS>::recordLookup(bool found, ProbeStamp stamp) const {
+    const size_t index = thread();
+    const bool owned = index < SHARDS;
+    Shard& shard = m_shards[owned ? index : SHARDS];
+    bump(shard.events[static_cast<size_t>(ProbeEvent::LOOKUP)], owned);
+    bump(shard.events[static_cast<size_t>(ProbeEvent::HIT)], owned, found);
+    bump(shard.events[static_cast<size_t>(ProbeEvent::MISS)], owned, !found);
+    if (m_hook) {
+        m_hook(ProbeEvent::LOOKUP, 0);
+    }
+    finish(shard, owned, found ? ProbeEvent::HIT : ProbeEvent::MISS, stamp);
+}
+
+
+template <bool LATENCY, size_t SHARDS>
+void MatrixProbe<LATENCY, SHARDS>::finish(Shard& shard, bool owned, ProbeEvent event, ProbeStamp stamp) const {
+    std::uint64_t nanoseconds = 0;
+    if constexpr (LATENCY) {
+        if (stamp != ProbeStamp{}) {
+            const auto elapsed = std::chrono::steady_clock::now() - stamp;
+            nanoseconds = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            bump(shard.latency[bucket(nanoseconds)], owned);
+        }
+    }
+    if (m_hook) {
+        m_hook(event, nanoseconds);
+    }
+}
+
+
+template <bool LATENCY, size_t SHARDS>
+size_t MatrixProbe<LATENCY, SHARDS>::thread() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+
+/*!
+ Увеличивает счетчик
+ @param counter Счетчик
+ @param owned   Пишет ли в счетчик только текущий поток
+ @param delta   Прибавляемое значение
+ */
+template <bool LATENCY, size_t SHARDS>
+void MatrixProbe<LATENCY, SHARDS>::bump(std::atomic<std::uint64_t>& counter, bool owned, std::uint64_t delta) {
+    if (owned) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    } else {
+        counter.fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+
+template <bool LATENCY, size_t SHARDS>
+size_t MatrixProbe<LATENCY, SHARDS>::bucket(std::uint64_t nanoseconds) {
+    size_t b = 0;
+    while (nanoseconds > 1 && b + 1 < PROBE_LATENCY_BUCKETS) {
+        nanoseconds >>= 1;
+        ++b;
+    }
+    return b;
+}
+
+
+/*!
+ @brief Аллокатор, подсчитывающий память, выделенную контейнерами одного хранилища
+ @details Оборачивает std::allocator. Счетчик общий для перепривязанных копий, поэтому
+  Data<T, N, CountingAllocator<...>> учитывает узлы и std::list, и std::map; копия контейнера
+  получает новый счетчик. Счетчик атомарный.
+ @tparam T тип выделяемых объектов
+ */
+template <typename T>
+class CountingAllocator {
+public:
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    CountingAllocator();
+    CountingAllocator(const CountingAllocator&) noexcept = default;
+    CountingAllocator& operator=(const CountingAllocator&) noexcept = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept;
+
+    T* allocate(size_t count);
+    void deallocate(T* pointer, size_t count) noexcept;
+
+    CountingAllocator select_on_container_copy_construction() const; ///< Создает аллокатор с новым счетчиком
+
+    size_t bytes() const; ///< Возвращает количество выделенных и еще не освобожденных байт
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept;
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept;
+
+private:
+    template <typename U>
+    friend class CountingAllocator;
+
+    std::shared_ptr<std::atomic<size_t>> m_bytes; ///< Счетчик, общий для перепривязанных копий
+};
+
+
+template <typename T>
+CountingAllocator<T>::CountingAllocator() : m_bytes{std::make_shared<std::atomic<size_t>>(0)} {}
+
+
+template <typename T>
+template <typename U>
+CountingAllocator<T>::CountingAllocator(const CountingAllocator<U>& other) noexcept : m_bytes{other.m_bytes} {}
+
+
+/*!
+ Выделяет память под count объектов
+ @param count Количество объектов
+ @return Указатель на неинициализированную память
+ */
+template <typename T>
+T* CountingAllocator<T>::allocate(size_t count) {
+    T* pointer = std::allocator<T>{}.allocate(count);
+    m_bytes->fetch_add(count * sizeof(T), std::memory_order_relaxed);
+    return pointer;
+}
+
+
+/*!
+ Освобождает память, выделенную allocate
+ @param pointer Указатель, полученный из allocate
+ @param count   Количество объектов, переданное в allocate
+ */
+template <typename T>
+void CountingAllocator<T>::deallocate(T* pointer, size_t count) noexcept {
+    std::allocator<T>{}.deallocate(pointer, count);
+    m_bytes->fetch_sub(count * sizeof(T), std::memory_order_relaxed);
+}
+
+
+/*!
+@return Аллокатор с новым нулевым счетчиком, чтобы копия контейнера считалась отдельно
+*/
+template <typename T>
+CountingAllocator<T> CountingAllocator<T>::select_on_container_copy_construction() const {
+    return CountingAllocator{};
+}
+
+
+/*!
+@return Количество байт, выделенных через этот аллокатор и его перепривязанные копии и еще не освобожденных
+*/
+template <typename T>
+size_t CountingAllocator<T>::bytes() const {
+    return m_bytes->load(std::memory_order_relaxed);
+}
+
+
+template <typename T>
+template <typename U>
+bool CountingAllocator<T>::operator==(const CountingAllocator<U>& other) const noexcept {
+    return m_bytes == other.m_bytes;
+}
+
+
+template <typename T>
+template <typename U>
+bool CountingAllocator<T>::operator!=(const CountingAllocator<U>& other) const noexcept {
+    return !(*this == other);
+}
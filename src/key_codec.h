@@ -0,0 +1,432 @@
+/*!
+@file
+@brief Заголовочный файл со способами кодирования набора индексов в ключ упорядоченного хранилища
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*!
+ @brief Ключ -- std::tuple из N индексов типа size_t
+ @details Принимает любые индексы, сравнение ключей поэлементное
+ @tparam N размерность матрицы
+ */
+template <size_t N>
+struct TupleKeyCodec {
+    /// @brief тип ключа
+    using Key = KeyType<N>;
+
+    static Key encode(const Indexes<N>& indexes);                   ///< Создает ключ
+    static std::pair<bool, Key> tryEncode(const Indexes<N>& indexes); ///< Создает ключ, если индексы представимы
+    static std::pair<bool, Key> lowerKey(const Indexes<N>& indexes); ///< Создает наименьший ключ не меньше индексов
+    static const Key& decode(const Key& key);                       ///< Возвращает индексы ключа
+    static std::uint64_t hash(const Key& key);                      ///< Вычисляет хэш ключа
+
+    template <typename Element>
+    static Key elementKey(const Element& elem);                     ///< Создает ключ элемента
+
+    /// @brief запись хранилища -- сам элемент (индекс_1, ..., индекс_N, значение)
+    template <typename T>
+    using Entry = ElementType<T, N>;
+
+    /// @brief итератор по элементам записей: записи уже являются элементами
+    template <typename Base>
+    using Iterator = Base;
+
+    template <typename Record>
+    static Key entryKey(const Record& entry);                        ///< Возвращает ключ записи
+    template <typename Record>
+    static auto& entryValue(Record& entry);                          ///< Возвращает значение записи
+    template <typename Container, typename V>
+    static auto& emplaceEntry(Container& entries, const Key& key, V&& val); ///< Создает запись в конце контейнера
+    template <typename Element>
+    static const Element& toEntry(const Element& elem);             ///< Создает запись из элемента
+};
+
+
+/*!
+ @brief Прямой итератор по записям (ключ, значение) с упакованным ключом, разыменование которого дает элемент
+ @details Индексы восстанавливаются KeyCodec::decode при каждом разыменовании в элемент, хранящийся
+  внутри итератора: ссылка действительна, пока жив итератор и до следующего разыменования.
+  Так хранилище держит в узле 8 или 16 байт ключа вместо N индексов size_t, а обход выглядит как обход Data
+ @tparam Base итератор по записям std::pair<Key, T> (узлы std::map или элементы std::vector)
+ @tparam KeyCodec способ кодирования индексов, например PackedKeyCodec<N, Bits>
+ */
+template <typename Base, typename KeyCodec>
+class DecodingIterator {
+    /// @brief тип хранимого значения
+    using Value = std::remove_const_t<typename std::iterator_traits<Base>::value_type::second_type>;
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = ElementType<Value, KeyCodec::RANK>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const value_type*;
+    using reference         = const value_type&;
+
+    DecodingIterator() = default;
+    DecodingIterator(Base it) : m_it{it} {}
+
+    reference operator*() const {
+        m_elem = makeElemImpl(KeyCodec::decode(m_it->first), std::make_index_sequence<KeyCodec::RANK>{}, m_it->second);
+        return m_elem;
+    }
+    pointer operator->() const { return &**this; }
+    DecodingIterator& operator++() { ++m_it; return *this; }
+    DecodingIterator operator++(int) { DecodingIterator tmp = *this; ++*this; return tmp; }
+    bool operator==(const DecodingIterator& other) const { return m_it == other.m_it; }
+    bool operator!=(const DecodingIterator& other) const { return m_it != other.m_it; }
+
+    const Base& base() const { return m_it; } ///< Возвращает итератор по записям
+
+private:
+    Base m_it{};                 ///< Текущая запись
+    mutable value_type m_elem{}; ///< Элемент, собранный при последнем разыменовании
+};
+
+
+#ifdef __SIZEOF_INT128__
+/// @brief беззнаковое 128-битное целое для ключей длиннее 64 бит
+__extension__ typedef unsigned __int128 UInt128;
+#endif
+
+
+/*!
+ @brief Ключ -- одно беззнаковое целое, в котором индексы записаны подряд по Bits бит, первый -- в старших битах
+ @details Такое кодирование сохраняет лексикографический порядок индексов, поэтому упорядоченное
+  хранилище и пропускающий поиск RangeView работают без изменений, а сравнение и хэширование ключа --
+  одна целочисленная операция. Ключ занимает 8 байт при N * Bits <= 64 и 16 байт при N * Bits <= 128.
+  Индексы не меньше 2^Bits не помещаются в ключ: encode для них бросает std::runtime_error, а tryEncode
+  возвращает false -- такой ячейки не может быть в хранилище, поэтому чтение и запись Default обходятся без исключения.
+ @tparam N размерность матрицы
+ @tparam Bits количество бит на один индекс
+ */
+template <size_t N, size_t Bits = 64 / N>
+struct PackedKeyCodec {
+    static_assert(N > 0 && Bits > 0 && Bits <= 64, "PackedKeyCodec requires 0 < Bits <= 64");
+#ifdef __SIZEOF_INT128__
+    static_assert(N * Bits <= 128, "PackedKeyCodec supports keys up to 128 bits");
+
+    /// @brief тип ключа
+    using Key = std::conditional_t<(N * Bits <= 64), std::uint64_t, UInt128>;
+#else
+    static_assert(N * Bits <= 64, "PackedKeyCodec supports keys up to 64 bits");
+
+    /// @brief тип ключа
+    using Key = std::uint64_t;
+#endif
+
+    /// @brief размерность матрицы
+    static constexpr size_t RANK = N;
+
+    /// @brief наибольший допустимый индекс
+    static constexpr size_t MAX_INDEX = Bits == 64 ? std::numeric_limits<size_t>::max() : (size_t{1} << Bits) - 1;
+
+    static Key encode(const Indexes<N>& indexes);                   ///< Создает ключ
+    static std::pair<bool, Key> tryEncode(const Indexes<N>& indexes); ///< Создает ключ, если индексы представимы
+    static std::pair<bool, Key> lowerKey(const Indexes<N>& indexes); ///< Создает наименьший ключ не меньше индексов
+    static Indexes<N> decode(Key key);                              ///< Восстанавливает индексы ключа
+    static std::uint64_t hash(Key key);                             ///< Вычисляет хэш ключа
+
+    template <typename Element>
+    static Key elementKey(const Element& elem);                     ///< Создает ключ элемента
+
+    /// @brief запись хранилища -- упакованный ключ и значение, индексы восстанавливаются при разыменовании
+    template <typename T>
+    using Entry = std::pair<Key, T>;
+
+    /// @brief итератор по элементам записей, см. DecodingIterator
+    template <typename Base>
+    using Iterator = DecodingIterator<Base, PackedKeyCodec>;
+
+    template <typename Record>
+    static Key entryKey(const Record& entry);                        ///< Возвращает ключ записи
+    template <typename Record>
+    static auto& entryValue(Record& entry);                          ///< Возвращает значение записи
+    template <typename Container, typename V>
+    static auto& emplaceEntry(Container& entries, const Key& key, V&& val); ///< Создает запись в конце контейнера
+    template <typename Element>
+    static auto toEntry(const Element& elem);                       ///< Создает запись из элемента
+
+private:
+    static Key append(Key key, size_t index); ///< Дописывает индекс в младшие биты ключа
+};
+
+
+/*!
+ @param indexes Набор индексов
+ @return Ключ
+ */
+template <size_t N>
+typename TupleKeyCodec<N>::Key TupleKeyCodec<N>::encode(const Indexes<N>& indexes) {
+    return makeKeyImpl(indexes, std::make_index_sequence<N>{});
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return true и ключ индексов: любой набор индексов представим
+ */
+template <size_t N>
+std::pair<bool, typename TupleKeyCodec<N>::Key> TupleKeyCodec<N>::tryEncode(const Indexes<N>& indexes) {
+    return {true, encode(indexes)};
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return true и ключ индексов: любой набор индексов представим
+ */
+template <size_t N>
+std::pair<bool, typename TupleKeyCodec<N>::Key> TupleKeyCodec<N>::lowerKey(const Indexes<N>& indexes) {
+    return {true, encode(indexes)};
+}
+
+
+/*!
+ @param key Ключ
+ @return Сам ключ: к нему применим std::get<I>
+ */
+template <size_t N>
+const typename TupleKeyCodec<N>::Key& TupleKeyCodec<N>::decode(const Key& key) {
+    return key;
+}
+
+
+/*!
+ @param elem Элемент (индекс_1, ..., индекс_N, значение)
+ @return Ключ элемента
+ */
+template <size_t N>
+template <typename Element>
+typename TupleKeyCodec<N>::Key TupleKeyCodec<N>::elementKey(const Element& elem) {
+    return elemKeyImpl(elem, std::make_index_sequence<N>{});
+}
+
+
+/*!
+ @param key Ключ
+ @return Хэш ключа, см. KeyHash
+ */
+template <size_t N>
+std::uint64_t TupleKeyCodec<N>::hash(const Key& key) {
+    return KeyHash<N>{}(key);
+}
+
+
+/*!
+ @param entry Запись (индекс_1, ..., индекс_N, значение)
+ @return Ключ записи
+ */
+template <size_t N>
+template <typename Record>
+typename TupleKeyCodec<N>::Key TupleKeyCodec<N>::entryKey(const Record& entry) {
+    return elemKeyImpl(entry, std::make_index_sequence<N>{});
+}
+
+
+/*!
+ @param entry Запись (индекс_1, ..., индекс_N, значение)
+ @return Ссылка на значение записи
+ */
+template <size_t N>
+template <typename Record>
+auto& TupleKeyCodec<N>::entryValue(Record& entry) {
+    return std::get<N>(entry);
+}
+
+
+/*!
+ @param entries Контейнер записей с emplace_back
+ @param key     Ключ
+ @param val     Значение, rvalue перемещается
+ @return Ссылка на значение созданной записи
+ */
+template <size_t N>
+template <typename Container, typename V>
+auto& TupleKeyCodec<N>::emplaceEntry(Container& entries, const Key& key, V&& val) {
+    return std::get<N>(emplaceElemImpl(entries, key, std::make_index_sequence<N>{}, std::forward<V>(val)));
+}
+
+
+/*!
+ @param elem Элемент
+ @return Сам элемент
+ */
+template <size_t N>
+template <typename Element>
+const Element& TupleKeyCodec<N>::toEntry(const Element& elem) {
+    return elem;
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return Ключ
+ @throw std::runtime_error Если какой-то индекс больше MAX_INDEX
+ */
+template <size_t N, size_t Bits>
+typename PackedKeyCodec<N, Bits>::Key PackedKeyCodec<N, Bits>::encode(const Indexes<N>& indexes) {
+    const auto [fits, key] = tryEncode(indexes);
+    if (!fits) {
+        const size_t index = *std::find_if(indexes.begin(), indexes.end(), [](size_t i) { return i > MAX_INDEX; });
+        throw std::runtime_error("Index " + std::to_string(index) + " does not fit into " + std::to_string(Bits) + "-bit packed key");
+    }
+    return key;
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return false, если какой-то индекс больше MAX_INDEX, иначе true и ключ
+ */
+template <size_t N, size_t Bits>
+std::pair<bool, typename PackedKeyCodec<N, Bits>::Key> PackedKeyCodec<N, Bits>::tryEncode(const Indexes<N>& indexes) {
+    Key key = 0;
+    for (size_t d = 0; d < N; ++d) {
+        if (indexes[d] > MAX_INDEX) {
+            return {false, Key{}};
+        }
+        key = append(key, indexes[d]);
+    }
+    return {true, key};
+}
+
+
+/*!
+ Создает наименьший ключ, индексы которого лексикографически не меньше переданных. Нужен для
+ поиска границ диапазона, в которых индексы могут выходить за MAX_INDEX: если indexes[d] > MAX_INDEX,
+ результат -- следующий за indexes[0..d) префикс, дополненный нулями
+ @param indexes Набор индексов
+ @return false, если такого ключа нет (все ключи меньше индексов), иначе true и ключ
+ */
+template <size_t N, size_t Bits>
+std::pair<bool, typename PackedKeyCodec<N, Bits>::Key> PackedKeyCodec<N, Bits>::lowerKey(const Indexes<N>& indexes) {
+    Key key = 0;
+    for (size_t d = 0; d < N; ++d) {
+        if (indexes[d] > MAX_INDEX) {
+            // префикс из d индексов занимает d * Bits < N * Bits бит, поэтому сдвиги ниже определены
+            const Key next = key + 1;
+            if (d == 0 || next == (Key{1} << (d * Bits))) {
+                return {false, Key{}};
+            }
+            return {true, next << ((N - d) * Bits)};
+        }
+        key = append(key, indexes[d]);
+    }
+    return {true, key};
+}
+
+
+/*!
+ @param key Ключ
+ @return Набор индексов, из которого создан ключ
+ */
+template <size_t N, size_t Bits>
+Indexes<N> PackedKeyCodec<N, Bits>::decode(Key key) {
+    Indexes<N> indexes;
+    for (size_t d = N; d-- > 0;) {
+        indexes[d] = static_cast<size_t>(key) & MAX_INDEX;
+        if (d > 0) {
+            key >>= Bits;
+        }
+    }
+    return indexes;
+}
+
+
+/*!
+ @param elem Элемент (индекс_1, ..., индекс_N, значение)
+ @return Ключ элемента
+ @throw std::runtime_error Если какой-то индекс больше MAX_INDEX
+ */
+template <size_t N, size_t Bits>
+template <typename Element>
+typename PackedKeyCodec<N, Bits>::Key PackedKeyCodec<N, Bits>::elementKey(const Element& elem) {
+    Indexes<N> indexes;
+    std::apply([&indexes](const auto&... items) {
+        size_t i = 0;
+        ((indexes[i++] = static_cast<size_t>(items)), ...);
+    }, elemKeyTieImpl(elem, std::make_index_sequence<N>{}));
+    return encode(indexes);
+}
+
+
+template <size_t N, size_t Bits>
+typename PackedKeyCodec<N, Bits>::Key PackedKeyCodec<N, Bits>::append(Key key, size_t index) {
+    if constexpr (Bits == 8 * sizeof(Key)) {
+        return static_cast<Key>(index);
+    } else {
+        return (key << Bits) | static_cast<Key>(index);
+    }
+}
+
+
+/*!
+ @param key Ключ
+ @return Хэш ключа: перемешанные биты одного или двух 64-битных слов
+ */
+template <size_t N, size_t Bits>
+std::uint64_t PackedKeyCodec<N, Bits>::hash(Key key) {
+    if constexpr (sizeof(Key) > sizeof(std::uint64_t)) {
+        return mixHash(static_cast<std::uint64_t>(key) ^ mixHash(static_cast<std::uint64_t>(key >> 64)));
+    } else {
+        return mixHash(key);
+    }
+}
+
+
+/*!
+ @param entry Запись (ключ, значение)
+ @return Ключ записи
+ */
+template <size_t N, size_t Bits>
+template <typename Record>
+typename PackedKeyCodec<N, Bits>::Key PackedKeyCodec<N, Bits>::entryKey(const Record& entry) {
+    return entry.first;
+}
+
+
+/*!
+ @param entry Запись (ключ, значение)
+ @return Ссылка на значение записи
+ */
+template <size_t N, size_t Bits>
+template <typename Record>
+auto& PackedKeyCodec<N, Bits>::entryValue(Record& entry) {
+    return entry.second;
+}
+
+
+/*!
+ @param entries Контейнер записей с emplace_back
+ @param key     Ключ
+ @param val     Значение, rvalue перемещается
+ @return Ссылка на значение созданной записи
+ */
+template <size_t N, size_t Bits>
+template <typename Container, typename V>
+auto& PackedKeyCodec<N, Bits>::emplaceEntry(Container& entries, const Key& key, V&& val) {
+    return entries.emplace_back(key, std::forward<V>(val)).second;
+}
+
+
+/*!
+ @param elem Элемент (индекс_1, ..., индекс_N, значение)
+ @return Запись (ключ, значение)
+ @throw std::runtime_error Если какой-то индекс больше MAX_INDEX
+ */
+template <size_t N, size_t Bits>
+template <typename Element>
+auto PackedKeyCodec<N, Bits>::toEntry(const Element& elem) {
+    return std::make_pair(elementKey(elem), std::get<N>(elem));
+}
@@ -0,0 +1,541 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией разреженной матрицы для частой записи:
+ изменения дописываются в буфер, фоновый поток сливает их в неизменяемую упорядоченную базу
+*/
+
+#pragma once
+
+#include "sparse_matrix.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/*!
+ @brief Бесконечная n-мерная разреженная матрица в духе LSM-дерева
+ @details Запись, в том числе запись Default (удаление), только дописывает изменение в небольшой
+  изменяемый буфер -- хэш-таблицу, удаление хранится как надгробие. Когда буфер дорастает до
+  max(minDelta, размер базы / BASE_TO_DELTA), он замораживается, а фоновый поток сливает его
+  с неизменяемой базой -- вектором элементов, упорядоченным по индексам. Новая база подхватывается
+  следующим обращением к матрице, записью или чтением: проверка готовности слияния -- одна атомарная
+  загрузка, поэтому чтение не берет блокировок: get ищет в буфере, затем в замороженном буфере,
+  затем двоичным поиском в базе. Изменения, оставшиеся в буфере к началу периода только чтения,
+  сливаются следующей записью или compact(). Матрица, как и Matrix, не потокобезопасна для пользователя,
+  причем даже чтение может подхватить новую базу, поэтому одновременное чтение из нескольких потоков
+  тоже требует внешней синхронизации; фоновый поток читает только неизменяемые данные.
+ @tparam T тип хранимого элемента
+ @tparam Default значение хранимого элемента по умолчанию
+ @tparam N размерность матрицы
+ */
+template <typename T, T Default, size_t N>
+class LsmMatrix {
+public:
+    /// @brief тип хранимого элемента: N индексов и значение
+    using Element = ElementType<T, N>;
+
+    class Iterator;
+
+    explicit LsmMatrix(size_t minDelta = DEFAULT_MIN_DELTA);
+
+    Proxy<T, N, 1, LsmMatrix> operator[](std::size_t);
+
+    void update(const Indexes<N>& indexes, const T& value); ///< Записывает элемент в ячейку с переданными индексами
+    void update(const Indexes<N>& indexes, T&& value);      ///< Перемещает элемент в ячейку с переданными индексами
+    T get(const Indexes<N>& indexes) const;                 ///< Считывает элемент из ячейки с переданными индексами
+    const T* tryGet(const Indexes<N>& indexes) const;       ///< Возвращает указатель на хранимое значение или nullptr
+
+    size_t size() const;        ///< Возвращает количество хранимых элементов
+    size_t deltaSize() const;   ///< Возвращает количество изменений, еще не слитых в базу
+    void compact();             ///< Сливает все изменения в базу, дожидаясь фонового слияния
+
+    Iterator begin() const;     ///< Возвращает итератор на начало
+    Iterator end() const;       ///< Возвращает итератор на конец
+
+    static constexpr size_t DEFAULT_MIN_DELTA = 1u << 16; ///< Наименьший размер буфера, при котором начинается слияние
+    static constexpr size_t BASE_TO_DELTA = 8;            ///< Во сколько раз база может быть больше буфера перед слиянием
+
+private:
+    /// @brief изменение ячейки: новое значение или надгробие
+    struct Change {
+        T value;    ///< Записанное значение, для надгробия -- Default
+        bool live;  ///< false -- надгробие: ячейка удалена
+    };
+
+    using Key     = KeyType<N>;
+    using Delta   = HashData<Change, N>;
+    using Changed = typename Delta::Element;
+    using Base    = std::vector<Element>;
+
+    template <typename V>
+    void setImpl(const Indexes<N>& indexes, V&& value);
+
+    void poll() const;    ///< Подхватывает базу, если фоновое слияние завершилось
+    void install() const; ///< Дожидается фонового слияния и подхватывает его базу
+    void release();       ///< Освобождает базу и буфер, замененные при чтении
+    void freeze();        ///< Замораживает буфер и запускает его слияние с базой в фоновом потоке
+
+    const Change* findChange(const Delta& delta, const Key& key) const; ///< Ищет изменение в буфере
+    const Element* findBase(const Key& key) const;                      ///< Ищет элемент в базе
+    const T* lookup(const Key& key) const;                              ///< Ищет значение, для надгробия -- Default
+
+    static std::vector<const Changed*> sorted(const Delta& delta);                  ///< Упорядочивает изменения буфера по индексам
+    static std::shared_ptr<const Base> merge(const Base& base, const Delta& delta); ///< Сливает буфер с базой
+
+    Delta m_delta;                                           ///< Изменяемый буфер, куда пишутся изменения
+    mutable std::shared_ptr<const Delta> m_frozen;           ///< Замороженный буфер, сливаемый с базой, или nullptr
+    mutable std::shared_ptr<const Base> m_base;              ///< Неизменяемая база, упорядоченная по индексам
+    mutable std::future<std::shared_ptr<const Base>> m_merge; ///< Результат фонового слияния
+    mutable std::shared_ptr<const Delta> m_retiredFrozen;    ///< Буфер, слитый в базу при чтении, живет до следующей записи
+    mutable std::shared_ptr<const Base> m_retiredBase;       ///< База, замененная при чтении, живет до следующей записи
+    size_t m_minDelta;                                       ///< Наименьший размер буфера для слияния
+    mutable size_t m_size = 0;                       ///< Закэшированное количество элементов
+    mutable bool m_sizeValid = true;                 ///< Признак актуальности m_size
+};
+
+
+/*!
+ @brief Итератор по элементам LsmMatrix в лексикографическом порядке индексов
+ @details Сливает три упорядоченных источника: базу, замороженный и изменяемый буферы, изменения
+  которых упорядочиваются при создании итератора за O(d log d), d -- deltaSize(). Из одинаковых
+  индексов побеждает более поздний источник, надгробия пропускаются, поэтому каждый элемент
+  встречается ровно один раз. Итератор владеет базой и замороженным буфером, поэтому подхват новой
+  базы его не портит; действителен до следующей записи в матрицу
+ */
+template <typename T, T Default, size_t N>
+class LsmMatrix<T, Default, N>::Iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const Element*;
+    using reference         = const Element&;
+
+    Iterator() = default;
+    explicit Iterator(const LsmMatrix& owner) : m_sources{std::make_shared<const Sources>(Sources{
+        owner.m_base, owner.m_frozen, owner.m_frozen ? sorted(*owner.m_frozen) : std::vector<const Changed*>{}, sorted(owner.m_delta)})}, m_done{false} {
+        settle();
+    }
+
+    reference operator*() const { return m_baseElem != nullptr ? *m_baseElem : m_elem; }
+    pointer operator->() const { return &**this; }
+    Iterator& operator++() { settle(); return *this; }
+    Iterator operator++(int) { Iterator tmp = *this; ++*this; return tmp; }
+    bool operator==(const Iterator& other) const { return m_done == other.m_done && (m_done || m_pos == other.m_pos); }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+private:
+    /// Источники элементов, общие для копий итератора
+    struct Sources {
+        std::shared_ptr<const Base> base;     ///< База
+        std::shared_ptr<const Delta> frozen;  ///< Замороженный буфер, владение нужно для frozenChanges
+        std::vector<const Changed*> frozenChanges; ///< Упорядоченные изменения замороженного буфера
+        std::vector<const Changed*> activeChanges; ///< Упорядоченные изменения изменяемого буфера
+    };
+
+    /// Количество источников: база, замороженный буфер, изменяемый буфер
+    static constexpr size_t SOURCES = 3;
+
+    /// Возвращает ключ очередного элемента источника, false -- источник исчерпан
+    bool head(size_t source, Key& key) const {
+        const auto seq = std::make_index_sequence<N>{};
+        if (source == 0) {
+            if (m_pos[0] == m_sources->base->size()) {
+                return false;
+            }
+            key = elemKeyImpl((*m_sources->base)[m_pos[0]], seq);
+            return true;
+        }
+        const auto& changes = source == 1 ? m_sources->frozenChanges : m_sources->activeChanges;
+        if (m_pos[source] == changes.size()) {
+            return false;
+        }
+        key = elemKeyImpl(*changes[m_pos[source]], seq);
+        return true;
+    }
+
+    /// Переходит к следующему видимому элементу: наименьшему ключу, не удаленному последним изменением
+    void settle() {
+        while (true) {
+            std::array<Key, SOURCES> keys{};
+            std::array<bool, SOURCES> has{};
+            const Key* least = nullptr;
+            for (size_t source = 0; source < SOURCES; ++source) {
+                has[source] = head(source, keys[source]);
+                if (has[source] && (least == nullptr || keys[source] < *least)) {
+                    least = &keys[source];
+                }
+            }
+            m_baseElem = nullptr;
+            if (least == nullptr) {
+                m_done = true;
+                return;
+            }
+
+            // источники проходятся от старого к новому, поэтому побеждает последнее изменение
+            const Change* change = nullptr;
+            for (size_t source = 0; source < SOURCES; ++source) {
+                if (!has[source] || keys[source] != *least) {
+                    continue;
+                }
+                if (source == 0) {
+                    m_baseElem = &(*m_sources->base)[m_pos[0]];
+                } else {
+                    const auto& changes = source == 1 ? m_sources->frozenChanges : m_sources->activeChanges;
+                    change = &std::get<N>(*changes[m_pos[source]]);
+                }
+                ++m_pos[source];
+            }
+            if (change == nullptr) {
+                return;
+            }
+            if (change->live) {
+                m_baseElem = nullptr;
+                m_elem = makeElemImpl(*least, std::make_index_sequence<N>{}, change->value);
+                return;
+            }
+        }
+    }
+
+    std::shared_ptr<const Sources> m_sources;  ///< Источники элементов
+    std::array<size_t, SOURCES> m_pos{};       ///< Позиции следующих элементов в источниках
+    const Element* m_baseElem = nullptr;       ///< Текущий элемент базы или nullptr, если он из буфера
+    Element m_elem{};                          ///< Текущий элемент буфера
+    bool m_done = true;                        ///< Признак конца
+};
+
+
+/*!
+ Создает пустую матрицу
+ @param minDelta Наименьший размер буфера изменений, при котором начинается фоновое слияние.
+  Значение 0 трактуется как 1
+ */
+template <typename T, T Default, size_t N>
+LsmMatrix<T, Default, N>::LsmMatrix(size_t minDelta)
+    : m_base{std::make_shared<const Base>()}, m_minDelta{std::max<size_t>(1, minDelta)} {}
+
+
+/*!
+@return Проксирующий класс
+*/
+template <typename T, T Default, size_t N>
+Proxy<T, N, 1, LsmMatrix<T, Default, N>> LsmMatrix<T, Default, N>::operator[](std::size_t index) {
+    Indexes<N> indexes{};
+    indexes[0] = index;
+    return {this, indexes};
+}
+
+
+/*!
+ Записывает элемент в буфер изменений. Запись Default оставляет надгробие
+ @param indexes Набор индексов
+ @param value   Записываемое значение
+ */
+template <typename T, T Default, size_t N>
+void LsmMatrix<T, Default, N>::update(const Indexes<N>& indexes, const T& value) {
+    setImpl(indexes, value);
+}
+
+
+/*!
+ Перемещает элемент в буфер изменений, см. update(const Indexes<N>&, const T&)
+ @param indexes Набор индексов
+ @param value   Перемещаемое значение
+ */
+template <typename T, T Default, size_t N>
+void LsmMatrix<T, Default, N>::update(const Indexes<N>& indexes, T&& value) {
+    setImpl(indexes, std::move(value));
+}
+
+
+/*!
+ Считывает элемент: буфер, затем замороженный буфер, затем база
+ @param indexes Набор индексов
+ @return Хранимое значение или Default
+ */
+template <typename T, T Default, size_t N>
+T LsmMatrix<T, Default, N>::get(const Indexes<N>& indexes) const {
+    poll();
+    return *lookup(makeKeyImpl(indexes, std::make_index_sequence<N>{}));
+}
+
+
+/*!
+ Ищет хранимое значение без копирования
+ @param indexes Набор индексов
+ @return Указатель на хранимое значение или nullptr, если ячейка пуста.
+  Указатель действителен до следующей записи в матрицу
+ */
+template <typename T, T Default, size_t N>
+const T* LsmMatrix<T, Default, N>::tryGet(const Indexes<N>& indexes) const {
+    poll();
+    const T* value = lookup(makeKeyImpl(indexes, std::make_index_sequence<N>{}));
+    return value != &StaticDefault<T, Default>::value() ? value : nullptr;
+}
+
+
+/*!
+@return Количество хранимых элементов. После записи пересчитывается один раз за
+ O(размер буферов * log(размер базы)) и кэшируется до следующей записи
+*/
+template <typename T, T Default, size_t N>
+size_t LsmMatrix<T, Default, N>::size() const {
+    poll();
+    if (m_sizeValid) {
+        return m_size;
+    }
+
+    const auto seq = std::make_index_sequence<N>{};
+    size_t count = m_base->size();
+    if (m_frozen) {
+        for (const auto& elem : *m_frozen) {
+            count += std::get<N>(elem).live;
+            count -= findBase(elemKeyImpl(elem, seq)) != nullptr;
+        }
+    }
+    for (const auto& elem : m_delta) {
+        const Key key = elemKeyImpl(elem, seq);
+        const Change* older = m_frozen ? findChange(*m_frozen, key) : nullptr;
+        count += std::get<N>(elem).live;
+        count -= older != nullptr ? older->live : findBase(key) != nullptr;
+    }
+
+    m_size = count;
+    m_sizeValid = true;
+    return m_size;
+}
+
+
+/*!
+@return Количество изменений в изменяемом и замороженном буферах, включая надгробия
+*/
+template <typename T, T Default, size_t N>
+size_t LsmMatrix<T, Default, N>::deltaSize() const {
+    poll();
+    return m_delta.size() + (m_frozen ? m_frozen->size() : 0);
+}
+
+
+/*!
+ Дожидается фонового слияния и синхронно сливает оставшиеся изменения в базу. После вызова
+ буферы пусты и чтение обходится одним двоичным поиском, например перед периодом только чтения
+ */
+template <typename T, T Default, size_t N>
+void LsmMatrix<T, Default, N>::compact() {
+    if (m_merge.valid()) {
+        install();
+    }
+    release();
+    if (m_delta.size() != 0) {
+        const Delta delta = std::move(m_delta);
+        m_delta = Delta{};
+        m_base = merge(*m_base, delta);
+    }
+}
+
+
+/*!
+ Создает итератор, упорядочивая изменения буферов за O(d log d), d -- deltaSize()
+@return Итератор на первый элемент
+*/
+template <typename T, T Default, size_t N>
+typename LsmMatrix<T, Default, N>::Iterator LsmMatrix<T, Default, N>::begin() const {
+    poll();
+    return Iterator{*this};
+}
+
+
+/*!
+@return Итератор на конец
+*/
+template <typename T, T Default, size_t N>
+typename LsmMatrix<T, Default, N>::Iterator LsmMatrix<T, Default, N>::end() const {
+    return Iterator{};
+}
+
+
+/*!
+ Записывает изменение в буфер и при необходимости запускает фоновое слияние.
+ База при записи не читается, поэтому стоимость записи -- вставка в хэш-таблицу
+ @param indexes Набор индексов
+ @param value   Записываемое значение, V -- const T& или T
+ */
+template <typename T, T Default, size_t N>
+template <typename V>
+void LsmMatrix<T, Default, N>::setImpl(const Indexes<N>& indexes, V&& value) {
+    release();
+    poll();
+
+    const bool live = !StaticDefault<T, Default>::isDefault(value);
+    const Key key = m_delta.makeKey(indexes);
+    const auto [exists, it] = m_delta.locate(key);
+    if (exists) {
+        Change& change = m_delta.value(it);
+        change.value = std::forward<V>(value);
+        change.live = live;
+    } else {
+        m_delta.emplace(it, key, Change{std::forward<V>(value), live});
+    }
+    m_sizeValid = false;
+
+    if (!m_merge.valid() && m_delta.size() >= std::max(m_minDelta, m_base->size() / BASE_TO_DELTA)) {
+        freeze();
+    }
+}
+
+
+/*!
+ Подхватывает результат фонового слияния, если он готов. Проверка готовности -- одна
+ атомарная загрузка, ожидания нет. Вызывается и при чтении, поэтому база не ждет следующей записи
+ */
+template <typename T, T Default, size_t N>
+void LsmMatrix<T, Default, N>::poll() const {
+    if (m_merge.valid() && m_merge.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+        install();
+    }
+}
+
+
+/*!
+ Заменяет базу результатом фонового слияния. Прежние база и замороженный буфер живут до следующей
+ записи: на них могут ссылаться указатели, полученные tryGet. Исключение, возникшее при слиянии,
+ пробрасывается отсюда
+ */
+template <typename T, T Default, size_t N>
+void LsmMatrix<T, Default, N>::install() const {
+    auto base = m_merge.get();
+    m_retiredBase = std::exchange(m_base, std::move(base));
+    m_retiredFrozen = std::exchange(m_frozen, nullptr);
+}
+
+
+/*!
+ Освобождает базу и замороженный буфер, замененные install() при чтении. Вызывается перед записью,
+ которая и так делает недействительными ранее полученные указатели
+ */
+template <typename T, T Default, size_t N>
+void LsmMatrix<T, Default, N>::release() {
+    m_retiredBase.reset();
+    m_retiredFrozen.reset();
+}
+
+
+/*!
+ Замораживает буфер и запускает его слияние с базой в отдельном потоке. Поток владеет копиями
+ указателей на базу и замороженный буфер, поэтому матрицу можно перемещать во время слияния
+ */
+template <typename T, T Default, size_t N>
+void LsmMatrix<T, Default, N>::freeze() {
+    m_frozen = std::make_shared<const Delta>(std::move(m_delta));
+    m_delta = Delta{};
+    m_merge = std::async(std::launch::async, [base = m_base, delta = m_frozen] {
+        return merge(*base, *delta);
+    });
+}
+
+
+/*!
+ Ищет изменение ячейки в буфере
+ @param delta Буфер
+ @param key   Ключ ячейки
+ @return Указатель на изменение или nullptr
+ */
+template <typename T, T Default, size_t N>
+const typename LsmMatrix<T, Default, N>::Change* LsmMatrix<T, Default, N>::findChange(const Delta& delta, const Key& key) const {
+    if (delta.size() == 0) {
+        return nullptr;
+    }
+    const auto [exists, it] = delta.locate(key);
+    return exists ? &delta.value(it) : nullptr;
+}
+
+
+/*!
+ Ищет элемент в базе двоичным поиском
+ @param key Ключ ячейки
+ @return Указатель на элемент или nullptr
+ */
+template <typename T, T Default, size_t N>
+const typename LsmMatrix<T, Default, N>::Element* LsmMatrix<T, Default, N>::findBase(const Key& key) const {
+    const auto seq = std::make_index_sequence<N>{};
+    const auto it = std::lower_bound(m_base->begin(), m_base->end(), key, [seq](const Element& elem, const Key& value) {
+        return elemKeyTieImpl(elem, seq) < value;
+    });
+    return it != m_base->end() && elemKeyTieImpl(*it, seq) == key ? &*it : nullptr;
+}
+
+
+/*!
+ Ищет значение ячейки: более позднее изменение перекрывает более раннее
+ @param key Ключ ячейки
+ @return Указатель на значение. Для пустой ячейки и надгробия -- на StaticDefault::value()
+ */
+template <typename T, T Default, size_t N>
+const T* LsmMatrix<T, Default, N>::lookup(const Key& key) const {
+    const Change* change = findChange(m_delta, key);
+    if (change == nullptr && m_frozen) {
+        change = findChange(*m_frozen, key);
+    }
+    if (change != nullptr) {
+        return change->live ? &change->value : &StaticDefault<T, Default>::value();
+    }
+    const Element* elem = findBase(key);
+    return elem != nullptr ? &std::get<N>(*elem) : &StaticDefault<T, Default>::value();
+}
+
+
+/*!
+ Упорядочивает изменения буфера по индексам, не копируя их
+ @param delta Буфер
+ @return Указатели на изменения буфера по возрастанию индексов
+ */
+template <typename T, T Default, size_t N>
+std::vector<const typename LsmMatrix<T, Default, N>::Changed*> LsmMatrix<T, Default, N>::sorted(const Delta& delta) {
+    std::vector<const Changed*> changes;
+    changes.reserve(delta.size());
+    for (const auto& elem : delta) {
+        changes.push_back(&elem);
+    }
+    std::sort(changes.begin(), changes.end(), [](const Changed* lhs, const Changed* rhs) {
+        return ElementKeyLess<N>{}(*lhs, *rhs);
+    });
+    return changes;
+}
+
+
+/*!
+ Сливает буфер с базой: изменения упорядочиваются и проходятся вместе с базой за один проход,
+ изменение заменяет элемент базы с тем же ключом, надгробия отбрасываются
+ @param base  База
+ @param delta Буфер
+ @return Новая база
+ */
+template <typename T, T Default, size_t N>
+std::shared_ptr<const typename LsmMatrix<T, Default, N>::Base> LsmMatrix<T, Default, N>::merge(const Base& base, const Delta& delta) {
+    const auto seq = std::make_index_sequence<N>{};
+    const std::vector<const Changed*> changes = sorted(delta);
+
+    auto result = std::make_shared<Base>();
+    result->reserve(base.size() + changes.size());
+    auto it = base.begin();
+    for (const Changed* changed : changes) {
+        const auto key = elemKeyTieImpl(*changed, seq);
+        for (; it != base.end() && elemKeyTieImpl(*it, seq) < key; ++it) {
+            result->push_back(*it);
+        }
+        if (it != base.end() && elemKeyTieImpl(*it, seq) == key) {
+            ++it;
+        }
+        const Change& change = std::get<N>(*changed);
+        if (change.live) {
+            result->push_back(makeElemImpl(key, seq, change.value));
+        }
+    }
+    result->insert(result->end(), it, base.end());
+    return result;
+}
@@ -0,0 +1,148 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией класса, отображающего файл в память
+*/
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MATRIX_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define MATRIX_HAS_MMAP 0
+#endif
+
+/*!
+ @brief RAII-обертка над отображением файла в память (mmap)
+ @details Файл отображается целиком. Объект можно перемещать, но нельзя копировать.
+ */
+class MappedFile {
+public:
+    /// Режим отображения
+    enum class Mode {
+        READ_ONLY, ///< Только чтение
+        READ_WRITE ///< Чтение и запись, изменения попадают в файл
+    };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path, Mode mode = Mode::READ_ONLY);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const; ///< Возвращает начало отображения
+    unsigned char* data();             ///< Возвращает начало отображения для записи
+    size_t size() const;               ///< Возвращает размер файла
+
+private:
+    void unmap(); ///< Снимает отображение
+
+    unsigned char* m_data = nullptr; ///< Начало отображения
+    size_t m_size = 0;               ///< Размер отображения
+};
+
+
+/*!
+ Отображает файл в память
+ @param path Путь к файлу
+ @param mode Режим отображения
+ @throw std::runtime_error Если файл не удалось открыть или отобразить
+ */
+inline MappedFile::MappedFile(const std::string& path, Mode mode) {
+#if MATRIX_HAS_MMAP
+    const bool writable = mode == Mode::READ_WRITE;
+    const int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can not open file " + path);
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Can not stat file " + path);
+    }
+    m_size = static_cast<size_t>(info.st_size);
+
+    if (m_size != 0) {
+        void* data = ::mmap(nullptr, m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Can not map file " + path);
+        }
+        m_data = static_cast<unsigned char*>(data);
+    }
+    ::close(fd);
+#else
+    (void)path;
+    (void)mode;
+    throw std::runtime_error("Memory mapped files are not supported on this platform");
+#endif
+}
+
+
+/*!
+ Снимает отображение
+ */
+inline MappedFile::~MappedFile() {
+    unmap();
+}
+
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data{std::exchange(other.m_data, nullptr)}, m_size{std::exchange(other.m_size, 0)} {}
+
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+
+/*!
+@return Начало отображения
+*/
+inline const unsigned char* MappedFile::data() const {
+    return m_data;
+}
+
+
+/*!
+@return Начало отображения для записи, если файл отображен в режиме READ_WRITE
+*/
+inline unsigned char* MappedFile::data() {
+    return m_data;
+}
+
+
+/*!
+@return Размер файла в байтах
+*/
+inline size_t MappedFile::size() const {
+    return m_size;
+}
+
+
+inline void MappedFile::unmap() {
+#if MATRIX_HAS_MMAP
+    if (m_data != nullptr) {
+        ::munmap(m_data, m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
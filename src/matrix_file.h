@@ -0,0 +1,346 @@
+/*!
+@file
+@brief Заголовочный файл с двоичным форматом хранения разреженной матрицы на диске,
+ функцией записи и классом MappedMatrix, читающим матрицу напрямую из отображенного в память файла
+*/
+
+#pragma once
+
+#include "sparse_matrix.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+
+/*!
+ @brief Заголовок файла матрицы
+ @details Файл состоит из заголовка, значения по умолчанию (sizeof(T) байт), массива ключей
+  (count * N беззнаковых 64-битных индексов, упорядоченных лексикографически) и массива значений
+  (count значений типа T). Смещения ключей и значений выровнены на MATRIX_FILE_ALIGNMENT.
+  Числа хранятся в порядке байт машины, записавшей файл.
+ */
+struct MatrixFileHeader {
+    char magic[8];                ///< Сигнатура MATRIX_FILE_MAGIC
+    std::uint32_t version;        ///< Версия формата
+    std::uint32_t dimension;      ///< Размерность матрицы N
+    std::uint64_t value_size;     ///< sizeof(T)
+    std::uint64_t count;          ///< Количество хранимых элементов
+    std::uint64_t default_offset; ///< Смещение значения по умолчанию
+    std::uint64_t keys_offset;    ///< Смещение массива ключей
+    std::uint64_t values_offset;  ///< Смещение массива значений
+    std::uint64_t reserved;       ///< Зарезервировано, равно 0
+};
+
+static_assert(sizeof(MatrixFileHeader) == 64, "Matrix file header must be 64 bytes");
+
+/// @brief сигнатура файла матрицы
+constexpr char MATRIX_FILE_MAGIC[8] = {'S', 'P', 'M', 'A', 'T', 'R', 'I', 'X'};
+/// @brief текущая версия формата
+constexpr std::uint32_t MATRIX_FILE_VERSION = 1;
+/// @brief выравнивание массивов в файле
+constexpr std::uint64_t MATRIX_FILE_ALIGNMENT = 64;
+
+
+namespace detail {
+
+/// Округляет смещение вверх до MATRIX_FILE_ALIGNMENT
+inline std::uint64_t alignOffset(std::uint64_t offset) {
+    return (offset + MATRIX_FILE_ALIGNMENT - 1) / MATRIX_FILE_ALIGNMENT * MATRIX_FILE_ALIGNMENT;
+}
+
+/// Дописывает нули до смещения offset
+inline void padTo(std::ofstream& out, std::uint64_t offset) {
+    static const char zeros[MATRIX_FILE_ALIGNMENT] = {};
+    const auto position = static_cast<std::uint64_t>(out.tellp());
+    out.write(zeros, static_cast<std::streamsize>(offset - position));
+}
+
+/*!
+ Пирамидальная сортировка записей прямо в отображенном файле: не требует дополнительной памяти,
+ ключи и значения переставляются согласованно
+ */
+template <typename T, size_t N>
+void sortRecords(std::uint64_t* keys, T* values, size_t count) {
+    const auto less = [keys](size_t a, size_t b) {
+        return std::lexicographical_compare(keys + a * N, keys + a * N + N, keys + b * N, keys + b * N + N);
+    };
+    const auto swap = [keys, values](size_t a, size_t b) {
+        std::swap_ranges(keys + a * N, keys + a * N + N, keys + b * N);
+        std::swap(values[a], values[b]);
+    };
+    const auto sift = [&](size_t root, size_t size) {
+        for (size_t child = 2 * root + 1; child < size; child = 2 * root + 1) {
+            if (child + 1 < size && less(child, child + 1)) {
+                ++child;
+            }
+            if (!less(root, child)) {
+                return;
+            }
+            swap(root, child);
+            root = child;
+        }
+    };
+
+    for (size_t root = count / 2; root-- > 0;) {
+        sift(root, count);
+    }
+    for (size_t size = count; size > 1; --size) {
+        swap(0, size - 1);
+        sift(0, size - 1);
+    }
+}
+
+}
+
+
+/*!
+ Записывает матрицу в файл. Ключи и значения пишутся потоком прямо из Matrix::begin()/end(),
+ второй копии матрицы в памяти не создается. Если порядок итерирования не совпадает с порядком
+ ключей, записанный файл упорядочивается на месте через отображение в память.
+ @param matrix Матрица
+ @param path   Путь к файлу, существующий файл перезаписывается
+ @throw std::runtime_error В случае ошибки ввода-вывода
+ */
+template <typename T, T Default, size_t N, typename Storage, typename Stats, typename Probe>
+void writeMatrix(const BasicMatrix<T, N, Storage, StaticDefault<T, Default>, Stats, Probe>& matrix, const std::string& path) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written");
+
+    MatrixFileHeader header{};
+    std::copy(std::begin(MATRIX_FILE_MAGIC), std::end(MATRIX_FILE_MAGIC), header.magic);
+    header.version        = MATRIX_FILE_VERSION;
+    header.dimension      = static_cast<std::uint32_t>(N);
+    header.value_size     = sizeof(T);
+    header.count          = matrix.size();
+    header.default_offset = sizeof(MatrixFileHeader);
+    header.keys_offset    = detail::alignOffset(header.default_offset + sizeof(T));
+    header.values_offset  = detail::alignOffset(header.keys_offset + header.count * N * sizeof(std::uint64_t));
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    if (!out) {
+        throw std::runtime_error("Can not create file " + path);
+    }
+
+    const T default_value = Default;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&default_value), sizeof(T));
+    detail::padTo(out, header.keys_offset);
+
+    bool sorted = true;
+    size_t written = 0;
+    std::uint64_t previous[N] = {};
+    for (const auto& element : matrix) {
+        std::uint64_t key[N];
+        std::apply([&key](const auto&... items) {
+            size_t i = 0;
+            ((key[i++] = static_cast<std::uint64_t>(items)), ...);
+        }, elemKeyImpl(element, std::make_index_sequence<N>{}));
+
+        if (written != 0 && sorted && !std::lexicographical_compare(previous, previous + N, key, key + N)) {
+            sorted = false;
+        }
+        std::copy(key, key + N, previous);
+        out.write(reinterpret_cast<const char*>(key), sizeof(key));
+        ++written;
+    }
+    detail::padTo(out, header.values_offset);
+
+    for (const auto& element : matrix) {
+        const T& value = std::get<N>(element);
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    out.close();
+    if (!out || written != header.count) {
+        throw std::runtime_error("Can not write file " + path);
+    }
+
+    if (!sorted) {
+        MappedFile file{path, MappedFile::Mode::READ_WRITE};
+        detail::sortRecords<T, N>(reinterpret_cast<std::uint64_t*>(file.data() + header.keys_offset),
+                                  reinterpret_cast<T*>(file.data() + header.values_offset),
+                                  static_cast<size_t>(header.count));
+    }
+}
+
+
+/*!
+ @brief Неизменяемая матрица, читающая элементы напрямую из отображенного в память файла
+ @details Открытие не копирует данные: get() выполняет двоичный поиск по массиву ключей файла,
+  итерирование возвращает элементы в порядке ключей.
+ @tparam T тип хранимого элемента
+ @tparam Default значение хранимого элемента по умолчанию
+ @tparam N размерность матрицы
+ */
+template <typename T, T Default, size_t N>
+class MappedMatrix {
+public:
+    /// @brief тип элемента, возвращаемого при итерировании
+    using Element = ElementType<T, N>;
+
+    class Iterator;
+
+    explicit MappedMatrix(const std::string& path);
+
+    T get(const Indexes<N>& indexes) const; ///< Считывает элемент из ячейки с переданными индексами
+    size_t size() const;                    ///< Возвращает количество хранимых элементов
+
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    Element element(size_t position) const; ///< Собирает элемент по номеру записи
+
+    MappedFile m_file;                      ///< Отображенный файл
+    const std::uint64_t* m_keys = nullptr;  ///< Массив ключей в файле
+    const T* m_values = nullptr;            ///< Массив значений в файле
+    size_t m_count = 0;                     ///< Количество элементов
+};
+
+
+/*!
+ @brief Итератор по элементам MappedMatrix
+ @details Разыменование возвращает Element по значению, structured bindings работают как с Matrix
+ */
+template <typename T, T Default, size_t N>
+class MappedMatrix<T, Default, N>::Iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = Element;
+
+    Iterator(const MappedMatrix* matrix, size_t position) : m_matrix{matrix}, m_position{position} {}
+
+    reference operator*() const { return m_matrix->element(m_position); }
+    Iterator& operator++() { ++m_position; return *this; }
+    Iterator operator++(int) { Iterator tmp = *this; ++m_position; return tmp; }
+    bool operator==(const Iterator& other) const { return m_position == other.m_position; }
+    bool operator!=(const Iterator& other) const { return m_position != other.m_position; }
+
+private:
+    const MappedMatrix* m_matrix; ///< Итерируемая матрица
+    size_t m_position;            ///< Номер текущей записи
+};
+
+
+/*!
+ Отображает файл матрицы в память и проверяет заголовок
+ @param path Путь к файлу, записанному writeMatrix
+ @throw std::runtime_error Если файл поврежден или записан для другого T, N или Default
+ */
+template <typename T, T Default, size_t N>
+MappedMatrix<T, Default, N>::MappedMatrix(const std::string& path) : m_file{path} {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be mapped");
+
+    MatrixFileHeader header{};
+    if (m_file.size() < sizeof(header)) {
+        throw std::runtime_error("File is too small for matrix header");
+    }
+    std::memcpy(&header, m_file.data(), sizeof(header));
+
+    if (!std::equal(std::begin(MATRIX_FILE_MAGIC), std::end(MATRIX_FILE_MAGIC), header.magic)) {
+        throw std::runtime_error("File is not a matrix file");
+    }
+    if (header.version != MATRIX_FILE_VERSION) {
+        throw std::runtime_error("Unsupported matrix file version " + std::to_string(header.version));
+    }
+    if (header.dimension != N || header.value_size != sizeof(T)) {
+        throw std::runtime_error("Matrix file dimension or value size mismatch");
+    }
+
+    // сравнения построены на делении, а не на умножении, чтобы поврежденный count не переполнял проверку
+    const std::uint64_t size = m_file.size();
+    if (header.keys_offset % alignof(std::uint64_t) != 0 || header.values_offset % alignof(T) != 0 ||
+        header.keys_offset > header.values_offset || header.values_offset > size ||
+        header.count > (header.values_offset - header.keys_offset) / (N * sizeof(std::uint64_t)) ||
+        header.count > (size - header.values_offset) / sizeof(T) ||
+        header.default_offset > size || size - header.default_offset < sizeof(T)) {
+        throw std::runtime_error("Matrix file is truncated or corrupted");
+    }
+
+    const T default_value = Default;
+    if (std::memcmp(m_file.data() + header.default_offset, &default_value, sizeof(T)) != 0) {
+        throw std::runtime_error("Matrix file default value mismatch");
+    }
+
+    m_keys   = reinterpret_cast<const std::uint64_t*>(m_file.data() + header.keys_offset);
+    m_values = reinterpret_cast<const T*>(m_file.data() + header.values_offset);
+    m_count  = static_cast<size_t>(header.count);
+}
+
+
+/*!
+ Считывает элемент двоичным поиском по массиву ключей
+ @param indexes Набор индексов
+ @return Хранимое значение или Default
+ */
+template <typename T, T Default, size_t N>
+T MappedMatrix<T, Default, N>::get(const Indexes<N>& indexes) const {
+    std::uint64_t key[N];
+    std::copy(indexes.begin(), indexes.end(), key);
+
+    size_t first = 0;
+    size_t count = m_count;
+    while (count > 0) {
+        const size_t step = count / 2;
+        const std::uint64_t* middle = m_keys + (first + step) * N;
+        if (std::lexicographical_compare(middle, middle + N, key, key + N)) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+
+    if (first == m_count || !std::equal(key, key + N, m_keys + first * N)) {
+        return Default;
+    }
+    return m_values[first];
+}
+
+
+/*!
+@return Количество хранимых элементов
+*/
+template <typename T, T Default, size_t N>
+size_t MappedMatrix<T, Default, N>::size() const {
+    return m_count;
+}
+
+
+/*!
+@return Итератор на начало диапазона элементов
+*/
+template <typename T, T Default, size_t N>
+typename MappedMatrix<T, Default, N>::Iterator MappedMatrix<T, Default, N>::begin() const {
+    return {this, 0};
+}
+
+
+/*!
+@return Итератор на конец диапазона элементов
+*/
+template <typename T, T Default, size_t N>
+typename MappedMatrix<T, Default, N>::Iterator MappedMatrix<T, Default, N>::end() const {
+    return {this, m_count};
+}
+
+
+/*!
+ Собирает элемент по номеру записи
+ @param position Номер записи
+ @return Элемент (индекс_1, ..., индекс_N, значение)
+ */
+template <typename T, T Default, size_t N>
+typename MappedMatrix<T, Default, N>::Element MappedMatrix<T, Default, N>::element(size_t position) const {
+    Indexes<N> indexes;
+    std::copy(m_keys + position * N, m_keys + position * N + N, indexes.begin());
+    return makeElemImpl(indexes, std::make_index_sequence<N>{}, m_values[position]);
+}
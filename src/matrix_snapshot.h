@@ -0,0 +1,143 @@
+/*!
+@file
+@brief Заголовочный файл с версией матрицы только для чтения, см. BasicMatrix::snapshot()
+*/
+
+#pragma once
+
+#include "indexes.h"
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+/*!
+ @brief Версия матрицы только для чтения
+ @details Хранит копию матрицы с copy-on-write хранилищем (например, CowData), поэтому создание и
+  копирование версии стоят O(1), а неизмененные страницы остаются общими с матрицей. Интерфейс
+  записи не предоставляется: версия не изменяется, пока жива. Для остальных операций чтения
+  (range(), ordered(), stats(), свободные функции) есть matrix(), а изменяемую копию
+  версии дает копирование matrix() -- тоже за O(1).
+ @tparam Matrix матрица, версия которой хранится
+ */
+template <typename Matrix>
+class MatrixSnapshot {
+public:
+    /// @brief тип элемента: N индексов и значение
+    using Element = typename Matrix::Element;
+
+    /// @brief итератор по элементам версии
+    using Iterator = typename Matrix::Iterator;
+
+    /// @brief размерность матрицы
+    static constexpr size_t N = std::tuple_size_v<Element> - 1;
+
+    /// @brief тип хранимого значения
+    using Value = std::tuple_element_t<N, Element>;
+
+    explicit MatrixSnapshot(Matrix matrix);
+
+    Value get(const Indexes<N>& indexes) const;             ///< Считывает элемент из ячейки с переданными индексами
+    template <typename... I>
+    Value operator()(I... indexes) const;                   ///< Считывает элемент по N индексам
+    const Value* tryGet(const Indexes<N>& indexes) const;   ///< Возвращает указатель на хранимое значение или nullptr
+    Iterator find(const Indexes<N>& indexes) const;         ///< Находит хранимый элемент, end() если его нет
+
+    Iterator begin() const;
+    Iterator end() const;
+    size_t size() const;        ///< Возвращает количество хранимых элементов
+    Value defaultValue() const; ///< Возвращает значение по умолчанию
+
+    const Matrix& matrix() const; ///< Возвращает матрицу версии для остальных операций чтения
+
+private:
+    Matrix m_matrix; ///< Копия матрицы, разделяющая с ней хранилище
+};
+
+
+/*!
+ @param matrix Копия матрицы, разделяющая с ней хранилище
+ */
+template <typename Matrix>
+MatrixSnapshot<Matrix>::MatrixSnapshot(Matrix matrix) : m_matrix{std::move(matrix)} {
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return Хранимое значение или Default
+ */
+template <typename Matrix>
+typename MatrixSnapshot<Matrix>::Value MatrixSnapshot<Matrix>::get(const Indexes<N>& indexes) const {
+    return m_matrix.get(indexes);
+}
+
+
+/*!
+ @param indexes Индексы, приводимые к size_t, ровно N штук
+ @return Хранимое значение или Default
+ */
+template <typename Matrix>
+template <typename... I>
+typename MatrixSnapshot<Matrix>::Value MatrixSnapshot<Matrix>::operator()(I... indexes) const {
+    return m_matrix(indexes...);
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return Указатель на хранимое значение или nullptr, действителен, пока жива версия
+ */
+template <typename Matrix>
+const typename MatrixSnapshot<Matrix>::Value* MatrixSnapshot<Matrix>::tryGet(const Indexes<N>& indexes) const {
+    return m_matrix.tryGet(indexes);
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return Итератор на элемент или end()
+ */
+template <typename Matrix>
+typename MatrixSnapshot<Matrix>::Iterator MatrixSnapshot<Matrix>::find(const Indexes<N>& indexes) const {
+    return m_matrix.find(indexes);
+}
+
+
+template <typename Matrix>
+typename MatrixSnapshot<Matrix>::Iterator MatrixSnapshot<Matrix>::begin() const {
+    return m_matrix.begin();
+}
+
+
+template <typename Matrix>
+typename MatrixSnapshot<Matrix>::Iterator MatrixSnapshot<Matrix>::end() const {
+    return m_matrix.end();
+}
+
+
+/*!
+ @return Количество хранимых элементов
+ */
+template <typename Matrix>
+size_t MatrixSnapshot<Matrix>::size() const {
+    return m_matrix.size();
+}
+
+
+/*!
+ @return Значение по умолчанию
+ */
+template <typename Matrix>
+typename MatrixSnapshot<Matrix>::Value MatrixSnapshot<Matrix>::defaultValue() const {
+    return m_matrix.defaultValue();
+}
+
+
+/*!
+ @return Матрица версии, действительна, пока жива версия
+ */
+template <typename Matrix>
+const Matrix& MatrixSnapshot<Matrix>::matrix() const {
+    return m_matrix;
+}
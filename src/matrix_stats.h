@@ -0,0 +1,216 @@
+/*!
+@file
+@brief Заголовочный файл со стратегиями статистики, которую BasicMatrix поддерживает при каждом изменении
+*/
+
+#pragma once
+
+#include "indexes.h"
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+/*!
+ @brief Статистика не собирается
+ @details Пустой класс: BasicMatrix проверяет ENABLED на этапе компиляции и не вызывает
+  обработчики, поэтому изменения матрицы ничего не стоят
+ */
+struct NoStats {
+    static constexpr bool ENABLED = false; ///< Признак того, что статистика собирается
+};
+
+
+/*!
+ @brief Статистика хранимых (не равных значению по умолчанию) элементов матрицы
+ @details Обновляется BasicMatrix при вставке, перезаписи и удалении элемента, запросы -- O(1):
+  - count() и sum() -- количество и сумма хранимых элементов;
+  - nnz(dimension, index) -- количество хранимых элементов с indexes[dimension] == index,
+    nnz(0, i) -- элементов в строке i, nnz(1, j) -- в столбце j;
+  - min() и max() при EXTREMES == true. Экстремумы поддерживаются лениво: вставка расширяет их
+    за O(1), а удаление или перезапись текущего экстремума помечает их устаревшими, и первый
+    следующий вызов BasicMatrix::stats() пересчитывает их проходом по элементам за O(nnz).
+    Стоимость амортизирована только при редких изменениях экстремумов; при чередовании удаления
+    максимума и stats() каждый вызов stats() стоит O(nnz).
+  Пересчет изменяет mutable поля, поэтому stats() нельзя вызывать одновременно из нескольких
+  потоков даже у константной матрицы, если EXTREMES == true.
+ @tparam T тип хранимого элемента
+ @tparam N размерность матрицы
+ @tparam EXTREMES поддерживать ли min() и max()
+ */
+template <typename T, size_t N, bool EXTREMES = false>
+class MatrixStats {
+public:
+    static constexpr bool ENABLED = true; ///< Признак того, что статистика собирается
+
+    size_t count() const;                              ///< Возвращает количество хранимых элементов
+    const T& sum() const;                              ///< Возвращает сумму хранимых элементов
+    size_t nnz(size_t dimension, size_t index) const;  ///< Возвращает количество элементов в срезе indexes[dimension] == index
+    const T& min() const;                              ///< Возвращает наименьший хранимый элемент
+    const T& max() const;                              ///< Возвращает наибольший хранимый элемент
+
+    void onInsert(const Indexes<N>& indexes, const T& value);   ///< Учитывает добавленный элемент
+    void onOverwrite(const T& old, const T& value);             ///< Учитывает перезапись элемента
+    void onErase(const Indexes<N>& indexes, const T& old);      ///< Учитывает удаленный элемент
+
+    template <typename InputIt>
+    void refresh(InputIt first, InputIt last) const;            ///< Пересчитывает устаревшие экстремумы
+
+private:
+    void extend(const T& value) const; ///< Расширяет экстремумы значением
+
+    size_t m_count = 0;                                         ///< Количество хранимых элементов
+    T m_sum{};                                                  ///< Сумма хранимых элементов
+    std::array<std::unordered_map<size_t, size_t>, N> m_slices; ///< Количество элементов в срезах по каждому измерению
+    mutable T m_min{};                                          ///< Наименьший элемент
+    mutable T m_max{};                                          ///< Наибольший элемент
+    mutable bool m_stale = false;                               ///< Экстремумы нужно пересчитать
+};
+
+
+/*!
+@return Количество хранимых элементов
+*/
+template <typename T, size_t N, bool EXTREMES>
+size_t MatrixStats<T, N, EXTREMES>::count() const {
+    return m_count;
+}
+
+
+/*!
+@return Сумма хранимых элементов, T{} для пустой матрицы
+*/
+template <typename T, size_t N, bool EXTREMES>
+const T& MatrixStats<T, N, EXTREMES>::sum() const {
+    return m_sum;
+}
+
+
+/*!
+ @param dimension Номер измерения, меньше N
+ @param index     Значение индекса в этом измерении
+ @return Количество хранимых элементов с indexes[dimension] == index
+ */
+template <typename T, size_t N, bool EXTREMES>
+size_t MatrixStats<T, N, EXTREMES>::nnz(size_t dimension, size_t index) const {
+    const auto& slices = m_slices.at(dimension);
+    const auto it = slices.find(index);
+    return it != slices.end() ? it->second : 0;
+}
+
+
+/*!
+@return Наименьший хранимый элемент, T{} для пустой матрицы. Действителен после BasicMatrix::stats()
+*/
+template <typename T, size_t N, bool EXTREMES>
+const T& MatrixStats<T, N, EXTREMES>::min() const {
+    static_assert(EXTREMES, "MatrixStats::min requires EXTREMES = true");
+    return m_min;
+}
+
+
+/*!
+@return Наибольший хранимый элемент, T{} для пустой матрицы. Действителен после BasicMatrix::stats()
+*/
+template <typename T, size_t N, bool EXTREMES>
+const T& MatrixStats<T, N, EXTREMES>::max() const {
+    static_assert(EXTREMES, "MatrixStats::max requires EXTREMES = true");
+    return m_max;
+}
+
+
+/*!
+ @param indexes Индексы добавленного элемента
+ @param value   Значение добавленного элемента
+ */
+template <typename T, size_t N, bool EXTREMES>
+void MatrixStats<T, N, EXTREMES>::onInsert(const Indexes<N>& indexes, const T& value) {
+    ++m_count;
+    m_sum += value;
+    for (size_t d = 0; d < N; ++d) {
+        ++m_slices[d][indexes[d]];
+    }
+    if constexpr (EXTREMES) {
+        extend(value);
+    }
+}
+
+
+/*!
+ @param old   Прежнее значение элемента
+ @param value Новое значение элемента
+ */
+template <typename T, size_t N, bool EXTREMES>
+void MatrixStats<T, N, EXTREMES>::onOverwrite(const T& old, const T& value) {
+    m_sum -= old;
+    m_sum += value;
+    if constexpr (EXTREMES) {
+        m_stale = m_stale || (old == m_min && m_min < value) || (old == m_max && value < m_max);
+        extend(value);
+    }
+}
+
+
+/*!
+ @param indexes Индексы удаленного элемента
+ @param old     Значение удаленного элемента
+ */
+template <typename T, size_t N, bool EXTREMES>
+void MatrixStats<T, N, EXTREMES>::onErase(const Indexes<N>& indexes, const T& old) {
+    --m_count;
+    m_sum -= old;
+    for (size_t d = 0; d < N; ++d) {
+        auto it = m_slices[d].find(indexes[d]);
+        if (--it->second == 0) {
+            m_slices[d].erase(it);
+        }
+    }
+    if constexpr (EXTREMES) {
+        m_stale = m_stale || old == m_min || old == m_max;
+    }
+}
+
+
+/*!
+ Пересчитывает экстремумы, если удаление или перезапись сделали их устаревшими
+ @param first Начало элементов матрицы
+ @param last  Конец элементов матрицы
+ */
+template <typename T, size_t N, bool EXTREMES>
+template <typename InputIt>
+void MatrixStats<T, N, EXTREMES>::refresh(InputIt first, InputIt last) const {
+    if constexpr (EXTREMES) {
+        if (!m_stale) {
+            return;
+        }
+        m_stale = false;
+        m_min = m_max = T{};
+        bool empty = true;
+        for (; first != last; ++first) {
+            const T& value = std::get<N>(*first);
+            if (empty) {
+                m_min = m_max = value;
+                empty = false;
+            }
+            extend(value);
+        }
+    }
+}
+
+
+template <typename T, size_t N, bool EXTREMES>
+void MatrixStats<T, N, EXTREMES>::extend(const T& value) const {
+    if (m_stale) {
+        return;
+    }
+    if (m_count == 1) {
+        m_min = m_max = value;
+    }
+    if (value < m_min) {
+        m_min = value;
+    }
+    if (m_max < value) {
+        m_max = value;
+    }
+}
@@ -0,0 +1,222 @@
+/*!
+@file
+@brief Заголовочный файл с умножением разреженной матрицы на вектор (SpMV)
+ и на матрицу (SpMM) для матриц в формате CSR
+*/
+
+#pragma once
+
+#include "csr_matrix.h"
+#include "thread_pool.h"
+#include "simd.h"
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+/*!
+ @brief Плотная матрица, хранящаяся построчно
+ @tparam T тип элементов
+ */
+template <typename T>
+struct DenseMatrix {
+    size_t rows = 0;      ///< Количество строк
+    size_t columns = 0;   ///< Количество столбцов
+    std::vector<T> data;  ///< Элементы, строка за строкой
+
+    DenseMatrix() = default;
+    DenseMatrix(size_t rows_, size_t columns_) : rows{rows_}, columns{columns_}, data(rows_ * columns_) {}
+
+    T& operator()(size_t row, size_t column) { return data[row * columns + column]; }
+    const T& operator()(size_t row, size_t column) const { return data[row * columns + column]; }
+};
+
+
+namespace detail {
+
+/*!
+ Делит непустые строки матрицы на parts частей с примерно равным количеством элементов.
+ Разбиение зависит только от структуры матрицы и parts.
+ @param offsets Начала непустых строк матрицы
+ @param parts   Количество частей
+ @return Границы частей, размер parts + 1
+ */
+inline std::vector<size_t> splitRows(const std::vector<size_t>& offsets, size_t parts) {
+    const size_t rows = offsets.size() - 1;
+    const size_t nnz  = offsets.back();
+
+    std::vector<size_t> bounds(parts + 1, rows);
+    bounds[0] = 0;
+    for (size_t part = 1; part < parts; ++part) {
+        const size_t target = nnz * part / parts;
+        const auto it = std::lower_bound(offsets.begin(), offsets.end(), target);
+        bounds[part] = std::max(bounds[part - 1], static_cast<size_t>(it - offsets.begin()));
+        bounds[part] = std::min(bounds[part], rows);
+    }
+    return bounds;
+}
+
+}
+
+
+/*!
+ Умножает разреженную матрицу на плотный вектор: y = A * x.
+ Строки распределяются между потоками пула, каждая строка целиком считается одним потоком,
+ поэтому результат не зависит от количества потоков и определяется только набором инструкций level.
+ @param matrix Матрица в формате CSR
+ @param x      Плотный вектор длиной не меньше matrix.columns()
+ @param pool   Пул потоков
+ @param level  Набор инструкций, по умолчанию лучший доступный
+ @return Вектор длиной matrix.rows()
+ @throw std::invalid_argument Если вектор короче количества столбцов матрицы
+ */
+template <typename T, T Default>
+std::vector<T> multiply(const CSRMatrix<T, Default>& matrix, const std::vector<T>& x,
+                        ThreadPool& pool, SimdLevel level = detectSimdLevel()) {
+    static_assert(Default == T{}, "Multiplication requires zero default value");
+
+    if (x.size() < matrix.columns()) {
+        throw std::invalid_argument("Vector is shorter than matrix columns count");
+    }
+
+    const auto& rows = matrix.lineIds();
+    const auto& offsets = matrix.offsets();
+    const size_t* indexes = matrix.indexes().data();
+    const T* values = matrix.values().data();
+
+    std::vector<T> y(matrix.rows());
+    const auto bounds = detail::splitRows(offsets, pool.size());
+
+    pool.run(pool.size(), [&](size_t part) {
+        for (size_t line = bounds[part]; line < bounds[part + 1]; ++line) {
+            const size_t first = offsets[line];
+            y[rows[line]] = simd::dot(level, indexes + first, values + first, offsets[line + 1] - first, x.data());
+        }
+    });
+    return y;
+}
+
+
+/*!
+ Умножает разреженную матрицу на плотную: C = A * B.
+ Каждая строка результата накапливается одним потоком как сумма строк B, взятых с весами из строки A.
+ @param matrix Матрица в формате CSR
+ @param dense  Плотная матрица, количество строк не меньше matrix.columns()
+ @param pool   Пул потоков
+ @param level  Набор инструкций, по умолчанию лучший доступный
+ @return Плотная матрица размера matrix.rows() x dense.columns
+ @throw std::invalid_argument Если размеры матриц не согласованы
+ */
+template <typename T, T Default>
+DenseMatrix<T> multiply(const CSRMatrix<T, Default>& matrix, const DenseMatrix<T>& dense,
+                        ThreadPool& pool, SimdLevel level = detectSimdLevel()) {
+    static_assert(Default == T{}, "Multiplication requires zero default value");
+
+    if (dense.rows < matrix.columns()) {
+        throw std::invalid_argument("Dense matrix has fewer rows than sparse matrix columns");
+    }
+
+    const auto& rows    = matrix.lineIds();
+    const auto& offsets = matrix.offsets();
+    const auto& indexes = matrix.indexes();
+    const auto& values  = matrix.values();
+
+    DenseMatrix<T> result{matrix.rows(), dense.columns};
+    const auto bounds = detail::splitRows(offsets, pool.size());
+
+    pool.run(pool.size(), [&](size_t part) {
+        for (size_t line = bounds[part]; line < bounds[part + 1]; ++line) {
+            T* y = result.data.data() + rows[line] * dense.columns;
+            for (size_t i = offsets[line]; i < offsets[line + 1]; ++i) {
+                simd::axpy(level, values[i], dense.data.data() + indexes[i] * dense.columns, y, dense.columns);
+            }
+        }
+    });
+    return result;
+}
+
+
+/*!
+ Умножает две разреженные матрицы: C = A * B (алгоритм Густавсона).
+ Каждый поток накапливает свои строки в плотном аккумуляторе длиной rhs.columns(), затем
+ части склеиваются в порядке строк. Внутри строки результата элементы упорядочены по столбцу,
+ нулевые суммы не сохраняются.
+ @param lhs  Левая матрица в формате CSR
+ @param rhs  Правая матрица в формате CSR
+ @param pool Пул потоков
+ @return Произведение в формате CSR
+ */
+template <typename T, T Default>
+CSRMatrix<T, Default> multiply(const CSRMatrix<T, Default>& lhs, const CSRMatrix<T, Default>& rhs,
+                               ThreadPool& pool) {
+    static_assert(Default == T{}, "Multiplication requires zero default value");
+
+    const auto& rows    = lhs.lineIds();
+    const auto& offsets = lhs.offsets();
+    const auto& indexes = lhs.indexes();
+    const auto& values  = lhs.values();
+    const size_t columns = lhs.size() == 0 ? 0 : rhs.columns();
+    const size_t parts = pool.size();
+    const auto bounds = detail::splitRows(offsets, parts);
+
+    std::vector<std::vector<size_t>> part_counts(parts);
+    std::vector<std::vector<size_t>> part_indexes(parts);
+    std::vector<std::vector<T>> part_values(parts);
+
+    pool.run(parts, [&](size_t part) {
+        std::vector<T> accumulator(columns);
+        std::vector<bool> used(columns);
+        std::vector<size_t> touched;
+
+        for (size_t line = bounds[part]; line < bounds[part + 1]; ++line) {
+            touched.clear();
+            for (size_t i = offsets[line]; i < offsets[line + 1]; ++i) {
+                const T& a = values[i];
+                for (const auto& [j, b] : rhs.row(indexes[i])) {
+                    if (!used[j]) {
+                        used[j] = true;
+                        touched.push_back(j);
+                    }
+                    accumulator[j] += a * b;
+                }
+            }
+            std::sort(touched.begin(), touched.end());
+
+            size_t count = 0;
+            for (const size_t j : touched) {
+                if (accumulator[j] != Default) {
+                    part_indexes[part].push_back(j);
+                    part_values[part].push_back(accumulator[j]);
+                    ++count;
+                }
+                accumulator[j] = T{};
+                used[j] = false;
+            }
+            part_counts[part].push_back(count);
+        }
+    });
+
+    size_t result_columns = 0;
+    std::vector<size_t> result_rows;
+    std::vector<size_t> result_offsets{0};
+    std::vector<size_t> result_indexes;
+    std::vector<T> result_values;
+    for (size_t part = 0; part < parts; ++part) {
+        for (size_t i = 0; i < part_counts[part].size(); ++i) {
+            if (part_counts[part][i] != 0) {
+                result_rows.push_back(rows[bounds[part] + i]);
+                result_offsets.push_back(result_offsets.back() + part_counts[part][i]);
+            }
+        }
+        for (const size_t j : part_indexes[part]) {
+            result_columns = std::max(result_columns, j + 1);
+        }
+        result_indexes.insert(result_indexes.end(), part_indexes[part].begin(), part_indexes[part].end());
+        result_values.insert(result_values.end(), part_values[part].begin(), part_values[part].end());
+    }
+
+    // как и в compress, количество строк определяется последней непустой строкой
+    const size_t rows_count = result_rows.empty() ? 0 : result_rows.back() + 1;
+    return {rows_count, result_columns, std::move(result_rows), std::move(result_offsets),
+            std::move(result_indexes), std::move(result_values)};
+}
@@ -0,0 +1,412 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией упорядоченного хранилища,
+ узлы которого хранят упакованный ключ вместо N индексов
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+#include "key_codec.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*!
+@brief Класс, который отвечает за хранение данных в одном дереве с упакованными ключами
+@details В отличие от Data<T, N>, где элемент лежит в узле списка с N индексами size_t, а дерево ссылается
+ на него, здесь один узел std::map хранит ключ PackedKeyCodec (8 или 16 байт) и значение. Индексы
+ восстанавливаются при разыменовании итератора (DecodingIterator), поэтому обход идет в порядке ключей,
+ то есть в лексикографическом порядке индексов, а не в порядке вставки. Для двумерной матрицы int это
+ один узел в 48 байт вместо двух узлов списка и дерева. Обратная сторона -- обход идет по узлам дерева,
+ разбросанным по памяти в порядке вставки, и медленнее обхода списка Data.
+ Интерфейс совпадает с Data<T, N>, поэтому класс можно передать в Matrix<T, Default, N, Storage>.
+@tparam T тип хранимых данных
+@tparam N n-мерность матрицы
+@tparam Bits количество бит на один индекс, индексы не меньше 2^Bits не хранятся, см. PackedKeyCodec
+@tparam Allocator аллокатор элементов, перепривязывается к узлам std::map
+*/
+template <typename T, size_t N, size_t Bits = 64 / N, typename Allocator = std::allocator<ElementType<T, N>>>
+class PackedData {
+public:
+    /// Набор возможных результатов  поиска
+    enum class FindStatus {
+        FOUND,    ///< Указывает, что объект был найден
+        NOT_FOUND ///< Указывает, что объект не был найден
+    };
+
+    /// @brief способ кодирования индексов в ключ
+    using KeyCodec = PackedKeyCodec<N, Bits>;
+
+    /// @brief тип ключа
+    using Key      = typename KeyCodec::Key;
+
+    /// @brief тип хранимого элемента, представляет из себя std::tuple из N индексов типа size_t и последющим значением типа T
+    using Element  = ElementType<T, N>;
+
+    /// @brief дерево от упакованного ключа к значению
+    using Map      = std::map<Key, T, std::less<Key>,
+                              typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const Key, T>>>;
+
+    /// @brief сокращение для итератора в Map
+    using MapIt    = typename Map::const_iterator;
+
+    /// @brief итератор по элементам в порядке ключей, восстанавливающий индексы
+    using It       = DecodingIterator<MapIt, KeyCodec>;
+
+    /// @brief признак того, что хранилище упорядочено по ключу
+    static constexpr bool IS_ORDERED = true;
+
+    void erase(const Key& key);                                ///< Удаляет элемент по ключу
+    void erase(MapIt it);                                      ///< Удаление по переданному итератору
+
+    void insert(const Key& key, const T& elem);                ///< Добавляет элемент по ключу
+    template <typename V>
+    void insert(MapIt it, const Key& key, V&& elem);           ///< Добавляет элемент по итератору, V -- const T& или T
+
+    std::pair<bool, MapIt> contains(const Key& key) const;     ///< Проверяет, есть ли элемент по переданному ключу
+    bool contains(MapIt it) const;                             ///< Проверяет, есть ли элемент по переданному итератору
+
+    std::pair<FindStatus, T> getElement(const Key& key) const; ///< Находит элемент по ключу
+    std::pair<FindStatus, T> getElement(MapIt it) const;       ///< Находит элемент по итератору
+
+    std::pair<bool, MapIt> locate(const Key& key) const;       ///< Ищет элемент или место для его вставки
+    template <typename V>
+    T& emplace(MapIt hint, const Key& key, V&& elem);          ///< Добавляет отсутствующий элемент в место, найденное locate
+    template <typename V>
+    T& emplace(const It& hint, const Key& key, V&& elem);      ///< Добавляет отсутствующий элемент, hint -- позиция обхода, например mapEnd()
+    T& value(MapIt it);                                        ///< Возвращает значение существующего элемента
+    const T& value(MapIt it) const;                            ///< Возвращает значение существующего элемента
+    It find(const Key& key) const;                             ///< Находит элемент по ключу, end() если его нет
+
+    It lowerBound(const Indexes<N>& indexes) const;            ///< Возвращает первый элемент с индексами не меньше indexes
+    It mapEnd() const;                                         ///< Возвращает конец упорядоченного обхода
+    const Element& element(const It& it) const;                ///< Возвращает элемент по позиции обхода
+
+    size_t size() const;                                       ///< Возвращает количесвто хранимых элементов
+    void reserve(size_t count);                                ///< Резервирует место под count элементов
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last);                  ///< Заменяет содержимое упорядоченными уникальными элементами
+
+    It begin() const;                                          ///< Возвращает итератор на начало
+    It end() const;                                            ///< Возвращает итератор на конец
+    std::vector<std::pair<It, It>> split(size_t parts) const;  ///< Делит элементы на не более parts последовательных частей
+
+    Key makeKey(const Indexes<N>& indexes) const;              ///< Создает ключ
+    std::pair<bool, Key> tryMakeKey(const Indexes<N>& indexes) const; ///< Создает ключ, если индексы представимы KeyCodec
+    Element makeElement(const Key& key, const T& elem) const;  ///< Создает элемент
+
+private:
+    Map m_map; ///< Упакованный ключ и значение в одном узле
+};
+
+
+/*!
+Удаляет элемент по переданному ключу
+@param key Ключ удаляемого элемент
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+void PackedData<T, N, Bits, Allocator>::erase(const Key& key) {
+    erase(m_map.find(key));
+}
+
+
+/*!
+Удаляет элемент по переданному итератору
+@param it Итератор на m_map
+@throw std::runtime_error В случае удаления по несуществующему ключу
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+void PackedData<T, N, Bits, Allocator>::erase(MapIt it) {
+    if (!contains(it)) {
+        throw std::runtime_error("Try to erase element by key which was not created");
+    }
+    m_map.erase(it);
+}
+
+
+/*!
+Добавляет элемент по ключу. В случае, когда элемент с таким ключом существует, значение перезаписывается.
+@param key Ключ для элемента
+@param val Хранимое значение
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+void PackedData<T, N, Bits, Allocator>::insert(const Key& key, const T& val) {
+    insert(locate(key).second, key, val);
+}
+
+
+/*!
+Добавляет элемент по итератору. В случае, когда элемент существует, значение перезаписывается на месте.
+@param it  Итератор, полученный из locate
+@param key Ключ для элемента
+@param val Хранимое значение, rvalue перемещается
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+template <typename V>
+void PackedData<T, N, Bits, Allocator>::insert(MapIt it, const Key& key, V&& val) {
+    if (contains(it) && !(key < it->first)) {
+        value(it) = std::forward<V>(val);
+        return;
+    }
+    emplace(it, key, std::forward<V>(val));
+}
+
+
+/*!
+Проверяет, существует ли элемент по переданному ключу
+@param key Ключ проверяемого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и итератора на m_map
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+std::pair<bool, typename PackedData<T, N, Bits, Allocator>::MapIt> PackedData<T, N, Bits, Allocator>::contains(const Key& key) const {
+    MapIt it = m_map.find(key);
+    return {contains(it), it};
+}
+
+
+/*!
+Проверяет, существует ли элемент по переданному итератору
+@param it Итератор на m_map
+@return true если элемент по переданному итератору существует, false -- если нет
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+bool PackedData<T, N, Bits, Allocator>::contains(MapIt it) const {
+    return it != m_map.end();
+}
+
+
+/*!
+Осуществляет поиск элемента по ключу
+@param key Ключ искомого элемента
+@return Пара FindStatus и значения, значение по умолчанию типа T, если элемента нет
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+std::pair<typename PackedData<T, N, Bits, Allocator>::FindStatus, T> PackedData<T, N, Bits, Allocator>::getElement(const Key& key) const {
+    return getElement(m_map.find(key));
+}
+
+
+/*!
+Осуществляет поиск элемента по итератору
+@param it Итератор на искомый элемент
+@return Пара FindStatus и значения, значение по умолчанию типа T, если элемента нет
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+std::pair<typename PackedData<T, N, Bits, Allocator>::FindStatus, T> PackedData<T, N, Bits, Allocator>::getElement(MapIt it) const {
+    if (!contains(it)) {
+        return {FindStatus::NOT_FOUND, T{}};
+    }
+    return {FindStatus::FOUND, it->second};
+}
+
+
+/*!
+Ищет элемент по ключу за один проход по дереву
+@param key Ключ искомого элемента
+@return std::pair из булевого значения (элемент найден/не найден) и итератора на m_map: на элемент
+ или на место, куда его следует вставить (подсказка для emplace)
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+std::pair<bool, typename PackedData<T, N, Bits, Allocator>::MapIt> PackedData<T, N, Bits, Allocator>::locate(const Key& key) const {
+    MapIt it = m_map.lower_bound(key);
+    return {it != m_map.end() && !(key < it->first), it};
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище, не выполняя повторного поиска
+@param hint Итератор, полученный из locate для того же ключа
+@param key  Ключ для элемента
+@param val  Хранимое значение, rvalue перемещается
+@return Ссылка на сохраненное значение
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+template <typename V>
+T& PackedData<T, N, Bits, Allocator>::emplace(MapIt hint, const Key& key, V&& val) {
+    return m_map.emplace_hint(hint, key, std::forward<V>(val))->second;
+}
+
+
+/*!
+Добавляет элемент, которого еще нет в хранилище, по позиции упорядоченного обхода: так вставка
+ по возрастанию ключей с подсказкой mapEnd() работает, как у Data
+@param hint Позиция обхода перед местом вставки, например mapEnd()
+@param key  Ключ для элемента
+@param val  Хранимое значение, rvalue перемещается
+@return Ссылка на сохраненное значение
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+template <typename V>
+T& PackedData<T, N, Bits, Allocator>::emplace(const It& hint, const Key& key, V&& val) {
+    return emplace(hint.base(), key, std::forward<V>(val));
+}
+
+
+/*!
+Возвращает ссылку на значение существующего элемента. Узел принадлежит неконстантному m_map,
+ поэтому снятие const с его значения корректно
+@param it Итератор на найденный элемент
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+T& PackedData<T, N, Bits, Allocator>::value(MapIt it) {
+    return const_cast<T&>(it->second);
+}
+
+
+/*!
+@param it Итератор на найденный элемент
+@return Ссылка на хранимое значение
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+const T& PackedData<T, N, Bits, Allocator>::value(MapIt it) const {
+    return it->second;
+}
+
+
+/*!
+Находит элемент по ключу
+@param key Ключ искомого элемента
+@return Итератор на элемент или end(), если элемента нет
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+typename PackedData<T, N, Bits, Allocator>::It PackedData<T, N, Bits, Allocator>::find(const Key& key) const {
+    return It{m_map.find(key)};
+}
+
+
+/*!
+Ищет первый элемент, индексы которого лексикографически не меньше переданных
+@param indexes Набор индексов, могут выходить за MAX_INDEX
+@return Итератор на элемент или mapEnd()
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+typename PackedData<T, N, Bits, Allocator>::It PackedData<T, N, Bits, Allocator>::lowerBound(const Indexes<N>& indexes) const {
+    const auto [exists, key] = KeyCodec::lowerKey(indexes);
+    return It{exists ? m_map.lower_bound(key) : m_map.end()};
+}
+
+
+/*!
+@return Итератор на конец упорядоченного обхода, совпадает с end()
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+typename PackedData<T, N, Bits, Allocator>::It PackedData<T, N, Bits, Allocator>::mapEnd() const {
+    return end();
+}
+
+
+/*!
+Возвращает элемент, на который указывает позиция упорядоченного обхода
+@param it Итератор на существующий элемент
+@return Элемент (индекс_1, ..., индекс_N, значение), собранный в итераторе: ссылка действительна, пока жив it
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+const typename PackedData<T, N, Bits, Allocator>::Element& PackedData<T, N, Bits, Allocator>::element(const It& it) const {
+    return *it;
+}
+
+
+/*!
+@return Количество хранимых элементов
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+size_t PackedData<T, N, Bits, Allocator>::size() const {
+    return m_map.size();
+}
+
+
+/*!
+Узлы дерева выделяются по одному, поэтому резервировать нечего
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+void PackedData<T, N, Bits, Allocator>::reserve(size_t) {
+}
+
+
+/*!
+Заменяет содержимое элементами [first, last), упорядоченными по индексам без повторов:
+ каждый узел вставляется в конец дерева за амортизированное O(1)
+@param first Начало диапазона элементов
+@param last  Конец диапазона элементов
+@throw std::runtime_error Если индексы элемента не помещаются в ключ
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+template <typename InputIt>
+void PackedData<T, N, Bits, Allocator>::assign(InputIt first, InputIt last) {
+    m_map.clear();
+    for (; first != last; ++first) {
+        m_map.emplace_hint(m_map.end(), KeyCodec::elementKey(*first), std::get<N>(*first));
+    }
+}
+
+
+/*!
+@return итератор на начало диапазона в порядке ключей
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+typename PackedData<T, N, Bits, Allocator>::It PackedData<T, N, Bits, Allocator>::begin() const {
+    return It{m_map.begin()};
+}
+
+
+/*!
+@return итератор на конец диапазона
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+typename PackedData<T, N, Bits, Allocator>::It PackedData<T, N, Bits, Allocator>::end() const {
+    return It{m_map.end()};
+}
+
+
+/*!
+Делит элементы на части для параллельной обработки одним последовательным проходом по дереву
+@param parts Желаемое количество частей
+@return Непустые диапазоны [first, last) в порядке итерирования, вместе покрывающие все элементы
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+std::vector<std::pair<typename PackedData<T, N, Bits, Allocator>::It, typename PackedData<T, N, Bits, Allocator>::It>>
+PackedData<T, N, Bits, Allocator>::split(size_t parts) const {
+    return splitEvenly(begin(), end(), size(), parts);
+}
+
+
+/*!
+@param indexes Набор индексов
+@return Ключ
+@throw std::runtime_error Если какой-то индекс больше MAX_INDEX
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+typename PackedData<T, N, Bits, Allocator>::Key PackedData<T, N, Bits, Allocator>::makeKey(const Indexes<N>& indexes) const {
+    return KeyCodec::encode(indexes);
+}
+
+
+/*!
+Создает ключ, не бросая исключений: ячейка, индексы которой не представимы KeyCodec,
+ не может храниться, поэтому поиск и удаление по ней ничего не находят
+@param indexes Набор индексов
+@return false, если индексы не помещаются в ключ, иначе true и ключ
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+std::pair<bool, typename PackedData<T, N, Bits, Allocator>::Key> PackedData<T, N, Bits, Allocator>::tryMakeKey(const Indexes<N>& indexes) const {
+    return KeyCodec::tryEncode(indexes);
+}
+
+
+/*!
+@param key  Ключ
+@param elem Хранимое значение
+@return Элемент (индекс_1, ..., индекс_N, значение)
+*/
+template <typename T, size_t N, size_t Bits, typename Allocator>
+typename PackedData<T, N, Bits, Allocator>::Element PackedData<T, N, Bits, Allocator>::makeElement(const Key& key, const T& elem) const {
+    return makeElemImpl(KeyCodec::decode(key), std::make_index_sequence<N>{}, elem);
+}
@@ -0,0 +1,93 @@
+/*!
+@file
+@brief Заголовочный файл с исполнителями параллельных алгоритмов BasicMatrix:
+ пул потоков ThreadPool или политика std::execution
+*/
+
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifndef MATRIX_EXECUTION_POLICIES
+/// @brief 1 -- параллельные алгоритмы BasicMatrix принимают политики std::execution (для libstdc++ нужна TBB)
+#define MATRIX_EXECUTION_POLICIES 0
+#endif
+
+#if MATRIX_EXECUTION_POLICIES
+#include <execution>
+#endif
+
+
+namespace detail {
+
+/// @brief количество частей на поток: запас для балансировки, если части обрабатываются с разной скоростью
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+/// @brief наименьший размер части: меньшие части не окупают передачу задачи потоку
+constexpr size_t MIN_CHUNK = 4096;
+
+/// Возвращает количество частей для count элементов и threads потоков
+inline size_t chunkCount(size_t count, size_t threads) {
+    return std::max<size_t>(1, std::min(threads * CHUNKS_PER_THREAD, count / MIN_CHUNK));
+}
+
+}
+
+
+/*!
+ @brief Исполнитель на пуле потоков: задачи раздаются потокам пула по одной
+ */
+class PoolExecutor {
+public:
+    explicit PoolExecutor(ThreadPool& pool) : m_pool{&pool} {}
+
+    size_t concurrency() const { return m_pool->size(); }   ///< Возвращает количество потоков
+    ThreadPool* pool() const { return m_pool; }             ///< Возвращает пул потоков
+
+    /// Выполняет fn(i) для всех i из [0, tasks)
+    template <typename Fn>
+    void run(size_t tasks, Fn&& fn) const { m_pool->run(tasks, std::forward<Fn>(fn)); }
+
+private:
+    ThreadPool* m_pool; ///< Пул потоков
+};
+
+
+#if MATRIX_EXECUTION_POLICIES
+
+/*!
+ @brief Исполнитель на политике std::execution: задачи выполняет std::for_each стандартной библиотеки
+ @tparam Policy тип политики, например std::execution::parallel_policy
+ */
+template <typename Policy>
+class PolicyExecutor {
+public:
+    explicit PolicyExecutor(const Policy& policy) : m_policy{policy} {}
+
+    size_t concurrency() const { return std::max<size_t>(1, std::thread::hardware_concurrency()); } ///< Возвращает количество ядер
+    ThreadPool* pool() const { return nullptr; }                                                    ///< Пула нет
+
+    /// Выполняет fn(i) для всех i из [0, tasks)
+    template <typename Fn>
+    void run(size_t tasks, Fn&& fn) const {
+        std::vector<size_t> ids(tasks);
+        std::iota(ids.begin(), ids.end(), size_t{0});
+        std::for_each(m_policy, ids.begin(), ids.end(), fn);
+    }
+
+private:
+    const Policy& m_policy; ///< Политика исполнения
+};
+
+
+/// @brief тип R, если Policy -- политика std::execution
+template <typename Policy, typename R = void>
+using IfExecutionPolicy = std::enable_if_t<std::is_execution_policy_v<std::decay_t<Policy>>, R>;
+
+#endif
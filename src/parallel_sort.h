@@ -0,0 +1,48 @@
+/*!
+@file
+@brief Заголовочный файл с параллельной устойчивой сортировкой на пуле потоков
+*/
+
+#pragma once
+
+#include "thread_pool.h"
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+/*!
+ Устойчиво сортирует диапазон: части диапазона сортируются параллельно, после чего
+ соседние части попарно сливаются, также параллельно. Разбиение зависит только от размера пула,
+ поэтому порядок равных элементов совпадает с порядком std::stable_sort.
+ @param first Начало диапазона
+ @param last  Конец диапазона
+ @param comp  Сравнение элементов
+ @param pool  Пул потоков
+ */
+template <typename RandomIt, typename Compare>
+void parallelSort(RandomIt first, RandomIt last, Compare comp, ThreadPool& pool) {
+    const size_t count = static_cast<size_t>(std::distance(first, last));
+    const size_t parts = std::min(pool.size(), std::max<size_t>(count / 4096, 1));
+
+    std::vector<RandomIt> bounds(parts + 1);
+    for (size_t part = 0; part <= parts; ++part) {
+        bounds[part] = first + static_cast<std::ptrdiff_t>(count * part / parts);
+    }
+
+    pool.run(parts, [&](size_t part) {
+        std::stable_sort(bounds[part], bounds[part + 1], comp);
+    });
+
+    for (size_t width = 1; width < parts; width *= 2) {
+        const size_t merges = (parts + 2 * width - 1) / (2 * width);
+        pool.run(merges, [&](size_t merge) {
+            const size_t low = 2 * width * merge;
+            const size_t mid = std::min(low + width, parts);
+            const size_t high = std::min(low + 2 * width, parts);
+            if (mid < high) {
+                std::inplace_merge(bounds[low], bounds[mid], bounds[high], comp);
+            }
+        });
+    }
+}
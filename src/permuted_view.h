@@ -0,0 +1,271 @@
+/*!
+@file
+@brief Заголовочный файл с представлением матрицы с переставленными измерениями
+ (транспонирование без копирования)
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+#include "parallel_sort.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/*!
+ @brief Представление матрицы, в котором измерение d соответствует измерению Order[d] исходной матрицы
+ @details Ничего не копирует: точечный доступ переставляет индексы (перестановка известна на этапе
+  компиляции) и обращается к исходной матрице за тот же один поиск, перебор отдает элементы
+  исходной матрицы с переставленными индексами в порядке ее итератора.
+  Для сканирования в порядке новых индексов materialize() строит отсортированную копию,
+  сортировка идет на пуле потоков, если он передан.
+  PermutedView<Matrix2D<int>, 1, 0> -- транспонированная матрица,
+  PermutedView<Matrix3D<int>, 1, 0, 2> -- (user, item, day) как (item, user, day).
+  Представление действительно, пока жива исходная матрица; изменения матрицы в нем видны.
+ @tparam Matrix исходная матрица
+ @tparam Order перестановка чисел 0, ..., N - 1
+ */
+template <typename Matrix, size_t... Order>
+class PermutedView {
+public:
+    /// @brief размерность матрицы
+    static constexpr size_t N = sizeof...(Order);
+
+    /// @brief тип элемента: N индексов в новом порядке и значение
+    using Element = typename Matrix::Element;
+
+    /// @brief тип хранимого значения
+    using Value = std::tuple_element_t<N, Element>;
+
+    class Iterator;
+
+    explicit PermutedView(const Matrix& matrix);
+
+    Value get(const Indexes<N>& indexes) const;             ///< Считывает элемент по индексам в новом порядке
+    template <typename... I>
+    Value operator()(I... indexes) const;                   ///< Считывает элемент по N индексам в новом порядке
+    const Value* tryGet(const Indexes<N>& indexes) const;   ///< Возвращает указатель на хранимое значение или nullptr
+
+    std::vector<Element> materialize() const;                   ///< Возвращает элементы, отсортированные по новым индексам
+    std::vector<Element> materialize(ThreadPool& pool) const;   ///< То же, копирование и сортировка на пуле потоков
+
+    Iterator begin() const;
+    Iterator end() const;
+    size_t size() const;        ///< Возвращает количество хранимых элементов
+    Value defaultValue() const; ///< Возвращает значение по умолчанию
+
+    static Indexes<N> source(const Indexes<N>& indexes);    ///< Переводит индексы представления в индексы матрицы
+    static Element permute(const Element& elem);            ///< Переставляет индексы элемента матрицы
+
+private:
+    void fill(std::vector<Element>& elements, ThreadPool* pool) const; ///< Копирует переставленные элементы
+
+    static constexpr std::array<size_t, N> ORDER{Order...}; ///< Перестановка измерений
+
+    const Matrix* m_matrix; ///< Исходная матрица
+};
+
+
+namespace detail {
+
+/// Проверяет, что числа Order -- перестановка 0, ..., N - 1
+template <size_t... Order>
+constexpr bool isPermutation() {
+    constexpr size_t N = sizeof...(Order);
+    const size_t order[] = {Order...};
+    bool seen[N] = {};
+    for (size_t d = 0; d < N; ++d) {
+        if (order[d] >= N || seen[order[d]]) {
+            return false;
+        }
+        seen[order[d]] = true;
+    }
+    return true;
+}
+
+}
+
+
+/*!
+ @brief Прямой итератор по элементам PermutedView
+ @details Разыменование возвращает элемент по значению, structured bindings работают как с Matrix
+ */
+template <typename Matrix, size_t... Order>
+class PermutedView<Matrix, Order...>::Iterator {
+    /// @brief итератор исходной матрицы
+    using Base = typename Matrix::Iterator;
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = Element;
+
+    explicit Iterator(Base it) : m_it{it} {}
+
+    reference operator*() const { return permute(*m_it); }
+    Iterator& operator++() { ++m_it; return *this; }
+    Iterator operator++(int) { Iterator tmp = *this; ++m_it; return tmp; }
+    bool operator==(const Iterator& other) const { return m_it == other.m_it; }
+    bool operator!=(const Iterator& other) const { return m_it != other.m_it; }
+
+private:
+    Base m_it; ///< Текущая позиция в исходной матрице
+};
+
+
+/*!
+ Создает представление
+ @param matrix Исходная матрица, должна пережить представление
+ */
+template <typename Matrix, size_t... Order>
+PermutedView<Matrix, Order...>::PermutedView(const Matrix& matrix) : m_matrix{&matrix} {
+    static_assert(detail::isPermutation<Order...>(), "PermutedView requires a permutation of 0, ..., N - 1");
+    static_assert(std::tuple_size_v<Element> == N + 1, "PermutedView order must list every dimension of the matrix");
+}
+
+
+/*!
+ @param indexes Индексы в порядке представления
+ @return Хранимое значение или значение по умолчанию
+ */
+template <typename Matrix, size_t... Order>
+typename PermutedView<Matrix, Order...>::Value PermutedView<Matrix, Order...>::get(const Indexes<N>& indexes) const {
+    return m_matrix->get(source(indexes));
+}
+
+
+/*!
+ Считывает элемент: view(i, j) == matrix(j, i) для транспонированной матрицы
+ @param indexes Ровно N индексов в порядке представления
+ @return Хранимое значение или значение по умолчанию
+ */
+template <typename Matrix, size_t... Order>
+template <typename... I>
+typename PermutedView<Matrix, Order...>::Value PermutedView<Matrix, Order...>::operator()(I... indexes) const {
+    static_assert(sizeof...(I) == N, "PermutedView::operator() requires exactly N indexes");
+    return get(Indexes<N>{static_cast<size_t>(indexes)...});
+}
+
+
+/*!
+ @param indexes Индексы в порядке представления
+ @return Указатель на значение в исходной матрице или nullptr, если элемент не хранится
+ */
+template <typename Matrix, size_t... Order>
+const typename PermutedView<Matrix, Order...>::Value* PermutedView<Matrix, Order...>::tryGet(const Indexes<N>& indexes) const {
+    return m_matrix->tryGet(source(indexes));
+}
+
+
+/*!
+@return Элементы с переставленными индексами в лексикографическом порядке новых индексов
+*/
+template <typename Matrix, size_t... Order>
+std::vector<typename PermutedView<Matrix, Order...>::Element> PermutedView<Matrix, Order...>::materialize() const {
+    std::vector<Element> elements;
+    fill(elements, nullptr);
+    std::sort(elements.begin(), elements.end(), ElementKeyLess<N>{});
+    return elements;
+}
+
+
+/*!
+ Строит ту же копию, что materialize(): для хранилища с произвольным доступом (HashData)
+ элементы копируются частями на пуле, сортировка -- parallelSort. Результат можно передать
+ в BasicMatrix::bulkLoad(std::move(elements)), чтобы получить упорядоченную матрицу в новом порядке
+ @param pool Пул потоков
+ @return Элементы с переставленными индексами в лексикографическом порядке новых индексов
+ */
+template <typename Matrix, size_t... Order>
+std::vector<typename PermutedView<Matrix, Order...>::Element> PermutedView<Matrix, Order...>::materialize(ThreadPool& pool) const {
+    std::vector<Element> elements;
+    fill(elements, &pool);
+    parallelSort(elements.begin(), elements.end(), ElementKeyLess<N>{}, pool);
+    return elements;
+}
+
+
+/*!
+@return Итератор на первый элемент в порядке исходной матрицы
+*/
+template <typename Matrix, size_t... Order>
+typename PermutedView<Matrix, Order...>::Iterator PermutedView<Matrix, Order...>::begin() const {
+    return Iterator{m_matrix->begin()};
+}
+
+
+/*!
+@return Итератор на конец представления
+*/
+template <typename Matrix, size_t... Order>
+typename PermutedView<Matrix, Order...>::Iterator PermutedView<Matrix, Order...>::end() const {
+    return Iterator{m_matrix->end()};
+}
+
+
+/*!
+@return Количество хранимых элементов исходной матрицы
+*/
+template <typename Matrix, size_t... Order>
+size_t PermutedView<Matrix, Order...>::size() const {
+    return m_matrix->size();
+}
+
+
+/*!
+@return Значение по умолчанию исходной матрицы
+*/
+template <typename Matrix, size_t... Order>
+typename PermutedView<Matrix, Order...>::Value PermutedView<Matrix, Order...>::defaultValue() const {
+    return m_matrix->defaultValue();
+}
+
+
+/*!
+ @param indexes Индексы в порядке представления
+ @return Индексы исходной матрицы: result[Order[d]] == indexes[d]
+ */
+template <typename Matrix, size_t... Order>
+Indexes<PermutedView<Matrix, Order...>::N> PermutedView<Matrix, Order...>::source(const Indexes<N>& indexes) {
+    Indexes<N> result;
+    for (size_t d = 0; d < N; ++d) {
+        result[ORDER[d]] = indexes[d];
+    }
+    return result;
+}
+
+
+/*!
+ @param elem Элемент исходной матрицы
+ @return Элемент (elem[Order[0]], ..., elem[Order[N - 1]], значение)
+ */
+template <typename Matrix, size_t... Order>
+typename PermutedView<Matrix, Order...>::Element PermutedView<Matrix, Order...>::permute(const Element& elem) {
+    return Element{std::get<Order>(elem)..., std::get<N>(elem)};
+}
+
+
+template <typename Matrix, size_t... Order>
+void PermutedView<Matrix, Order...>::fill(std::vector<Element>& elements, ThreadPool* pool) const {
+    using Base = typename Matrix::Iterator;
+    using Category = typename std::iterator_traits<Base>::iterator_category;
+
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>) {
+        if (pool != nullptr) {
+            elements.resize(size());
+            const Base first = m_matrix->begin();
+            pool->parallelFor(0, elements.size(), [&](size_t begin, size_t end) {
+                std::transform(first + static_cast<std::ptrdiff_t>(begin), first + static_cast<std::ptrdiff_t>(end),
+                               elements.begin() + static_cast<std::ptrdiff_t>(begin), permute);
+            });
+            return;
+        }
+    }
+    elements.reserve(size());
+    std::transform(m_matrix->begin(), m_matrix->end(), std::back_inserter(elements), permute);
+}
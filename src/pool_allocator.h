@@ -0,0 +1,275 @@
+/*!
+@file
+@brief Заголовочный файл с пулом узлов фиксированного размера и аллокатором на его основе
+ для узловых контейнеров Data<T, N, Allocator>
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+/*!
+ @brief Пул блоков одного размера
+ @details Память выделяется кусками, число блоков в куске удваивается до MAX_CHUNK_NODES.
+  Освобожденные блоки попадают в односвязный список свободных и переиспользуются первыми,
+  память кусков возвращается системе только при разрушении пула. Пул не потокобезопасен.
+ */
+class NodePool {
+public:
+    NodePool(size_t size, size_t alignment);
+    ~NodePool();
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void* allocate();             ///< Выделяет один блок
+    void deallocate(void* node);  ///< Возвращает блок в пул
+
+    size_t size() const;          ///< Возвращает размер блока
+    size_t alignment() const;     ///< Возвращает выравнивание блока
+
+    static constexpr size_t FIRST_CHUNK_NODES = 32;   ///< Количество блоков в первом куске
+    static constexpr size_t MAX_CHUNK_NODES   = 4096; ///< Максимальное количество блоков в куске
+
+private:
+    /// @brief свободный блок
+    struct FreeNode {
+        FreeNode* next; ///< Следующий свободный блок
+    };
+
+    void grow(); ///< Выделяет новый кусок и разбивает его на свободные блоки
+
+    size_t m_size = 0;                       ///< Размер блока с учетом выравнивания
+    size_t m_alignment;                      ///< Выравнивание блока
+    size_t m_chunkNodes = FIRST_CHUNK_NODES; ///< Количество блоков в следующем куске
+    FreeNode* m_free = nullptr;              ///< Список свободных блоков
+    std::vector<void*> m_chunks;             ///< Выделенные куски
+};
+
+
+/*!
+ Создает пустой пул
+ @param size      Размер блока
+ @param alignment Выравнивание блока
+ */
+inline NodePool::NodePool(size_t size, size_t alignment) : m_alignment{std::max(alignment, alignof(FreeNode))} {
+    m_size = (std::max(size, sizeof(FreeNode)) + m_alignment - 1) / m_alignment * m_alignment;
+}
+
+
+/*!
+ Освобождает все куски. Блоки, выданные пулом, становятся недействительными
+ */
+inline NodePool::~NodePool() {
+    for (void* chunk : m_chunks) {
+        ::operator delete(chunk, std::align_val_t{m_alignment});
+    }
+}
+
+
+/*!
+@return Блок размера size()
+*/
+inline void* NodePool::allocate() {
+    if (m_free == nullptr) {
+        grow();
+    }
+    FreeNode* node = m_free;
+    m_free = node->next;
+    return node;
+}
+
+
+/*!
+ Возвращает блок в список свободных
+ @param node Блок, выделенный этим пулом
+ */
+inline void NodePool::deallocate(void* node) {
+    m_free = ::new (node) FreeNode{m_free};
+}
+
+
+/*!
+@return Размер блока
+*/
+inline size_t NodePool::size() const {
+    return m_size;
+}
+
+
+/*!
+@return Выравнивание блока
+*/
+inline size_t NodePool::alignment() const {
+    return m_alignment;
+}
+
+
+inline void NodePool::grow() {
+    auto* chunk = static_cast<unsigned char*>(::operator new(m_size * m_chunkNodes, std::align_val_t{m_alignment}));
+    m_chunks.push_back(chunk);
+
+    // блоки связываются с конца, чтобы выдача шла по возрастанию адресов
+    for (size_t i = m_chunkNodes; i-- > 0;) {
+        m_free = ::new (chunk + i * m_size) FreeNode{m_free};
+    }
+    m_chunkNodes = std::min(m_chunkNodes * 2, MAX_CHUNK_NODES);
+}
+
+
+/*!
+ @brief Набор пулов для разных размеров узлов
+ @details Контейнер перепривязывает аллокатор к своим узлам, поэтому одному набору
+  нужно несколько пулов: по одному на каждую пару (размер, выравнивание).
+ */
+class PoolResource {
+public:
+    NodePool& pool(size_t size, size_t alignment); ///< Возвращает пул для блоков заданного размера
+
+private:
+    /// @brief пул и запрошенные для него размер и выравнивание
+    struct Entry {
+        size_t size;                    ///< Запрошенный размер блока
+        size_t alignment;               ///< Запрошенное выравнивание блока
+        std::unique_ptr<NodePool> pool; ///< Пул
+    };
+
+    std::vector<Entry> m_pools; ///< Пулы, их обычно не больше двух
+};
+
+
+/*!
+ Находит или создает пул
+ @param size      Размер блока
+ @param alignment Выравнивание блока
+ @return Пул
+ */
+inline NodePool& PoolResource::pool(size_t size, size_t alignment) {
+    for (const auto& entry : m_pools) {
+        if (entry.size == size && entry.alignment == alignment) {
+            return *entry.pool;
+        }
+    }
+    m_pools.push_back(Entry{size, alignment, std::make_unique<NodePool>(size, alignment)});
+    return *m_pools.back().pool;
+}
+
+
+/*!
+ @brief Аллокатор, выделяющий одиночные объекты из пула узлов
+ @details Предназначен для std::list и std::map внутри Data<T, N, Allocator>: каждая вставка
+  берет блок из списка свободных, каждое удаление возвращает его туда же, без обращения к
+  глобальному аллокатору. Массивы (n > 1) выделяются через operator new.
+  Каждый контейнер получает собственный набор пулов: при копировании контейнера создается новый
+  набор, при перемещении и обмене набор переходит вместе с элементами. Аллокатор не потокобезопасен.
+ @tparam T тип выделяемых объектов
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    PoolAllocator();
+    PoolAllocator(const PoolAllocator&) noexcept = default; ///< Перемещение тоже копирует: исходный аллокатор должен остаться рабочим
+    PoolAllocator& operator=(const PoolAllocator&) noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept;
+
+    T* allocate(size_t count);
+    void deallocate(T* pointer, size_t count) noexcept;
+
+    PoolAllocator select_on_container_copy_construction() const; ///< Создает аллокатор с новым набором пулов
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept;
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const noexcept;
+
+private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    NodePool& pool(); ///< Возвращает пул для объектов типа T
+
+    std::shared_ptr<PoolResource> m_resource; ///< Набор пулов, общий для перепривязанных копий
+    NodePool* m_pool = nullptr;               ///< Пул для T из m_resource, ищется при первом обращении
+};
+
+
+template <typename T>
+PoolAllocator<T>::PoolAllocator() : m_resource{std::make_shared<PoolResource>()} {}
+
+
+template <typename T>
+template <typename U>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& other) noexcept : m_resource{other.m_resource} {}
+
+
+/*!
+ Выделяет память под count объектов
+ @param count Количество объектов
+ @return Указатель на неинициализированную память
+ */
+template <typename T>
+T* PoolAllocator<T>::allocate(size_t count) {
+    if (count == 1) {
+        return static_cast<T*>(pool().allocate());
+    }
+    return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{alignof(T)}));
+}
+
+
+/*!
+ Освобождает память, выделенную allocate
+ @param pointer Указатель, полученный из allocate
+ @param count   Количество объектов, переданное в allocate
+ */
+template <typename T>
+void PoolAllocator<T>::deallocate(T* pointer, size_t count) noexcept {
+    if (count == 1) {
+        pool().deallocate(pointer);
+        return;
+    }
+    ::operator delete(pointer, std::align_val_t{alignof(T)});
+}
+
+
+/*!
+@return Аллокатор с новым пустым набором пулов, чтобы копия контейнера не делила пулы с оригиналом
+*/
+template <typename T>
+PoolAllocator<T> PoolAllocator<T>::select_on_container_copy_construction() const {
+    return PoolAllocator{};
+}
+
+
+template <typename T>
+template <typename U>
+bool PoolAllocator<T>::operator==(const PoolAllocator<U>& other) const noexcept {
+    return m_resource == other.m_resource;
+}
+
+
+template <typename T>
+template <typename U>
+bool PoolAllocator<T>::operator!=(const PoolAllocator<U>& other) const noexcept {
+    return !(*this == other);
+}
+
+
+template <typename T>
+NodePool& PoolAllocator<T>::pool() {
+    if (m_pool == nullptr) {
+        m_pool = &m_resource->pool(sizeof(T), alignof(T));
+    }
+    return *m_pool;
+}
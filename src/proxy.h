@@ -7,127 +7,118 @@
 #pragma once
 
 #include "indexes.h"
-#include <memory>
-#include <string>
 #include <array>
-#include <stdexcept>
-#include <iostream>
+#include <utility>
 
 /*!
- @brief интерфейс проски класса
- @details
+ @brief прокси класс, который будет возвращен объектом Matrix<T, Default, N>
+ при вызове Matrix<T, Default, N>::operator[]
+ @details Количество уже переданных индексов хранится в типе, поэтому лишний индекс или
+  запись/чтение с недостающими индексами -- ошибка компиляции. Пока индексов меньше N,
+  прокси умеет только принимать следующий индекс, после N-го -- только читать и записывать.
+  Обращение к объекту-создателю -- прямой невиртуальный вызов.
  @tparam V тип хранимого в матрице элемента
  @tparam N размерность матрицы
+ @tparam Depth количество переданных индексов
+ @tparam Subject объект-создатель, реализующий update(indexes, elem) и get(indexes)
  */
-template <typename V, size_t N>
-class IProxy {
+template <typename V, size_t N, size_t Depth, typename Subject>
+class Proxy {
+    static_assert(Depth > 0 && Depth < N, "Proxy depth must be in [1, N)");
 public:
-    ~IProxy() = default;
-    virtual void update(const Indexes<N>& indexes, const V& elem) = 0; ///< Передает индексы и значение элемента
-    virtual V get(const Indexes<N>& indexes) const = 0;                ///< Запрашивает значение элемента по индексам
+    Proxy(Subject* subjectPtr, const Indexes<N>& indexes);
+
+    Proxy<V, N, Depth + 1, Subject> operator[](std::size_t index) const;
+private:
+    Subject* m_subjectPtr; ///< Указатель на объект-создатель
+    Indexes<N> m_indexes;  ///< Набор индексов, заполнены первые Depth
 };
 
 
 /*!
- @brief прокси класс, который будет возвращен объектом Matrix<T, Default, N>
- при вызове Matrix<T, Default, N>::operator[]
- @details
- @tparam V тип хранимого в матрице элемента
+ @brief прокси класс со всеми N индексами
+ @details Записывает и читает элемент объекта-создателя
  */
-template <typename V, size_t N>
-class Proxy : public IProxy<V, N> {
+template <typename V, size_t N, typename Subject>
+class Proxy<V, N, N, Subject> {
 public:
-    Proxy(IProxy<V, N> * prevProxyPtr);
-    
-    Proxy<V, N>& operator=(const V& elem);
-    Proxy<V, N>& operator[](std::size_t index);
-    operator V();
-    
-    void update(const Indexes<N>& indexes, const V& elem) override; ///< Передает индексы и значение элемента в m_subjectPtr
-    V get(const Indexes<N>& indexes) const override;           ///< Запрашивает значение элемента по индексам у m_subjectPtr
-    void addIndex(size_t index);                       ///< Добавляет индекс в m_indexes
+    Proxy(Subject* subjectPtr, const Indexes<N>& indexes);
+    Proxy(const Proxy&) = default;
+
+    Proxy& operator=(const V& elem);
+    Proxy& operator=(V&& elem);
+    Proxy& operator=(const Proxy& other);
+    operator V() const;
 private:
-    IProxy<V, N> * m_subjectPtr; ///<  Указатель на объект-создатель
-    Indexes<N> m_indexes;        ///< Набор индексов
-    size_t m_counter = 0;        ///< Счетчик переданных индексов
+    Subject* m_subjectPtr; ///< Указатель на объект-создатель
+    Indexes<N> m_indexes;  ///< Набор индексов
 };
 
 
-template <typename V, size_t N>
-Proxy<V, N>::Proxy(IProxy<V, N> * subjectPtr) : m_subjectPtr{subjectPtr} {}
+template <typename V, size_t N, size_t Depth, typename Subject>
+Proxy<V, N, Depth, Subject>::Proxy(Subject* subjectPtr, const Indexes<N>& indexes)
+    : m_subjectPtr{subjectPtr}, m_indexes{indexes} {}
 
 
 /*!
- Принимет и сохраняет индекс, вовзращает ссылку на себя
+ Принимет очередной индекс
  @param index Индекс
- @return Ссылку на себя
+ @return Прокси с Depth + 1 индексами
  */
-template <typename V, size_t N>
-Proxy<V, N>& Proxy<V, N>::operator[](std::size_t index) {
-    addIndex(index);
-    return *this;
+template <typename V, size_t N, size_t Depth, typename Subject>
+Proxy<V, N, Depth + 1, Subject> Proxy<V, N, Depth, Subject>::operator[](std::size_t index) const {
+    Indexes<N> indexes = m_indexes;
+    indexes[Depth] = index;
+    return {m_subjectPtr, indexes};
 }
 
 
+template <typename V, size_t N, typename Subject>
+Proxy<V, N, N, Subject>::Proxy(Subject* subjectPtr, const Indexes<N>& indexes)
+    : m_subjectPtr{subjectPtr}, m_indexes{indexes} {}
+
+
 /*!
- Инициирует обновление объекта-создателя
+ Обновляет объект-создатель
  @param elem Элемент для записи в объект-создатель
  @return Ссылку на себя
  */
-template <typename V, size_t N>
-Proxy<V, N>& Proxy<V, N>::operator=(const V& elem) {
-    update(m_indexes, elem);
+template <typename V, size_t N, typename Subject>
+Proxy<V, N, N, Subject>& Proxy<V, N, N, Subject>::operator=(const V& elem) {
+    m_subjectPtr->update(m_indexes, elem);
     return *this;
 }
 
 
 /*!
- Обновляет объект-создатель
- @param indexes  Набор индексов
- @param elem Элемент
- @throw std::runtime_error Если передано слишком мало индексов
- */
-template <typename V, size_t N>
-void Proxy<V, N>::update(const Indexes<N>& indexes, const V& elem) {
-    if (m_counter < N) {
-        std::string error_message = "Too few indexes";
-        throw std::runtime_error(error_message);
-    }
-    m_subjectPtr->update(indexes, elem);
-}
-
-/*!
- Запрашивет элемент у объекта-создателя
- @param indexes Набор индексов
- @return Элемент
+ Перемещает элемент в объект-создатель: matrix[1][2] = std::move(value) не копирует значение
+ @param elem Элемент для записи в объект-создатель
+ @return Ссылку на себя
  */
-template <typename V, size_t N>
-V Proxy<V, N>::get(const Indexes<N>& indexes) const {
-    return m_subjectPtr->get(indexes);
+template <typename V, size_t N, typename Subject>
+Proxy<V, N, N, Subject>& Proxy<V, N, N, Subject>::operator=(V&& elem) {
+    m_subjectPtr->update(m_indexes, std::move(elem));
+    return *this;
 }
 
 
 /*!
- Инициирует чтение элемента из объекта-создателя
- @return Элемент
+ Записывает в объект-создатель значение, прочитанное через другой прокси
+ (matrix[1][1] = matrix[2][2])
+ @param other Прокси, из которого читается значение
+ @return Ссылку на себя
  */
-template <typename V, size_t N>
-Proxy<V, N>::operator V() {
-    return get(m_indexes);
+template <typename V, size_t N, typename Subject>
+Proxy<V, N, N, Subject>& Proxy<V, N, N, Subject>::operator=(const Proxy& other) {
+    return *this = static_cast<V>(other);
 }
 
 
 /*!
- Добавляет  переданный индекс в набор индексов
- @param index Индекс
- @throw std::runtime_error Если произошла попытка добавления лишнего индекса
+ Запрашивет элемент у объекта-создателя
+ @return Элемент
  */
-template <typename V, size_t N>
-void Proxy<V, N>::addIndex(size_t index) {
-    if (m_counter >= N) {
-        std::string error_message = "Too many indexes";
-        throw std::runtime_error(error_message);
-    }
-    
-    m_indexes[m_counter++] = index;
+template <typename V, size_t N, typename Subject>
+Proxy<V, N, N, Subject>::operator V() const {
+    return m_subjectPtr->get(m_indexes);
 }
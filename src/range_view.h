@@ -0,0 +1,345 @@
+/*!
+@file
+@brief Заголовочный файл с ленивым представлением элементов матрицы,
+ индексы которых попадают в N-мерный прямоугольник
+*/
+
+#pragma once
+
+#include "data_helpers.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+/// Позиция в упорядоченном индексе хранилища: тип, который возвращает lowerBound
+template <typename Storage, size_t N>
+struct OrderedPosition {
+    using type = decltype(std::declval<const Storage&>().lowerBound(std::declval<const Indexes<N>&>()));
+};
+
+/// Позиция в последовательности элементов хранилища
+template <typename Storage>
+struct SequencePosition {
+    using type = typename Storage::It;
+};
+
+/// Количество упорядоченных индексов хранилища: Storage::ORDERS или один основной
+template <typename Storage, typename = void>
+struct IndexOrders : std::integral_constant<size_t, 1> {};
+
+template <typename Storage>
+struct IndexOrders<Storage, std::void_t<decltype(Storage::ORDERS)>> : std::integral_constant<size_t, Storage::ORDERS> {};
+
+/*!
+ Ищет первый элемент не меньше key в индексе order упорядоченного хранилища
+ @param storage Хранилище
+ @param key     Индексы, сдвинутые в порядок индекса order
+ @param order   Номер индекса, 0 для хранилища с одним индексом
+ @return Позиция в индексе
+ */
+template <typename Storage, size_t N>
+auto lowerBound(const Storage& storage, const Indexes<N>& key, size_t order) {
+    if constexpr (IndexOrders<Storage>::value > 1) {
+        return storage.lowerBound(key, order);
+    } else {
+        return storage.lowerBound(key);
+    }
+}
+
+/*!
+ @param storage Хранилище
+ @param order   Номер индекса, 0 для хранилища с одним индексом
+ @return Конец индекса order упорядоченного хранилища
+ */
+template <typename Storage>
+auto mapEnd(const Storage& storage, size_t order) {
+    if constexpr (IndexOrders<Storage>::value > 1) {
+        return storage.mapEnd(order);
+    } else {
+        return storage.mapEnd();
+    }
+}
+
+}
+
+
+/*!
+ @brief Ленивое представление элементов хранилища, лежащих в прямоугольнике [lo, hi] (границы включены)
+ @details Для упорядоченного хранилища (Storage::IS_ORDERED) используется пропускающий поиск по
+  упорядоченному индексу: встретив ключ вне прямоугольника, итератор переходит lowerBound'ом сразу к
+  следующему ключу, который может в него попасть. Поэтому срез с фиксированными первыми индексами
+  стоит O(log nnz + размер результата), а произвольный прямоугольник -- O(log nnz) на каждый
+  встреченный префикс плюс размер результата. Если у хранилища несколько индексов (Storage::ORDERS,
+  индекс d упорядочен по ключу, начинающемуся с измерения d, см. IndexedData), выбирается тот, в котором
+  ведущими оказываются фиксированные или самые узкие измерения прямоугольника: так столбец двумерной
+  матрицы стоит O(log nnz + размер столбца), а не O(строк * log nnz). Элементы тогда перебираются
+  в порядке выбранного индекса. Для неупорядоченного хранилища элементы перебираются целиком и фильтруются.
+  Представление действительно до изменения матрицы.
+ @tparam Storage хранилище элементов
+ @tparam N размерность матрицы
+ */
+template <typename Storage, size_t N>
+class RangeView {
+public:
+    /// @brief тип элемента
+    using Element = typename Storage::Element;
+
+    class Iterator;
+
+    RangeView(const Storage* storage, const Indexes<N>& lo, const Indexes<N>& hi);
+
+    Iterator begin() const;
+    Iterator end() const;
+    bool empty() const;   ///< Проверяет, что в прямоугольнике нет элементов
+
+    bool contains(const Indexes<N>& indexes) const; ///< Проверяет, лежат ли индексы в прямоугольнике
+
+private:
+    static size_t chooseOrder(const Indexes<N>& lo, const Indexes<N>& hi); ///< Выбирает индекс хранилища для обхода
+
+    const Storage* m_storage; ///< Хранилище матрицы
+    Indexes<N> m_lo;          ///< Нижняя граница
+    Indexes<N> m_hi;          ///< Верхняя граница
+    bool m_empty;             ///< Прямоугольник пуст (lo[d] > hi[d] для какого-то d)
+    size_t m_order;           ///< Номер индекса хранилища, по которому идет обход
+    Indexes<N> m_keyLo;       ///< Нижняя граница, сдвинутая в порядок индекса m_order
+    Indexes<N> m_keyHi;       ///< Верхняя граница, сдвинутая в порядок индекса m_order
+};
+
+
+/*!
+ @brief Прямой итератор по элементам RangeView
+ @details Разыменование возвращает ссылку на элемент хранилища, structured bindings работают как с Matrix
+ */
+template <typename Storage, size_t N>
+class RangeView<Storage, N>::Iterator {
+    /// @brief итератор хранилища: позиция упорядоченного индекса (тип lowerBound) или последовательность элементов
+    using Base = typename std::conditional_t<Storage::IS_ORDERED, detail::OrderedPosition<Storage, N>, detail::SequencePosition<Storage>>::type;
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Element;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const Element*;
+    using reference         = const Element&;
+
+    Iterator(const RangeView* view, Base it);
+
+    reference operator*() const;
+    pointer operator->() const { return &**this; }
+    Iterator& operator++();
+    Iterator operator++(int) { Iterator tmp = *this; ++*this; return tmp; }
+    bool operator==(const Iterator& other) const { return m_it == other.m_it; }
+    bool operator!=(const Iterator& other) const { return m_it != other.m_it; }
+
+private:
+    void settle();     ///< Продвигает итератор к первому элементу в прямоугольнике
+    Base baseEnd() const;
+
+    const RangeView* m_view; ///< Представление
+    Base m_it;               ///< Текущая позиция в хранилище
+};
+
+
+namespace detail {
+
+/// Собирает индексы элемента в массив
+template <size_t N, typename Element>
+Indexes<N> elementIndexes(const Element& elem) {
+    Indexes<N> indexes;
+    std::apply([&indexes](const auto&... items) {
+        size_t i = 0;
+        ((indexes[i++] = static_cast<size_t>(items)), ...);
+    }, elemKeyTieImpl(elem, std::make_index_sequence<N>{}));
+    return indexes;
+}
+
+}
+
+
+/*!
+ Создает представление
+ @param storage Хранилище матрицы
+ @param lo      Нижняя граница по каждому измерению
+ @param hi      Верхняя граница по каждому измерению
+ */
+template <typename Storage, size_t N>
+RangeView<Storage, N>::RangeView(const Storage* storage, const Indexes<N>& lo, const Indexes<N>& hi)
+    : m_storage{storage}, m_lo{lo}, m_hi{hi}, m_empty{false}, m_order{chooseOrder(lo, hi)},
+      m_keyLo{rotateIndexes(lo, m_order)}, m_keyHi{rotateIndexes(hi, m_order)} {
+    for (size_t d = 0; d < N; ++d) {
+        m_empty = m_empty || lo[d] > hi[d];
+    }
+}
+
+
+/*!
+ Выбирает индекс хранилища, в котором прямоугольник отсекает больше всего ключей: с наибольшим
+ числом фиксированных (lo == hi) ведущих измерений, а при равенстве -- с самым узким первым
+ нефиксированным измерением. При полном равенстве остается основной индекс 0, поэтому срезы
+ и ordered() идут в лексикографическом порядке
+ @param lo Нижняя граница по каждому измерению
+ @param hi Верхняя граница по каждому измерению
+ @return Номер индекса, меньше detail::IndexOrders<Storage>
+ */
+template <typename Storage, size_t N>
+size_t RangeView<Storage, N>::chooseOrder(const Indexes<N>& lo, const Indexes<N>& hi) {
+    constexpr size_t ORDERS = Storage::IS_ORDERED ? detail::IndexOrders<Storage>::value : 1;
+
+    size_t best = 0;
+    size_t bestFixed = 0;
+    size_t bestWidth = 0;
+    for (size_t order = 0; order < ORDERS; ++order) {
+        size_t fixed = 0;
+        while (fixed < N && lo[(order + fixed) % N] == hi[(order + fixed) % N]) {
+            ++fixed;
+        }
+        const size_t width = fixed < N ? hi[(order + fixed) % N] - lo[(order + fixed) % N] : 0;
+        if (order == 0 || fixed > bestFixed || (fixed == bestFixed && width < bestWidth)) {
+            best = order;
+            bestFixed = fixed;
+            bestWidth = width;
+        }
+    }
+    return best;
+}
+
+
+/*!
+@return Итератор на первый элемент в прямоугольнике
+*/
+template <typename Storage, size_t N>
+typename RangeView<Storage, N>::Iterator RangeView<Storage, N>::begin() const {
+    if (m_empty) {
+        return end();
+    }
+    if constexpr (Storage::IS_ORDERED) {
+        return {this, detail::lowerBound(*m_storage, m_keyLo, m_order)};
+    } else {
+        return {this, m_storage->begin()};
+    }
+}
+
+
+/*!
+@return Итератор на конец представления
+*/
+template <typename Storage, size_t N>
+typename RangeView<Storage, N>::Iterator RangeView<Storage, N>::end() const {
+    if constexpr (Storage::IS_ORDERED) {
+        return {this, detail::mapEnd(*m_storage, m_order)};
+    } else {
+        return {this, m_storage->end()};
+    }
+}
+
+
+/*!
+@return true, если в прямоугольнике нет элементов
+*/
+template <typename Storage, size_t N>
+bool RangeView<Storage, N>::empty() const {
+    return begin() == end();
+}
+
+
+/*!
+ @param indexes Набор индексов
+ @return true, если lo[d] <= indexes[d] <= hi[d] для всех d
+ */
+template <typename Storage, size_t N>
+bool RangeView<Storage, N>::contains(const Indexes<N>& indexes) const {
+    for (size_t d = 0; d < N; ++d) {
+        if (indexes[d] < m_lo[d] || indexes[d] > m_hi[d]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+template <typename Storage, size_t N>
+RangeView<Storage, N>::Iterator::Iterator(const RangeView* view, Base it) : m_view{view}, m_it{it} {
+    settle();
+}
+
+
+template <typename Storage, size_t N>
+typename RangeView<Storage, N>::Iterator::reference RangeView<Storage, N>::Iterator::operator*() const {
+    if constexpr (Storage::IS_ORDERED) {
+        return m_view->m_storage->element(m_it);
+    } else {
+        return *m_it;
+    }
+}
+
+
+template <typename Storage, size_t N>
+typename RangeView<Storage, N>::Iterator& RangeView<Storage, N>::Iterator::operator++() {
+    ++m_it;
+    settle();
+    return *this;
+}
+
+
+template <typename Storage, size_t N>
+typename RangeView<Storage, N>::Iterator::Base RangeView<Storage, N>::Iterator::baseEnd() const {
+    if constexpr (Storage::IS_ORDERED) {
+        return detail::mapEnd(*m_view->m_storage, m_view->m_order);
+    } else {
+        return m_view->m_storage->end();
+    }
+}
+
+
+/*!
+ Продвигает итератор к первому элементу в прямоугольнике. Для упорядоченного хранилища первое
+ измерение d, по которому ключ вышел за границы, определяет следующий кандидат:
+ если key[d] < lo[d], то (key[0..d), lo[d], lo[d+1..]); если key[d] > hi[d], то префикс
+ key[0..e) увеличивается на единицу в последнем измерении e - 1, где key[e - 1] < hi[e - 1],
+ а остальные измерения начинаются с lo. Каждый кандидат строго больше текущего ключа.
+ Ключ и границы берутся в порядке измерений индекса m_order, см. rotateIndexes.
+ */
+template <typename Storage, size_t N>
+void RangeView<Storage, N>::Iterator::settle() {
+    const Base last = baseEnd();
+    const Indexes<N>& lo = m_view->m_keyLo;
+    const Indexes<N>& hi = m_view->m_keyHi;
+
+    while (m_it != last) {
+        const Indexes<N> key = rotateIndexes(detail::elementIndexes<N>(**this), m_view->m_order);
+
+        size_t d = 0;
+        while (d < N && lo[d] <= key[d] && key[d] <= hi[d]) {
+            ++d;
+        }
+        if (d == N) {
+            return;
+        }
+
+        if constexpr (Storage::IS_ORDERED) {
+            Indexes<N> target = lo;
+            if (key[d] < lo[d]) {
+                std::copy(key.begin(), key.begin() + d, target.begin());
+            } else {
+                size_t e = d;
+                while (e > 0 && key[e - 1] >= hi[e - 1]) {
+                    --e;
+                }
+                if (e == 0) {
+                    m_it = last;
+                    return;
+                }
+                std::copy(key.begin(), key.begin() + e, target.begin());
+                ++target[e - 1];
+            }
+            m_it = detail::lowerBound(*m_view->m_storage, target, m_view->m_order);
+        } else {
+            ++m_it;
+        }
+    }
+}
@@ -0,0 +1,288 @@
+/*!
+@file
+@brief Заголовочный файл с векторизованными ядрами для умножения разреженных матриц
+ и выбором набора инструкций во время выполнения
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define MATRIX_SIMD_X86 0
+#endif
+
+/// Набор инструкций, которым выполняются ядра
+enum class SimdLevel {
+    SCALAR, ///< Без векторизации
+    AVX2,   ///< AVX2
+    AVX512  ///< AVX-512 F + DQ
+};
+
+
+/*!
+ Определяет лучший набор инструкций, поддерживаемый процессором. Результат вычисляется один раз.
+ @return Доступный набор инструкций
+ */
+inline SimdLevel detectSimdLevel() {
+#if MATRIX_SIMD_X86
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+
+namespace simd {
+
+/*!
+ Скалярное произведение разреженной линии на плотный вектор без векторизации
+ */
+template <typename T>
+T dotScalar(const size_t* indexes, const T* values, size_t count, const T* x) {
+    T sum{};
+    for (size_t i = 0; i < count; ++i) {
+        sum += values[i] * x[indexes[i]];
+    }
+    return sum;
+}
+
+
+/*!
+ Скалярное y += a * x для плотных векторов
+ */
+template <typename T>
+void axpyScalar(T a, const T* x, T* y, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+
+/// @brief тип, для которого есть векторизованное скалярное произведение
+template <typename T>
+constexpr bool hasVectorDot = MATRIX_SIMD_X86 && sizeof(size_t) == 8 &&
+    ((std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8)) ||
+     std::is_same_v<T, float> || std::is_same_v<T, double>);
+
+
+#if MATRIX_SIMD_X86
+
+/// Сумма четырех 32-битных целых
+__attribute__((target("avx2")))
+inline std::int32_t reduceAdd(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+/// Сумма четырех float
+__attribute__((target("avx2")))
+inline float reduceAdd(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+/// Сумма четырех double
+__attribute__((target("avx2")))
+inline double reduceAdd(__m256d v) {
+    __m128d low = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    low = _mm_add_sd(low, _mm_unpackhi_pd(low, low));
+    return _mm_cvtsd_f64(low);
+}
+
+
+/*!
+ Скалярное произведение с использованием AVX2: по 4 элемента за итерацию через gather
+ */
+template <typename T>
+__attribute__((target("avx2")))
+T dotAvx2(const size_t* indexes, const T* values, size_t count, const T* x) {
+    size_t i = 0;
+    T sum{};
+    if constexpr (std::is_integral_v<T> && sizeof(T) == 4) {
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 4 <= count; i += 4) {
+            const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes + i));
+            const __m128i xv  = _mm256_i64gather_epi32(reinterpret_cast<const int*>(x), idx, 4);
+            const __m128i av  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            acc = _mm_add_epi32(acc, _mm_mullo_epi32(av, xv));
+        }
+        sum = static_cast<T>(reduceAdd(acc));
+    } else if constexpr (std::is_same_v<T, float>) {
+        __m128 acc = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes + i));
+            const __m128 xv   = _mm256_i64gather_ps(x, idx, 4);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(values + i), xv));
+        }
+        sum = reduceAdd(acc);
+    } else if constexpr (std::is_same_v<T, double>) {
+        __m256d acc = _mm256_setzero_pd();
+        for (; i + 4 <= count; i += 4) {
+            const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indexes + i));
+            const __m256d xv  = _mm256_i64gather_pd(x, idx, 8);
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(values + i), xv));
+        }
+        sum = reduceAdd(acc);
+    }
+    // 64-битные целые в AVX2 не умеют перемножаться, для них остается только скалярный хвост
+    for (; i < count; ++i) {
+        sum += values[i] * x[indexes[i]];
+    }
+    return sum;
+}
+
+
+/*!
+ Скалярное произведение с использованием AVX-512: по 8 элементов за итерацию через gather.
+ Используются маскированные варианты gather с нулевым источником, чтобы не опираться на
+ неинициализированные регистры (GCC выдает на них ложные предупреждения)
+ */
+template <typename T>
+__attribute__((target("avx512f,avx512dq")))
+T dotAvx512(const size_t* indexes, const T* values, size_t count, const T* x) {
+    size_t i = 0;
+    T sum{};
+    if constexpr (std::is_integral_v<T> && sizeof(T) == 4) {
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 8 <= count; i += 8) {
+            const __m512i idx = _mm512_loadu_si512(indexes + i);
+            const __m256i xv  = _mm512_mask_i64gather_epi32(_mm256_setzero_si256(), 0xff, idx, x, 4);
+            const __m256i av  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(av, xv));
+        }
+        sum = static_cast<T>(reduceAdd(_mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1))));
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) == 8) {
+        __m512i acc = _mm512_setzero_si512();
+        for (; i + 8 <= count; i += 8) {
+            const __m512i idx = _mm512_loadu_si512(indexes + i);
+            const __m512i xv  = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), 0xff, idx, x, 8);
+            acc = _mm512_add_epi64(acc, _mm512_mullo_epi64(_mm512_loadu_si512(values + i), xv));
+        }
+        alignas(64) std::int64_t lanes[8];
+        _mm512_store_si512(lanes, acc);
+        for (const std::int64_t lane : lanes) {
+            sum += static_cast<T>(lane);
+        }
+    } else if constexpr (std::is_same_v<T, float>) {
+        __m256 acc = _mm256_setzero_ps();
+        for (; i + 8 <= count; i += 8) {
+            const __m512i idx = _mm512_loadu_si512(indexes + i);
+            const __m256 xv   = _mm512_mask_i64gather_ps(_mm256_setzero_ps(), 0xff, idx, x, 4);
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(values + i), xv));
+        }
+        sum = reduceAdd(_mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1)));
+    } else if constexpr (std::is_same_v<T, double>) {
+        __m512d acc = _mm512_setzero_pd();
+        for (; i + 8 <= count; i += 8) {
+            const __m512i idx = _mm512_loadu_si512(indexes + i);
+            const __m512d xv  = _mm512_mask_i64gather_pd(_mm512_setzero_pd(), 0xff, idx, x, 8);
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(_mm512_loadu_pd(values + i), xv));
+        }
+        sum = reduceAdd(_mm256_add_pd(_mm512_castpd512_pd256(acc), _mm512_extractf64x4_pd(acc, 1)));
+    }
+    for (; i < count; ++i) {
+        sum += values[i] * x[indexes[i]];
+    }
+    return sum;
+}
+
+
+/*!
+ y += a * x, векторизуемый компилятором под AVX2
+ */
+template <typename T>
+__attribute__((target("avx2")))
+void axpyAvx2(T a, const T* x, T* y, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+
+/*!
+ y += a * x, векторизуемый компилятором под AVX-512
+ */
+template <typename T>
+__attribute__((target("avx512f,avx512dq")))
+void axpyAvx512(T a, const T* x, T* y, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+#endif
+
+
+/*!
+ Скалярное произведение разреженной линии на плотный вектор
+ @param level   Набор инструкций
+ @param indexes Индексы элементов линии
+ @param values  Значения элементов линии
+ @param count   Количество элементов линии
+ @param x       Плотный вектор
+ @return Сумма values[i] * x[indexes[i]]. Порядок суммирования зависит только от level
+ */
+template <typename T>
+T dot(SimdLevel level, const size_t* indexes, const T* values, size_t count, const T* x) {
+#if MATRIX_SIMD_X86
+    if constexpr (hasVectorDot<T>) {
+        switch (level) {
+            case SimdLevel::AVX512:
+                return dotAvx512(indexes, values, count, x);
+            case SimdLevel::AVX2:
+                return dotAvx2(indexes, values, count, x);
+            case SimdLevel::SCALAR:
+                break;
+        }
+    }
+#endif
+    (void)level;
+    return dotScalar(indexes, values, count, x);
+}
+
+
+/*!
+ y += a * x для плотных векторов
+ @param level Набор инструкций
+ @param a     Множитель
+ @param x     Прибавляемый вектор
+ @param y     Изменяемый вектор
+ @param count Длина векторов
+ */
+template <typename T>
+void axpy(SimdLevel level, T a, const T* x, T* y, size_t count) {
+#if MATRIX_SIMD_X86
+    if constexpr (std::is_arithmetic_v<T>) {
+        switch (level) {
+            case SimdLevel::AVX512:
+                return axpyAvx512(a, x, y, count);
+            case SimdLevel::AVX2:
+                return axpyAvx2(a, x, y, count);
+            case SimdLevel::SCALAR:
+                break;
+        }
+    }
+#endif
+    (void)level;
+    axpyScalar(a, x, y, count);
+}
+
+}
@@ -6,126 +6,948 @@
 #pragma once
 #include "proxy.h"
 #include "data.h"
+#include "hash_data.h"
+#include "cow_data.h"
+#include "block_data.h"
+#include "dense_data.h"
+#include "indexed_data.h"
+#include "packed_data.h"
+#include "bulk_load.h"
+#include "pool_allocator.h"
+#include "range_view.h"
+#include "permuted_view.h"
+#include "matrix_snapshot.h"
+#include "default_policy.h"
+#include "expression.h"
+#include "matrix_stats.h"
+#include "instrumentation.h"
+#include "parallel_executor.h"
 #include <map>
 #include <list>
 #include <tuple>
 #include <memory>
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <stdexcept>
 
 /*!
  @brief Целевой класс, реализующий бесконечную n-мерную разреженную матрицу
- @details
+ @details Элементы, которые стратегия DefaultPolicy считает значением по умолчанию, не хранятся.
+  Стратегия -- базовый класс, поэтому пустая StaticDefault не занимает места (Matrix<T, Default, N>),
+  а RuntimeDefault хранит значение по умолчанию и допуск в объекте матрицы (RuntimeMatrix<T, N>).
+  Статистика Stats -- тоже базовый класс: с NoStats изменения матрицы не тратят на нее ни памяти, ни времени.
  @tparam T тип хранимого элемента
- @tparam Default  значение хранимого элемента по умолчанию
  @tparam N размерность матрицы
+ @tparam Storage хранилище элементов: Data<T, N> (список + std::map), HashData<T, N> (плоская хэш-таблица),
+  CowData<T, N> (страницы хэш-таблиц, копируемые при записи), IndexedData<T, N> (индекс по каждому измерению)
+  или DenseData<T, N, Extents<...>> (плотный массив).
+  Псевдонимы Matrix, RuntimeMatrix и ProbedMatrix принимают вместо хранилища Extents<...> и выбирают DenseData
+ @tparam DefaultPolicy стратегия значения по умолчанию: value() и isDefault(elem)
+ @tparam Stats статистика, обновляемая при каждом изменении: NoStats или MatrixStats<T, N, EXTREMES>
+ @tparam Probe счетчики горячих путей: NoProbe или MatrixProbe<LATENCY>, по умолчанию выбирается
+  макросом MATRIX_INSTRUMENTATION
  */
-template <typename T, T Default, size_t N>
-class Matrix : public IProxy<T, N> {
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats = NoStats, typename Probe = DefaultProbe>
+class BasicMatrix : private DefaultPolicy, private Stats, private Probe {
 public:
     /// @brief сокращение итератора
-    using Iterator = typename Data<T, N>::It;
+    using Iterator = typename Storage::It;
+    
+    /// @brief тип хранимого элемента: N индексов и значение
+    using Element = typename Storage::Element;
+    
+    /// @brief ленивое представление элементов из прямоугольника индексов
+    using View = RangeView<Storage, N>;
+    
+    /// @brief элементы в лексикографическом порядке индексов: представление упорядоченного индекса или отсортированная копия
+    using OrderedView = std::conditional_t<Storage::IS_ORDERED, View, std::vector<Element>>;
+    
+    BasicMatrix() = default;
+    explicit BasicMatrix(const DefaultPolicy& policy);
+    template <typename Expr>
+    BasicMatrix(const MatrixExpression<Expr>& expr, const DefaultPolicy& policy = DefaultPolicy{}); ///< Вычисляет выражение
+    template <typename Expr>
+    BasicMatrix& operator=(const MatrixExpression<Expr>& expr);                                       ///< Заменяет содержимое результатом выражения
+    
+    Proxy<T, N, 1, BasicMatrix> operator[](std::size_t);
+    
+    void update(const Indexes<N>& indexes, const T& value); ///< Записывает элемент в ячейку с переданными индексами
+    void update(const Indexes<N>& indexes, T&& value);      ///< Перемещает элемент в ячейку с переданными индексами
+    T get(const Indexes<N>& indexes) const;                 ///< Считывает элемент из ячейки с переданными индексами
+    const T& getRef(const Indexes<N>& indexes) const;       ///< Возвращает ссылку на хранимое значение или на Default
+    
+    template <typename... I>
+    T operator()(I... indexes) const;                       ///< Считывает элемент по N индексам без Proxy
+    void set(const Indexes<N>& indexes, const T& value);    ///< Записывает элемент за один поиск
+    void set(const Indexes<N>& indexes, T&& value);         ///< Перемещает элемент в матрицу за один поиск
+    template <typename... Args>
+    void emplace(const Indexes<N>& indexes, Args&&... args); ///< Создает значение из args и перемещает его в матрицу
+    const T* tryGet(const Indexes<N>& indexes) const;       ///< Возвращает указатель на хранимое значение или nullptr
+    Iterator find(const Indexes<N>& indexes) const;         ///< Находит хранимый элемент, end() если его нет
+    template <typename Fn>
+    void modify(const Indexes<N>& indexes, Fn fn);          ///< Изменяет элемент на месте за один поиск
+    
+    template <typename Range>
+    void bulkLoad(const Range& elements, DuplicatePolicy policy = DuplicatePolicy::KEEP_LAST); ///< Загружает набор элементов
+    template <typename Range>
+    void bulkLoad(const Range& elements, DuplicatePolicy policy, ThreadPool& pool);             ///< Загружает набор элементов, сортируя его на пуле потоков
+    void bulkLoad(std::vector<Element>&& elements, DuplicatePolicy policy = DuplicatePolicy::KEEP_LAST); ///< Загружает элементы без копирования вектора
+    void bulkLoad(std::vector<Element>&& elements, DuplicatePolicy policy, ThreadPool& pool);             ///< Загружает элементы без копирования вектора на пуле потоков
     
-    Proxy<T, N> operator[](std::size_t);
+    template <typename Fn>
+    void parallelForEach(Fn fn, ThreadPool& pool) const;                       ///< Вызывает fn(elem) для каждого элемента на пуле потоков
+    template <typename R, typename Map, typename Reduce>
+    R parallelReduce(R init, Map map, Reduce reduce, ThreadPool& pool) const;  ///< Сворачивает map(elem) операцией reduce на пуле потоков
+    template <typename Fn>
+    BasicMatrix parallelTransform(Fn fn, ThreadPool& pool) const;              ///< Возвращает матрицу из fn(value), вычисленных на пуле потоков
+#if MATRIX_EXECUTION_POLICIES
+    template <typename Policy, typename Fn>
+    IfExecutionPolicy<Policy> parallelForEach(Policy&& policy, Fn fn) const;                            ///< parallelForEach с политикой std::execution
+    template <typename Policy, typename R, typename Map, typename Reduce>
+    IfExecutionPolicy<Policy, R> parallelReduce(Policy&& policy, R init, Map map, Reduce reduce) const; ///< parallelReduce с политикой std::execution
+    template <typename Policy, typename Fn>
+    IfExecutionPolicy<Policy, BasicMatrix> parallelTransform(Policy&& policy, Fn fn) const;             ///< parallelTransform с политикой std::execution
+#endif
     
-    void update(const Indexes<N>& indexes, const T& value) override; ///< Записывает элемент в ячейку с переданными индексами
-    T get(const Indexes<N>& indexes) const override;            ///< Считывает элемент из ячейки с переданными индексами
+    View range(const Indexes<N>& lo, const Indexes<N>& hi) const; ///< Возвращает элементы из прямоугольника [lo, hi]
+    template <typename... I>
+    View slice(I... prefix) const;                                 ///< Возвращает элементы с фиксированными первыми индексами
+    OrderedView ordered() const;                                   ///< Возвращает элементы в порядке индексов
+    PermutedView<BasicMatrix, 1, 0> transpose() const;             ///< Возвращает транспонированную матрицу без копирования
+    template <size_t... Order>
+    PermutedView<BasicMatrix, Order...> permute() const;           ///< Возвращает матрицу с переставленными измерениями без копирования
     
-    Iterator begin();
-    Iterator end();
+    template <typename Fn>
+    auto apply(Fn fn) const;                                       ///< Возвращает ленивое выражение fn(*this)
+    
+    Iterator begin() const;
+    Iterator end() const;
     size_t size() const; ///< Возвращает количесвто хранимых элементов
+    
+    T defaultValue() const;                       ///< Возвращает значение по умолчанию
+    const DefaultPolicy& defaultPolicy() const;   ///< Возвращает стратегию значения по умолчанию
+    const Stats& stats() const;                   ///< Возвращает статистику элементов, не потокобезопасно
+    MatrixSnapshot<BasicMatrix> snapshot() const; ///< Возвращает версию только для чтения, разделяющую с матрицей хранилище
+    const Probe& probe() const;                   ///< Возвращает счетчики горячих путей
+    Probe& probe();                               ///< Возвращает счетчики горячих путей, например для setHook
+    const Storage& storage() const;               ///< Возвращает хранилище элементов
 private:
-    Data<T, N> m_data; ///< Объект-хранитель элементов
+    void bulkLoadImpl(std::vector<Element> elements, DuplicatePolicy policy, ThreadPool* pool); ///< Общая часть bulkLoad
+    template <typename V>
+    void setImpl(const Indexes<N>& indexes, V&& value);                                         ///< Общая часть set, V -- const T& или T
+    template <typename Fn, typename Executor>
+    void forEachImpl(Fn& fn, const Executor& executor) const;                                   ///< Общая часть parallelForEach
+    template <typename R, typename Map, typename Reduce, typename Executor>
+    R reduceImpl(R init, Map& map, Reduce& reduce, const Executor& executor) const;             ///< Общая часть parallelReduce
+    template <typename Fn, typename Executor>
+    BasicMatrix transformImpl(Fn& fn, const Executor& executor) const;                          ///< Общая часть parallelTransform
+    
+    void noteInsert(const Indexes<N>& indexes, const T& value, ProbeStamp stamp = {});  ///< Сообщает статистике и Probe о добавлении элемента
+    void noteOverwrite(const T& old, const T& value, ProbeStamp stamp = {});            ///< Сообщает статистике и Probe о перезаписи элемента
+    void noteErase(const Indexes<N>& indexes, const T& old, ProbeStamp stamp = {});     ///< Сообщает статистике и Probe об удалении элемента
+    
+    ProbeStamp probeStart() const;                                  ///< Отмечает начало операции для Probe
+    void noteProbe(ProbeEvent event, ProbeStamp stamp = {}) const;  ///< Сообщает Probe о событии
+    void noteLookup(bool found, ProbeStamp stamp) const;            ///< Сообщает Probe о поиске при чтении
+    
+    Storage m_data;    ///< Объект-хранитель элементов
 };
 
 
 /*!
- Записывает элемент в ячейку с переданными индексами
+ Создает пустую матрицу
+ @param policy Стратегия значения по умолчанию, например RuntimeDefault<double>{0.0, 1e-12}
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::BasicMatrix(const DefaultPolicy& policy) : DefaultPolicy{policy} {}
+
+
+/*!
+ Вычисляет выражение одним слиянием упорядоченных элементов операндов, без промежуточных матриц.
+ Ячейки, которых нет ни в одном операнде, равны expr.defaultValue(), поэтому оно должно быть
+ значением по умолчанию и для результата. Результаты, равные значению по умолчанию, не сохраняются.
+ @param expr   Выражение над матрицами той же размерности, например a + 2 * b
+ @param policy Стратегия значения по умолчанию результата
+ @throw std::runtime_error Если пустые ячейки выражения не равны значению по умолчанию результата
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Expr>
+BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::BasicMatrix(const MatrixExpression<Expr>& expr, const DefaultPolicy& policy) : DefaultPolicy{policy} {
+    static_assert(Expr::DIMENSION == N, "Expression dimension must match matrix dimension");
+    
+    const Expr& e = expr.self();
+    if (!defaultPolicy().isDefault(static_cast<T>(e.defaultValue()))) {
+        throw std::runtime_error("Expression does not evaluate to the default value in empty cells");
+    }
+    
+    for (typename Expr::Cursor cursor{e}; !cursor.done(); cursor.next()) {
+        T value = static_cast<T>(cursor.value());
+        if (defaultPolicy().isDefault(value)) {
+            continue;
+        }
+        const auto key = m_data.makeKey(cursor.key());
+        if constexpr (Storage::IS_ORDERED) {
+            // ключи приходят по возрастанию, поэтому вставка в конец индекса -- амортизированное O(1)
+            noteInsert(cursor.key(), m_data.emplace(m_data.mapEnd(), key, std::move(value)));
+        } else {
+            noteInsert(cursor.key(), m_data.emplace(m_data.locate(key).second, key, std::move(value)));
+        }
+    }
+}
+
+
+/*!
+ Вычисляет выражение во временную матрицу и перемещает ее в себя, поэтому матрица может
+ участвовать в собственном выражении: a = a + b
+ @param expr Выражение
+ @return Ссылку на себя
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Expr>
+BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>& BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::operator=(const MatrixExpression<Expr>& expr) {
+    *this = BasicMatrix{expr, defaultPolicy()};
+    return *this;
+}
+
+
+/*!
+ Записывает элемент в ячейку с переданными индексами. Вызывается из Proxy
  @param indexes  Набор индексов
  @param value Записываемое значение
  */
-template <typename T, T Default, size_t N>
-void Matrix<T, Default, N>::update(const Indexes<N>& indexes, const T& value) {
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::update(const Indexes<N>& indexes, const T& value) {
+    set(indexes, value);
+}
+
+
+/*!
+ Перемещает элемент в ячейку с переданными индексами. Вызывается из Proxy для rvalue
+ @param indexes Набор индексов
+ @param value   Записываемое значение
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::update(const Indexes<N>& indexes, T&& value) {
+    set(indexes, std::move(value));
+}
+
+
+/*!
+Считывет элемент в ячейку с переданными индексами
+@param indexes  Набор индексов
+@return Хранимое значение или Default, если элемента нет
+*/
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+T BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::get(const Indexes<N>& indexes) const {
+    const T* value = tryGet(indexes);
+    return value != nullptr ? *value : defaultValue();
+}
+
+
+/*!
+ Считывает элемент без копирования: для тяжелых T вместо get()
+ @param indexes Набор индексов
+ @return Ссылка на хранимое значение или на значение по умолчанию стратегии.
+  Ссылка на хранимое значение действительна до следующего изменения матрицы
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+const T& BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::getRef(const Indexes<N>& indexes) const {
+    const T* value = tryGet(indexes);
+    return value != nullptr ? *value : defaultPolicy().value();
+}
+
+
+/*!
+ Считывает элемент по N индексам: matrix(i, j, k) равносильно matrix.get({i, j, k})
+ @param indexes Индексы, приводимые к size_t, ровно N штук
+ @return Хранимое значение или Default
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename... I>
+T BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::operator()(I... indexes) const {
+    static_assert(sizeof...(I) == N, "Matrix::operator() requires exactly N indexes");
+    return get(Indexes<N>{static_cast<size_t>(indexes)...});
+}
+
+
+/*!
+ Записывает элемент в ячейку с переданными индексами, выполняя ровно один поиск в хранилище
+ @param indexes Набор индексов
+ @param value   Записываемое значение, копируется в хранилище один раз
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::set(const Indexes<N>& indexes, const T& value) {
+    setImpl(indexes, value);
+}
+
+
+/*!
+ Перемещает элемент в ячейку с переданными индексами, выполняя ровно один поиск в хранилище.
+ Значение не копируется: новый элемент создается в хранилище перемещением, существующий
+ перезаписывается перемещающим присваиванием
+ @param indexes Набор индексов
+ @param value   Записываемое значение
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::set(const Indexes<N>& indexes, T&& value) {
+    setImpl(indexes, std::move(value));
+}
+
+
+/*!
+ Создает значение T(args...) и перемещает его в матрицу: matrix.emplace({i, j}, 1, 2, 3).
+ Значение создается до записи, потому что его нужно сравнить со значением по умолчанию
+ @param indexes Набор индексов
+ @param args    Аргументы конструктора T
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename... Args>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::emplace(const Indexes<N>& indexes, Args&&... args) {
+    setImpl(indexes, T(std::forward<Args>(args)...));
+}
+
+
+/*!
+ Общая часть set: значение передается в хранилище через std::forward
+ @param indexes Набор индексов
+ @param value   Записываемое значение
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename V>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::setImpl(const Indexes<N>& indexes, V&& value) {
     /*
       1. Если пришло    значение по умолчанию и элемент с такими индексами    существует
       -- удаляем этот элемент
       2. Если пришло    значение по умолчанию и элемент с такими индексами НЕ существует
       -- ничего не делаем
       3. Если пришло НЕ значение по умолчанию и элемент с такими индексами НЕ существует
-      -- сохраняем этот элемент
+      -- сохраняем этот элемент в место, найденное поиском
       4. Если пришло НЕ значение по умолчанию и элемент с такими индексами    существует
-      -- удаляем старое значение по этому ключу и затем добавляем новое с таким же ключом
+      -- перезаписываем значение по найденному итератору
      */
-     
-    const auto key = m_data.makeKey(indexes);
-    const bool is_default = value == Default;
-    const auto [exists, it] = m_data.contains(key);
+    
+    const ProbeStamp stamp = probeStart();
+    const auto [fits, key] = detail::tryMakeKey(m_data, indexes);
+    if (!fits) {
+        // такой ячейки не может быть в хранилище: Default в ней уже записан, другое значение не сохранить
+        if (!defaultPolicy().isDefault(value)) {
+            m_data.makeKey(indexes); // бросает исключение хранилища
+        }
+        return;
+    }
+    const auto [exists, it] = m_data.locate(key);
+    noteProbe(ProbeEvent::LOOKUP);
+    
+    if (defaultPolicy().isDefault(value)) {
+        if (exists) {
+            // п.1
+            noteErase(indexes, m_data.value(it), stamp);
+            m_data.erase(it);
+        }
+    } else if (exists) {
+        // п.4
+        noteOverwrite(m_data.value(it), value, stamp);
+        m_data.insert(it, key, std::forward<V>(value));
+    } else {
+        // п.3
+        noteInsert(indexes, m_data.emplace(it, key, std::forward<V>(value)), stamp);
+    }
+}
 
-    if (is_default && exists) {
-        // п.1 Значение по умолчанию и элемент с такими индексами существует
-        m_data.erase(it);
-    } else if (!is_default) {
-        // п.3 & п.4 Пришло НЕ значение по умолчанию
-        m_data.insert(it, key, value); // Data<T, N>::insert удалит старое значение,
-                                       // в случае, когда элемент по такому ключу уже существует
+
+/*!
+ Ищет элемент без копирования значения
+ @param indexes Набор индексов
+ @return Указатель на хранимое значение или nullptr, если в ячейке Default.
+  Указатель действителен до следующего изменения матрицы
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+const T* BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::tryGet(const Indexes<N>& indexes) const {
+    const ProbeStamp stamp = probeStart();
+    const auto [fits, key] = detail::tryMakeKey(m_data, indexes);
+    if (!fits) {
+        noteLookup(false, stamp);
+        return nullptr;
     }
+    const auto [found, it] = m_data.locate(key);
+    noteLookup(found, stamp);
+    return found ? &m_data.value(it) : nullptr;
 }
 
 
 /*!
-Считывет элемент в ячейку с переданными индексами
-@param indexes  Набор индексов
-@return Хранимое значение
-*/
-template <typename T, T Default, size_t N>
-T Matrix<T, Default, N>::get(const Indexes<N>& indexes) const {
-    /*
-     1. Если элемент с такими индексами    существует
-     -- возвращаем его
-     2. Если элемент с такими индексами НЕ существует
-     -- возвращаем значение по умолчанию
-     */
+ Находит хранимый элемент
+ @param indexes Набор индексов
+ @return Итератор на элемент (индекс_1, ..., индекс_N, значение) или end()
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+typename BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::Iterator BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::find(const Indexes<N>& indexes) const {
+    const ProbeStamp stamp = probeStart();
+    const auto [fits, key] = detail::tryMakeKey(m_data, indexes);
+    const auto it = fits ? m_data.find(key) : m_data.end();
+    noteLookup(it != m_data.end(), stamp);
+    return it;
+}
+
+
+/*!
+ Изменяет элемент за один поиск в хранилище: fn получает ссылку на хранимое значение или,
+ если элемента нет, на копию Default. Если после fn значение равно Default, элемент удаляется,
+ если значение отлично от Default, отсутствовавший элемент добавляется. Существующий элемент
+ изменяется на месте и сохраняет свое положение при итерировании.
+ @param indexes Набор индексов
+ @param fn      Функция вида void(T&)
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Fn>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::modify(const Indexes<N>& indexes, Fn fn) {
+    const ProbeStamp stamp = probeStart();
+    const auto [fits, key] = detail::tryMakeKey(m_data, indexes);
+    if (!fits) {
+        // ячейки нет в хранилище; сохранить в нее значение, отличное от Default, нельзя
+        T value = defaultValue();
+        fn(value);
+        if (!defaultPolicy().isDefault(value)) {
+            m_data.makeKey(indexes); // бросает исключение хранилища
+        }
+        return;
+    }
+    const auto [exists, it] = m_data.locate(key);
+    noteProbe(ProbeEvent::LOOKUP);
     
-    const auto key  = m_data.makeKey(indexes);
-    const auto [status, elem] = m_data.getElement(key);
+    if (exists) {
+        T& value = m_data.value(it);
+        // прежнее значение нужно только статистике, без нее копия не создается
+        std::conditional_t<Stats::ENABLED, const T, const T&> old = value;
+        fn(value);
+        if (defaultPolicy().isDefault(value)) {
+            noteErase(indexes, old, stamp);
+            m_data.erase(it);
+        } else {
+            noteOverwrite(old, value, stamp);
+        }
+        return;
+    }
     
-    switch (status) {
-        case Data<T, N>::FindStatus::FOUND:
-            // п.1
-            return elem;
-            break;
-        case Data<T, N>::FindStatus::NOT_FOUND:
-            // п.2
-            return Default;
-            break;
+    T value = defaultValue();
+    fn(value);
+    if (!defaultPolicy().isDefault(value)) {
+        noteInsert(indexes, m_data.emplace(it, key, std::move(value)), stamp);
+    }
+}
+
+
+/*!
+ Загружает набор элементов в обход Proxy. Значения, равные Default, во входных данных пропускаются.
+ Повторяющиеся индексы разрешаются согласно policy, причем уже хранящееся в матрице значение
+ считается встретившимся раньше загружаемого. Итоговые значения, равные Default, не сохраняются.
+ Для упорядоченного хранилища элементы сортируются и пустая матрица строится за один проход,
+ для неупорядоченного -- место резервируется один раз и элементы вставляются без сортировки.
+ @param elements Диапазон кортежей (индекс_1, ..., индекс_N, значение)
+ @param policy   Способ разрешения повторяющихся индексов
+ @throw std::runtime_error Для DuplicatePolicy::THROW при повторении индексов, матрица при этом может быть загружена частично
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Range>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::bulkLoad(const Range& elements, DuplicatePolicy policy) {
+    bulkLoadImpl(std::vector<Element>(std::begin(elements), std::end(elements)), policy, nullptr);
+}
+
+
+/*!
+ @copydoc bulkLoad(const Range&, DuplicatePolicy)
+ @param pool Пул потоков, на котором сортируются элементы
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Range>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::bulkLoad(const Range& elements, DuplicatePolicy policy, ThreadPool& pool) {
+    bulkLoadImpl(std::vector<Element>(std::begin(elements), std::end(elements)), policy, &pool);
+}
+
+
+/*!
+ @copydoc bulkLoad(const Range&, DuplicatePolicy)
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::bulkLoad(std::vector<Element>&& elements, DuplicatePolicy policy) {
+    bulkLoadImpl(std::move(elements), policy, nullptr);
+}
+
+
+/*!
+ @copydoc bulkLoad(const Range&, DuplicatePolicy, ThreadPool&)
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::bulkLoad(std::vector<Element>&& elements, DuplicatePolicy policy, ThreadPool& pool) {
+    bulkLoadImpl(std::move(elements), policy, &pool);
+}
+
+
+/*!
+ Общая часть bulkLoad
+ @param elements Копия загружаемых элементов
+ @param policy   Способ разрешения повторяющихся индексов
+ @param pool     Пул потоков или nullptr
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::bulkLoadImpl(std::vector<Element> elements, DuplicatePolicy policy, ThreadPool* pool) {
+    const auto is_default = [this](const Element& elem) { return defaultPolicy().isDefault(std::get<N>(elem)); };
+    elements.erase(std::remove_if(elements.begin(), elements.end(), is_default), elements.end());
+    
+    if constexpr (Storage::IS_ORDERED) {
+        sortUnique<N>(elements, policy, pool);
+        if (m_data.size() == 0) {
+            elements.erase(std::remove_if(elements.begin(), elements.end(), is_default), elements.end());
+            m_data.assign(std::make_move_iterator(elements.begin()), std::make_move_iterator(elements.end()));
+            for (const auto& elem : m_data) {
+                noteInsert(detail::elementIndexes<N>(elem), std::get<N>(elem));
+            }
+            return;
+        }
+    }
+    
+    m_data.reserve(m_data.size() + elements.size());
+    for (auto& elem : elements) {
+        const Indexes<N> indexes = detail::elementIndexes<N>(elem);
+        const auto key = m_data.makeKey(indexes);
+        const auto [exists, it] = m_data.locate(key);
+        
+        if (!exists) {
+            noteInsert(indexes, m_data.emplace(it, key, std::move(std::get<N>(elem))));
+            continue;
+        }
+        
+        T value = resolveDuplicate(m_data.value(it), std::get<N>(elem), policy);
+        if (defaultPolicy().isDefault(value)) {
+            noteErase(indexes, m_data.value(it));
+            m_data.erase(it);
+        } else {
+            noteOverwrite(m_data.value(it), value);
+            m_data.insert(it, key, std::move(value));
+        }
+    }
+}
+
+
+/*!
+ Вызывает fn для каждого хранимого элемента. Хранилище делится на последовательные части
+ (Storage::split): соседние участки массива для HashData, страницы CowData, тайлы BlockData,
+ части раздаются потокам пула. fn вызывается одновременно из нескольких потоков, порядок вызовов не определен.
+ Матрицу нельзя изменять, пока выполняется обход
+ @param fn   Функция вида void(const Element&)
+ @param pool Пул потоков
+ @throw Первое исключение, выброшенное fn
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Fn>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::parallelForEach(Fn fn, ThreadPool& pool) const {
+    forEachImpl(fn, PoolExecutor{pool});
+}
+
+
+/*!
+ Сворачивает значения map(elem) всех хранимых элементов: каждая часть хранилища сворачивается
+ в своем потоке, затем результаты частей сворачиваются с init по порядку. reduce должна быть
+ ассоциативной, результат детерминирован при одном и том же размере пула
+ @param init   Начальное значение, возвращается для пустой матрицы
+ @param map    Функция вида R(const Element&)
+ @param reduce Функция вида R(R, R)
+ @param pool   Пул потоков
+ @return Свертка init и map(elem) всех элементов
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename R, typename Map, typename Reduce>
+R BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::parallelReduce(R init, Map map, Reduce reduce, ThreadPool& pool) const {
+    return reduceImpl(std::move(init), map, reduce, PoolExecutor{pool});
+}
+
+
+/*!
+ Возвращает матрицу с той же стратегией значения по умолчанию, в которой каждое хранимое значение v
+ заменено на fn(v). fn вычисляется на пуле потоков, результаты, равные значению по умолчанию, не сохраняются.
+ Пустые ячейки остаются пустыми, поэтому fn(Default) не вычисляется
+ @param fn   Функция вида T(const T&)
+ @param pool Пул потоков, на нем же сортируются элементы упорядоченного хранилища
+ @return Новая матрица
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Fn>
+BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::parallelTransform(Fn fn, ThreadPool& pool) const {
+    return transformImpl(fn, PoolExecutor{pool});
+}
+
+
+#if MATRIX_EXECUTION_POLICIES
+
+/*!
+ @copydoc parallelForEach(Fn, ThreadPool&)
+ @param policy Политика std::execution, части хранилища обрабатывает std::for_each(policy, ...)
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Policy, typename Fn>
+IfExecutionPolicy<Policy> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::parallelForEach(Policy&& policy, Fn fn) const {
+    forEachImpl(fn, PolicyExecutor<std::decay_t<Policy>>{policy});
+}
+
+
+/*!
+ @copydoc parallelReduce(R, Map, Reduce, ThreadPool&)
+ @param policy Политика std::execution
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Policy, typename R, typename Map, typename Reduce>
+IfExecutionPolicy<Policy, R> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::parallelReduce(Policy&& policy, R init, Map map, Reduce reduce) const {
+    return reduceImpl(std::move(init), map, reduce, PolicyExecutor<std::decay_t<Policy>>{policy});
+}
+
+
+/*!
+ @copydoc parallelTransform(Fn, ThreadPool&)
+ @param policy Политика std::execution
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Policy, typename Fn>
+IfExecutionPolicy<Policy, BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::parallelTransform(Policy&& policy, Fn fn) const {
+    return transformImpl(fn, PolicyExecutor<std::decay_t<Policy>>{policy});
+}
+
+#endif
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Fn, typename Executor>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::forEachImpl(Fn& fn, const Executor& executor) const {
+    const auto ranges = m_data.split(detail::chunkCount(size(), executor.concurrency()));
+    executor.run(ranges.size(), [&ranges, &fn](size_t i) {
+        for (auto it = ranges[i].first; it != ranges[i].second; ++it) {
+            fn(*it);
+        }
+    });
+}
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename R, typename Map, typename Reduce, typename Executor>
+R BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::reduceImpl(R init, Map& map, Reduce& reduce, const Executor& executor) const {
+    const auto ranges = m_data.split(detail::chunkCount(size(), executor.concurrency()));
+    // части непустые, поэтому свертка части начинается с ее первого элемента и не требует нейтрального элемента
+    std::vector<std::optional<R>> partial(ranges.size());
+    executor.run(ranges.size(), [&](size_t i) {
+        auto it = ranges[i].first;
+        R acc = map(*it);
+        for (++it; it != ranges[i].second; ++it) {
+            acc = reduce(std::move(acc), map(*it));
+        }
+        partial[i].emplace(std::move(acc));
+    });
+    
+    for (auto& value : partial) {
+        init = reduce(std::move(init), std::move(*value));
+    }
+    return init;
+}
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Fn, typename Executor>
+BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::transformImpl(Fn& fn, const Executor& executor) const {
+    const auto ranges = m_data.split(detail::chunkCount(size(), executor.concurrency()));
+    std::vector<std::vector<Element>> parts(ranges.size());
+    executor.run(ranges.size(), [&](size_t i) {
+        for (auto it = ranges[i].first; it != ranges[i].second; ++it) {
+            T value = fn(std::get<N>(*it));
+            if (!defaultPolicy().isDefault(value)) {
+                parts[i].push_back(makeElemImpl(elemKeyImpl(*it, std::make_index_sequence<N>{}), std::make_index_sequence<N>{}, std::move(value)));
+            }
+        }
+    });
+    
+    std::vector<Element> elements;
+    elements.reserve(size());
+    for (auto& part : parts) {
+        std::move(part.begin(), part.end(), std::back_inserter(elements));
     }
+    
+    BasicMatrix result{defaultPolicy()};
+    if constexpr (Storage::IS_ORDERED) {
+        if (ThreadPool* pool = executor.pool()) {
+            result.bulkLoad(std::move(elements), DuplicatePolicy::KEEP_LAST, *pool);
+        } else {
+            result.bulkLoad(std::move(elements));
+        }
+    } else {
+        // ключи уникальны, поэтому неупорядоченное хранилище строится целиком без поиска
+        result.m_data.assign(std::make_move_iterator(elements.begin()), std::make_move_iterator(elements.end()));
+        for (const auto& elem : result.m_data) {
+            result.noteInsert(detail::elementIndexes<N>(elem), std::get<N>(elem));
+        }
+    }
+    return result;
+}
+
+
+/*!
+ Возвращает ленивое представление элементов, индексы которых лежат в прямоугольнике.
+ Стоимость пропорциональна размеру результата, только если прямоугольник ограничивает ведущие
+ измерения индекса: для упорядоченного хранилища обход стоит O(log nnz) на каждый встреченный префикс ключа.
+ С Data столбец двумерной матрицы, range({0, j}, {SIZE_MAX, j}), поэтому стоит O(строк * log nnz);
+ IndexedData (IndexedMatrix) держит индекс по каждому измерению, и тот же столбец стоит
+ O(log nnz + размер столбца). Для неупорядоченного хранилища (HashData, CowData, BlockData) перебираются все элементы -- O(nnz)
+ @param lo Нижние границы по каждому измерению (включительно)
+ @param hi Верхние границы по каждому измерению (включительно)
+ @return Представление, итерирование идет в порядке ключей выбранного индекса упорядоченного хранилища, см. RangeView
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+typename BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::View BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::range(const Indexes<N>& lo, const Indexes<N>& hi) const {
+    return {&m_data, lo, hi};
+}
+
+
+/*!
+ Возвращает ленивое представление элементов с фиксированными первыми индексами:
+ matrix.slice(17) -- строка 17 двумерной матрицы, matrix.slice(1, 2) -- линия (1, 2, *) трехмерной.
+ Префикс -- ведущие измерения, поэтому для упорядоченного хранилища срез стоит
+ O(log nnz + размер результата), для неупорядоченного -- O(nnz), см. range()
+ @param prefix Значения первых sizeof...(I) индексов, не больше N
+ @return Представление
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename... I>
+typename BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::View BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::slice(I... prefix) const {
+    static_assert(sizeof...(I) <= N, "Matrix::slice accepts at most N indexes");
+    
+    const size_t fixed[] = {static_cast<size_t>(prefix)..., 0};
+    Indexes<N> lo{};
+    Indexes<N> hi;
+    hi.fill(std::numeric_limits<size_t>::max());
+    for (size_t d = 0; d < sizeof...(I); ++d) {
+        lo[d] = hi[d] = fixed[d];
+    }
+    return range(lo, hi);
+}
+
+
+/*!
+ Возвращает элементы в лексикографическом порядке индексов, в отличие от begin()/end(),
+ которые перебирают элементы в порядке вставки. Для упорядоченного хранилища это ленивое
+ представление над его индексом (O(1) на создание, без копирования), для неупорядоченного --
+ копия элементов, отсортированная за O(nnz log nnz)
+ @return Диапазон элементов (индекс_1, ..., индекс_N, значение)
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+typename BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::OrderedView BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::ordered() const {
+    if constexpr (Storage::IS_ORDERED) {
+        return slice();
+    } else {
+        std::vector<Element> elements(m_data.begin(), m_data.end());
+        std::sort(elements.begin(), elements.end(), ElementKeyLess<N>{});
+        return elements;
+    }
+}
+
+
+/*!
+ Транспонирует двумерную матрицу без копирования: matrix.transpose()(i, j) == matrix(j, i)
+ @return Представление над матрицей, см. permuted_view.h
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+PermutedView<BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>, 1, 0> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::transpose() const {
+    static_assert(N == 2, "Matrix::transpose requires a two-dimensional matrix");
+    return PermutedView<BasicMatrix, 1, 0>{*this};
+}
+
+
+/*!
+ Переставляет измерения без копирования: измерение d представления -- измерение Order[d] матрицы,
+ matrix.permute<1, 0, 2>() превращает (user, item, day) в (item, user, day)
+ @tparam Order Перестановка чисел 0, ..., N - 1
+ @return Представление над матрицей, см. permuted_view.h
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <size_t... Order>
+PermutedView<BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>, Order...> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::permute() const {
+    static_assert(sizeof...(Order) == N, "Matrix::permute requires exactly N dimensions");
+    return PermutedView<BasicMatrix, Order...>{*this};
+}
+
+
+/*!
+ Поэлементное преобразование, см. expression.h
+ @param fn Функция вида T(T), вызывается для хранимых элементов и для значения по умолчанию
+ @return Ленивое выражение, ссылающееся на матрицу
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+template <typename Fn>
+auto BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::apply(Fn fn) const {
+    return UnaryExpression{MatrixOperand<BasicMatrix>{*this}, std::move(fn)};
 }
 
 
 /*!
 @return Количество хранимых элементов
 */
-template <typename T, T Default, size_t N>
-size_t Matrix<T, Default, N>::size() const {
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+size_t BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::size() const {
     return m_data.size();
 }
 
 
+/*!
+@return Значение, которое возвращается для отсутствующих элементов
+*/
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+T BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::defaultValue() const {
+    return DefaultPolicy::value();
+}
+
+
+/*!
+@return Стратегия значения по умолчанию
+*/
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+const DefaultPolicy& BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::defaultPolicy() const {
+    return *this;
+}
+
+
+/*!
+ Возвращает статистику элементов. Доступно, если Stats::ENABLED. Устаревшие после удаления или
+ перезаписи экстремумы пересчитываются здесь за O(nnz), иначе вызов -- O(1). Несмотря на const,
+ пересчет изменяет статистику, поэтому одновременные вызовы stats() из разных потоков -- гонка данных
+ @return Статистика, действительна до следующего изменения матрицы
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+const Stats& BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::stats() const {
+    static_assert(Stats::ENABLED, "BasicMatrix::stats requires a statistics policy such as MatrixStats");
+    Stats::refresh(m_data.begin(), m_data.end());
+    return *this;
+}
+
+
+/*!
+ Создает версию матрицы для чтения, пока матрица продолжает изменяться. Хранилище CowData
+ копируется за O(1), после чего запись в матрицу копирует только затронутые страницы, а страницы,
+ которые больше не нужны ни одной версии, освобождаются. Версия только для чтения, изменяемую
+ копию дает snapshot().matrix(), ее запись на матрицу не влияет. Статистика Stats копируется целиком.
+ @return Неизменяемая версия матрицы
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+MatrixSnapshot<BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::snapshot() const {
+    static_assert(detail::IsCopyOnWrite<Storage>::value, "Matrix::snapshot requires a copy-on-write storage such as CowData");
+    return MatrixSnapshot<BasicMatrix>{*this};
+}
+
+
+/*!
+ Возвращает счетчики горячих путей. Доступно, если Probe::ENABLED
+ @return Стратегия Probe, например MatrixProbe: report(), reset(), setHook()
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+const Probe& BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::probe() const {
+    static_assert(Probe::ENABLED, "BasicMatrix::probe requires an instrumentation policy such as MatrixProbe");
+    return *this;
+}
+
+
+/*!
+ Возвращает счетчики горячих путей. Доступно, если Probe::ENABLED
+ @return Стратегия Probe, например MatrixProbe: report(), reset(), setHook()
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+Probe& BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::probe() {
+    static_assert(Probe::ENABLED, "BasicMatrix::probe requires an instrumentation policy such as MatrixProbe");
+    return *this;
+}
+
+
+/*!
+ Возвращает хранилище, например чтобы узнать объем памяти Data с CountingAllocator:
+ matrix.storage().allocator().bytes()
+ @return Хранилище элементов
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+const Storage& BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::storage() const {
+    return m_data;
+}
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::noteInsert(const Indexes<N>& indexes, const T& value, ProbeStamp stamp) {
+    if constexpr (Stats::ENABLED) {
+        Stats::onInsert(indexes, value);
+    }
+    noteProbe(ProbeEvent::INSERT, stamp);
+}
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::noteOverwrite(const T& old, const T& value, ProbeStamp stamp) {
+    if constexpr (Stats::ENABLED) {
+        Stats::onOverwrite(old, value);
+    }
+    noteProbe(ProbeEvent::OVERWRITE, stamp);
+}
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::noteErase(const Indexes<N>& indexes, const T& old, ProbeStamp stamp) {
+    if constexpr (Stats::ENABLED) {
+        Stats::onErase(indexes, old);
+    }
+    noteProbe(ProbeEvent::DEFAULT_ERASE, stamp);
+}
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+ProbeStamp BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::probeStart() const {
+    if constexpr (Probe::ENABLED) {
+        return Probe::start();
+    } else {
+        return {};
+    }
+}
+
+
+/*!
+ Учитывает событие в Probe. Задержка измеряется, только если передана отметка stamp из probeStart()
+ @param event Событие
+ @param stamp Начало операции или пустая отметка
+ */
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::noteProbe(ProbeEvent event, ProbeStamp stamp) const {
+    if constexpr (Probe::ENABLED) {
+        Probe::record(event, stamp);
+    }
+}
+
+
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+void BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::noteLookup(bool found, ProbeStamp stamp) const {
+    if constexpr (Probe::ENABLED) {
+        Probe::recordLookup(found, stamp);
+    }
+}
+
+
 /*!
 @return Проксирующий класс
 */
-template <typename T, T Default, size_t N>
-Proxy<T, N> Matrix<T, Default, N>::operator[](std::size_t index) {
-    Proxy proxy = Proxy<T, N>{this};
-    proxy.addIndex(index);
-    return proxy;
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+Proxy<T, N, 1, BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>> BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::operator[](std::size_t index) {
+    Indexes<N> indexes{};
+    indexes[0] = index;
+    return {this, indexes};
 }
 
 
 /*!
 @return Итератор на начало диапазона элементов
 */
-template <typename T, T Default, size_t N>
-typename Matrix<T, Default, N>::Iterator Matrix<T, Default, N>::begin() {
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+typename BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::Iterator BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::begin() const {
     return m_data.begin();
 }
 
@@ -133,12 +955,42 @@ typename Matrix<T, Default, N>::Iterator Matrix<T, Default, N>::begin() {
 /*!
 @return Итератор на конец диапазона элементов
 */
-template <typename T, T Default, size_t N>
-typename Matrix<T, Default, N>::Iterator Matrix<T, Default, N>::end() {
+template <typename T, size_t N, typename Storage, typename DefaultPolicy, typename Stats, typename Probe>
+typename BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::Iterator BasicMatrix<T, N, Storage, DefaultPolicy, Stats, Probe>::end() const {
     return m_data.end();
 }
 
+/// @brief матрица со значением по умолчанию, заданным параметром шаблона. Storage = Extents<...> выбирает DenseData
+template <typename T, T Default, size_t N, typename Storage = Data<T, N>, typename Stats = NoStats>
+using Matrix = BasicMatrix<T, N, typename detail::SelectStorage<T, N, Storage>::type, StaticDefault<T, Default>, Stats>;
+/// @brief матрица со значением по умолчанию и допуском, заданными при создании, например для double
+template <typename T, size_t N, typename Storage = Data<T, N>>
+using RuntimeMatrix = BasicMatrix<T, N, typename detail::SelectStorage<T, N, Storage>::type, RuntimeDefault<T>>;
+/// @brief матрица, поддерживающая сумму, количество элементов в срезах и экстремумы за O(1)
+template <typename T, T Default, size_t N, typename Storage = Data<T, N>>
+using StatsMatrix = Matrix<T, Default, N, Storage, MatrixStats<T, N, true>>;
 /// @brief сокращение для двумерной матрицы с нулевым значением по умолчанию
 template <typename T, T Default = 0> using Matrix2D = Matrix<T, Default, 2>;
 /// @brief сокращение для трехмерной матрицы с нулевым значением по умолчанию
 template <typename T, T Default = 0> using Matrix3D = Matrix<T, Default, 3>;
+/// @brief матрица, узлы хранилища которой выделяются из пула PoolAllocator
+template <typename T, T Default, size_t N>
+using PoolMatrix = Matrix<T, Default, N, Data<T, N, PoolAllocator<ElementType<T, N>>>>;
+/// @brief матрица с индексами меньше 2^Bits, ключи которой упакованы в одно целое
+template <typename T, T Default, size_t N, size_t Bits = 64 / N>
+using PackedMatrix = Matrix<T, Default, N, PackedData<T, N, Bits>>;
+/// @brief матрица с упорядоченным индексом по каждому измерению: range() по любому измерению стоит O(log nnz + размер результата)
+template <typename T, T Default, size_t N>
+using IndexedMatrix = Matrix<T, Default, N, IndexedData<T, N>>;
+/// @brief матрица, версии которой (snapshot()) создаются за O(1) и разделяют неизмененные страницы
+template <typename T, T Default, size_t N>
+using CowMatrix = Matrix<T, Default, N, CowData<T, N>>;
+/// @brief матрица, хранящая элементы плотными тайлами формы Shape (8x8 для N = 2, 4x4x4 для N = 3)
+template <typename T, T Default, size_t N, typename Shape = typename detail::CubeTile<N>::type>
+using BlockMatrix = Matrix<T, Default, N, BlockData<T, N, Shape>>;
+/// @brief матрица размера E_1 x ... x E_N, хранящая элементы плотным массивом с маской занятых ячеек
+template <typename T, T Default, size_t... E>
+using FixedMatrix = Matrix<T, Default, sizeof...(E), Extents<E...>>;
+/// @brief матрица со счетчиками горячих путей независимо от MATRIX_INSTRUMENTATION
+template <typename T, T Default, size_t N, typename Storage = Data<T, N>, typename Probe = MatrixProbe<>>
+using ProbedMatrix = BasicMatrix<T, N, typename detail::SelectStorage<T, N, Storage>::type, StaticDefault<T, Default>, NoStats, Probe>;
@@ -0,0 +1,466 @@
+/*!
+@file
+@brief Заголовочный файл с потоковым чтением и записью матрицы в текстовых координатных форматах:
+ MatrixMarket (.mtx) и строки "i j v" (CSV)
+*/
+
+#pragma once
+
+#include "sparse_matrix.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/// Текстовый формат матрицы
+enum class TextFormat {
+    MATRIX_MARKET, ///< MatrixMarket coordinate: заголовок, строка размеров, индексы с единицы
+    COORDINATE     ///< Строки "i j v" или "i,j,v", индексы с нуля, строки с '#' -- комментарии
+};
+
+
+namespace detail {
+
+/// Заголовок файла MatrixMarket
+template <size_t N>
+struct MarketHeader {
+    bool pattern = false;   ///< Значения не записаны, каждый элемент равен единице
+    bool symmetric = false; ///< Записан только нижний треугольник, элемент (i, j) означает и (j, i)
+    bool sized = false;     ///< Строка размеров прочитана, extents и entries нужно проверить
+    Indexes<N> extents{};   ///< Объявленные протяженности по каждому измерению
+    size_t entries = 0;     ///< Объявленное количество строк с элементами
+    size_t body = 0;        ///< Смещение первой строки с элементами
+};
+
+
+/// Размер буфера записи, больше этого объема в памяти не накапливается
+constexpr size_t TEXT_WRITE_BUFFER = 1 << 20;
+
+
+/// Проверяет, является ли символ разделителем полей
+inline bool isSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+
+/// Возвращает строку в нижнем регистре
+inline std::string lowercase(std::string_view text) {
+    std::string result{text};
+    for (auto& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+
+/*!
+ Разбирает число в начале [first, last)
+ @return Указатель на символ после числа
+ @throw std::runtime_error Если число не удалось разобрать
+ */
+template <typename V>
+const char* parseNumber(const char* first, const char* last, V& value, size_t offset) {
+    if constexpr (std::is_same_v<V, bool>) {
+        // std::from_chars для bool не определен: значение записывается как 0 или 1
+        unsigned number = 0;
+        const char* end = parseNumber(first, last, number, offset);
+        if (number > 1) {
+            throw std::runtime_error("Malformed boolean at byte " + std::to_string(offset));
+        }
+        value = number != 0;
+        return end;
+    } else {
+        if constexpr (!std::is_integral_v<V>) {
+            if (first != last && *first == '+') {
+                ++first;
+            }
+        }
+        const auto [end, error] = std::from_chars(first, last, value);
+        if (error != std::errc{}) {
+            throw std::runtime_error("Malformed number at byte " + std::to_string(offset));
+        }
+        return end;
+    }
+}
+
+
+/*!
+ Разбирает заголовок MatrixMarket: строку "%%MatrixMarket matrix coordinate <field> <symmetry>",
+ комментарии и строку размеров
+ @tparam N Размерность матрицы: строка размеров содержит N протяженностей и количество элементов
+ @param text Содержимое файла
+ @return Заголовок
+ @throw std::runtime_error Для неподдерживаемого или поврежденного заголовка
+ */
+template <size_t N>
+MarketHeader<N> parseMarketHeader(std::string_view text) {
+    const size_t banner_end = std::min(text.find('\n'), text.size());
+    const std::string banner = lowercase(text.substr(0, banner_end));
+    if (banner.rfind("%%matrixmarket", 0) != 0 || banner.find("coordinate") == std::string::npos) {
+        throw std::runtime_error("Only MatrixMarket coordinate files are supported");
+    }
+    if (banner.find("complex") != std::string::npos || banner.find("hermitian") != std::string::npos
+        || banner.find("skew-symmetric") != std::string::npos) {
+        throw std::runtime_error("Unsupported MatrixMarket field or symmetry: " + banner);
+    }
+
+    MarketHeader<N> header;
+    header.pattern = banner.find("pattern") != std::string::npos;
+    header.symmetric = banner.find("symmetric") != std::string::npos;
+
+    size_t position = banner_end;
+    while (position < text.size()) {
+        const size_t start = position + 1;
+        const size_t end = std::min(text.find('\n', start), text.size());
+        const std::string_view line = text.substr(start, end - start);
+        position = end;
+        if (line.empty() || line[0] == '%' || line.find_first_not_of(" \t\r") == std::string_view::npos) {
+            continue;
+        }
+        // строка размеров: N протяженностей и количество элементов
+        const char* p = line.data();
+        const char* const line_end = line.data() + line.size();
+        const size_t offset = start;
+        for (size_t d = 0; d <= N; ++d) {
+            while (p < line_end && isSeparator(*p)) {
+                ++p;
+            }
+            if (p == line_end) {
+                throw std::runtime_error("MatrixMarket size line must contain " + std::to_string(N + 1) + " numbers");
+            }
+            p = parseNumber(p, line_end, d < N ? header.extents[d] : header.entries, offset);
+        }
+        while (p < line_end && isSeparator(*p)) {
+            ++p;
+        }
+        if (p != line_end) {
+            throw std::runtime_error("MatrixMarket size line must contain " + std::to_string(N + 1) + " numbers");
+        }
+        header.sized = true;
+        header.body = std::min(end + 1, text.size());
+        return header;
+    }
+    throw std::runtime_error("MatrixMarket size line is missing");
+}
+
+
+/*!
+ Разбирает строки [first, last) в элементы. Пустые строки и строки, начинающиеся с comment, пропускаются
+ @param text    Начало файла, нужно для смещений в сообщениях об ошибках
+ @param shift   Вычитается из индексов: 1 для MatrixMarket, 0 для COORDINATE
+ @param header  Заголовок MatrixMarket или заголовок по умолчанию
+ @param comment Символ комментария
+ @param out     Вектор, в который дописываются элементы
+ @return Количество разобранных строк с элементами, без симметричных копий
+ @throw std::runtime_error Если строка повреждена или индекс выходит за объявленные в заголовке протяженности
+ */
+template <typename T, size_t N>
+size_t parseLines(const char* text, const char* first, const char* last, size_t shift, const MarketHeader<N>& header,
+                  char comment, std::vector<ElementType<T, N>>& out) {
+    size_t entries = 0;
+    while (first < last) {
+        const char* line_end = static_cast<const char*>(std::memchr(first, '\n', static_cast<size_t>(last - first)));
+        if (line_end == nullptr) {
+            line_end = last;
+        }
+
+        const char* p = first;
+        while (p < line_end && isSeparator(*p)) {
+            ++p;
+        }
+        if (p == line_end || *p == comment) {
+            first = line_end + 1;
+            continue;
+        }
+
+        const size_t offset = static_cast<size_t>(p - text);
+        Indexes<N> indexes;
+        for (size_t d = 0; d < N; ++d) {
+            while (p < line_end && isSeparator(*p)) {
+                ++p;
+            }
+            p = parseNumber(p, line_end, indexes[d], offset);
+            if (indexes[d] < shift) {
+                throw std::runtime_error("MatrixMarket indexes start from 1, line at byte " + std::to_string(offset));
+            }
+            indexes[d] -= shift;
+            if (header.sized && indexes[d] >= header.extents[d]) {
+                throw std::runtime_error("Index exceeds the MatrixMarket size line, line at byte " + std::to_string(offset));
+            }
+        }
+
+        T value{1};
+        if (!header.pattern) {
+            while (p < line_end && isSeparator(*p)) {
+                ++p;
+            }
+            p = parseNumber(p, line_end, value, offset);
+        }
+        while (p < line_end && isSeparator(*p)) {
+            ++p;
+        }
+        if (p != line_end) {
+            throw std::runtime_error("Unexpected trailing data in line at byte " + std::to_string(offset));
+        }
+
+        out.push_back(std::tuple_cat(makeKeyImpl(indexes, std::make_index_sequence<N>{}), std::make_tuple(value)));
+        ++entries;
+        if constexpr (N == 2) {
+            if (header.symmetric && indexes[0] != indexes[1]) {
+                out.emplace_back(indexes[1], indexes[0], value);
+            }
+        }
+        first = line_end + 1;
+    }
+    return entries;
+}
+
+
+/*!
+ Разбирает весь файл, деля его на части по границам строк
+ @param path   Путь к файлу
+ @param format Формат файла
+ @param pool   Пул потоков или nullptr
+ @return Элементы в порядке их следования в файле
+ @throw std::runtime_error Если файл поврежден, в том числе если количество строк с элементами
+  MatrixMarket не совпадает с объявленным в строке размеров (например, файл обрезан)
+ */
+template <typename T, size_t N>
+std::vector<ElementType<T, N>> parseText(const std::string& path, TextFormat format, ThreadPool* pool) {
+    const MappedFile file{path};
+    const char* text = reinterpret_cast<const char*>(file.data());
+    const std::string_view view{text, file.size()};
+
+    MarketHeader<N> header;
+    if (format == TextFormat::MATRIX_MARKET) {
+        header = parseMarketHeader<N>(view);
+        if (header.symmetric && N != 2) {
+            throw std::runtime_error("Symmetric MatrixMarket files require a two-dimensional matrix");
+        }
+    }
+    const size_t shift = format == TextFormat::MATRIX_MARKET ? 1 : 0;
+    const char comment = format == TextFormat::MATRIX_MARKET ? '%' : '#';
+
+    const size_t body = header.body;
+    const size_t parts = pool != nullptr ? pool->size() * 4 : 1;
+
+    // границы частей сдвигаются к началу следующей строки
+    std::vector<size_t> bounds(parts + 1, view.size());
+    bounds[0] = body;
+    for (size_t part = 1; part < parts; ++part) {
+        size_t bound = std::max(bounds[part - 1], body + (view.size() - body) * part / parts);
+        if (bound > body && bound < view.size() && text[bound - 1] != '\n') {
+            bound = std::min(view.find('\n', bound), view.size());
+            bound = std::min(bound + 1, view.size());
+        }
+        bounds[part] = bound;
+    }
+
+    std::vector<std::vector<ElementType<T, N>>> chunks(parts);
+    std::vector<size_t> entries(parts);
+    const auto parse = [&](size_t part) {
+        entries[part] = parseLines<T, N>(text, text + bounds[part], text + bounds[part + 1], shift, header, comment, chunks[part]);
+    };
+    if (pool != nullptr) {
+        pool->run(parts, parse);
+    } else {
+        parse(0);
+    }
+
+    const size_t parsed = std::accumulate(entries.begin(), entries.end(), size_t{0});
+    if (header.sized && parsed != header.entries) {
+        throw std::runtime_error("MatrixMarket file declares " + std::to_string(header.entries) + " entries, but contains "
+                                 + std::to_string(parsed));
+    }
+
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        total += chunk.size();
+    }
+    std::vector<ElementType<T, N>> elements;
+    elements.reserve(total);
+    for (auto& chunk : chunks) {
+        elements.insert(elements.end(), chunk.begin(), chunk.end());
+        std::vector<ElementType<T, N>>{}.swap(chunk);
+    }
+    return elements;
+}
+
+
+/*!
+ @brief Буфер записи: числа форматируются std::to_chars в буфер фиксированного размера,
+  заполненный буфер сбрасывается в поток
+ */
+class TextWriter {
+public:
+    explicit TextWriter(const std::string& path);
+
+    template <typename V>
+    void number(const V& value); ///< Дописывает число
+    void put(char c);            ///< Дописывает символ
+    void text(std::string_view text); ///< Дописывает строку
+    void finish();               ///< Сбрасывает буфер и закрывает файл
+
+private:
+    void reserve(size_t bytes); ///< Освобождает в буфере не меньше bytes байт
+
+    std::ofstream m_out;       ///< Файл
+    std::string m_path;        ///< Путь к файлу для сообщений об ошибках
+    std::vector<char> m_buffer; ///< Буфер
+    size_t m_used = 0;         ///< Заполненная часть буфера
+};
+
+
+inline TextWriter::TextWriter(const std::string& path) : m_out{path, std::ios::binary | std::ios::trunc}, m_path{path}, m_buffer(TEXT_WRITE_BUFFER) {
+    if (!m_out) {
+        throw std::runtime_error("Can not create file " + path);
+    }
+}
+
+
+template <typename V>
+void TextWriter::number(const V& value) {
+    if constexpr (std::is_same_v<V, bool>) {
+        // std::to_chars для bool удален: значение пишется как 0 или 1, см. parseNumber
+        put(value ? '1' : '0');
+    } else {
+        reserve(64);
+        const auto [end, error] = std::to_chars(m_buffer.data() + m_used, m_buffer.data() + m_buffer.size(), value);
+        if (error != std::errc{}) {
+            throw std::runtime_error("Can not format value for " + m_path);
+        }
+        m_used = static_cast<size_t>(end - m_buffer.data());
+    }
+}
+
+
+inline void TextWriter::put(char c) {
+    reserve(1);
+    m_buffer[m_used++] = c;
+}
+
+
+inline void TextWriter::text(std::string_view text) {
+    for (char c : text) {
+        put(c);
+    }
+}
+
+
+inline void TextWriter::finish() {
+    m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+    m_used = 0;
+    m_out.close();
+    if (!m_out) {
+        throw std::runtime_error("Can not write file " + m_path);
+    }
+}
+
+
+inline void TextWriter::reserve(size_t bytes) {
+    if (m_buffer.size() - m_used < bytes) {
+        m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+        m_used = 0;
+        if (!m_out) {
+            throw std::runtime_error("Can not write file " + m_path);
+        }
+    }
+}
+
+}
+
+
+/*!
+ Загружает элементы из текстового файла в матрицу. Файл отображается в память целиком, числа
+ разбираются std::from_chars без копирования строк, элементы передаются в bulkLoad одним пакетом.
+ В MatrixMarket поддерживаются поля real, integer и pattern (значение 1) и симметрия general и symmetric,
+ для N != 2 строка размеров содержит N протяженностей и количество элементов. Индексы проверяются
+ по объявленным протяженностям, а количество строк с элементами -- по объявленному, поэтому обрезанный
+ файл не загружается. Значения bool записываются как 0 и 1.
+ @param matrix Матрица, в которую добавляются элементы
+ @param path   Путь к файлу
+ @param format Формат файла
+ @param policy Способ разрешения повторяющихся индексов, см. bulkLoad
+ @throw std::runtime_error Если файл не удалось прочитать или он поврежден, матрица при этом не изменяется
+ */
+template <typename M>
+void loadText(M& matrix, const std::string& path, TextFormat format, DuplicatePolicy policy = DuplicatePolicy::KEEP_LAST) {
+    using Element = typename M::Element;
+    constexpr size_t N = std::tuple_size_v<Element> - 1;
+    matrix.bulkLoad(detail::parseText<std::tuple_element_t<N, Element>, N>(path, format, nullptr), policy);
+}
+
+
+/*!
+ @copydoc loadText(M&, const std::string&, TextFormat, DuplicatePolicy)
+ @param pool Пул потоков: файл делится на части по границам строк, части разбираются параллельно,
+  порядок элементов (важный для DuplicatePolicy) совпадает с порядком в файле
+ */
+template <typename M>
+void loadText(M& matrix, const std::string& path, TextFormat format, DuplicatePolicy policy, ThreadPool& pool) {
+    using Element = typename M::Element;
+    constexpr size_t N = std::tuple_size_v<Element> - 1;
+    matrix.bulkLoad(detail::parseText<std::tuple_element_t<N, Element>, N>(path, format, &pool), policy, pool);
+}
+
+
+/*!
+ Записывает элементы матрицы в текстовый файл потоком из Matrix::begin()/end(). Элементы
+ форматируются std::to_chars в буфер фиксированного размера (detail::TEXT_WRITE_BUFFER),
+ поэтому расход памяти не зависит от размера матрицы. Для MatrixMarket индексы пишутся с единицы,
+ а строка размеров содержит наибольшие индексы по каждому измерению и количество элементов.
+ Значения bool пишутся как 0 и 1 с полем integer.
+ @param matrix Матрица
+ @param path   Путь к файлу, существующий файл перезаписывается
+ @param format Формат файла
+ @throw std::runtime_error В случае ошибки ввода-вывода
+ */
+template <typename M>
+void saveText(const M& matrix, const std::string& path, TextFormat format) {
+    using Element = typename M::Element;
+    constexpr size_t N = std::tuple_size_v<Element> - 1;
+    using T = std::tuple_element_t<N, Element>;
+
+    detail::TextWriter out{path};
+    const size_t shift = format == TextFormat::MATRIX_MARKET ? 1 : 0;
+
+    if (format == TextFormat::MATRIX_MARKET) {
+        Indexes<N> extents{};
+        for (const auto& element : matrix) {
+            const Indexes<N> indexes = detail::elementIndexes<N>(element);
+            for (size_t d = 0; d < N; ++d) {
+                extents[d] = std::max(extents[d], indexes[d] + 1);
+            }
+        }
+        out.text(std::is_integral_v<T> ? "%%MatrixMarket matrix coordinate integer general\n"
+                                       : "%%MatrixMarket matrix coordinate real general\n");
+        for (size_t d = 0; d < N; ++d) {
+            out.number(extents[d]);
+            out.put(' ');
+        }
+        out.number(matrix.size());
+        out.put('\n');
+    }
+
+    for (const auto& element : matrix) {
+        const Indexes<N> indexes = detail::elementIndexes<N>(element);
+        for (size_t d = 0; d < N; ++d) {
+            out.number(indexes[d] + shift);
+            out.put(' ');
+        }
+        out.number(std::get<N>(element));
+        out.put('\n');
+    }
+    out.finish();
+}
@@ -0,0 +1,191 @@
+/*!
+@file
+@brief Заголовочный файл с описанием и реализацией пула потоков,
+ на котором выполняются параллельные операции над матрицами
+*/
+
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+/*!
+ @brief Пул потоков с фиксированным количеством исполнителей
+ @details Вызывающий поток тоже участвует в работе, поэтому пул размера 1 не создает ни одного
+  дополнительного потока. Разбиение работы на части детерминировано и зависит только от размера пула.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const; ///< Возвращает количество потоков, включая вызывающий
+
+    template <typename Fn>
+    void run(size_t tasks, Fn&& fn);                         ///< Выполняет fn(i) для всех i из [0, tasks)
+
+    template <typename Fn>
+    void parallelFor(size_t first, size_t last, Fn&& fn);    ///< Делит [first, last) на size() частей и выполняет fn(begin, end)
+
+private:
+    void work(); ///< Цикл исполнителя
+
+    std::vector<std::thread> m_workers;          ///< Дополнительные потоки
+    std::queue<std::function<void()>> m_tasks;   ///< Очередь задач
+    std::mutex m_mutex;                          ///< Защищает m_tasks и m_stop
+    std::condition_variable m_condition;         ///< Оповещает исполнителей о новых задачах
+    bool m_stop = false;                         ///< Признак остановки пула
+};
+
+
+/*!
+ Создает пул потоков
+ @param threads Количество потоков, включая вызывающий. Значение 0 трактуется как 1
+ */
+inline ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    m_workers.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) {
+        m_workers.emplace_back([this] { work(); });
+    }
+}
+
+
+/*!
+ Останавливает исполнителей, дождавшись выполнения уже поставленных задач
+ */
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+
+/*!
+@return Количество потоков, включая вызывающий
+*/
+inline size_t ThreadPool::size() const {
+    return m_workers.size() + 1;
+}
+
+
+/*!
+ Выполняет задачи из очереди до остановки пула
+ */
+inline void ThreadPool::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_condition.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+        task();
+    }
+}
+
+
+/*!
+ Выполняет fn(i) для всех i из [0, tasks) и дожидается завершения. Задачи раздаются исполнителям
+ по одной, вызывающий поток выполняет задачи наравне с ними. Вложенный вызов из задачи пула не поддерживается.
+ @param tasks Количество задач
+ @param fn    Функция, принимающая номер задачи
+ @throw Первое исключение, выброшенное одной из задач
+ */
+template <typename Fn>
+void ThreadPool::run(size_t tasks, Fn&& fn) {
+    if (tasks == 0) {
+        return;
+    }
+    if (tasks == 1 || m_workers.empty()) {
+        for (size_t i = 0; i < tasks; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t next = 0;
+    size_t exited = 0;
+    std::exception_ptr error;
+
+    auto worker = [&] {
+        for (;;) {
+            size_t task;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if (next == tasks) {
+                    return;
+                }
+                task = next++;
+            }
+            try {
+                fn(task);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{mutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    const size_t helpers = std::min(m_workers.size(), tasks - 1);
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        for (size_t i = 0; i < helpers; ++i) {
+            m_tasks.emplace([&] {
+                worker();
+                std::lock_guard<std::mutex> lock{mutex};
+                ++exited;
+                done.notify_one();
+            });
+        }
+    }
+    m_condition.notify_all();
+
+    worker();
+
+    // локальные переменные используются исполнителями, поэтому ждем выхода каждого из них
+    std::unique_lock<std::mutex> lock{mutex};
+    done.wait(lock, [&] { return exited == helpers; });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+
+/*!
+ Делит диапазон [first, last) на size() равных частей и выполняет fn(begin, end) для каждой
+ @param first Начало диапазона
+ @param last  Конец диапазона
+ @param fn    Функция, принимающая границы части
+ */
+template <typename Fn>
+void ThreadPool::parallelFor(size_t first, size_t last, Fn&& fn) {
+    const size_t count  = last > first ? last - first : 0;
+    const size_t chunks = std::min(size(), count);
+
+    run(chunks, [&](size_t chunk) {
+        fn(first + count * chunk / chunks, first + count * (chunk + 1) / chunks);
+    });
+}
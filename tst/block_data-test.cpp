@@ -0,0 +1,116 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <random>
+
+
+TEST(BlockData, MatchesReference) {
+    BlockMatrix<int, 0, 3> matrix;
+    std::map<std::tuple<size_t, size_t, size_t>, int> reference;
+    
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<size_t> index{0, 19};
+    std::uniform_int_distribution<int> value{0, 3};
+    for (int i = 0; i < 20000; ++i) {
+        const size_t x = index(gen);
+        const size_t y = index(gen);
+        const size_t z = index(gen);
+        const int v = value(gen);
+        matrix[x][y][z] = v;
+        if (v == 0) {
+            reference.erase({x, y, z});
+        } else {
+            reference[{x, y, z}] = v;
+        }
+    }
+    
+    ASSERT_EQ(matrix.size(), reference.size());
+    size_t count = 0;
+    for (const auto& [x, y, z, v] : matrix) {
+        ASSERT_EQ(reference.at({x, y, z}), v);
+        ++count;
+    }
+    ASSERT_EQ(count, reference.size());
+    for (const auto& [key, v] : reference) {
+        const auto [x, y, z] = key;
+        ASSERT_EQ(matrix(x, y, z), v);
+    }
+}
+
+
+TEST(BlockData, TilesAndMask) {
+    BlockMatrix<int, -1, 2> matrix;
+    for (size_t i = 0; i < 16; ++i) {
+        for (size_t j = 0; j < 8; ++j) {
+            matrix[i][j] = static_cast<int>(i * 8 + j);
+        }
+    }
+    const auto& storage = matrix.storage();
+    
+    ASSERT_EQ(matrix.size(), 128u);
+    ASSERT_EQ(storage.tiles(), 2u);
+    
+    matrix[3][3] = -1;
+    ASSERT_EQ(matrix.size(), 127u);
+    ASSERT_EQ(matrix(3, 3), -1);
+    ASSERT_EQ(matrix.tryGet({3, 3}), nullptr);
+    ASSERT_EQ(*matrix.tryGet({3, 4}), 28);
+    
+    size_t cells = 0;
+    long long sum = 0;
+    storage.forEachTile([&](const Indexes<2>& origin, const auto& values, std::uint64_t mask) {
+        ASSERT_EQ(origin[1], 0u);
+        cells += static_cast<size_t>(__builtin_popcountll(mask));
+        for (int v : values) {
+            sum += v;
+        }
+    });
+    ASSERT_EQ(cells, 127u);
+    ASSERT_EQ(sum, 127 * 128 / 2 - 27);
+    
+    for (size_t i = 0; i < 8; ++i) {
+        for (size_t j = 0; j < 8; ++j) {
+            matrix[i][j] = -1;
+        }
+    }
+    ASSERT_EQ(matrix.size(), 64u);
+    ASSERT_EQ(storage.tiles(), 1u);
+    ASSERT_EQ(matrix(8, 0), 64);
+    ASSERT_EQ(matrix(15, 7), 127);
+}
+
+
+TEST(BlockData, CustomShape) {
+    BlockMatrix<long, 0, 2, TileShape<1, 32>> matrix;
+    matrix[100][31] = 15;
+    matrix[100][32] = 25;
+    matrix[101][0] = 35;
+    
+    ASSERT_EQ(matrix.size(), 3u);
+    ASSERT_EQ(matrix.storage().tiles(), 3u);
+    ASSERT_EQ(matrix(100, 31), 15);
+    ASSERT_EQ(matrix(100, 32), 25);
+    ASSERT_EQ(matrix(101, 0), 35);
+    
+    const auto it = matrix.find({100, 31});
+    ASSERT_NE(it, matrix.end());
+    ASSERT_EQ(std::get<2>(*it), 15);
+}
+
+
+TEST(BlockData, BulkLoad) {
+    std::vector<ElementType<int, 2>> elements;
+    for (size_t i = 0; i < 1000; ++i) {
+        elements.emplace_back(i / 40, i % 40, static_cast<int>(i) + 1);
+    }
+    
+    BlockMatrix<int, 0, 2> matrix;
+    matrix.bulkLoad(elements);
+    
+    ASSERT_EQ(matrix.size(), 1000u);
+    ASSERT_EQ(matrix.storage().tiles(), 20u);
+    ASSERT_EQ(matrix(24, 39), 1000);
+    ASSERT_EQ(static_cast<size_t>(std::distance(matrix.begin(), matrix.end())), 1000u);
+}
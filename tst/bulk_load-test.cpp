@@ -0,0 +1,127 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <sstream>
+
+
+TEST(BulkLoad, EmptyMatrix) {
+    Matrix<int, -1, 2> matrix;
+    std::vector<std::tuple<size_t, size_t, int>> elements = {{3, 4, 34}, {1, 2, 12}, {5, 5, -1}, {0, 9, 9}};
+    std::ostringstream os;
+    
+    matrix.bulkLoad(elements);
+    for (const auto& [x, y, v] : matrix) {
+        os << x << y << v << ';';
+    }
+    
+    ASSERT_EQ(matrix.size(), 3);
+    ASSERT_EQ(os.str(), "099;1212;3434;");
+    ASSERT_TRUE(matrix[5][5] == -1);
+}
+
+
+TEST(BulkLoad, DuplicatePolicies) {
+    const std::vector<std::tuple<size_t, size_t, int>> elements = {{1, 1, 1}, {2, 2, 5}, {1, 1, 2}, {1, 1, 3}};
+    
+    Matrix2D<int> first, last, sum, error;
+    first.bulkLoad(elements, DuplicatePolicy::KEEP_FIRST);
+    last.bulkLoad(elements, DuplicatePolicy::KEEP_LAST);
+    sum.bulkLoad(elements, DuplicatePolicy::SUM);
+    
+    ASSERT_TRUE(first[1][1] == 1);
+    ASSERT_TRUE(last[1][1] == 3);
+    ASSERT_TRUE(sum[1][1] == 6);
+    ASSERT_EQ(sum.size(), 2);
+    ASSERT_THROW(error.bulkLoad(elements, DuplicatePolicy::THROW), std::runtime_error);
+}
+
+
+TEST(BulkLoad, DuplicateCancelsToDefault) {
+    Matrix2D<int> matrix;
+    const std::vector<std::tuple<size_t, size_t, int>> elements = {{1, 1, 5}, {1, 1, -5}};
+    
+    matrix.bulkLoad(elements, DuplicatePolicy::SUM);
+    
+    ASSERT_EQ(matrix.size(), 0);
+}
+
+
+TEST(BulkLoad, DefaultValuesAreSkipped) {
+    Matrix<int, 0, 2, HashData<int, 2>> hash_matrix;
+    Matrix2D<int> matrix;
+    matrix[1][1] = 10;
+    const std::vector<std::tuple<size_t, size_t, int>> elements = {{1, 1, 0}, {2, 2, 0}, {2, 2, 3}};
+    
+    matrix.bulkLoad(elements, DuplicatePolicy::KEEP_FIRST);
+    hash_matrix.bulkLoad(elements, DuplicatePolicy::KEEP_FIRST);
+    
+    ASSERT_TRUE(matrix[1][1] == 10);
+    ASSERT_TRUE(matrix[2][2] == 3);
+    ASSERT_TRUE(hash_matrix[2][2] == 3);
+    ASSERT_EQ(hash_matrix.size(), 1);
+}
+
+
+TEST(BulkLoad, Merge) {
+    Matrix<int, 0, 2, HashData<int, 2>> matrix;
+    matrix[1][1] = 10;
+    matrix[2][2] = 20;
+    matrix[3][3] = 30;
+    const std::vector<std::tuple<size_t, size_t, int>> elements = {{1, 1, 1}, {2, 2, -20}, {4, 4, 4}};
+    
+    matrix.bulkLoad(elements, DuplicatePolicy::SUM);
+    
+    ASSERT_EQ(matrix.size(), 3);
+    ASSERT_TRUE(matrix[1][1] == 11);
+    ASSERT_TRUE(matrix[2][2] == 0);
+    ASSERT_TRUE(matrix[3][3] == 30);
+    ASSERT_TRUE(matrix[4][4] == 4);
+}
+
+
+TEST(BulkLoad, MergeKeepFirst) {
+    Matrix2D<int> matrix;
+    matrix[1][1] = 10;
+    const std::vector<std::tuple<size_t, size_t, int>> elements = {{1, 1, 1}, {1, 2, 2}};
+    
+    matrix.bulkLoad(elements, DuplicatePolicy::KEEP_FIRST);
+    
+    ASSERT_TRUE(matrix[1][1] == 10);
+    ASSERT_TRUE(matrix[1][2] == 2);
+}
+
+
+TEST(BulkLoad, ParallelMatchesSequential) {
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<size_t> index{0, 200};
+    std::uniform_int_distribution<int> value{0, 5};
+    std::vector<std::tuple<size_t, size_t, size_t, int>> elements(100000);
+    for (auto& [x, y, z, v] : elements) {
+        x = index(gen);
+        y = index(gen);
+        z = index(gen);
+        v = value(gen);
+    }
+    
+    Matrix3D<int> sequential;
+    Matrix<int, 0, 3, HashData<int, 3>> parallel;
+    ThreadPool pool{4};
+    sequential.bulkLoad(elements, DuplicatePolicy::KEEP_LAST);
+    parallel.bulkLoad(elements, DuplicatePolicy::KEEP_LAST, pool);
+    
+    Matrix3D<int> expected;
+    for (const auto& [x, y, z, v] : elements) {
+        if (v != 0) {
+            expected[x][y][z] = v;
+        }
+    }
+    
+    ASSERT_EQ(sequential.size(), expected.size());
+    ASSERT_EQ(parallel.size(), expected.size());
+    for (const auto& [x, y, z, v] : expected) {
+        ASSERT_EQ(sequential.get({x, y, z}), v);
+        ASSERT_EQ(parallel.get({x, y, z}), v);
+    }
+}
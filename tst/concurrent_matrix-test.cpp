@@ -0,0 +1,102 @@
+#include "concurrent_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+TEST(ConcurrentMatrix, SingleThread) {
+    ConcurrentMatrix<int, -1, 2> matrix{3};
+    
+    matrix[100][100] = 314;
+    matrix.update({1, 2}, 12);
+    matrix.update({1, 2}, -1);
+    
+    ASSERT_EQ(matrix.shards(), 4);
+    ASSERT_TRUE(matrix[100][100] == 314);
+    ASSERT_EQ(matrix.get({1, 2}), -1);
+    ASSERT_EQ(matrix.size(), 1);
+}
+
+
+TEST(ConcurrentMatrix, Accumulate) {
+    ConcurrentMatrix<int, 0, 2> matrix;
+    
+    ASSERT_EQ(matrix.accumulate({1, 1}, 5), 5);
+    ASSERT_EQ(matrix.accumulate({1, 1}, 2), 7);
+    ASSERT_EQ(matrix.accumulate({1, 1}, -7), 0);
+    ASSERT_EQ(matrix.size(), 0);
+}
+
+
+TEST(ConcurrentMatrix, Snapshot) {
+    ConcurrentMatrix<int, 0, 2, Data<int, 2>> matrix;
+    std::ostringstream os;
+    
+    matrix.update({3, 4}, 34);
+    matrix.update({1, 2}, 12);
+    matrix.update({0, 9}, 9);
+    const auto snapshot = matrix.snapshot();
+    matrix.update({5, 5}, 55);
+    
+    for (const auto& [x, y, v] : snapshot) {
+        os << x << y << v << ';';
+    }
+    
+    ASSERT_EQ(os.str(), "099;1212;3434;");
+    ASSERT_EQ(matrix.size(), 4);
+}
+
+
+TEST(ConcurrentMatrix, Stress) {
+    constexpr size_t THREADS = 8;
+    constexpr size_t CELLS = 64;
+    constexpr int ROUNDS = 2000;
+    
+    ConcurrentMatrix<long long, 0, 3> matrix{8};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    
+    for (size_t t = 0; t < THREADS; ++t) {
+        writers.emplace_back([&matrix, t] {
+            for (int round = 0; round < ROUNDS; ++round) {
+                for (size_t cell = 0; cell < CELLS; ++cell) {
+                    matrix.accumulate({cell, cell % 7, cell % 3}, 1);
+                }
+                matrix.update({1000 + t, static_cast<size_t>(round), 0}, round + 1);
+            }
+        });
+    }
+    
+    std::thread reader{[&matrix, &stop] {
+        while (!stop) {
+            // каждый писатель увеличивает ячейки по порядку, поэтому в согласованном снимке
+            // счетчики не возрастают с номером ячейки и отличаются не больше чем на THREADS
+            const auto snapshot = matrix.snapshot();
+            const long long first = snapshot.get({0, 0, 0});
+            const long long last  = snapshot.get({CELLS - 1, (CELLS - 1) % 7, (CELLS - 1) % 3});
+            long long previous = first;
+            for (size_t cell = 1; cell < CELLS; ++cell) {
+                const long long current = snapshot.get({cell, cell % 7, cell % 3});
+                EXPECT_LE(current, previous);
+                previous = current;
+            }
+            EXPECT_LE(first - last, static_cast<long long>(THREADS));
+        }
+    }};
+    
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    stop = true;
+    reader.join();
+    
+    for (size_t cell = 0; cell < CELLS; ++cell) {
+        ASSERT_EQ(matrix.get({cell, cell % 7, cell % 3}), ROUNDS * static_cast<long long>(THREADS));
+    }
+    ASSERT_EQ(matrix.size(), CELLS + THREADS * ROUNDS);
+    ASSERT_EQ(matrix.snapshot().size(), CELLS + THREADS * ROUNDS);
+}
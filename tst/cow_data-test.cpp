@@ -0,0 +1,122 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>
+
+
+TEST(CowData, MatchesReference) {
+    CowMatrix<int, 0, 3> matrix;
+    std::map<std::tuple<size_t, size_t, size_t>, int> reference;
+    
+    std::mt19937 gen{5};
+    std::uniform_int_distribution<size_t> index{0, 15};
+    std::uniform_int_distribution<int> value{0, 3};
+    for (int i = 0; i < 20000; ++i) {
+        const size_t x = index(gen);
+        const size_t y = index(gen);
+        const size_t z = index(gen);
+        const int v = value(gen);
+        matrix[x][y][z] = v;
+        if (v == 0) {
+            reference.erase({x, y, z});
+        } else {
+            reference[{x, y, z}] = v;
+        }
+    }
+    
+    ASSERT_EQ(matrix.size(), reference.size());
+    size_t count = 0;
+    for (const auto& [x, y, z, v] : matrix) {
+        ASSERT_EQ(reference.at({x, y, z}), v);
+        ++count;
+    }
+    ASSERT_EQ(count, reference.size());
+}
+
+
+TEST(CowData, Snapshot) {
+    CowMatrix<int, -1, 2> matrix;
+    for (size_t i = 0; i < 10000; ++i) {
+        matrix.set({i, i % 7}, static_cast<int>(i));
+    }
+    
+    const auto snapshot = matrix.snapshot();
+    
+    matrix[5][5] = 100;
+    matrix[7][0] = -1;
+    matrix.modify({14, 0}, [](int& v) { v += 1; });
+    
+    ASSERT_EQ(snapshot.size(), 10000u);
+    ASSERT_EQ(snapshot(5, 5), 5);
+    ASSERT_EQ(snapshot(7, 0), 7);
+    ASSERT_EQ(snapshot(14, 0), 14);
+    ASSERT_EQ(matrix.size(), 9999u);
+    ASSERT_EQ(matrix(5, 5), 100);
+    ASSERT_EQ(matrix(7, 0), -1);
+    ASSERT_EQ(matrix(14, 0), 15);
+    
+    auto version = snapshot.matrix();
+    version[1][1] = 42;
+    ASSERT_EQ(version(1, 1), 42);
+    ASSERT_EQ(snapshot(1, 1), 1);
+    ASSERT_EQ(matrix(1, 1), 1);
+}
+
+
+TEST(CowData, CopiesOnlyTouchedPages) {
+    using Storage = CowData<int, 2>;
+    Storage data;
+    for (size_t i = 0; i < 100000; ++i) {
+        const auto key = data.makeKey({i, i});
+        data.emplace(data.locate(key).second, key, 1);
+    }
+    ASSERT_EQ(data.sharedPages(), 0u);
+    
+    const auto copy = data;
+    ASSERT_EQ(data.sharedPages(), Storage::PAGES);
+    ASSERT_EQ(copy.sharedPages(), Storage::PAGES);
+    
+    const auto key = data.makeKey({3, 3});
+    data.insert(data.locate(key).second, key, 2);
+    ASSERT_EQ(data.sharedPages(), Storage::PAGES - 1);
+    ASSERT_EQ(copy.value(copy.locate(key).second), 1);
+    
+    {
+        const auto dropped = data;
+    }
+    ASSERT_EQ(data.sharedPages(), Storage::PAGES - 1);
+}
+
+
+TEST(CowData, ConcurrentReaders) {
+    CowMatrix<long long, 0, 2> matrix;
+    for (size_t i = 0; i < 1000; ++i) {
+        matrix.set({i, 0}, 1);
+    }
+    
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&failed, snapshot = matrix.snapshot()] {
+            for (int pass = 0; pass < 50; ++pass) {
+                long long sum = 0;
+                for (const auto& [i, j, v] : snapshot) {
+                    sum += v;
+                }
+                failed = failed || sum != 1000;
+            }
+        });
+    }
+    for (size_t i = 0; i < 20000; ++i) {
+        matrix.set({i % 1000, i % 3}, static_cast<long long>(i));
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    
+    ASSERT_FALSE(failed);
+}
@@ -0,0 +1,138 @@
+#include "csr_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <limits>
+#include <sstream>
+
+
+namespace {
+
+Matrix2D<int> makeMatrix() {
+    Matrix2D<int> matrix;
+    matrix[2][5] = 25;
+    matrix[0][3] = 3;
+    matrix[2][1] = 21;
+    matrix[0][0] = 1;
+    matrix[4][4] = 44;
+    return matrix;
+}
+
+}
+
+
+TEST(CSRMatrix, Arrays) {
+    const auto csr = toCSR(makeMatrix());
+    
+    ASSERT_EQ(csr.size(), 5);
+    ASSERT_EQ(csr.rows(), 5);
+    ASSERT_EQ(csr.columns(), 6);
+    ASSERT_EQ(csr.lineIds(), (std::vector<size_t>{0, 2, 4}));
+    ASSERT_EQ(csr.offsets(), (std::vector<size_t>{0, 2, 4, 5}));
+    ASSERT_EQ(csr.indexes(), (std::vector<size_t>{0, 3, 1, 5, 4}));
+    ASSERT_EQ(csr.values(),  (std::vector<int>{1, 3, 21, 25, 44}));
+}
+
+
+TEST(CSRMatrix, Get) {
+    const auto matrix = makeMatrix();
+    const auto csr = toCSR(matrix);
+    
+    for (size_t x = 0; x < 8; ++x) {
+        for (size_t y = 0; y < 8; ++y) {
+            ASSERT_EQ(csr(x, y), matrix.get({x, y}));
+        }
+    }
+}
+
+
+TEST(CSRMatrix, Row) {
+    const auto csr = toCSR(makeMatrix());
+    std::ostringstream os;
+    
+    for (const auto& [y, v] : csr.row(2)) {
+        os << y << ' ' << v << ';';
+    }
+    
+    ASSERT_EQ(os.str(), "1 21;5 25;");
+    ASSERT_TRUE(csr.directLines());
+    ASSERT_TRUE(csr.row(1).empty());
+    ASSERT_TRUE(csr.row(100).empty());
+    ASSERT_EQ(csr.row(4).size(), 1);
+}
+
+
+TEST(CSRMatrix, Iteration) {
+    const auto csr = toCSR(makeMatrix());
+    std::ostringstream os;
+    
+    for (const auto& [x, y, v] : csr) {
+        os << x << y << v << ';';
+    }
+    
+    ASSERT_EQ(os.str(), "001;033;2121;2525;4444;");
+}
+
+
+TEST(CSRMatrix, Empty) {
+    const auto csr = toCSR(Matrix2D<int>{});
+    
+    ASSERT_EQ(csr.size(), 0);
+    ASSERT_EQ(csr.begin(), csr.end());
+    ASSERT_EQ(csr(3, 3), 0);
+}
+
+
+TEST(CSCMatrix, Column) {
+    const auto csc = toCSC(makeMatrix());
+    std::ostringstream os;
+    
+    for (const auto& [x, v] : csc.column(4)) {
+        os << x << ' ' << v << ';';
+    }
+    
+    ASSERT_EQ(os.str(), "4 44;");
+    ASSERT_EQ(csc.lines(), 6);
+    ASSERT_EQ(csc(2, 5), 25);
+    ASSERT_EQ(csc(5, 2), 0);
+}
+
+
+TEST(CSCMatrix, Iteration) {
+    const auto csc = toCSC(makeMatrix());
+    std::ostringstream os;
+    
+    for (const auto& [x, y, v] : csc) {
+        os << x << y << v << ';';
+    }
+    
+    ASSERT_EQ(os.str(), "001;2121;033;4444;2525;");
+}
+
+
+TEST(CSRMatrix, InconsistentArrays) {
+    ASSERT_THROW((CSRMatrix<int>{2, 2, {0, 1}, {0}, {1}}), std::invalid_argument);
+    ASSERT_THROW((CSRMatrix<int>{2, 2, {1, 0}, {0, 1, 2}, {0, 1}, {1, 2}}), std::invalid_argument);
+}
+
+
+TEST(CSRMatrix, FarIndex) {
+    constexpr size_t FAR = 1'000'000'000'000;
+    Matrix2D<int> matrix;
+    matrix[FAR][0] = 1;
+    matrix[3][FAR] = 2;
+    
+    const auto csr = toCSR(matrix);
+    
+    ASSERT_EQ(csr.rows(), FAR + 1);
+    ASSERT_EQ(csr.columns(), FAR + 1);
+    ASSERT_EQ(csr.offsets().size(), 3);
+    ASSERT_FALSE(csr.directLines());
+    ASSERT_EQ(csr(FAR, 0), 1);
+    ASSERT_EQ(csr(3, FAR), 2);
+    ASSERT_TRUE(csr.row(FAR - 1).empty());
+    ASSERT_EQ(toCSC(matrix)(FAR, 0), 1);
+    
+    matrix[std::numeric_limits<size_t>::max()][0] = 3;
+    ASSERT_THROW(toCSR(matrix), std::invalid_argument);
+}
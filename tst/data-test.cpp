@@ -119,3 +119,45 @@ TEST(Data, Find) {
     ASSERT_EQ(value_1, value);
     ASSERT_EQ(value_2, 0);
 }
+
+
+TEST(Data, LocateAndEmplace) {
+    Data<int, 2> data;
+    data.insert(data.makeKey({1, 1}), 11);
+    data.insert(data.makeKey({3, 3}), 33);
+    
+    const auto key = data.makeKey({2, 2});
+    const auto [exists, hint] = data.locate(key);
+    ASSERT_FALSE(exists);
+    data.emplace(hint, key, 22);
+    
+    const auto [found, it] = data.locate(key);
+    ASSERT_TRUE(found);
+    ASSERT_EQ(data.value(it), 22);
+    ASSERT_EQ(std::get<2>(*data.find(data.makeKey({3, 3}))), 33);
+    ASSERT_TRUE(data.find(data.makeKey({4, 4})) == data.end());
+    ASSERT_EQ(data.size(), 3);
+}
+
+
+TEST(Data, CopyOwnsIndex) {
+    std::vector<int> values;
+    Data<int, 2> copy;
+    {
+        Data<int, 2> data;
+        data.insert(data.makeKey({1, 1}), 11);
+        data.insert(data.makeKey({2, 2}), 22);
+        copy = data;
+        Data<int, 2> constructed{data};
+        data.erase(data.makeKey({1, 1}));
+        ASSERT_EQ(constructed.getElement(constructed.makeKey({1, 1})).second, 11);
+    }
+    
+    copy.erase(copy.makeKey({1, 1}));
+    for (const auto& [x, y, v] : copy) {
+        values.push_back(v);
+    }
+    
+    ASSERT_EQ(values, std::vector<int>{22});
+    ASSERT_EQ(copy.getElement(copy.makeKey({2, 2})).second, 22);
+}
@@ -0,0 +1,122 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <type_traits>
+
+
+static_assert(Extents<4, 8>::CELLS == 32);
+static_assert(Extents<4, 8>::offset({1, 2}) == 10);
+static_assert(Extents<4, 8>::indexesOf(10)[1] == 2);
+static_assert(!Extents<4, 8>::contains({4, 0}));
+static_assert(Extents<4, 8>::lowerOffset({1, 9}) == 16);
+static_assert(Extents<4, 8>::lowerOffset({4, 0}) == 32);
+using SmallMatrix = Matrix<int, 0, 2, Extents<4, 8>>;
+static_assert(std::is_same_v<std::decay_t<decltype(SmallMatrix{}.storage())>, DenseData<int, 2, Extents<4, 8>>>);
+
+
+TEST(DenseData, MatchesReference) {
+    Matrix<int, 0, 3, Extents<20, 20, 20>> matrix;
+    std::map<std::tuple<size_t, size_t, size_t>, int> reference;
+
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<size_t> index{0, 19};
+    std::uniform_int_distribution<int> value{0, 3};
+    for (int i = 0; i < 20000; ++i) {
+        const size_t x = index(gen);
+        const size_t y = index(gen);
+        const size_t z = index(gen);
+        const int v = value(gen);
+        matrix[x][y][z] = v;
+        if (v == 0) {
+            reference.erase({x, y, z});
+        } else {
+            reference[{x, y, z}] = v;
+        }
+    }
+
+    ASSERT_EQ(matrix.size(), reference.size());
+    auto expected = reference.begin();
+    for (const auto& [x, y, z, v] : matrix) {
+        ASSERT_EQ(expected->first, std::make_tuple(x, y, z));
+        ASSERT_EQ(expected->second, v);
+        ++expected;
+    }
+    ASSERT_TRUE(expected == reference.end());
+}
+
+
+TEST(DenseData, OutOfExtents) {
+    FixedMatrix<int, -1, 4, 4> matrix;
+    std::ostringstream os;
+
+    ASSERT_EQ(matrix.storage().values(), nullptr);
+    matrix[3][1] = 31;
+    matrix[0][2] = 2;
+
+    ASSERT_EQ(matrix.get({4, 0}), -1);
+    ASSERT_EQ(matrix.tryGet({0, 100}), nullptr);
+    ASSERT_THROW(matrix.set({4, 0}, 1), std::runtime_error);
+    ASSERT_EQ(matrix.size(), 2);
+
+    for (const auto& [x, y, v] : matrix) {
+        os << x << y << v << ';';
+    }
+    ASSERT_EQ(os.str(), "022;3131;");
+
+    const int* values = matrix.storage().values();
+    ASSERT_EQ(std::accumulate(values, values + 16, 0), 33);
+}
+
+
+TEST(DenseData, OrderedRangeAndExpression) {
+    using M = FixedMatrix<int, 0, 20, 20>;
+    static_assert(std::is_same_v<M::OrderedView, M::View>);
+    M matrix;
+    Matrix<int, 0, 2> reference;
+    for (size_t i = 0; i < 20; ++i) {
+        for (size_t j = (i * 7) % 3; j < 20; j += 3) {
+            matrix[i][j] = static_cast<int>(i * 20 + j + 1);
+            reference[i][j] = static_cast<int>(i * 20 + j + 1);
+        }
+    }
+
+    // индексы за пределами Extents в границах прямоугольника допустимы
+    std::ostringstream expected;
+    std::ostringstream actual;
+    for (const auto& [x, y, v] : reference.range({3, 17}, {5, 100})) {
+        expected << x << ',' << y << '=' << v << ';';
+    }
+    for (const auto& [x, y, v] : matrix.range({3, 17}, {5, 100})) {
+        actual << x << ',' << y << '=' << v << ';';
+    }
+    ASSERT_EQ(actual.str(), expected.str());
+    ASSERT_TRUE(matrix.slice(25).empty());
+
+    const M doubled = matrix + matrix;
+    ASSERT_EQ(doubled.size(), matrix.size());
+    for (const auto& [x, y, v] : matrix) {
+        ASSERT_EQ(doubled(x, y), 2 * v);
+    }
+}
+
+
+TEST(DenseData, ParallelReduce) {
+    Matrix<long, 0, 2, Extents<256, 256>> matrix;
+    ThreadPool pool{3};
+    long expected = 0;
+    for (size_t i = 0; i < 256; i += 3) {
+        for (size_t j = 0; j < 256; j += 2) {
+            matrix[i][j] = static_cast<long>(i + j + 1);
+            expected += static_cast<long>(i + j + 1);
+        }
+    }
+
+    const long sum = matrix.parallelReduce(0L, [](const auto& elem) { return std::get<2>(elem); }, std::plus<>{}, pool);
+
+    ASSERT_EQ(sum, expected);
+}
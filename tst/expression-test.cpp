@@ -0,0 +1,91 @@
+#include "sparse_matrix.h"
+#include "random_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <stdexcept>
+
+
+namespace {
+
+/// Случайное значение из [-3, 3], в том числе значение по умолчанию
+int smallValue(size_t, std::mt19937& gen) {
+    return std::uniform_int_distribution<int>{-3, 3}(gen);
+}
+
+}
+
+
+TEST(Expression, Arithmetic) {
+    Matrix<int, 0, 2> a;
+    Matrix<int, 0, 2, HashData<int, 2>> b;
+    fillRandom(a, 400, 30, 1, smallValue);
+    fillRandom(b, 400, 30, 2, smallValue);
+    
+    Matrix<int, 0, 2> sum = a + b;
+    Matrix<int, 0, 2> diff = a - b;
+    Matrix<int, 0, 2, HashData<int, 2>> combo = 2 * a - hadamard(a, b) * 3;
+    
+    for (size_t i = 0; i < 30; ++i) {
+        for (size_t j = 0; j < 30; ++j) {
+            ASSERT_EQ(sum(i, j), a(i, j) + b(i, j));
+            ASSERT_EQ(diff(i, j), a(i, j) - b(i, j));
+            ASSERT_EQ(combo(i, j), 2 * a(i, j) - a(i, j) * b(i, j) * 3);
+        }
+    }
+    for (const auto& [i, j, v] : sum) {
+        ASSERT_NE(v, 0);
+        ASSERT_EQ(v, a(i, j) + b(i, j));
+    }
+}
+
+
+TEST(Expression, DefaultsAreNotStored) {
+    Matrix<int, 0, 2> a;
+    a[1][1] = 5;
+    a[2][2] = 7;
+    
+    Matrix<int, 0, 2> zero = a - a;
+    ASSERT_EQ(zero.size(), 0);
+    
+    Matrix<int, 0, 2> b;
+    b[2][2] = 1;
+    b[3][3] = 4;
+    Matrix<int, 0, 2> product = hadamard(a, b);
+    ASSERT_EQ(product.size(), 1);
+    ASSERT_EQ(product(2, 2), 7);
+}
+
+
+TEST(Expression, NonZeroDefault) {
+    Matrix<int, -1, 2> a;
+    Matrix<int, 1, 2> b;
+    a[0][0] = 4;
+    b[0][1] = 6;
+    
+    Matrix<int, 0, 2> sum = a + b;
+    ASSERT_EQ(sum.size(), 2);
+    ASSERT_EQ(sum(0, 0), 5);
+    ASSERT_EQ(sum(0, 1), 5);
+    
+    ASSERT_THROW((Matrix<int, 0, 2>{a - b}), std::runtime_error);
+}
+
+
+TEST(Expression, ApplyAndSelfAssignment) {
+    RuntimeMatrix<double, 2> a{RuntimeDefault<double>{0.0, 1e-9}};
+    a[1][2] = 2.0;
+    a[3][4] = 1e-10 + 1.0;
+    
+    a = (a - a * 0.5).apply([](double v) { return v * v; }) + a;
+    ASSERT_EQ(a.size(), 2);
+    ASSERT_DOUBLE_EQ(a(1, 2), 3.0);
+    ASSERT_NEAR(a(3, 4), 1.25, 1e-9);
+    
+    Matrix<int, 0, 2> b;
+    b[0][0] = 3;
+    Matrix<int, 0, 2> squared = b.apply([](int v) { return v * v; });
+    ASSERT_EQ(squared(0, 0), 9);
+    ASSERT_THROW((Matrix<int, 0, 2>{b.apply([](int v) { return v + 1; })}), std::runtime_error);
+}
@@ -0,0 +1,162 @@
+#include "hash_data.h"
+#include "data.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <random>
+
+
+TEST(HashData, Insert) {
+    HashData<int, 2> data;
+    Indexes<2> indexes = {100, 100};
+    int value = 314;
+    
+    auto key  = data.makeKey(indexes);
+    data.insert(key, value);
+    const auto [status, value_1] = data.getElement(key);
+    const auto [exists, it] = data.contains(key);
+    
+    ASSERT_TRUE(exists);
+    ASSERT_EQ(value_1, value);
+    ASSERT_EQ(data.size(), 1);
+}
+
+
+TEST(HashData, InsertTwice) {
+    HashData<int, 2> data;
+    const Indexes<2> indexes = {100, 100};
+    const int value_1 = 314;
+    const int value_2 = 215;
+    
+    auto key  = data.makeKey(indexes);
+    data.insert(key, value_1);
+    data.insert(key, value_2);
+    
+    const auto [status, value_3] = data.getElement(key);
+    
+    ASSERT_EQ(status, (HashData<int, 2>::FindStatus::FOUND));
+    ASSERT_EQ(value_3, value_2);
+    ASSERT_EQ(data.size(), 1);
+}
+
+
+TEST(HashData, ContainsOnEmpty) {
+    HashData<int, 3> data;
+    
+    const auto [exists, it] = data.contains(data.makeKey({1, 2, 3}));
+    const auto [status, value] = data.getElement(it);
+    
+    ASSERT_FALSE(exists);
+    ASSERT_EQ(status, (HashData<int, 3>::FindStatus::NOT_FOUND));
+    ASSERT_EQ(value, 0);
+}
+
+
+TEST(HashData, Erase) {
+    HashData<int, 2> data;
+    auto key_1 = data.makeKey({100, 100});
+    auto key_2 = data.makeKey({120, 400});
+    
+    data.insert(key_1, 314);
+    data.insert(key_2, 215);
+    data.erase(key_1);
+    
+    ASSERT_FALSE(data.contains(key_1).first);
+    ASSERT_TRUE (data.contains(key_2).first);
+    ASSERT_EQ(data.getElement(key_2).second, 215);
+    ASSERT_EQ(data.size(), 1);
+}
+
+
+TEST(HashData, EraseUninsertedElement) {
+    HashData<int, 2> data;
+    
+    ASSERT_THROW(data.erase(data.makeKey({100, 100})), std::runtime_error);
+    
+    data.insert(data.makeKey({1, 1}), 1);
+    
+    ASSERT_THROW(data.erase(data.makeKey({100, 100})), std::runtime_error);
+}
+
+
+TEST(HashData, Iteration) {
+    HashData<int, 2> data;
+    
+    data.insert(data.makeKey({1, 2}), 3);
+    data.insert(data.makeKey({4, 5}), 6);
+    data.insert(data.makeKey({1, 2}), 7);
+    
+    std::map<std::tuple<size_t, size_t>, int> elements;
+    for (const auto& [x, y, v] : data) {
+        elements[{x, y}] = v;
+    }
+    
+    ASSERT_EQ(elements.size(), 2);
+    ASSERT_EQ((elements[{1, 2}]), 7);
+    ASSERT_EQ((elements[{4, 5}]), 6);
+}
+
+
+TEST(HashData, MatchesData) {
+    HashData<int, 3> hash_data;
+    Data<int, 3> data;
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<size_t> index{0, 31};
+    std::uniform_int_distribution<int> action{0, 2};
+    
+    for (int i = 0; i < 20000; ++i) {
+        const Indexes<3> indexes = {index(gen), index(gen), index(gen)};
+        const auto key = data.makeKey(indexes);
+        
+        if (action(gen) == 0) {
+            if (data.contains(key).first) {
+                data.erase(key);
+                hash_data.erase(key);
+            }
+        } else {
+            data.insert(key, i);
+            hash_data.insert(key, i);
+        }
+        
+        ASSERT_EQ(hash_data.size(), data.size());
+    }
+    
+    for (const auto& [x, y, z, v] : data) {
+        const auto [status, value] = hash_data.getElement(hash_data.makeKey({x, y, z}));
+        ASSERT_EQ(status, (HashData<int, 3>::FindStatus::FOUND));
+        ASSERT_EQ(value, v);
+    }
+}
+
+
+TEST(HashData, Reserve) {
+    HashData<int, 2> data;
+    data.reserve(1000);
+    
+    for (size_t i = 0; i < 1000; ++i) {
+        data.insert(data.makeKey({i, i}), static_cast<int>(i));
+    }
+    
+    ASSERT_EQ(data.size(), 1000);
+    ASSERT_EQ(data.getElement(data.makeKey({999, 999})).second, 999);
+}
+
+
+TEST(HashData, LocateAndEmplace) {
+    HashData<int, 2> data;
+    
+    for (size_t i = 0; i < 100; ++i) {
+        const auto key = data.makeKey({i, i});
+        const auto [exists, hint] = data.locate(key);
+        ASSERT_FALSE(exists);
+        data.emplace(hint, key, static_cast<int>(i));
+    }
+    
+    const auto [found, it] = data.locate(data.makeKey({42, 42}));
+    ASSERT_TRUE(found);
+    data.value(it) = -42;
+    ASSERT_EQ(std::get<2>(*data.find(data.makeKey({42, 42}))), -42);
+    ASSERT_TRUE(data.find(data.makeKey({100, 100})) == data.end());
+    ASSERT_EQ(data.size(), 100);
+}
@@ -0,0 +1,97 @@
+#include "sparse_matrix.h"
+#include "random_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+
+namespace {
+
+/// Хранилище, считающее поиски в упорядоченных индексах
+struct CountingIndexedData : IndexedData<int, 2> {
+    inline static size_t seeks = 0;
+
+    MapIt lowerBound(const Indexes<2>& indexes) const {
+        ++seeks;
+        return IndexedData::lowerBound(indexes);
+    }
+
+    MapIt lowerBound(const Indexes<2>& indexes, size_t order) const {
+        ++seeks;
+        return IndexedData::lowerBound(indexes, order);
+    }
+};
+
+/// Элементы представления в порядке обхода
+template <typename View>
+std::vector<ElementType<int, 2>> collect(const View& view) {
+    return {view.begin(), view.end()};
+}
+
+constexpr size_t ALL = std::numeric_limits<size_t>::max();
+
+}
+
+
+TEST(IndexedData, MatchesDataOnRandomBoxes) {
+    const auto reference = randomMatrix<Matrix<int, 0, 2>>(3000, 64, 5, ordinal);
+    auto indexed = randomMatrix<IndexedMatrix<int, 0, 2>>(3000, 64, 5, ordinal);
+
+    ASSERT_EQ(indexed.size(), reference.size());
+    for (size_t x = 0; x < 64; x += 7) {
+        indexed.set({x, x}, 0);
+    }
+    auto expected = reference;
+    for (size_t x = 0; x < 64; x += 7) {
+        expected.set({x, x}, 0);
+    }
+
+    const Indexes<2> boxes[][2] = {
+        {{0, 5}, {ALL, 5}}, {{3, 0}, {3, ALL}}, {{10, 20}, {12, 40}}, {{0, 30}, {63, 31}}, {{5, 5}, {4, 4}}
+    };
+    for (const auto& [lo, hi] : boxes) {
+        auto actual = collect(indexed.range(lo, hi));
+        auto wanted = collect(expected.range(lo, hi));
+        std::sort(actual.begin(), actual.end());
+        ASSERT_EQ(actual, wanted);
+    }
+    ASSERT_TRUE(std::equal(indexed.ordered().begin(), indexed.ordered().end(), expected.ordered().begin(), expected.ordered().end()));
+}
+
+
+TEST(IndexedData, ColumnQuerySkipsRows) {
+    Matrix<int, 0, 2, CountingIndexedData> matrix;
+    for (size_t row = 0; row < 1000; ++row) {
+        matrix.set({row, row % 10}, static_cast<int>(row) + 1);
+    }
+
+    CountingIndexedData::seeks = 0;
+    const auto column = collect(matrix.range({0, 3}, {ALL, 3}));
+
+    ASSERT_EQ(column.size(), 100U);
+    for (size_t i = 0; i < column.size(); ++i) {
+        ASSERT_EQ(std::get<0>(column[i]), 10 * i + 3);
+        ASSERT_EQ(std::get<1>(column[i]), 3U);
+    }
+    ASSERT_LE(CountingIndexedData::seeks, 2U);
+}
+
+
+TEST(IndexedData, EraseAndCopyKeepIndexes) {
+    IndexedMatrix<int, 0, 3> matrix;
+    matrix.set({1, 2, 3}, 1);
+    matrix.set({4, 2, 6}, 2);
+    matrix.set({7, 8, 3}, 3);
+    matrix.set({4, 2, 6}, 0);
+
+    const auto copy = matrix;
+    matrix.set({1, 2, 3}, 0);
+
+    ASSERT_EQ(*matrix.range({0, 0, 3}, {ALL, ALL, 3}).begin(), std::make_tuple(size_t{7}, size_t{8}, size_t{3}, 3));
+    ASSERT_TRUE(matrix.range({0, 2, 0}, {ALL, 2, ALL}).empty());
+    ASSERT_EQ(copy.size(), 2U);
+    ASSERT_EQ(std::distance(copy.range({0, 0, 3}, {ALL, ALL, 3}).begin(), copy.range({0, 0, 3}, {ALL, ALL, 3}).end()), 2);
+}
@@ -0,0 +1,151 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+
+TEST(Instrumentation, DisabledIsFree) {
+    static_assert(std::is_empty_v<NoProbe>, "NoProbe must not take space");
+    static_assert(sizeof(BasicMatrix<int, 2, Data<int, 2>, StaticDefault<int, 0>, NoStats, NoProbe>) == sizeof(Data<int, 2>),
+                  "Matrix without instrumentation must be as large as its storage");
+    static_assert(sizeof(BasicMatrix<int, 2, HashData<int, 2>, StaticDefault<int, 0>, NoStats, NoProbe>) == sizeof(HashData<int, 2>),
+                  "Matrix without instrumentation must be as large as its storage");
+#if !MATRIX_INSTRUMENTATION
+    static_assert(std::is_same_v<DefaultProbe, NoProbe>, "Instrumentation must be disabled by default");
+#endif
+    
+    Matrix<int, 0, 2, Data<int, 2>, NoStats> matrix;
+    matrix[1][1] = 1;
+    ASSERT_EQ(matrix(1, 1), 1);
+}
+
+
+TEST(Instrumentation, Counters) {
+    ProbedMatrix<int, 0, 2> matrix;
+    
+    matrix[0][0] = 1;
+    matrix[0][0] = 2;
+    matrix[0][1] = 3;
+    matrix[0][0] = 0;
+    matrix[5][5] = 0;
+    ASSERT_EQ(matrix(0, 1), 3);
+    ASSERT_EQ(matrix(0, 0), 0);
+    ASSERT_EQ(matrix.find({7, 7}), matrix.end());
+    matrix.modify({0, 1}, [](int& v) { v += 1; });
+    matrix.modify({0, 1}, [](int& v) { v = 0; });
+    matrix.modify({2, 2}, [](int& v) { v = 5; });
+    
+    const ProbeReport report = matrix.probe().report();
+    ASSERT_EQ(report.count(ProbeEvent::LOOKUP), 11u);
+    ASSERT_EQ(report.count(ProbeEvent::HIT), 1u);
+    ASSERT_EQ(report.count(ProbeEvent::MISS), 2u);
+    ASSERT_EQ(report.count(ProbeEvent::INSERT), 3u);
+    ASSERT_EQ(report.count(ProbeEvent::OVERWRITE), 2u);
+    ASSERT_EQ(report.count(ProbeEvent::DEFAULT_ERASE), 2u);
+    
+    matrix.bulkLoad(std::vector<std::tuple<size_t, size_t, int>>{{2, 2, 0}, {3, 3, 1}, {4, 4, 1}});
+    ASSERT_EQ(matrix.probe().report().count(ProbeEvent::INSERT), 5u);
+    ASSERT_EQ(matrix.probe().report().count(ProbeEvent::LOOKUP), 11u);
+    
+    matrix.probe().reset();
+    ASSERT_EQ(matrix.probe().report().count(ProbeEvent::INSERT), 0u);
+    
+    const auto copy = matrix;
+    ASSERT_EQ(copy.probe().report().count(ProbeEvent::LOOKUP), 0u);
+}
+
+
+TEST(Instrumentation, ThreadsAndLatency) {
+    ProbedMatrix<int, 0, 2, HashData<int, 2>, MatrixProbe<true>> matrix;
+    for (size_t i = 0; i < 100; ++i) {
+        matrix.set({i, i}, 1);
+    }
+    
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 8; ++r) {
+        readers.emplace_back([&matrix] {
+            for (size_t i = 0; i < 1000; ++i) {
+                matrix.get({i % 200, i % 200});
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    
+    const ProbeReport report = matrix.probe().report();
+    ASSERT_EQ(report.count(ProbeEvent::LOOKUP), 8100u);
+    ASSERT_EQ(report.count(ProbeEvent::HIT), 4000u);
+    ASSERT_EQ(report.count(ProbeEvent::MISS), 4000u);
+    
+    std::uint64_t samples = 0;
+    for (const auto bucket : report.latency) {
+        samples += bucket;
+    }
+    ASSERT_EQ(samples, 8100u);
+}
+
+
+TEST(Instrumentation, Hook) {
+    ProbedMatrix<int, 0, 3> matrix;
+    std::vector<ProbeEvent> events;
+    matrix.probe().setHook([&events](ProbeEvent event, std::uint64_t) { events.push_back(event); });
+    
+    matrix[1][2][3] = 4;
+    matrix.get({1, 2, 3});
+    
+    const std::vector<ProbeEvent> expected{ProbeEvent::LOOKUP, ProbeEvent::INSERT, ProbeEvent::LOOKUP, ProbeEvent::HIT};
+    ASSERT_EQ(events, expected);
+    
+    matrix.probe().setHook(nullptr);
+    matrix[1][2][3] = 0;
+    ASSERT_EQ(events.size(), 4u);
+}
+
+
+TEST(Instrumentation, HookSurvivesAssignment) {
+    ProbedMatrix<int, 0, 2> a;
+    ProbedMatrix<int, 0, 2> b;
+    a[0][0] = 1;
+    b[1][1] = 2;
+    
+    ProbedMatrix<int, 0, 2> matrix;
+    size_t events = 0;
+    matrix.probe().setHook([&events](ProbeEvent, std::uint64_t) { ++events; });
+    
+    matrix = a + b;
+    ASSERT_EQ(matrix.size(), 2u);
+    matrix.get({0, 0});
+    ASSERT_EQ(events, 2u);
+    
+    ThreadPool pool{2};
+    matrix = a.parallelTransform([](int v) { return v + 1; }, pool);
+    matrix = b;
+    matrix.get({1, 1});
+    ASSERT_EQ(events, 4u);
+    ASSERT_EQ(matrix(1, 1), 2);
+}
+
+
+TEST(Instrumentation, CountingAllocator) {
+    Matrix<int, 0, 2, Data<int, 2, CountingAllocator<ElementType<int, 2>>>> matrix;
+    ASSERT_EQ(matrix.storage().allocator().bytes(), 0u);
+    
+    for (size_t i = 0; i < 100; ++i) {
+        matrix[i][i] = 1;
+    }
+    const size_t bytes = matrix.storage().allocator().bytes();
+    ASSERT_GE(bytes, 100 * sizeof(ElementType<int, 2>));
+    
+    auto copy = matrix;
+    ASSERT_EQ(copy.storage().allocator().bytes(), bytes);
+    ASSERT_NE(copy.storage().allocator(), matrix.storage().allocator());
+    
+    for (size_t i = 0; i < 100; ++i) {
+        matrix[i][i] = 0;
+    }
+    ASSERT_EQ(matrix.storage().allocator().bytes(), 0u);
+    ASSERT_EQ(copy.storage().allocator().bytes(), bytes);
+}
@@ -0,0 +1,134 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+
+TEST(PackedKeyCodec, RoundTrip) {
+    using Codec = PackedKeyCodec<3, 21>;
+    const Indexes<3> indexes = {1, Codec::MAX_INDEX, 12345};
+    
+    ASSERT_EQ(sizeof(Codec::Key), 8);
+    ASSERT_EQ(Codec::decode(Codec::encode(indexes)), indexes);
+    ASSERT_EQ(Codec::elementKey(std::make_tuple(size_t{1}, Codec::MAX_INDEX, size_t{12345}, 7)), Codec::encode(indexes));
+}
+
+
+TEST(PackedKeyCodec, WideKey) {
+    using Codec = PackedKeyCodec<4, 32>;
+    const Indexes<4> indexes = {4000000000u, 3, 0, 4294967295u};
+    
+    ASSERT_EQ(sizeof(Codec::Key), 16);
+    ASSERT_EQ(Codec::decode(Codec::encode(indexes)), indexes);
+}
+
+
+TEST(PackedKeyCodec, PreservesOrder) {
+    using Codec = PackedKeyCodec<3, 10>;
+    std::mt19937 gen{3};
+    std::uniform_int_distribution<size_t> index{0, Codec::MAX_INDEX};
+    
+    for (int i = 0; i < 1000; ++i) {
+        const Indexes<3> lhs = {index(gen), index(gen), index(gen)};
+        const Indexes<3> rhs = {index(gen) % 4, lhs[1], index(gen)};
+        ASSERT_EQ(lhs < rhs, Codec::encode(lhs) < Codec::encode(rhs));
+    }
+}
+
+
+TEST(PackedKeyCodec, OutOfRange) {
+    using Codec = PackedKeyCodec<2, 8>;
+    
+    ASSERT_THROW(Codec::encode({256, 0}), std::runtime_error);
+    ASSERT_THROW(Codec::encode({0, 1000}), std::runtime_error);
+    
+    ASSERT_EQ(Codec::lowerKey({3, 256}), std::make_pair(true, Codec::encode({4, 0})));
+    ASSERT_EQ(Codec::lowerKey({3, 7}), std::make_pair(true, Codec::encode({3, 7})));
+    ASSERT_FALSE(Codec::lowerKey({255, 256}).first);
+    ASSERT_FALSE(Codec::lowerKey({256, 0}).first);
+}
+
+
+TEST(PackedKeyCodec, MatrixMatchesTupleKeys) {
+    PackedMatrix<int, 0, 3> packed;
+    Matrix<int, 0, 3> reference;
+    std::mt19937 gen{11};
+    std::uniform_int_distribution<size_t> index{0, 15};
+    std::uniform_int_distribution<int> value{0, 3};
+    
+    for (int i = 0; i < 3000; ++i) {
+        const Indexes<3> indexes = {index(gen), index(gen), index(gen)};
+        const int v = value(gen);
+        packed.set(indexes, v);
+        reference.set(indexes, v);
+    }
+    
+    ASSERT_EQ(packed.size(), reference.size());
+    const auto ordered = packed.ordered();
+    ASSERT_TRUE(std::equal(ordered.begin(), ordered.end(), reference.ordered().begin(), reference.ordered().end()));
+    
+    const auto slice = packed.slice(3, 4);
+    ASSERT_TRUE(std::equal(slice.begin(), slice.end(), reference.slice(3, 4).begin(), reference.slice(3, 4).end()));
+    
+    const auto box = packed.range({2, 0, 5}, {9, 15, 9});
+    ASSERT_TRUE(std::equal(box.begin(), box.end(), reference.range({2, 0, 5}, {9, 15, 9}).begin(), reference.range({2, 0, 5}, {9, 15, 9}).end()));
+    
+    // узел хранит упакованный ключ, поэтому обход идет в порядке ключей
+    ASSERT_TRUE(std::equal(packed.begin(), packed.end(), reference.ordered().begin(), reference.ordered().end()));
+}
+
+
+// записи хранят упакованный ключ и значение вместо N индексов size_t
+static_assert(sizeof(PackedData<int, 2>::Map::value_type) == 16);
+static_assert(sizeof(PackedHashData<int, 3>::Entry) == 16);
+
+
+TEST(PackedKeyCodec, HashDataMatchesTupleKeys) {
+    Matrix<int, 0, 3, PackedHashData<int, 3, 10>> packed;
+    Matrix<int, 0, 3, HashData<int, 3>> reference;
+    std::mt19937 gen{13};
+    std::uniform_int_distribution<size_t> index{0, 15};
+    std::uniform_int_distribution<int> value{0, 3};
+    
+    for (int i = 0; i < 3000; ++i) {
+        const Indexes<3> indexes = {index(gen), index(gen), index(gen)};
+        const int v = value(gen);
+        packed.set(indexes, v);
+        reference.set(indexes, v);
+    }
+    
+    ASSERT_EQ(packed.size(), reference.size());
+    for (const auto& [x, y, z, v] : reference) {
+        ASSERT_EQ(packed(x, y, z), v);
+    }
+    const auto ordered = packed.ordered();
+    const auto expected = reference.ordered();
+    ASSERT_TRUE(std::equal(ordered.begin(), ordered.end(), expected.begin(), expected.end()));
+    ASSERT_EQ(*packed.find({std::get<0>(*reference.begin()), std::get<1>(*reference.begin()), std::get<2>(*reference.begin())}), *reference.begin());
+    
+    ASSERT_THROW(packed.set({1024, 0, 0}, 1), std::runtime_error);
+    ASSERT_EQ(packed(1024, 0, 0), 0);
+    ASSERT_NO_THROW(packed.set({1024, 0, 0}, 0));
+}
+
+
+TEST(PackedKeyCodec, MatrixRejectsOutOfRange) {
+    PackedMatrix<int, 0, 2, 16> matrix;
+    matrix[65535][1] = 5;
+    
+    ASSERT_THROW(matrix.set({65536, 0}, 1), std::runtime_error);
+    ASSERT_THROW(matrix.modify({65536, 0}, [](int& value) { value = 1; }), std::runtime_error);
+    ASSERT_EQ(matrix.size(), 1);
+    ASSERT_EQ(matrix(65535, 1), 5);
+    
+    // чтение и запись Default в непредставимую ячейку не бросают: такой ячейки нет в хранилище
+    ASSERT_EQ(matrix(70000, 1), 0);
+    ASSERT_EQ(matrix.tryGet({1, 70000}), nullptr);
+    ASSERT_TRUE(matrix.find({70000, 70000}) == matrix.end());
+    ASSERT_NO_THROW(matrix.set({65536, 0}, 0));
+    ASSERT_NO_THROW(matrix[65536][1] = 0);
+    ASSERT_EQ(matrix.size(), 1);
+}
@@ -0,0 +1,129 @@
+#include "lsm_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+
+
+TEST(LsmMatrix, ReadsThroughDeltaAndBase) {
+    LsmMatrix<int, -1, 2> matrix{4};
+
+    matrix[1][1] = 11;
+    matrix[2][2] = 22;
+    matrix.compact();
+    matrix[1][1] = 111;
+    matrix.update({2, 2}, -1);
+    matrix.update({3, 3}, 33);
+
+    ASSERT_EQ(matrix.deltaSize(), 3);
+    ASSERT_TRUE(matrix[1][1] == 111);
+    ASSERT_EQ(matrix.get({2, 2}), -1);
+    ASSERT_EQ(matrix.tryGet({2, 2}), nullptr);
+    ASSERT_EQ(matrix.get({3, 3}), 33);
+    ASSERT_EQ(matrix.size(), 2);
+
+    matrix.compact();
+
+    ASSERT_EQ(matrix.deltaSize(), 0);
+    ASSERT_EQ(matrix.get({1, 1}), 111);
+    ASSERT_EQ(matrix.get({2, 2}), -1);
+    ASSERT_EQ(matrix.size(), 2);
+}
+
+
+TEST(LsmMatrix, IterationMergesDeltaAndBase) {
+    LsmMatrix<int, 0, 2> matrix;
+    std::ostringstream os;
+
+    matrix.update({3, 4}, 34);
+    matrix.update({1, 2}, 12);
+    matrix.update({0, 9}, 9);
+    matrix.compact();
+    matrix.update({1, 2}, 0);
+    matrix.update({3, 4}, 43);
+    matrix.update({5, 5}, 55);
+    matrix.update({6, 6}, 0);
+
+    for (const auto& [x, y, v] : matrix) {
+        os << x << y << v << ';';
+    }
+
+    ASSERT_EQ(os.str(), "099;3443;5555;");
+}
+
+
+TEST(LsmMatrix, BackgroundMergesMatchReference) {
+    LsmMatrix<long, 0, 3> matrix{64};
+    std::map<Indexes<3>, long> reference;
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<size_t> index{0, 15};
+    std::uniform_int_distribution<long> value{0, 3};
+
+    for (int i = 0; i < 50000; ++i) {
+        const Indexes<3> indexes = {index(gen), index(gen), index(gen)};
+        const long v = value(gen);
+        matrix.update(indexes, v);
+        if (v == 0) {
+            reference.erase(indexes);
+        } else {
+            reference[indexes] = v;
+        }
+
+        if (i % 997 == 0) {
+            ASSERT_EQ(matrix.size(), reference.size());
+            for (const auto& [key, expected] : reference) {
+                ASSERT_EQ(matrix.get(key), expected);
+            }
+
+            // итерирование идет в порядке индексов, как у std::map, хотя часть изменений еще в буферах
+            auto expected = reference.begin();
+            for (const auto& [x, y, z, v] : matrix) {
+                ASSERT_TRUE(expected != reference.end());
+                ASSERT_EQ(expected->first, (Indexes<3>{x, y, z}));
+                ASSERT_EQ(expected->second, v);
+                ++expected;
+            }
+            ASSERT_TRUE(expected == reference.end());
+        }
+    }
+
+    std::map<Indexes<3>, long> iterated;
+    for (const auto& [x, y, z, v] : matrix) {
+        ASSERT_TRUE(iterated.emplace(Indexes<3>{x, y, z}, v).second);
+    }
+    ASSERT_EQ(iterated, reference);
+
+    matrix.compact();
+    iterated.clear();
+    for (const auto& [x, y, z, v] : matrix) {
+        iterated.emplace(Indexes<3>{x, y, z}, v);
+    }
+    ASSERT_EQ(iterated, reference);
+    ASSERT_EQ(matrix.size(), reference.size());
+    ASSERT_EQ(matrix.deltaSize(), 0);
+}
+
+
+TEST(LsmMatrix, ReadsInstallFinishedMerge) {
+    LsmMatrix<int, 0, 2> matrix{4};
+    for (size_t i = 0; i < 4; ++i) {
+        matrix.update({i, i}, static_cast<int>(i) + 1);
+    }
+    const int* value = matrix.tryGet({1, 1});
+    ASSERT_NE(value, nullptr);
+
+    // слияние запущено четвертой записью, дальше только чтение
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (matrix.deltaSize() != 0 && std::chrono::steady_clock::now() < deadline) {
+        ASSERT_EQ(matrix.get({3, 3}), 4);
+        std::this_thread::yield();
+    }
+
+    ASSERT_EQ(matrix.deltaSize(), 0);
+    ASSERT_EQ(*value, 2);
+    ASSERT_EQ(matrix.size(), 4);
+}
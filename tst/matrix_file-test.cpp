@@ -0,0 +1,118 @@
+#include "matrix_file.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+
+TEST(MatrixFile, RoundTrip) {
+    const std::string path = testing::TempDir() + "matrix_file_round_trip.bin";
+    Matrix<int, -1, 2> matrix;
+    matrix[3][4] = 34;
+    matrix[1][2] = 12;
+    matrix[0][9] = 9;
+    
+    writeMatrix(matrix, path);
+    MappedMatrix<int, -1, 2> mapped{path};
+    std::ostringstream os;
+    for (const auto& [x, y, v] : mapped) {
+        os << x << y << v << ';';
+    }
+    
+    ASSERT_EQ(mapped.size(), 3);
+    ASSERT_EQ(os.str(), "099;1212;3434;");
+    ASSERT_EQ(mapped.get({3, 4}), 34);
+    ASSERT_EQ(mapped.get({4, 3}), -1);
+    std::remove(path.c_str());
+}
+
+
+TEST(MatrixFile, UnorderedStorageIsSorted) {
+    const std::string path = testing::TempDir() + "matrix_file_hash.bin";
+    Matrix<long long, 0, 3, HashData<long long, 3>> matrix;
+    for (size_t i = 0; i < 100; ++i) {
+        matrix[(i * 37) % 100][i % 7][i % 3] = static_cast<long long>(i) + 1;
+    }
+    
+    writeMatrix(matrix, path);
+    MappedMatrix<long long, 0, 3> mapped{path};
+    
+    ASSERT_EQ(mapped.size(), matrix.size());
+    for (size_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(mapped.get({(i * 37) % 100, i % 7, i % 3}), static_cast<long long>(i) + 1);
+    }
+    
+    auto previous = mapped.begin();
+    for (auto it = std::next(previous); it != mapped.end(); ++it, ++previous) {
+        const auto& [x0, y0, z0, v0] = *previous;
+        const auto& [x1, y1, z1, v1] = *it;
+        ASSERT_LT(std::tie(x0, y0, z0), std::tie(x1, y1, z1));
+        (void)v0;
+        (void)v1;
+    }
+    std::remove(path.c_str());
+}
+
+
+TEST(MatrixFile, HeaderMismatch) {
+    const std::string path = testing::TempDir() + "matrix_file_mismatch.bin";
+    Matrix<int, 0, 2> matrix;
+    matrix[1][1] = 1;
+    writeMatrix(matrix, path);
+    
+    using WrongDefault   = MappedMatrix<int, 1, 2>;
+    using WrongDimension = MappedMatrix<int, 0, 3>;
+    using WrongType      = MappedMatrix<short, 0, 2>;
+    
+    ASSERT_THROW(WrongDefault{path}, std::runtime_error);
+    ASSERT_THROW(WrongDimension{path}, std::runtime_error);
+    ASSERT_THROW(WrongType{path}, std::runtime_error);
+    ASSERT_THROW((MappedMatrix<int, 0, 2>{path + ".missing"}), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+
+TEST(MatrixFile, CorruptedHeader) {
+    const std::string path = testing::TempDir() + "matrix_file_corrupted.bin";
+    Matrix<int, 0, 2> matrix;
+    matrix[1][1] = 1;
+    writeMatrix(matrix, path);
+    
+    const auto corrupt = [&path](size_t field, std::uint64_t value) {
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        MatrixFileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        std::uint64_t* fields[] = {&header.count, &header.default_offset};
+        const std::uint64_t old = *fields[field];
+        *fields[field] = value;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return old;
+    };
+    
+    // count * N * 8 и count * sizeof(T) переполняются в 0 и без проверки делением проходят сравнение с размером файла
+    const std::uint64_t count = corrupt(0, std::uint64_t{1} << 62);
+    ASSERT_THROW((MappedMatrix<int, 0, 2>{path}), std::runtime_error);
+    corrupt(0, count);
+    
+    corrupt(1, std::numeric_limits<std::uint64_t>::max() - 1);
+    ASSERT_THROW((MappedMatrix<int, 0, 2>{path}), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+
+TEST(MatrixFile, EmptyMatrix) {
+    const std::string path = testing::TempDir() + "matrix_file_empty.bin";
+    Matrix2D<int> matrix;
+    
+    writeMatrix(matrix, path);
+    MappedMatrix<int, 0, 2> mapped{path};
+    
+    ASSERT_EQ(mapped.size(), 0);
+    ASSERT_TRUE(mapped.begin() == mapped.end());
+    ASSERT_EQ(mapped.get({0, 0}), 0);
+    std::remove(path.c_str());
+}
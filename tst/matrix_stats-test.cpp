@@ -0,0 +1,126 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+
+namespace {
+
+template <typename M>
+void checkAgainstScan(const M& matrix) {
+    const auto& stats = matrix.stats();
+    
+    long long sum = 0;
+    int min = 0;
+    int max = 0;
+    std::vector<size_t> rows(10, 0);
+    std::vector<size_t> columns(10, 0);
+    bool first = true;
+    for (const auto& [i, j, v] : matrix) {
+        sum += v;
+        min = first ? v : std::min(min, v);
+        max = first ? v : std::max(max, v);
+        first = false;
+        ++rows[i];
+        ++columns[j];
+    }
+    
+    ASSERT_EQ(stats.count(), matrix.size());
+    ASSERT_EQ(stats.sum(), sum);
+    ASSERT_EQ(stats.min(), min);
+    ASSERT_EQ(stats.max(), max);
+    for (size_t k = 0; k < 10; ++k) {
+        ASSERT_EQ(stats.nnz(0, k), rows[k]);
+        ASSERT_EQ(stats.nnz(1, k), columns[k]);
+    }
+}
+
+}
+
+
+TEST(MatrixStats, TracksUpdates) {
+    StatsMatrix<int, 0, 2> matrix;
+    
+    matrix[1][2] = 5;
+    matrix[1][3] = -4;
+    matrix[2][3] = 9;
+    ASSERT_EQ(matrix.stats().count(), 3);
+    ASSERT_EQ(matrix.stats().sum(), 10);
+    ASSERT_EQ(matrix.stats().nnz(0, 1), 2);
+    ASSERT_EQ(matrix.stats().nnz(1, 3), 2);
+    ASSERT_EQ(matrix.stats().min(), -4);
+    ASSERT_EQ(matrix.stats().max(), 9);
+    
+    matrix[2][3] = 1;
+    ASSERT_EQ(matrix.stats().max(), 5);
+    ASSERT_EQ(matrix.stats().sum(), 2);
+    
+    matrix[1][3] = 0;
+    ASSERT_EQ(matrix.stats().min(), 1);
+    ASSERT_EQ(matrix.stats().nnz(0, 1), 1);
+    ASSERT_EQ(matrix.stats().nnz(1, 3), 1);
+    
+    matrix.modify({1, 2}, [](int& value) { value -= 5; });
+    matrix.modify({2, 3}, [](int& value) { value -= 1; });
+    ASSERT_EQ(matrix.stats().count(), 0);
+    ASSERT_EQ(matrix.stats().sum(), 0);
+    ASSERT_EQ(matrix.stats().nnz(0, 1), 0);
+}
+
+
+TEST(MatrixStats, MatchesScan) {
+    Matrix<int, 0, 2, HashData<int, 2>, MatrixStats<int, 2, true>> hashed;
+    StatsMatrix<int, 0, 2> ordered;
+    std::mt19937 gen{17};
+    std::uniform_int_distribution<size_t> index{0, 9};
+    std::uniform_int_distribution<int> value{-5, 5};
+    
+    for (int i = 0; i < 2000; ++i) {
+        const Indexes<2> indexes = {index(gen), index(gen)};
+        const int v = value(gen);
+        if (i % 3 == 0) {
+            hashed.modify(indexes, [v](int& x) { x += v; });
+            ordered.modify(indexes, [v](int& x) { x += v; });
+        } else {
+            hashed.set(indexes, v);
+            ordered.set(indexes, v);
+        }
+        if (i % 100 == 0) {
+            checkAgainstScan(hashed);
+            checkAgainstScan(ordered);
+        }
+    }
+    
+    std::vector<std::tuple<size_t, size_t, int>> elements;
+    for (int i = 0; i < 300; ++i) {
+        elements.emplace_back(index(gen), index(gen), value(gen));
+    }
+    hashed.bulkLoad(elements, DuplicatePolicy::SUM);
+    ordered.bulkLoad(elements, DuplicatePolicy::SUM);
+    checkAgainstScan(hashed);
+    checkAgainstScan(ordered);
+    
+    StatsMatrix<int, 0, 2> loaded;
+    loaded.bulkLoad(elements, DuplicatePolicy::SUM);
+    checkAgainstScan(loaded);
+    
+    StatsMatrix<int, 0, 2> evaluated = ordered - loaded * 2;
+    checkAgainstScan(evaluated);
+}
+
+
+TEST(MatrixStats, CountsWithoutExtremes) {
+    Matrix<int, 0, 3, Data<int, 3>, MatrixStats<int, 3>> matrix;
+    matrix[1][2][3] = 4;
+    matrix[1][5][3] = 6;
+    
+    ASSERT_EQ(matrix.stats().sum(), 10);
+    ASSERT_EQ(matrix.stats().nnz(2, 3), 2);
+    ASSERT_EQ(matrix.stats().nnz(1, 5), 1);
+    using Uninstrumented = BasicMatrix<int, 3, Data<int, 3>, StaticDefault<int, 0>, NoStats, NoProbe>;
+    ASSERT_EQ(sizeof(Uninstrumented), sizeof(Data<int, 3>));
+}
@@ -0,0 +1,190 @@
+#include "multiply.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <atomic>
+
+
+namespace {
+
+template <typename T>
+Matrix2D<T> randomMatrix(size_t rows, size_t columns, size_t count, std::uint32_t seed) {
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<size_t> row{0, rows - 1};
+    std::uniform_int_distribution<size_t> column{0, columns - 1};
+    std::uniform_int_distribution<int> value{-9, 9};
+    
+    Matrix2D<T> matrix;
+    for (size_t i = 0; i < count; ++i) {
+        matrix[row(gen)][column(gen)] = static_cast<T>(value(gen));
+    }
+    return matrix;
+}
+
+template <typename T>
+std::vector<T> randomVector(size_t size, std::uint32_t seed) {
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<int> value{-9, 9};
+    
+    std::vector<T> result(size);
+    for (auto& v : result) {
+        v = static_cast<T>(value(gen));
+    }
+    return result;
+}
+
+const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512};
+
+}
+
+
+TEST(ThreadPool, RunsEveryTask) {
+    ThreadPool pool{4};
+    std::vector<std::atomic<int>> counters(1000);
+    
+    pool.run(counters.size(), [&](size_t i) { ++counters[i]; });
+    
+    for (const auto& counter : counters) {
+        ASSERT_EQ(counter.load(), 1);
+    }
+}
+
+
+TEST(ThreadPool, ParallelForCoversRange) {
+    ThreadPool pool{3};
+    std::vector<int> marks(100);
+    
+    pool.parallelFor(10, 90, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            ++marks[i];
+        }
+    });
+    
+    for (size_t i = 0; i < marks.size(); ++i) {
+        ASSERT_EQ(marks[i], i >= 10 && i < 90 ? 1 : 0);
+    }
+}
+
+
+TEST(ThreadPool, RethrowsTaskException) {
+    ThreadPool pool{4};
+    
+    ASSERT_THROW(pool.run(16, [](size_t i) {
+        if (i == 7) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+}
+
+
+TEST(Multiply, MatrixVector) {
+    const auto matrix = randomMatrix<int>(200, 300, 5000, 1);
+    const auto csr = toCSR(matrix);
+    const auto x = randomVector<int>(csr.columns(), 2);
+    
+    std::vector<int> expected(csr.rows());
+    for (const auto& [i, j, v] : matrix) {
+        expected[i] += v * x[j];
+    }
+    
+    for (const size_t threads : {1, 2, 5}) {
+        ThreadPool pool{threads};
+        for (const auto level : levels) {
+            if (level > detectSimdLevel()) {
+                continue;
+            }
+            ASSERT_EQ(multiply(csr, x, pool, level), expected);
+        }
+    }
+}
+
+
+TEST(Multiply, MatrixVectorLong) {
+    const auto csr = toCSR(randomMatrix<long>(100, 100, 3000, 3));
+    const auto x = randomVector<long>(csr.columns(), 4);
+    ThreadPool pool{2};
+    
+    const auto expected = multiply(csr, x, pool, SimdLevel::SCALAR);
+    
+    ASSERT_EQ(multiply(csr, x, pool), expected);
+}
+
+
+TEST(Multiply, MatrixVectorDeterministic) {
+    const auto csr = toCSR(randomMatrix<int>(500, 500, 20000, 5));
+    const auto x = randomVector<int>(csr.columns(), 6);
+    ThreadPool pool_1{1};
+    ThreadPool pool_8{8};
+    
+    ASSERT_EQ(multiply(csr, x, pool_1), multiply(csr, x, pool_8));
+}
+
+
+TEST(Multiply, MatrixVectorShortVector) {
+    const auto csr = toCSR(randomMatrix<int>(10, 10, 50, 7));
+    ThreadPool pool{1};
+    
+    ASSERT_THROW(multiply(csr, std::vector<int>(csr.columns() - 1), pool), std::invalid_argument);
+}
+
+
+TEST(Multiply, MatrixDense) {
+    const auto matrix = randomMatrix<int>(50, 40, 400, 8);
+    const auto csr = toCSR(matrix);
+    DenseMatrix<int> dense{csr.columns(), 13};
+    dense.data = randomVector<int>(dense.data.size(), 9);
+    
+    DenseMatrix<int> expected{csr.rows(), dense.columns};
+    for (const auto& [i, k, v] : matrix) {
+        for (size_t j = 0; j < dense.columns; ++j) {
+            expected(i, j) += v * dense(k, j);
+        }
+    }
+    
+    for (const size_t threads : {1, 3}) {
+        ThreadPool pool{threads};
+        for (const auto level : levels) {
+            if (level > detectSimdLevel()) {
+                continue;
+            }
+            ASSERT_EQ(multiply(csr, dense, pool, level).data, expected.data);
+        }
+    }
+}
+
+
+TEST(Multiply, MatrixMatrix) {
+    const auto lhs = randomMatrix<int>(60, 40, 300, 10);
+    const auto rhs = randomMatrix<int>(40, 70, 300, 11);
+    
+    Matrix2D<int> expected;
+    for (const auto& [i, k, a] : lhs) {
+        for (const auto& [l, j, b] : rhs) {
+            if (k == l) {
+                expected[i][j] = expected[i][j] + a * b;
+            }
+        }
+    }
+    const auto expected_csr = toCSR(expected);
+    
+    for (const size_t threads : {1, 4}) {
+        ThreadPool pool{threads};
+        const auto product = multiply(toCSR(lhs), toCSR(rhs), pool);
+        
+        ASSERT_EQ(product.rows(), expected_csr.rows());
+        ASSERT_EQ(product.lineIds(), expected_csr.lineIds());
+        ASSERT_EQ(product.offsets(), expected_csr.offsets());
+        ASSERT_EQ(product.indexes(), expected_csr.indexes());
+        ASSERT_EQ(product.values(), expected_csr.values());
+    }
+}
+
+
+TEST(Multiply, MatrixMatrixEmpty) {
+    ThreadPool pool{2};
+    const auto product = multiply(toCSR(Matrix2D<int>{}), toCSR(randomMatrix<int>(5, 5, 10, 12)), pool);
+    
+    ASSERT_EQ(product.size(), 0);
+    ASSERT_EQ(product.rows(), 0);
+}
@@ -0,0 +1,122 @@
+#include "sparse_matrix.h"
+#include "random_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <random>
+
+
+namespace {
+
+/// Значение i-й записи из [1, 100]
+int percent(size_t i, std::mt19937&) {
+    return static_cast<int>(i % 100) + 1;
+}
+
+
+template <typename M>
+void checkParallelAlgorithms() {
+    const auto matrix = randomMatrix<M>(60000, 1000, 11, percent);
+    ThreadPool pool{4};
+    
+    long long expected = 0;
+    for (const auto& elem : matrix) {
+        expected += std::get<2>(elem);
+    }
+    
+    std::atomic<long long> sum{0};
+    std::atomic<size_t> count{0};
+    matrix.parallelForEach([&](const auto& elem) {
+        sum += std::get<2>(elem);
+        ++count;
+    }, pool);
+    ASSERT_EQ(count.load(), matrix.size());
+    ASSERT_EQ(sum.load(), expected);
+    
+    const auto reduced = matrix.parallelReduce(0LL, [](const auto& elem) { return static_cast<long long>(std::get<2>(elem)); },
+                                               [](long long a, long long b) { return a + b; }, pool);
+    ASSERT_EQ(reduced, expected);
+    
+    const auto halved = matrix.parallelTransform([](int v) { return v / 2; }, pool);
+    size_t kept = 0;
+    for (const auto& [i, j, v] : matrix) {
+        ASSERT_EQ(halved(i, j), v / 2);
+        kept += v / 2 != 0;
+    }
+    ASSERT_EQ(halved.size(), kept);
+}
+
+
+template <typename Storage>
+void checkSplit(const Storage& storage) {
+    for (size_t parts : {1, 2, 7, 100}) {
+        const auto ranges = storage.split(parts);
+        ASSERT_LE(ranges.size(), parts);
+        
+        auto it = storage.begin();
+        size_t count = 0;
+        for (const auto& [first, last] : ranges) {
+            ASSERT_TRUE(first == it);
+            ASSERT_TRUE(first != last);
+            for (; it != last; ++it) {
+                ++count;
+            }
+        }
+        ASSERT_TRUE(it == storage.end());
+        ASSERT_EQ(count, storage.size());
+    }
+}
+
+}
+
+
+TEST(ParallelExecutor, AllStorages) {
+    checkParallelAlgorithms<Matrix<int, 0, 2>>();
+    checkParallelAlgorithms<Matrix<int, 0, 2, HashData<int, 2>>>();
+    checkParallelAlgorithms<CowMatrix<int, 0, 2>>();
+    checkParallelAlgorithms<BlockMatrix<int, 0, 2>>();
+}
+
+
+TEST(ParallelExecutor, SplitCoversStorage) {
+    checkSplit(randomMatrix<Matrix<int, 0, 2>>(1000, 1000, 11, percent).storage());
+    checkSplit(randomMatrix<Matrix<int, 0, 2, HashData<int, 2>>>(1000, 1000, 11, percent).storage());
+    checkSplit(randomMatrix<CowMatrix<int, 0, 2>>(1000, 1000, 11, percent).storage());
+    checkSplit(randomMatrix<BlockMatrix<int, 0, 2>>(1000, 1000, 11, percent).storage());
+    
+    const HashData<int, 2> hashed;
+    const BlockData<int, 2> blocked;
+    ASSERT_TRUE(hashed.split(4).empty());
+    ASSERT_TRUE(blocked.split(4).empty());
+}
+
+
+TEST(ParallelExecutor, ReduceOfEmptyMatrix) {
+    Matrix<int, 0, 2> matrix;
+    ThreadPool pool{2};
+    
+    const int result = matrix.parallelReduce(42, [](const auto& elem) { return std::get<2>(elem); }, [](int a, int b) { return a + b; }, pool);
+    ASSERT_EQ(result, 42);
+    ASSERT_EQ(matrix.parallelTransform([](int v) { return v + 1; }, pool).size(), 0u);
+}
+
+
+#if MATRIX_EXECUTION_POLICIES
+TEST(ParallelExecutor, ExecutionPolicy) {
+    const auto matrix = randomMatrix<Matrix<int, 0, 2, HashData<int, 2>>>(60000, 1000, 11, percent);
+    
+    std::atomic<size_t> count{0};
+    matrix.parallelForEach(std::execution::par, [&count](const auto&) { ++count; });
+    ASSERT_EQ(count.load(), matrix.size());
+    
+    const auto sum = matrix.parallelReduce(std::execution::par, 0LL, [](const auto& elem) { return static_cast<long long>(std::get<2>(elem)); },
+                                           [](long long a, long long b) { return a + b; });
+    long long expected = 0;
+    for (const auto& elem : matrix) {
+        expected += std::get<2>(elem);
+    }
+    ASSERT_EQ(sum, expected);
+    ASSERT_EQ(matrix.parallelTransform(std::execution::seq, [](int v) { return v; }).size(), matrix.size());
+}
+#endif
@@ -0,0 +1,81 @@
+#include "sparse_matrix.h"
+#include "random_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+
+TEST(PermutedView, Transpose) {
+    Matrix2D<int, -1> matrix;
+    matrix[1][5] = 7;
+    matrix[3][2] = 9;
+    
+    const auto transposed = matrix.transpose();
+    
+    ASSERT_EQ(transposed.size(), 2u);
+    ASSERT_EQ(transposed(5, 1), 7);
+    ASSERT_EQ(transposed(2, 3), 9);
+    ASSERT_EQ(transposed(1, 5), -1);
+    ASSERT_EQ(transposed.defaultValue(), -1);
+    ASSERT_EQ(transposed.tryGet({1, 5}), nullptr);
+    ASSERT_EQ(transposed.tryGet({5, 1}), matrix.tryGet({1, 5}));
+    
+    matrix[4][0] = 3;
+    ASSERT_EQ(transposed(0, 4), 3);
+    
+    std::vector<std::tuple<size_t, size_t, int>> elements;
+    for (const auto& [i, j, v] : transposed) {
+        elements.emplace_back(i, j, v);
+    }
+    const std::vector<std::tuple<size_t, size_t, int>> expected{{5, 1, 7}, {2, 3, 9}, {0, 4, 3}};
+    ASSERT_EQ(elements, expected);
+    
+    const std::vector<std::tuple<size_t, size_t, int>> sorted{{0, 4, 3}, {2, 3, 9}, {5, 1, 7}};
+    ASSERT_EQ(transposed.materialize(), sorted);
+}
+
+
+TEST(PermutedView, Permute) {
+    Matrix3D<int> matrix;
+    fillRandom(matrix, 3000, 30, 11, ordinal);
+    
+    const auto view = matrix.permute<1, 2, 0>();
+    ASSERT_EQ(view.size(), matrix.size());
+    for (const auto& [x, y, z, v] : matrix) {
+        ASSERT_EQ(view(y, z, x), v);
+    }
+    for (const auto& [y, z, x, v] : view) {
+        ASSERT_EQ(matrix(x, y, z), v);
+    }
+    ASSERT_EQ(view(0, 0, 100), 0);
+}
+
+
+TEST(PermutedView, Materialize) {
+    Matrix3D<int> matrix;
+    fillRandom(matrix, 3000, 30, 11, ordinal);
+    Matrix<int, 0, 3, HashData<int, 3>> hashed;
+    fillRandom(hashed, 3000, 30, 11, ordinal);
+    
+    std::vector<std::tuple<size_t, size_t, size_t, int>> expected;
+    for (const auto& [x, y, z, v] : matrix) {
+        expected.emplace_back(y, x, z, v);
+    }
+    std::sort(expected.begin(), expected.end());
+    
+    ThreadPool pool{4};
+    const auto view = matrix.permute<1, 0, 2>();
+    const auto hashed_view = hashed.permute<1, 0, 2>();
+    ASSERT_EQ(view.materialize(), expected);
+    ASSERT_EQ(view.materialize(pool), expected);
+    ASSERT_EQ(hashed_view.materialize(), expected);
+    ASSERT_EQ(hashed_view.materialize(pool), expected);
+    
+    Matrix3D<int> permuted;
+    permuted.bulkLoad(view.materialize(pool));
+    ASSERT_EQ(permuted.size(), matrix.size());
+    for (const auto& [x, y, z, v] : matrix) {
+        ASSERT_EQ(permuted(y, x, z), v);
+    }
+}
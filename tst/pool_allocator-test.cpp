@@ -0,0 +1,66 @@
+#include "sparse_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+
+TEST(NodePool, ReusesFreedNodes) {
+    NodePool pool{24, 8};
+    
+    void* first  = pool.allocate();
+    void* second = pool.allocate();
+    pool.deallocate(first);
+    
+    ASSERT_EQ(pool.size(), 24);
+    ASSERT_NE(first, second);
+    ASSERT_EQ(pool.allocate(), first);
+}
+
+
+TEST(NodePool, Alignment) {
+    NodePool pool{12, 4};
+    
+    for (size_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(pool.allocate()) % pool.alignment(), 0);
+    }
+    ASSERT_EQ(pool.size() % pool.alignment(), 0);
+}
+
+
+TEST(PoolMatrix, BehavesLikeMatrix) {
+    PoolMatrix<int, -1, 2> matrix;
+    std::ostringstream os;
+    
+    for (size_t i = 0; i < 1000; ++i) {
+        matrix[i][i] = static_cast<int>(i);
+    }
+    for (size_t i = 1; i < 1000; ++i) {
+        matrix[i][i] = -1;
+    }
+    matrix[5][6] = 56;
+    for (const auto& [x, y, v] : matrix) {
+        os << x << y << v << ';';
+    }
+    
+    ASSERT_EQ(matrix.size(), 2);
+    ASSERT_EQ(os.str(), "000;5656;");
+}
+
+
+TEST(PoolMatrix, CopyAndMove) {
+    PoolMatrix<int, 0, 2> matrix;
+    matrix[1][1] = 11;
+    
+    PoolMatrix<int, 0, 2> copy = matrix;
+    copy[2][2] = 22;
+    PoolMatrix<int, 0, 2> moved = std::move(matrix);
+    moved[3][3] = 33;
+    matrix = copy;
+    
+    ASSERT_EQ(copy.size(), 2);
+    ASSERT_EQ(moved.size(), 2);
+    ASSERT_EQ(moved(1, 1), 11);
+    ASSERT_EQ(moved(2, 2), 0);
+    ASSERT_EQ(matrix(2, 2), 22);
+}
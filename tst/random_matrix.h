@@ -0,0 +1,55 @@
+/*!
+@file
+@brief Вспомогательные функции тестов: заполнение матрицы случайными элементами
+*/
+
+#pragma once
+
+#include "indexes.h"
+
+#include <cstdint>
+#include <random>
+#include <tuple>
+
+
+/*!
+ Записывает в матрицу count элементов со случайными индексами из [0, side) по каждому измерению.
+ Генератор инициализируется seed, поэтому содержимое воспроизводимо. Совпавшие индексы перезаписываются,
+ а значение по умолчанию удаляет элемент, так что элементов может оказаться меньше count
+ @param matrix Матрица с методом set(indexes, value)
+ @param count  Количество записей
+ @param side   Граница индексов
+ @param seed   Начальное значение генератора
+ @param value  Функция value(i, gen), возвращающая значение i-й записи
+ */
+template <typename M, typename Value>
+void fillRandom(M& matrix, size_t count, size_t side, std::uint32_t seed, Value value) {
+    constexpr size_t N = std::tuple_size_v<typename M::Element> - 1;
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<size_t> index{0, side - 1};
+    for (size_t i = 0; i < count; ++i) {
+        Indexes<N> indexes;
+        for (auto& item : indexes) {
+            item = index(gen);
+        }
+        matrix.set(indexes, value(i, gen));
+    }
+}
+
+
+/*!
+ Создает матрицу и заполняет ее, см. fillRandom
+ @return Заполненная матрица
+ */
+template <typename M, typename Value>
+M randomMatrix(size_t count, size_t side, std::uint32_t seed, Value value) {
+    M matrix;
+    fillRandom(matrix, count, side, seed, value);
+    return matrix;
+}
+
+
+/// Значение i-й записи: i + 1, все значения различны и не равны нулю
+inline int ordinal(size_t i, std::mt19937&) {
+    return static_cast<int>(i) + 1;
+}
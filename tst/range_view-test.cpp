@@ -0,0 +1,100 @@
+#include "sparse_matrix.h"
+#include "random_matrix.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <vector>
+
+
+namespace {
+
+template <typename M>
+std::vector<std::tuple<size_t, size_t, size_t, int>> bruteForce(const M& matrix, const Indexes<3>& lo, const Indexes<3>& hi) {
+    std::vector<std::tuple<size_t, size_t, size_t, int>> result;
+    for (const auto& [x, y, z, v] : matrix) {
+        if (lo[0] <= x && x <= hi[0] && lo[1] <= y && y <= hi[1] && lo[2] <= z && z <= hi[2]) {
+            result.emplace_back(x, y, z, v);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+
+template <typename View>
+std::vector<std::tuple<size_t, size_t, size_t, int>> collect(const View& view) {
+    std::vector<std::tuple<size_t, size_t, size_t, int>> result(view.begin(), view.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}
+
+
+TEST(RangeView, Slice) {
+    Matrix<int, -1, 2> matrix;
+    std::ostringstream os;
+    
+    matrix[17][5] = 175;
+    matrix[16][9] = 169;
+    matrix[17][1] = 171;
+    matrix[18][0] = 180;
+    for (const auto& [x, y, v] : matrix.slice(17)) {
+        os << x << y << v << ';';
+    }
+    
+    ASSERT_EQ(os.str(), "171171;175175;");
+    ASSERT_TRUE(matrix.slice(3).empty());
+    ASSERT_EQ(std::distance(matrix.slice().begin(), matrix.slice().end()), 4);
+    ASSERT_EQ(std::distance(matrix.slice(17, 5).begin(), matrix.slice(17, 5).end()), 1);
+}
+
+
+TEST(RangeView, BoxMatchesBruteForce) {
+    Matrix3D<int> ordered;
+    Matrix<int, 0, 3, HashData<int, 3>> hashed;
+    fillRandom(ordered, 2000, 20, 7, ordinal);
+    fillRandom(hashed, 2000, 20, 7, ordinal);
+    
+    const std::vector<std::pair<Indexes<3>, Indexes<3>>> boxes = {
+        {{0, 0, 0}, {19, 19, 19}},
+        {{3, 4, 5}, {7, 8, 9}},
+        {{5, 0, 0}, {5, 19, 19}},
+        {{0, 10, 0}, {19, 10, 19}},
+        {{0, 0, 19}, {19, 19, 19}},
+        {{12, 3, 3}, {12, 3, 3}},
+        {{8, 8, 8}, {4, 9, 9}},
+    };
+    
+    for (const auto& [lo, hi] : boxes) {
+        const auto expected = bruteForce(ordered, lo, hi);
+        ASSERT_EQ(collect(ordered.range(lo, hi)), expected);
+        ASSERT_EQ(collect(hashed.range(lo, hi)), expected);
+    }
+}
+
+
+TEST(RangeView, OrderedStorageYieldsKeyOrder) {
+    Matrix3D<int> matrix;
+    fillRandom(matrix, 2000, 20, 7, ordinal);
+    
+    const auto view = matrix.range({2, 2, 2}, {15, 15, 15});
+    std::vector<std::tuple<size_t, size_t, size_t, int>> elements(view.begin(), view.end());
+    
+    ASSERT_FALSE(elements.empty());
+    ASSERT_TRUE(std::is_sorted(elements.begin(), elements.end()));
+}
+
+
+TEST(RangeView, MaxIndexes) {
+    constexpr size_t MAX = std::numeric_limits<size_t>::max();
+    Matrix2D<int> matrix;
+    
+    matrix[MAX][MAX] = 1;
+    matrix[MAX][0] = 2;
+    matrix[0][MAX] = 3;
+    
+    ASSERT_EQ(std::distance(matrix.slice(MAX).begin(), matrix.slice(MAX).end()), 2);
+    ASSERT_EQ(std::distance(matrix.range({0, MAX}, {MAX, MAX}).begin(), matrix.range({0, MAX}, {MAX, MAX}).end()), 2);
+}
@@ -3,6 +3,8 @@
 #include "gtest/gtest.h"
 
 #include <sstream>
+#include <type_traits>
+#include <utility>
 
 
 TEST(MatrixTest, DefaultSize) {
@@ -66,19 +68,278 @@ TEST(MatrixTest, OperatorEq) {
 }
 
 
+namespace {
+
+template <typename Proxy, typename = void>
+struct CanIndex : std::false_type {};
+
+template <typename Proxy>
+struct CanIndex<Proxy, std::void_t<decltype(std::declval<Proxy&>()[0])>> : std::true_type {};
+
+}
+
+
 TEST(MatrixTest, TooManyIndexes) {
-    Matrix<int, -1, 2> matrix;
+    using Full = decltype(std::declval<Matrix<int, -1, 2>&>()[100][100]);
     
-    ASSERT_THROW(matrix[100][100][100] = 10, std::runtime_error);
+    ASSERT_FALSE(CanIndex<Full>::value);
+    ASSERT_TRUE((std::is_convertible_v<Full, int>));
 }
 
 
 TEST(MatrixTest, FewIndexes) {
-    Matrix<int, -1, 2> matrix;
+    using Partial = decltype(std::declval<Matrix<int, -1, 2>&>()[100]);
+    
+    ASSERT_TRUE(CanIndex<Partial>::value);
+    ASSERT_FALSE((std::is_assignable_v<Partial&, int>));
+    ASSERT_FALSE((std::is_convertible_v<Partial, int>));
+}
+
+
+TEST(MatrixTest, ProxyToProxy) {
+    Matrix<int, -1, 3> matrix;
+    
+    matrix[1][2][3] = 123;
+    matrix[3][2][1] = matrix[1][2][3];
+    
+    ASSERT_TRUE(matrix[3][2][1] == 123);
+    ASSERT_EQ(matrix.size(), 2);
+}
+
+
+TEST(MatrixTest, HashStorage) {
+    Matrix<int, -1, 2, HashData<int, 2>> matrix;
+    std::ostringstream os;
+    
+    matrix[100][100] = 314;
+    matrix[1][2] = 3;
+    matrix[1][2] = -1;
+    for(const auto& [x, y, v]: matrix) {
+        os << x << y << v << std::endl;
+    }
+    
+    ASSERT_TRUE(matrix[100][100] == 314);
+    ASSERT_TRUE(matrix[1][2] == -1);
+    ASSERT_EQ(matrix.size(), 1);
+    ASSERT_EQ(os.str(), "100100314\n");
+}
+
+
+TEST(MatrixTest, DirectAccess) {
+    Matrix<int, -1, 3> matrix;
+    
+    matrix.set({1, 2, 3}, 123);
+    matrix.set({3, 2, 1}, 321);
+    matrix.set({3, 2, 1}, 42);
+    matrix.set({7, 7, 7}, -1);
+    
+    ASSERT_EQ(matrix(1, 2, 3), 123);
+    ASSERT_EQ(matrix(3u, 2u, 1u), 42);
+    ASSERT_EQ(matrix.get({7, 7, 7}), -1);
+    ASSERT_EQ(matrix.size(), 2);
+    
+    ASSERT_NE(matrix.tryGet({1, 2, 3}), nullptr);
+    ASSERT_EQ(*matrix.tryGet({1, 2, 3}), 123);
+    ASSERT_EQ(matrix.tryGet({7, 7, 7}), nullptr);
+    
+    const auto it = matrix.find({3, 2, 1});
+    ASSERT_TRUE(it != matrix.end());
+    ASSERT_EQ(std::get<3>(*it), 42);
+    ASSERT_TRUE(matrix.find({0, 0, 0}) == matrix.end());
+    
+    matrix.set({1, 2, 3}, -1);
+    ASSERT_EQ(matrix.size(), 1);
+}
+
+
+template <typename Storage>
+void checkModify() {
+    Matrix<int, 0, 2, Storage> matrix;
+    
+    for (int i = 0; i < 5; ++i) {
+        matrix.modify({1, 1}, [](int& value) { ++value; });
+    }
+    matrix.modify({2, 2}, [](int& value) { value += 0; });
+    
+    ASSERT_EQ(matrix(1, 1), 5);
+    ASSERT_EQ(matrix.size(), 1);
+    
+    matrix.modify({1, 1}, [](int& value) { value = 0; });
+    ASSERT_EQ(matrix.size(), 0);
+}
+
+
+TEST(MatrixTest, Modify) {
+    checkModify<Data<int, 2>>();
+    checkModify<HashData<int, 2>>();
+}
+
+
+template <typename Storage>
+void checkOrdered() {
+    Matrix<int, 0, 2, Storage> matrix;
+    matrix.set({3, 1}, 1);
+    matrix.set({1, 7}, 2);
+    matrix.set({1, 2}, 3);
+    matrix.set({2, 5}, 4);
+    matrix.set({1, 7}, 5);
+    
+    std::ostringstream os;
+    for (const auto& [x, y, v] : matrix.ordered()) {
+        os << x << y << v << ' ';
+    }
+    ASSERT_EQ(os.str(), "123 175 254 311 ");
+}
+
+
+TEST(MatrixTest, Ordered) {
+    checkOrdered<Data<int, 2>>();
+    checkOrdered<HashData<int, 2>>();
+}
+
+
+TEST(MatrixTest, OverwriteKeepsInsertionOrder) {
+    Matrix<int, 0, 2> matrix;
+    matrix[3][1] = 1;
+    matrix[1][7] = 2;
+    matrix[2][5] = 3;
+    matrix[3][1] = 4;
     
-    ASSERT_THROW(matrix[100] = 10, std::runtime_error);
+    std::ostringstream os;
+    for (const auto& [x, y, v] : matrix) {
+        os << x << y << v << ' ';
+    }
+    ASSERT_EQ(os.str(), "314 172 253 ");
 }
 
 
+TEST(MatrixTest, RuntimeDefault) {
+    RuntimeMatrix<double, 2> matrix{RuntimeDefault<double>{-1.5}};
+    
+    ASSERT_EQ(matrix.defaultValue(), -1.5);
+    ASSERT_EQ(matrix(0, 0), -1.5);
+    
+    matrix[1][2] = 0.25;
+    matrix[3][4] = -1.5;
+    ASSERT_EQ(matrix.size(), 1);
+    ASSERT_EQ(static_cast<double>(matrix[1][2]), 0.25);
+    
+    matrix[1][2] = -1.5;
+    ASSERT_EQ(matrix.size(), 0);
+}
+
+
+TEST(MatrixTest, EpsilonDefault) {
+    RuntimeMatrix<double, 2, HashData<double, 2>> matrix{RuntimeDefault<double>{0.0, 1e-9}};
+    
+    matrix.set({1, 1}, 1e-12);
+    matrix.set({2, 2}, -1e-12);
+    ASSERT_EQ(matrix.size(), 0);
+    
+    matrix.set({3, 3}, 0.1);
+    matrix.modify({3, 3}, [](double& value) { value -= 0.1 + 1e-15; });
+    ASSERT_EQ(matrix.size(), 0);
+    
+    const std::vector<std::tuple<size_t, size_t, double>> elements{{1, 1, 1e-10}, {2, 2, 2.0}};
+    matrix.bulkLoad(elements);
+    ASSERT_EQ(matrix.size(), 1);
+    ASSERT_EQ(matrix(2, 2), 2.0);
+}
+
+
+TEST(MatrixTest, StaticDefaultIsFree) {
+    // без NoProbe при MATRIX_INSTRUMENTATION=ON матрица содержит счетчики MatrixProbe
+    using Uninstrumented = BasicMatrix<int, 2, Data<int, 2>, StaticDefault<int, 0>, NoStats, NoProbe>;
+    ASSERT_EQ(sizeof(Uninstrumented), sizeof(Data<int, 2>));
+}
 
 
+namespace {
+
+// Значение, которое считает свои копирования: перемещение разрешено и не считается
+struct Counted {
+    Counted(int v = 0) : value{v} {}
+    Counted(const Counted& other) : value{other.value} { ++copies; }
+    Counted(Counted&& other) noexcept : value{other.value} {}
+    Counted& operator=(const Counted& other) { value = other.value; ++copies; return *this; }
+    Counted& operator=(Counted&& other) noexcept { value = other.value; return *this; }
+    
+    bool operator==(const Counted& other) const { return value == other.value; }
+    bool operator<(const Counted& other) const { return value < other.value; }
+    bool operator<=(const Counted& other) const { return value <= other.value; }
+    Counted operator-(const Counted& other) const { return Counted{value - other.value}; }
+    Counted operator+(const Counted& other) const { return Counted{value + other.value}; }
+    
+    int value;
+    static inline size_t copies = 0;
+};
+
+
+template <typename Storage>
+void checkWritesWithoutCopies() {
+    RuntimeMatrix<Counted, 2, Storage> matrix;
+    Counted::copies = 0;
+    
+    matrix.set({1, 2}, Counted{5});
+    matrix[1][2] = Counted{6};
+    matrix.emplace({3, 4}, 7);
+    Counted value{8};
+    matrix[5][6] = std::move(value);
+    matrix.set({3, 4}, Counted{0});
+    for (int i = 1; i < 100; ++i) {
+        matrix.emplace({static_cast<size_t>(i), 0}, i);
+    }
+    ASSERT_EQ(Counted::copies, 0u);
+    
+    ASSERT_EQ(matrix.size(), 101u);
+    ASSERT_EQ(matrix.getRef({1, 2}).value, 6);
+    ASSERT_EQ(matrix.getRef({5, 6}).value, 8);
+    ASSERT_EQ(matrix.getRef({3, 4}).value, 0);
+    ASSERT_EQ(matrix.getRef({99, 0}).value, 99);
+    ASSERT_EQ(Counted::copies, 0u);
+    
+    const Counted copied{9};
+    matrix.set({1, 2}, copied);
+    ASSERT_EQ(Counted::copies, 1u);
+    ASSERT_EQ(matrix.get({1, 2}).value, 9);
+    ASSERT_EQ(Counted::copies, 2u);
+}
+
+}
+
+
+TEST(MatrixTest, MoveWritesDoNotCopy) {
+    checkWritesWithoutCopies<Data<Counted, 2>>();
+    checkWritesWithoutCopies<HashData<Counted, 2>>();
+    checkWritesWithoutCopies<CowData<Counted, 2>>();
+    checkWritesWithoutCopies<BlockData<Counted, 2>>();
+}
+
+
+TEST(MatrixTest, BulkLoadMovesValues) {
+    std::vector<ElementType<Counted, 2>> elements;
+    for (size_t i = 0; i < 100; ++i) {
+        elements.emplace_back(i % 10, i / 10, static_cast<int>(i) + 1);
+    }
+    
+    auto copy = elements;
+    RuntimeMatrix<Counted, 2> ordered;
+    RuntimeMatrix<Counted, 2, HashData<Counted, 2>> hashed;
+    Counted::copies = 0;
+    
+    ordered.bulkLoad(std::move(elements));
+    hashed.bulkLoad(std::move(copy));
+    ASSERT_EQ(Counted::copies, 0u);
+    ASSERT_EQ(ordered.size(), 100u);
+    ASSERT_EQ(hashed.getRef({9, 9}).value, 100);
+}
+
+
+TEST(MatrixTest, GetRefReturnsDefault) {
+    Matrix<int, -1, 2> matrix;
+    matrix[1][1] = 5;
+    
+    using Policy = StaticDefault<int, -1>;
+    ASSERT_EQ(&matrix.getRef({0, 0}), &Policy::VALUE);
+    ASSERT_EQ(&matrix.getRef({1, 1}), matrix.tryGet({1, 1}));
+}
@@ -0,0 +1,177 @@
+#include "text_io.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+
+namespace {
+
+std::string writeFile(const std::string& name, const std::string& content) {
+    const std::string path = testing::TempDir() + name;
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    out << content;
+    return path;
+}
+
+
+template <typename M>
+std::string dump(const M& matrix) {
+    std::ostringstream os;
+    for (const auto& [x, y, v] : matrix.ordered()) {
+        os << x << ',' << y << '=' << v << ';';
+    }
+    return os.str();
+}
+
+}
+
+
+TEST(TextIO, MatrixMarket) {
+    const std::string path = writeFile("text_io_market.mtx",
+        "%%MatrixMarket matrix coordinate real general\n"
+        "% comment\n"
+        "\n"
+        "4 5 3\n"
+        "1 1 1.5\n"
+        "4 5 -2e3\r\n"
+        "  2\t3 +0.25\n");
+    
+    RuntimeMatrix<double, 2> matrix;
+    loadText(matrix, path, TextFormat::MATRIX_MARKET);
+    
+    ASSERT_EQ(dump(matrix), "0,0=1.5;1,2=0.25;3,4=-2000;");
+    std::remove(path.c_str());
+}
+
+
+TEST(TextIO, PatternSymmetric) {
+    const std::string path = writeFile("text_io_pattern.mtx",
+        "%%MatrixMarket matrix coordinate pattern symmetric\n"
+        "3 3 2\n"
+        "2 1\n"
+        "3 3\n");
+    
+    Matrix<int, 0, 2> matrix;
+    loadText(matrix, path, TextFormat::MATRIX_MARKET);
+    
+    ASSERT_EQ(dump(matrix), "0,1=1;1,0=1;2,2=1;");
+    std::remove(path.c_str());
+}
+
+
+TEST(TextIO, Coordinate) {
+    const std::string path = writeFile("text_io_coordinate.csv",
+        "# i,j,v\n"
+        "0,0,5\n"
+        "7, 3, -1\n"
+        "0 0 6\n"
+        "2,2,0");
+    
+    Matrix<int, 0, 2, HashData<int, 2>> matrix;
+    loadText(matrix, path, TextFormat::COORDINATE);
+    
+    ASSERT_EQ(dump(matrix), "0,0=6;7,3=-1;");
+    std::remove(path.c_str());
+}
+
+
+TEST(TextIO, Malformed) {
+    Matrix<int, 0, 2> matrix;
+    matrix[1][1] = 1;
+    
+    const std::string bad_value = writeFile("text_io_bad_value.csv", "1 2 3\n1 2 x\n");
+    ASSERT_THROW(loadText(matrix, bad_value, TextFormat::COORDINATE), std::runtime_error);
+    
+    const std::string extra = writeFile("text_io_extra.csv", "1 2 3 4\n");
+    ASSERT_THROW(loadText(matrix, extra, TextFormat::COORDINATE), std::runtime_error);
+    
+    const std::string zero_index = writeFile("text_io_zero.mtx", "%%MatrixMarket matrix coordinate integer general\n2 2 1\n0 1 5\n");
+    ASSERT_THROW(loadText(matrix, zero_index, TextFormat::MATRIX_MARKET), std::runtime_error);
+    
+    const std::string array = writeFile("text_io_array.mtx", "%%MatrixMarket matrix array real general\n2 2\n1\n2\n3\n4\n");
+    ASSERT_THROW(loadText(matrix, array, TextFormat::MATRIX_MARKET), std::runtime_error);
+    
+    const std::string truncated = writeFile("text_io_truncated.mtx", "%%MatrixMarket matrix coordinate integer general\n3 3 3\n1 1 5\n2 2 6\n");
+    ASSERT_THROW(loadText(matrix, truncated, TextFormat::MATRIX_MARKET), std::runtime_error);
+    
+    const std::string outside = writeFile("text_io_outside.mtx", "%%MatrixMarket matrix coordinate integer general\n2 2 1\n3 1 5\n");
+    ASSERT_THROW(loadText(matrix, outside, TextFormat::MATRIX_MARKET), std::runtime_error);
+    
+    ASSERT_EQ(dump(matrix), "1,1=1;");
+    for (const auto& path : {bad_value, extra, zero_index, array, truncated, outside}) {
+        std::remove(path.c_str());
+    }
+}
+
+
+TEST(TextIO, BoolRoundTrip) {
+    Matrix<bool, false, 2> matrix;
+    matrix[0][3] = true;
+    matrix[2][1] = true;
+    
+    for (const auto format : {TextFormat::MATRIX_MARKET, TextFormat::COORDINATE}) {
+        const std::string path = testing::TempDir() + "text_io_bool.txt";
+        saveText(matrix, path, format);
+        
+        Matrix<bool, false, 2> loaded;
+        loadText(loaded, path, format);
+        ASSERT_EQ(dump(loaded), "0,3=1;2,1=1;");
+        std::remove(path.c_str());
+    }
+}
+
+
+TEST(TextIO, RoundTripParallel) {
+    Matrix<long long, 0, 3> matrix;
+    std::mt19937 gen{9};
+    std::uniform_int_distribution<size_t> index{0, 99};
+    std::uniform_int_distribution<long long> value{-1000000, 1000000};
+    for (int i = 0; i < 20000; ++i) {
+        matrix.set({index(gen), index(gen), index(gen)}, value(gen));
+    }
+    
+    ThreadPool pool{4};
+    for (const auto format : {TextFormat::MATRIX_MARKET, TextFormat::COORDINATE}) {
+        const std::string path = testing::TempDir() + "text_io_round_trip.txt";
+        saveText(matrix, path, format);
+        
+        Matrix<long long, 0, 3> sequential;
+        loadText(sequential, path, format);
+        Matrix<long long, 0, 3> parallel;
+        loadText(parallel, path, format, DuplicatePolicy::THROW, pool);
+        
+        ASSERT_EQ(sequential.size(), matrix.size());
+        ASSERT_EQ(parallel.size(), matrix.size());
+        for (const auto& [x, y, z, v] : matrix) {
+            ASSERT_EQ(sequential(x, y, z), v);
+            ASSERT_EQ(parallel(x, y, z), v);
+        }
+        std::remove(path.c_str());
+    }
+}
+
+
+TEST(TextIO, ParallelKeepsFileOrder) {
+    std::ostringstream content;
+    for (int i = 1; i <= 5000; ++i) {
+        content << i % 7 << ' ' << i % 3 << ' ' << i << '\n';
+    }
+    const std::string path = writeFile("text_io_order.csv", content.str());
+    
+    ThreadPool pool{4};
+    Matrix<int, 0, 2> last;
+    loadText(last, path, TextFormat::COORDINATE, DuplicatePolicy::KEEP_LAST, pool);
+    Matrix<int, 0, 2> first;
+    loadText(first, path, TextFormat::COORDINATE, DuplicatePolicy::KEEP_FIRST, pool);
+    
+    for (int i = 4980; i <= 5000; ++i) {
+        ASSERT_EQ(last(i % 7, i % 3) > 4978, true);
+    }
+    ASSERT_EQ(first(1, 1), 1);
+    ASSERT_EQ(first(2, 2), 2);
+    std::remove(path.c_str());
+}